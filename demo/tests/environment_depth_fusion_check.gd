@@ -0,0 +1,89 @@
+extends SceneTree
+
+# Headless check for OpenXREnvironmentDepthFusion, which doesn't need an XR device.
+#
+# Integrates a synthetic depth image of a wall, and checks the distances and the mesh that come
+# out of the fusion. Run it from the repository root with:
+#
+#   godot --headless --path demo --script res://tests/environment_depth_fusion_check.gd
+#
+# The exit code is the number of failed checks.
+
+const WALL_DISTANCE := 2.0
+const IMAGE_SIZE := 64
+const INTEGRATION_COUNT := 4
+
+var failures := 0
+
+
+func _initialize() -> void:
+	_run()
+
+
+func _run() -> void:
+	var fusion := OpenXREnvironmentDepthFusion.new()
+	var voxel_size: float = fusion.voxel_size
+
+	# A depth camera at the origin, looking down -Z at a wall that fills the whole image. Linear
+	# depth is measured along the forward axis, so it's the same for every texel.
+	var depth := PackedFloat32Array()
+	depth.resize(IMAGE_SIZE * IMAGE_SIZE)
+	depth.fill(WALL_DISTANCE)
+	var tan_fov := Vector4(-0.5, 0.5, -0.5, 0.5)
+
+	for _i in INTEGRATION_COUNT:
+		fusion.integrate_depth_image(depth, IMAGE_SIZE, IMAGE_SIZE, Transform3D(), tan_fov)
+		await fusion.blocks_changed
+
+	_check(fusion.get_block_count() > 0, "blocks were allocated around the wall")
+
+	var on_wall: float = fusion.get_distance(Vector3(0.0, 0.0, -WALL_DISTANCE))
+	_check(absf(on_wall) < voxel_size, "distance on the wall is about 0 (got %f)" % on_wall)
+
+	var in_front: float = fusion.get_distance(Vector3(0.0, 0.0, -WALL_DISTANCE + 0.05))
+	_check(absf(in_front - 0.05) < voxel_size, "distance in front of the wall is about 0.05 (got %f)" % in_front)
+
+	var behind: float = fusion.get_distance(Vector3(0.0, 0.0, -WALL_DISTANCE - 0.05))
+	_check(behind < 0.0, "distance behind the wall is negative (got %f)" % behind)
+
+	var unobserved: float = fusion.get_distance(Vector3(0.0, 0.0, 5.0))
+	_check(is_inf(unobserved), "distance behind the camera is unknown (got %f)" % unobserved)
+
+	var vertex_count := 0
+	var off_wall_count := 0
+	var misaligned_count := 0
+	for block in fusion.get_blocks():
+		var arrays: Array = fusion.extract_block_mesh(block)
+		if arrays.is_empty():
+			continue
+
+		var vertices: PackedVector3Array = arrays[Mesh.ARRAY_VERTEX]
+		var normals: PackedVector3Array = arrays[Mesh.ARRAY_NORMAL]
+		var indices: PackedInt32Array = arrays[Mesh.ARRAY_INDEX]
+		_check(normals.size() == vertices.size(), "block %s has a normal per vertex" % block)
+		_check(indices.size() % 3 == 0, "block %s has whole triangles" % block)
+
+		vertex_count += vertices.size()
+		for i in vertices.size():
+			if absf(vertices[i].z + WALL_DISTANCE) > voxel_size:
+				off_wall_count += 1
+			# Normals point out of the surface, towards the camera.
+			if normals[i].z < 0.9:
+				misaligned_count += 1
+
+	_check(vertex_count > 0, "the wall was meshed")
+	_check(off_wall_count == 0, "all %d vertices lie on the wall (%d don't)" % [vertex_count, off_wall_count])
+	_check(misaligned_count == 0, "all %d normals face the camera (%d don't)" % [vertex_count, misaligned_count])
+
+	fusion.clear()
+	_check(fusion.get_block_count() == 0, "clear() removes all blocks")
+
+	if failures == 0:
+		print("OpenXREnvironmentDepthFusion: all checks passed")
+	quit(failures)
+
+
+func _check(condition: bool, description: String) -> void:
+	if not condition:
+		failures += 1
+		printerr("FAILED: ", description)
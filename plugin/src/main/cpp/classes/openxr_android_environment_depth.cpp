@@ -49,7 +49,15 @@ void OpenXRAndroidEnvironmentDepth::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("set_reprojection_offset_exponent", "offset_exponent"), &OpenXRAndroidEnvironmentDepth::set_reprojection_offset_exponent);
 	ClassDB::bind_method(D_METHOD("get_reprojection_offset_exponent"), &OpenXRAndroidEnvironmentDepth::get_reprojection_offset_exponent);
 
+	ClassDB::bind_method(D_METHOD("set_downsample", "downsample"), &OpenXRAndroidEnvironmentDepth::set_downsample);
+	ClassDB::bind_method(D_METHOD("get_downsample"), &OpenXRAndroidEnvironmentDepth::get_downsample);
+
+	ClassDB::bind_method(D_METHOD("set_limit_to_receivers", "enabled"), &OpenXRAndroidEnvironmentDepth::set_limit_to_receivers);
+	ClassDB::bind_method(D_METHOD("get_limit_to_receivers"), &OpenXRAndroidEnvironmentDepth::get_limit_to_receivers);
+
 	ADD_PROPERTY(PropertyInfo(Variant::INT, "render_priority"), "set_render_priority", "get_render_priority");
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "downsample", PROPERTY_HINT_RANGE, "1,4,1"), "set_downsample", "get_downsample");
+	ADD_PROPERTY(PropertyInfo(Variant::BOOL, "limit_to_receivers"), "set_limit_to_receivers", "get_limit_to_receivers");
 
 	ADD_GROUP("Reprojection Offset", "reprojection_offset_");
 	ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "reprojection_offset_scale"), "set_reprojection_offset_scale", "get_reprojection_offset_scale");
@@ -80,6 +88,22 @@ float OpenXRAndroidEnvironmentDepth::get_reprojection_offset_exponent() const {
 	return OpenXRAndroidEnvironmentDepthExtension::get_singleton()->get_reprojection_offset_exponent();
 }
 
+void OpenXRAndroidEnvironmentDepth::set_downsample(int p_downsample) {
+	OpenXRAndroidEnvironmentDepthExtension::get_singleton()->set_reprojection_downsample(p_downsample);
+}
+
+int OpenXRAndroidEnvironmentDepth::get_downsample() const {
+	return OpenXRAndroidEnvironmentDepthExtension::get_singleton()->get_reprojection_downsample();
+}
+
+void OpenXRAndroidEnvironmentDepth::set_limit_to_receivers(bool p_enabled) {
+	OpenXRAndroidEnvironmentDepthExtension::get_singleton()->set_reprojection_limit_to_receivers(p_enabled);
+}
+
+bool OpenXRAndroidEnvironmentDepth::get_limit_to_receivers() const {
+	return OpenXRAndroidEnvironmentDepthExtension::get_singleton()->get_reprojection_limit_to_receivers();
+}
+
 void OpenXRAndroidEnvironmentDepth::_notification(int p_what) {
 	switch (p_what) {
 		case NOTIFICATION_ENTER_TREE:
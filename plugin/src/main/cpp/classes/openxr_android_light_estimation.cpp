@@ -34,11 +34,14 @@
 #include <godot_cpp/classes/environment.hpp>
 #include <godot_cpp/classes/open_xr_interface.hpp>
 #include <godot_cpp/classes/open_xrapi_extension.hpp>
+#include <godot_cpp/classes/rendering_server.hpp>
 #include <godot_cpp/classes/shader.hpp>
 #include <godot_cpp/classes/shader_material.hpp>
 #include <godot_cpp/classes/sky.hpp>
+#include <godot_cpp/classes/time.hpp>
 #include <godot_cpp/classes/world_environment.hpp>
 #include <godot_cpp/classes/xr_server.hpp>
+#include <godot_cpp/variant/typed_array.hpp>
 
 #include "extensions/openxr_android_light_estimation_extension.h"
 
@@ -122,12 +125,24 @@ void OpenXRAndroidLightEstimation::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("set_ambient_light_energy_multiplier", "value"), &OpenXRAndroidLightEstimation::set_ambient_light_energy_multiplier);
 	ClassDB::bind_method(D_METHOD("get_ambient_light_energy_multiplier"), &OpenXRAndroidLightEstimation::get_ambient_light_energy_multiplier);
 
+	ClassDB::bind_method(D_METHOD("set_smoothing_time", "smoothing_time"), &OpenXRAndroidLightEstimation::set_smoothing_time);
+	ClassDB::bind_method(D_METHOD("get_smoothing_time"), &OpenXRAndroidLightEstimation::get_smoothing_time);
+
+	ClassDB::bind_method(D_METHOD("set_sky_update_threshold", "threshold"), &OpenXRAndroidLightEstimation::set_sky_update_threshold);
+	ClassDB::bind_method(D_METHOD("get_sky_update_threshold"), &OpenXRAndroidLightEstimation::get_sky_update_threshold);
+
+	ClassDB::bind_method(D_METHOD("set_max_sky_update_rate", "rate"), &OpenXRAndroidLightEstimation::set_max_sky_update_rate);
+	ClassDB::bind_method(D_METHOD("get_max_sky_update_rate"), &OpenXRAndroidLightEstimation::get_max_sky_update_rate);
+
 	ADD_PROPERTY(PropertyInfo(Variant::OBJECT, "directional_light", PROPERTY_HINT_NODE_TYPE, "DirectionalLight3D"), "set_directional_light", "get_directional_light");
 	ADD_PROPERTY(PropertyInfo(Variant::INT, "directional_light_mode", PROPERTY_HINT_ENUM, "Disabled,Direction Only,Direction + Intensity,Direction + Color + Intensity"), "set_directional_light_mode", "get_directional_light_mode");
 	ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "directional_light_energy_multiplier", PROPERTY_HINT_RANGE, "0,16,0.01"), "set_directional_light_energy_multiplier", "get_directional_light_energy_multiplier");
 	ADD_PROPERTY(PropertyInfo(Variant::OBJECT, "world_environment", PROPERTY_HINT_NODE_TYPE, "WorldEnvironment"), "set_world_environment", "get_world_environment");
-	ADD_PROPERTY(PropertyInfo(Variant::INT, "ambient_light_mode", PROPERTY_HINT_ENUM, "Disabled,Color,Spherical Harmonics"), "set_ambient_light_mode", "get_ambient_light_mode");
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "ambient_light_mode", PROPERTY_HINT_ENUM, "Disabled:0,Color:1,Spherical Harmonics:2,Spherical Harmonics (Global Shader Parameters):4"), "set_ambient_light_mode", "get_ambient_light_mode");
 	ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "ambient_light_energy_multiplier", PROPERTY_HINT_RANGE, "0,16,0.01"), "set_ambient_light_energy_multiplier", "get_ambient_light_energy_multiplier");
+	ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "smoothing_time", PROPERTY_HINT_RANGE, "0,2,0.01,suffix:s"), "set_smoothing_time", "get_smoothing_time");
+	ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "sky_update_threshold", PROPERTY_HINT_RANGE, "0,1,0.001"), "set_sky_update_threshold", "get_sky_update_threshold");
+	ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "max_sky_update_rate", PROPERTY_HINT_RANGE, "0,90,0.1,suffix:Hz"), "set_max_sky_update_rate", "get_max_sky_update_rate");
 
 	BIND_ENUM_CONSTANT(DIRECTIONAL_LIGHT_MODE_DISABLED);
 	BIND_ENUM_CONSTANT(DIRECTIONAL_LIGHT_MODE_DIRECTION_ONLY);
@@ -138,6 +153,7 @@ void OpenXRAndroidLightEstimation::_bind_methods() {
 	BIND_ENUM_CONSTANT(AMBIENT_LIGHT_MODE_COLOR);
 	BIND_ENUM_CONSTANT(AMBIENT_LIGHT_MODE_SPHERICAL_HARMONICS);
 	//BIND_ENUM_CONSTANT(AMBIENT_LIGHT_MODE_CUBEMAP);
+	BIND_ENUM_CONSTANT(AMBIENT_LIGHT_MODE_SPHERICAL_HARMONICS_GLOBAL_SHADER);
 }
 
 void OpenXRAndroidLightEstimation::_notification(int p_what) {
@@ -215,6 +231,7 @@ float OpenXRAndroidLightEstimation::get_directional_light_energy_multiplier() {
 
 void OpenXRAndroidLightEstimation::set_world_environment(WorldEnvironment *p_world_environment) {
 	reset_sky();
+	spherical_harmonics_state.applied_coefficients.clear();
 	if (p_world_environment) {
 		world_environment_id = p_world_environment->get_instance_id();
 		if (is_processing_internal()) {
@@ -230,7 +247,12 @@ WorldEnvironment *OpenXRAndroidLightEstimation::get_world_environment() const {
 }
 
 void OpenXRAndroidLightEstimation::set_ambient_light_mode(AmbientLightMode p_ambient_light_mode) {
+	if (ambient_light_mode != p_ambient_light_mode) {
+		// Don't leave the sky of the previous mode in place, e.g. alongside the global shader parameters.
+		reset_sky();
+	}
 	ambient_light_mode = p_ambient_light_mode;
+	spherical_harmonics_state.applied_coefficients.clear();
 	if (ambient_light_mode != AMBIENT_LIGHT_MODE_DISABLED && is_processing_internal()) {
 		configure_light_estimate_types();
 	}
@@ -248,6 +270,30 @@ float OpenXRAndroidLightEstimation::get_ambient_light_energy_multiplier() {
 	return ambient_light_energy_multiplier;
 }
 
+void OpenXRAndroidLightEstimation::set_smoothing_time(float p_smoothing_time) {
+	smoothing_time = MAX(p_smoothing_time, 0.0f);
+}
+
+float OpenXRAndroidLightEstimation::get_smoothing_time() const {
+	return smoothing_time;
+}
+
+void OpenXRAndroidLightEstimation::set_sky_update_threshold(float p_threshold) {
+	sky_update_threshold = MAX(p_threshold, 0.0f);
+}
+
+float OpenXRAndroidLightEstimation::get_sky_update_threshold() const {
+	return sky_update_threshold;
+}
+
+void OpenXRAndroidLightEstimation::set_max_sky_update_rate(float p_rate) {
+	max_sky_update_rate = MAX(p_rate, 0.0f);
+}
+
+float OpenXRAndroidLightEstimation::get_max_sky_update_rate() const {
+	return max_sky_update_rate;
+}
+
 void OpenXRAndroidLightEstimation::start_or_stop() {
 	OpenXRAndroidLightEstimationExtension *light_estimation_extension = OpenXRAndroidLightEstimationExtension::get_singleton();
 	ERR_FAIL_NULL(light_estimation_extension);
@@ -284,7 +330,10 @@ void OpenXRAndroidLightEstimation::configure_light_estimate_types() {
 		estimate_types.set_flag(OpenXRAndroidLightEstimationExtension::LIGHT_ESTIMATE_TYPE_DIRECTIONAL_LIGHT);
 	}
 
-	if (get_world_environment() && ambient_light_mode != AMBIENT_LIGHT_MODE_DISABLED) {
+	if (ambient_light_mode == AMBIENT_LIGHT_MODE_SPHERICAL_HARMONICS_GLOBAL_SHADER) {
+		// Custom materials read the global shader parameters, so no WorldEnvironment is needed.
+		estimate_types.set_flag(OpenXRAndroidLightEstimationExtension::LIGHT_ESTIMATE_TYPE_SPHERICAL_HARMONICS_TOTAL);
+	} else if (get_world_environment() && ambient_light_mode != AMBIENT_LIGHT_MODE_DISABLED) {
 		if (ambient_light_mode == AMBIENT_LIGHT_MODE_COLOR) {
 			estimate_types.set_flag(OpenXRAndroidLightEstimationExtension::LIGHT_ESTIMATE_TYPE_AMBIENT);
 		} else if (ambient_light_mode == AMBIENT_LIGHT_MODE_SPHERICAL_HARMONICS) {
@@ -299,80 +348,223 @@ void OpenXRAndroidLightEstimation::update_light_estimate() {
 	OpenXRAndroidLightEstimationExtension *light_estimation_extension = OpenXRAndroidLightEstimationExtension::get_singleton();
 	ERR_FAIL_NULL(light_estimation_extension);
 
+	int64_t estimate_time = light_estimation_extension->get_last_updated_time();
+	if (light_estimation_extension->is_estimate_valid() && estimate_time > last_update_time) {
+		last_update_time = estimate_time;
+
+		if (light_estimation_extension->is_directional_light_valid()) {
+			directional_light_state.target_direction = light_estimation_extension->get_directional_light_direction();
+			directional_light_state.target_intensity = light_estimation_extension->get_directional_light_intensity();
+			if (!directional_light_state.valid) {
+				directional_light_state.direction = directional_light_state.target_direction;
+				directional_light_state.intensity = directional_light_state.target_intensity;
+				directional_light_state.valid = true;
+			}
+			directional_light_state.dirty = true;
+		}
+
+		if (light_estimation_extension->is_spherical_harmonics_total_valid()) {
+			PackedVector3Array coefficients = light_estimation_extension->get_spherical_harmonics_total_coefficients();
+			const Vector3 *coefficients_ptr = coefficients.ptr();
+			for (int i = 0; i < 9; i++) {
+				spherical_harmonics_state.target_coefficients[i] = coefficients_ptr[i] * ANDROID_LIGHT_ESTIMATION_SH_FACTORS[i];
+				if (!spherical_harmonics_state.valid) {
+					spherical_harmonics_state.coefficients[i] = spherical_harmonics_state.target_coefficients[i];
+				}
+			}
+			spherical_harmonics_state.valid = true;
+			spherical_harmonics_state.dirty = true;
+		}
+
+		WorldEnvironment *world_environment = get_world_environment();
+		Ref<Environment> env;
+		if (world_environment) {
+			env = world_environment->get_environment();
+		}
+
+		if (env.is_valid() && ambient_light_mode == AMBIENT_LIGHT_MODE_COLOR && light_estimation_extension->is_ambient_light_valid()) {
+			// The color is premultiplied with intensity.
+			Color intensity = light_estimation_extension->get_ambient_light_intensity();
+			env->set_ambient_light_color(intensity.linear_to_srgb());
+			env->set_ambient_light_energy(ambient_light_energy_multiplier);
+			env->set_ambient_source(Environment::AMBIENT_SOURCE_COLOR);
+		}
+	}
+
+	// Estimates arrive at a much lower rate than frames, so ease towards the latest one
+	// every frame rather than jumping to it.
+	float weight = 1.0f;
+	if (smoothing_time > 0.0f) {
+		weight = 1.0f - Math::exp(-(float)get_process_delta_time() / smoothing_time);
+	}
+
+	update_directional_light(weight);
+	update_spherical_harmonics(weight);
+}
+
+void OpenXRAndroidLightEstimation::update_directional_light(float p_weight) {
+	DirectionalLight3D *direction_light = get_directional_light();
+	if (!direction_light || directional_light_mode == DIRECTIONAL_LIGHT_MODE_DISABLED || !directional_light_state.dirty) {
+		return;
+	}
+
+	DirectionalLightState &state = directional_light_state;
+	Vector3 direction = state.direction.lerp(state.target_direction, p_weight);
+	if (!direction.is_zero_approx()) {
+		state.direction = direction.normalized();
+	} else {
+		state.direction = state.target_direction;
+	}
+	state.intensity = state.intensity.lerp(state.target_intensity, p_weight);
+	if (state.direction.is_equal_approx(state.target_direction) && state.intensity.is_equal_approx(state.target_intensity)) {
+		state.direction = state.target_direction;
+		state.intensity = state.target_intensity;
+		state.dirty = false;
+	}
+
 	XRServer *xr_server = XRServer::get_singleton();
 	ERR_FAIL_NULL(xr_server);
 
-	if (!light_estimation_extension->is_estimate_valid()) {
+	Basis light_basis = Basis::looking_at(-state.direction) * xr_server->get_world_origin().basis;
+	direction_light->set_global_basis(light_basis);
+
+	if (directional_light_mode >= DIRECTIONAL_LIGHT_MODE_DIRECTION_INTENSITY) {
+		if (directional_light_mode == DIRECTIONAL_LIGHT_MODE_DIRECTION_COLOR_INTENSITY) {
+			// The color is premultiplied with intensity.
+			direction_light->set_color(state.intensity.linear_to_srgb());
+			direction_light->set_param(Light3D::PARAM_ENERGY, directional_light_energy_multiplier);
+		} else {
+			float luminance = (0.2126 * state.intensity.r) + (0.7152 * state.intensity.g) + (0.0722 * state.intensity.b);
+			direction_light->set_param(Light3D::PARAM_ENERGY, luminance * directional_light_energy_multiplier);
+		}
+	}
+}
+
+void OpenXRAndroidLightEstimation::update_spherical_harmonics(float p_weight) {
+	SphericalHarmonicsState &state = spherical_harmonics_state;
+	if (!state.valid) {
 		return;
 	}
 
-	int64_t estimate_time = light_estimation_extension->get_last_updated_time();
-	if (estimate_time <= last_update_time) {
+	if (ambient_light_mode != AMBIENT_LIGHT_MODE_SPHERICAL_HARMONICS && ambient_light_mode != AMBIENT_LIGHT_MODE_SPHERICAL_HARMONICS_GLOBAL_SHADER) {
 		return;
 	}
-	last_update_time = estimate_time;
 
-	DirectionalLight3D *direction_light = get_directional_light();
-	if (direction_light && directional_light_mode != DIRECTIONAL_LIGHT_MODE_DISABLED && light_estimation_extension->is_directional_light_valid()) {
-		Basis light_basis = Basis::looking_at(-light_estimation_extension->get_directional_light_direction()) * xr_server->get_world_origin().basis;
-		direction_light->set_global_basis(light_basis);
-
-		if (directional_light_mode >= DIRECTIONAL_LIGHT_MODE_DIRECTION_INTENSITY) {
-			Color intensity = light_estimation_extension->get_directional_light_intensity();
-
-			if (directional_light_mode == DIRECTIONAL_LIGHT_MODE_DIRECTION_COLOR_INTENSITY) {
-				// The color is premultiplied with intensity.
-				direction_light->set_color(intensity.linear_to_srgb());
-				direction_light->set_param(Light3D::PARAM_ENERGY, directional_light_energy_multiplier);
-			} else {
-				float luminance = (0.2126 * intensity.r) + (0.7152 * intensity.g) + (0.0722 * intensity.b);
-				direction_light->set_param(Light3D::PARAM_ENERGY, luminance * directional_light_energy_multiplier);
+	if (state.dirty) {
+		bool converged = true;
+		for (int i = 0; i < 9; i++) {
+			state.coefficients[i] = state.coefficients[i].lerp(state.target_coefficients[i], p_weight);
+			converged = converged && state.coefficients[i].is_equal_approx(state.target_coefficients[i]);
+		}
+		if (converged) {
+			for (int i = 0; i < 9; i++) {
+				state.coefficients[i] = state.target_coefficients[i];
 			}
+			state.dirty = false;
 		}
 	}
 
-	WorldEnvironment *world_environment = get_world_environment();
-	Ref<Environment> env;
-	if (world_environment) {
-		env = world_environment->get_environment();
-	}
+	XRServer *xr_server = XRServer::get_singleton();
+	ERR_FAIL_NULL(xr_server);
 
-	if (env.is_valid() && ambient_light_mode != AMBIENT_LIGHT_MODE_DISABLED) {
-		if (ambient_light_mode == AMBIENT_LIGHT_MODE_COLOR && light_estimation_extension->is_ambient_light_valid()) {
-			// The color is premultiplied with intensity.
-			Color intensity = light_estimation_extension->get_ambient_light_intensity();
-			env->set_ambient_light_color(intensity.linear_to_srgb());
-			env->set_ambient_light_energy(ambient_light_energy_multiplier);
-			env->set_ambient_source(Environment::AMBIENT_SOURCE_COLOR);
-		} else if (ambient_light_mode == AMBIENT_LIGHT_MODE_SPHERICAL_HARMONICS && light_estimation_extension->is_spherical_harmonics_total_valid()) {
-			PackedVector3Array coefficients = light_estimation_extension->get_spherical_harmonics_total_coefficients();
-			Vector3 *coefficients_ptr = coefficients.ptrw();
-			for (int i = 0; i < 9; i++) {
-				coefficients_ptr[i] = coefficients_ptr[i] * ANDROID_LIGHT_ESTIMATION_SH_FACTORS[i];
-			}
+	Basis rotation = xr_server->get_world_origin().basis;
 
-			if (sky_shader.is_null()) {
-				sky_shader.instantiate();
-				sky_shader->set_code(ANDROID_LIGHT_ESTIMATION_SHADER);
-			}
-			if (sky_material.is_null()) {
-				sky_material.instantiate();
-				sky_material->set_shader(sky_shader);
-				sky->set_material(sky_material);
+	if (ambient_light_mode == AMBIENT_LIGHT_MODE_SPHERICAL_HARMONICS_GLOBAL_SHADER) {
+		// Global shader parameters don't invalidate the sky, so they can be updated on every change.
+		if (!needs_spherical_harmonics_update(rotation, 0.0f)) {
+			return;
+		}
+
+		OpenXRAndroidLightEstimationExtension *light_estimation_extension = OpenXRAndroidLightEstimationExtension::get_singleton();
+		ERR_FAIL_NULL(light_estimation_extension);
+
+		Vector3 coefficients[9];
+		for (int i = 0; i < 9; i++) {
+			coefficients[i] = state.coefficients[i] * ambient_light_energy_multiplier;
+		}
+		light_estimation_extension->set_smoothed_spherical_harmonics_global_shader_parameters(coefficients, rotation);
+	} else {
+		WorldEnvironment *world_environment = get_world_environment();
+		Ref<Environment> env;
+		if (world_environment) {
+			env = world_environment->get_environment();
+		}
+		if (env.is_null()) {
+			return;
+		}
+
+		// Every change to the sky material re-renders the radiance cubemap and its mipmaps, so
+		// only do so for visible changes and at a limited rate.
+		uint64_t now = Time::get_singleton()->get_ticks_usec();
+		if (max_sky_update_rate > 0.0f && state.applied_coefficients.size() == 9 && now - state.last_applied_usec < (uint64_t)(1000000.0f / max_sky_update_rate)) {
+			return;
+		}
+		if (!needs_spherical_harmonics_update(rotation, sky_update_threshold)) {
+			return;
+		}
+		state.last_applied_usec = now;
+
+		if (sky_shader.is_null()) {
+			sky_shader.instantiate();
+			sky_shader->set_code(ANDROID_LIGHT_ESTIMATION_SHADER);
+		}
+		if (sky_material.is_null()) {
+			sky_material.instantiate();
+			sky_material->set_shader(sky_shader);
+			sky->set_material(sky_material);
+		}
+
+		PackedVector3Array coefficients;
+		coefficients.resize(9);
+		Vector3 *coefficients_ptr = coefficients.ptrw();
+		for (int i = 0; i < 9; i++) {
+			coefficients_ptr[i] = state.coefficients[i];
+		}
+
+		sky_material->set_shader_parameter("coefficients", coefficients);
+		sky_material->set_shader_parameter("rotation", rotation);
+		sky_material->set_shader_parameter("ambient_light_energy_multiplier", ambient_light_energy_multiplier);
+		if (env->get_sky() != sky) {
+			if (old_sky.is_null()) {
+				old_sky = env->get_sky();
 			}
+			env->set_sky(sky);
+		}
+		env->set_ambient_source(Environment::AMBIENT_SOURCE_SKY);
+	}
 
-			sky_material->set_shader_parameter("coefficients", coefficients);
-			sky_material->set_shader_parameter("rotation", xr_server->get_world_origin().basis);
-			sky_material->set_shader_parameter("ambient_light_energy_multiplier", ambient_light_energy_multiplier);
-			if (env->get_sky() != sky) {
-				if (old_sky.is_null()) {
-					old_sky = env->get_sky();
-				}
-				env->set_sky(sky);
+	state.applied_coefficients.resize(9);
+	Vector3 *applied_ptr = state.applied_coefficients.ptrw();
+	for (int i = 0; i < 9; i++) {
+		applied_ptr[i] = state.coefficients[i];
+	}
+	state.applied_rotation = rotation;
+	state.applied_energy_multiplier = ambient_light_energy_multiplier;
+}
+
+bool OpenXRAndroidLightEstimation::needs_spherical_harmonics_update(const Basis &p_rotation, float p_threshold) const {
+	const SphericalHarmonicsState &state = spherical_harmonics_state;
+	if (state.applied_coefficients.size() != 9) {
+		return true;
+	}
+
+	if (!p_rotation.is_equal_approx(state.applied_rotation) || !Math::is_equal_approx(ambient_light_energy_multiplier, state.applied_energy_multiplier)) {
+		return true;
+	}
+
+	const Vector3 *applied_ptr = state.applied_coefficients.ptr();
+	for (int i = 0; i < 9; i++) {
+		Vector3 difference = (state.coefficients[i] - applied_ptr[i]).abs();
+		if (p_threshold > 0.0f) {
+			if (difference[difference.max_axis_index()] > p_threshold) {
+				return true;
 			}
-			env->set_ambient_source(Environment::AMBIENT_SOURCE_SKY);
+		} else if (!difference.is_zero_approx()) {
+			return true;
 		}
 	}
+
+	return false;
 }
 
 void OpenXRAndroidLightEstimation::reset_sky() {
@@ -108,18 +108,27 @@ void OpenXRAndroidTrackableObjectTracker::_ensure_updated() {
 		return;
 	}
 
-	// always set pose, even when old last updated time == xr_trackable_object.lastUpdatedTime, since
+	_apply_xrtrackable_object(xr_trackable_object);
+}
+
+void OpenXRAndroidTrackableObjectTracker::update_from_xrtrackable_object(const XrTrackableObjectANDROID &p_xr_trackable_object) {
+	last_frame = Engine::get_singleton()->get_process_frames();
+	_apply_xrtrackable_object(p_xr_trackable_object);
+}
+
+void OpenXRAndroidTrackableObjectTracker::_apply_xrtrackable_object(const XrTrackableObjectANDROID &p_xr_trackable_object) {
+	// always set pose, even when old last updated time == p_xr_trackable_object.lastUpdatedTime, since
 	// it could have changed due to XR changing the reference space
-	extents.x = xr_trackable_object.extents.width;
-	extents.y = xr_trackable_object.extents.height;
-	extents.z = xr_trackable_object.extents.depth;
-	_set_center_pose(xr_trackable_object.centerPose);
+	extents.x = p_xr_trackable_object.extents.width;
+	extents.y = p_xr_trackable_object.extents.height;
+	extents.z = p_xr_trackable_object.extents.depth;
+	_set_center_pose(p_xr_trackable_object.centerPose);
 
-	if (_set_last_updated_time(xr_trackable_object.lastUpdatedTime) == xr_trackable_object.lastUpdatedTime) {
+	if (_set_last_updated_time(p_xr_trackable_object.lastUpdatedTime) == p_xr_trackable_object.lastUpdatedTime) {
 		return;
 	}
 
-	switch (xr_trackable_object.objectLabel) {
+	switch (p_xr_trackable_object.objectLabel) {
 		case XR_OBJECT_LABEL_UNKNOWN_ANDROID:
 			object_label = OBJECT_LABEL_UNKNOWN;
 			break;
@@ -134,12 +143,12 @@ void OpenXRAndroidTrackableObjectTracker::_ensure_updated() {
 			break;
 		case XR_OBJECT_LABEL_MAX_ENUM_ANDROID:
 		default:
-			UtilityFunctions::printerr("OpenXR: invalid object label: ", xr_trackable_object.objectLabel);
+			UtilityFunctions::printerr("OpenXR: invalid object label: ", p_xr_trackable_object.objectLabel);
 			_set_tracking_state(XR_TRACKING_STATE_STOPPED_ANDROID);
 			return;
 	}
 
-	_set_tracking_state(xr_trackable_object.trackingState);
+	_set_tracking_state(p_xr_trackable_object.trackingState);
 
 	// Any recursive calls this 'updated' signal brings will early-return.
 	// It should never infinitely recurse.
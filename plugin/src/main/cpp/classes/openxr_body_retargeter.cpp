@@ -0,0 +1,354 @@
+/**************************************************************************/
+/*  openxr_body_retargeter.cpp                                            */
+/**************************************************************************/
+/*                       This file is part of:                            */
+/*                              GODOT XR                                  */
+/*                      https://godotengine.org                           */
+/**************************************************************************/
+/* Copyright (c) 2022-present Godot XR contributors (see CONTRIBUTORS.md) */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#include "classes/openxr_body_retargeter.h"
+
+#include <godot_cpp/classes/engine.hpp>
+#include <godot_cpp/classes/skeleton_profile_humanoid.hpp>
+#include <godot_cpp/classes/xr_server.hpp>
+
+using namespace godot;
+
+/// Mapping from body tracker joints to the bones of Godot's humanoid skeleton profile.
+struct RetargetJoint {
+	XRBodyTracker::Joint joint;
+	const char *bone_name;
+};
+
+static const RetargetJoint retarget_joints[] = {
+	{ XRBodyTracker::JOINT_HIPS, "Hips" },
+	{ XRBodyTracker::JOINT_SPINE, "Spine" },
+	{ XRBodyTracker::JOINT_CHEST, "Chest" },
+	{ XRBodyTracker::JOINT_UPPER_CHEST, "UpperChest" },
+	{ XRBodyTracker::JOINT_NECK, "Neck" },
+	{ XRBodyTracker::JOINT_HEAD, "Head" },
+
+	{ XRBodyTracker::JOINT_LEFT_SHOULDER, "LeftShoulder" },
+	{ XRBodyTracker::JOINT_LEFT_UPPER_ARM, "LeftUpperArm" },
+	{ XRBodyTracker::JOINT_LEFT_LOWER_ARM, "LeftLowerArm" },
+	{ XRBodyTracker::JOINT_LEFT_HAND, "LeftHand" },
+	{ XRBodyTracker::JOINT_LEFT_THUMB_METACARPAL, "LeftThumbMetacarpal" },
+	{ XRBodyTracker::JOINT_LEFT_THUMB_PHALANX_PROXIMAL, "LeftThumbProximal" },
+	{ XRBodyTracker::JOINT_LEFT_THUMB_PHALANX_DISTAL, "LeftThumbDistal" },
+	{ XRBodyTracker::JOINT_LEFT_INDEX_FINGER_PHALANX_PROXIMAL, "LeftIndexProximal" },
+	{ XRBodyTracker::JOINT_LEFT_INDEX_FINGER_PHALANX_INTERMEDIATE, "LeftIndexIntermediate" },
+	{ XRBodyTracker::JOINT_LEFT_INDEX_FINGER_PHALANX_DISTAL, "LeftIndexDistal" },
+	{ XRBodyTracker::JOINT_LEFT_MIDDLE_FINGER_PHALANX_PROXIMAL, "LeftMiddleProximal" },
+	{ XRBodyTracker::JOINT_LEFT_MIDDLE_FINGER_PHALANX_INTERMEDIATE, "LeftMiddleIntermediate" },
+	{ XRBodyTracker::JOINT_LEFT_MIDDLE_FINGER_PHALANX_DISTAL, "LeftMiddleDistal" },
+	{ XRBodyTracker::JOINT_LEFT_RING_FINGER_PHALANX_PROXIMAL, "LeftRingProximal" },
+	{ XRBodyTracker::JOINT_LEFT_RING_FINGER_PHALANX_INTERMEDIATE, "LeftRingIntermediate" },
+	{ XRBodyTracker::JOINT_LEFT_RING_FINGER_PHALANX_DISTAL, "LeftRingDistal" },
+	{ XRBodyTracker::JOINT_LEFT_PINKY_FINGER_PHALANX_PROXIMAL, "LeftLittleProximal" },
+	{ XRBodyTracker::JOINT_LEFT_PINKY_FINGER_PHALANX_INTERMEDIATE, "LeftLittleIntermediate" },
+	{ XRBodyTracker::JOINT_LEFT_PINKY_FINGER_PHALANX_DISTAL, "LeftLittleDistal" },
+
+	{ XRBodyTracker::JOINT_RIGHT_SHOULDER, "RightShoulder" },
+	{ XRBodyTracker::JOINT_RIGHT_UPPER_ARM, "RightUpperArm" },
+	{ XRBodyTracker::JOINT_RIGHT_LOWER_ARM, "RightLowerArm" },
+	{ XRBodyTracker::JOINT_RIGHT_HAND, "RightHand" },
+	{ XRBodyTracker::JOINT_RIGHT_THUMB_METACARPAL, "RightThumbMetacarpal" },
+	{ XRBodyTracker::JOINT_RIGHT_THUMB_PHALANX_PROXIMAL, "RightThumbProximal" },
+	{ XRBodyTracker::JOINT_RIGHT_THUMB_PHALANX_DISTAL, "RightThumbDistal" },
+	{ XRBodyTracker::JOINT_RIGHT_INDEX_FINGER_PHALANX_PROXIMAL, "RightIndexProximal" },
+	{ XRBodyTracker::JOINT_RIGHT_INDEX_FINGER_PHALANX_INTERMEDIATE, "RightIndexIntermediate" },
+	{ XRBodyTracker::JOINT_RIGHT_INDEX_FINGER_PHALANX_DISTAL, "RightIndexDistal" },
+	{ XRBodyTracker::JOINT_RIGHT_MIDDLE_FINGER_PHALANX_PROXIMAL, "RightMiddleProximal" },
+	{ XRBodyTracker::JOINT_RIGHT_MIDDLE_FINGER_PHALANX_INTERMEDIATE, "RightMiddleIntermediate" },
+	{ XRBodyTracker::JOINT_RIGHT_MIDDLE_FINGER_PHALANX_DISTAL, "RightMiddleDistal" },
+	{ XRBodyTracker::JOINT_RIGHT_RING_FINGER_PHALANX_PROXIMAL, "RightRingProximal" },
+	{ XRBodyTracker::JOINT_RIGHT_RING_FINGER_PHALANX_INTERMEDIATE, "RightRingIntermediate" },
+	{ XRBodyTracker::JOINT_RIGHT_RING_FINGER_PHALANX_DISTAL, "RightRingDistal" },
+	{ XRBodyTracker::JOINT_RIGHT_PINKY_FINGER_PHALANX_PROXIMAL, "RightLittleProximal" },
+	{ XRBodyTracker::JOINT_RIGHT_PINKY_FINGER_PHALANX_INTERMEDIATE, "RightLittleIntermediate" },
+	{ XRBodyTracker::JOINT_RIGHT_PINKY_FINGER_PHALANX_DISTAL, "RightLittleDistal" },
+
+	{ XRBodyTracker::JOINT_LEFT_UPPER_LEG, "LeftUpperLeg" },
+	{ XRBodyTracker::JOINT_LEFT_LOWER_LEG, "LeftLowerLeg" },
+	{ XRBodyTracker::JOINT_LEFT_FOOT, "LeftFoot" },
+	{ XRBodyTracker::JOINT_LEFT_TOES, "LeftToes" },
+	{ XRBodyTracker::JOINT_RIGHT_UPPER_LEG, "RightUpperLeg" },
+	{ XRBodyTracker::JOINT_RIGHT_LOWER_LEG, "RightLowerLeg" },
+	{ XRBodyTracker::JOINT_RIGHT_FOOT, "RightFoot" },
+	{ XRBodyTracker::JOINT_RIGHT_TOES, "RightToes" },
+};
+
+void OpenXRBodyRetargeter::_bind_methods() {
+	ClassDB::bind_method(D_METHOD("set_body_tracker", "body_tracker"), &OpenXRBodyRetargeter::set_body_tracker);
+	ClassDB::bind_method(D_METHOD("get_body_tracker"), &OpenXRBodyRetargeter::get_body_tracker);
+
+	ClassDB::bind_method(D_METHOD("set_skeletons", "skeletons"), &OpenXRBodyRetargeter::set_skeletons);
+	ClassDB::bind_method(D_METHOD("get_skeletons"), &OpenXRBodyRetargeter::get_skeletons);
+
+	ClassDB::bind_method(D_METHOD("set_bone_map", "bone_map"), &OpenXRBodyRetargeter::set_bone_map);
+	ClassDB::bind_method(D_METHOD("get_bone_map"), &OpenXRBodyRetargeter::get_bone_map);
+
+	ClassDB::bind_method(D_METHOD("set_apply_hips_position", "apply_hips_position"), &OpenXRBodyRetargeter::set_apply_hips_position);
+	ClassDB::bind_method(D_METHOD("get_apply_hips_position"), &OpenXRBodyRetargeter::get_apply_hips_position);
+
+	ClassDB::bind_method(D_METHOD("rebuild"), &OpenXRBodyRetargeter::rebuild);
+
+	ADD_PROPERTY(PropertyInfo(Variant::STRING_NAME, "body_tracker", PROPERTY_HINT_ENUM_SUGGESTION, "/user/body_tracker"), "set_body_tracker", "get_body_tracker");
+	ADD_PROPERTY(PropertyInfo(Variant::ARRAY, "skeletons", PROPERTY_HINT_TYPE_STRING, vformat("%d/%d:Skeleton3D", Variant::NODE_PATH, PROPERTY_HINT_NODE_PATH_VALID_TYPES)), "set_skeletons", "get_skeletons");
+	ADD_PROPERTY(PropertyInfo(Variant::OBJECT, "bone_map", PROPERTY_HINT_RESOURCE_TYPE, "BoneMap"), "set_bone_map", "get_bone_map");
+	ADD_PROPERTY(PropertyInfo(Variant::BOOL, "apply_hips_position"), "set_apply_hips_position", "get_apply_hips_position");
+}
+
+void OpenXRBodyRetargeter::_notification(int p_what) {
+	switch (p_what) {
+		case NOTIFICATION_READY: {
+			tables_dirty = true;
+			set_process_internal(!Engine::get_singleton()->is_editor_hint());
+		} break;
+		case NOTIFICATION_INTERNAL_PROCESS: {
+			_update_skeletons();
+		} break;
+	}
+}
+
+void OpenXRBodyRetargeter::_build_table(Skeleton3D *p_skeleton, const Ref<SkeletonProfile> &p_profile, const LocalVector<Quaternion> &p_reference_rotations, SkeletonTable &r_table) const {
+	const int bone_count = p_skeleton->get_bone_count();
+
+	// Find which skeleton bones are driven by which joint.
+	LocalVector<int> bone_joint;
+	LocalVector<Quaternion> bone_reference_rotation;
+	bone_joint.resize(bone_count);
+	bone_reference_rotation.resize(bone_count);
+	for (int i = 0; i < bone_count; i++) {
+		bone_joint[i] = -1;
+	}
+
+	for (const RetargetJoint &retarget_joint : retarget_joints) {
+		StringName bone_name = retarget_joint.bone_name;
+		if (bone_map.is_valid()) {
+			bone_name = bone_map->get_skeleton_bone_name(bone_name);
+			if (bone_name.is_empty()) {
+				continue;
+			}
+		}
+
+		int bone = p_skeleton->find_bone(bone_name);
+		int profile_bone = p_profile->find_bone(retarget_joint.bone_name);
+		if (bone < 0 || profile_bone < 0) {
+			continue;
+		}
+
+		bone_joint[bone] = retarget_joint.joint;
+		bone_reference_rotation[bone] = p_reference_rotations[profile_bone];
+	}
+
+	// Visit the bones parents first, so that entries always come after their parent entry.
+	LocalVector<int> bone_entry;
+	bone_entry.resize(bone_count);
+	for (int i = 0; i < bone_count; i++) {
+		bone_entry[i] = -1;
+	}
+
+	LocalVector<int> stack;
+	PackedInt32Array parentless_bones = p_skeleton->get_parentless_bones();
+	for (int i = parentless_bones.size() - 1; i >= 0; i--) {
+		stack.push_back(parentless_bones[i]);
+	}
+
+	while (!stack.is_empty()) {
+		const int bone = stack[stack.size() - 1];
+		stack.remove_at(stack.size() - 1);
+
+		if (bone_joint[bone] >= 0) {
+			BoneEntry entry;
+			entry.bone = bone;
+			entry.joint = (XRBodyTracker::Joint)bone_joint[bone];
+
+			const int parent = p_skeleton->get_bone_parent(bone);
+			const Transform3D parent_global_rest = parent >= 0 ? p_skeleton->get_bone_global_rest(parent) : Transform3D();
+			const Quaternion parent_rotation = parent_global_rest.basis.get_rotation_quaternion();
+
+			int ancestor = parent;
+			while (ancestor >= 0 && bone_entry[ancestor] < 0) {
+				ancestor = p_skeleton->get_bone_parent(ancestor);
+			}
+
+			if (ancestor >= 0) {
+				entry.parent_entry = bone_entry[ancestor];
+				entry.parent_offset = p_skeleton->get_bone_global_rest(ancestor).basis.get_rotation_quaternion().inverse() * parent_rotation;
+			} else {
+				entry.parent_offset = parent_rotation;
+			}
+
+			entry.correction = bone_reference_rotation[bone].inverse() * p_skeleton->get_bone_global_rest(bone).basis.get_rotation_quaternion();
+			entry.rest_rotation = p_skeleton->get_bone_rest(bone).basis.get_rotation_quaternion();
+
+			if (entry.joint == XRBodyTracker::JOINT_HIPS && entry.parent_entry < 0) {
+				entry.apply_position = true;
+				entry.parent_transform_inverse = parent_global_rest.affine_inverse();
+			}
+
+			bone_entry[bone] = r_table.entries.size();
+			r_table.entries.push_back(entry);
+		}
+
+		PackedInt32Array children = p_skeleton->get_bone_children(bone);
+		for (int i = children.size() - 1; i >= 0; i--) {
+			stack.push_back(children[i]);
+		}
+	}
+}
+
+void OpenXRBodyRetargeter::_build_tables() {
+	tables.clear();
+	tables_dirty = false;
+
+	if (!is_inside_tree() || skeletons.is_empty()) {
+		return;
+	}
+
+	// Global rotations of the humanoid reference pose, which is what the body tracker joints are relative to.
+	Ref<SkeletonProfileHumanoid> profile;
+	profile.instantiate();
+
+	LocalVector<Quaternion> reference_rotations;
+	reference_rotations.resize(profile->get_bone_size());
+	for (int i = 0; i < profile->get_bone_size(); i++) {
+		Quaternion rotation = profile->get_reference_pose(i).basis.get_rotation_quaternion();
+		int parent = profile->find_bone(profile->get_bone_parent(i));
+		reference_rotations[i] = parent >= 0 && parent < i ? reference_rotations[parent] * rotation : rotation;
+	}
+
+	for (int i = 0; i < skeletons.size(); i++) {
+		Skeleton3D *skeleton = Object::cast_to<Skeleton3D>(get_node_or_null(skeletons[i]));
+		if (skeleton == nullptr) {
+			WARN_PRINT(vformat("OpenXRBodyRetargeter: %s isn't a Skeleton3D", String(skeletons[i])));
+			continue;
+		}
+
+		SkeletonTable table;
+		table.skeleton = skeleton->get_instance_id();
+		_build_table(skeleton, profile, reference_rotations, table);
+		if (table.entries.is_empty()) {
+			WARN_PRINT(vformat("OpenXRBodyRetargeter: no humanoid bones found in %s", String(skeletons[i])));
+			continue;
+		}
+
+		tables.push_back(table);
+	}
+}
+
+void OpenXRBodyRetargeter::_update_skeletons() {
+	if (tables_dirty) {
+		_build_tables();
+	}
+
+	if (tables.is_empty()) {
+		return;
+	}
+
+	XRServer *xr_server = XRServer::get_singleton();
+	Ref<XRBodyTracker> tracker;
+	if (xr_server != nullptr) {
+		tracker = xr_server->get_tracker(body_tracker);
+	}
+	if (tracker.is_null() || !tracker->get_has_tracking_data()) {
+		return;
+	}
+
+	// Read each joint once, and share it between all the skeletons.
+	for (const RetargetJoint &retarget_joint : retarget_joints) {
+		const XRBodyTracker::Joint joint = retarget_joint.joint;
+		joint_valid[joint] = tracker->get_joint_flags(joint).has_flag(XRBodyTracker::JOINT_FLAG_ORIENTATION_VALID);
+		if (joint_valid[joint]) {
+			joint_rotations[joint] = tracker->get_joint_transform(joint).basis.get_rotation_quaternion();
+		}
+	}
+
+	const bool hips_position_valid = apply_hips_position && tracker->get_joint_flags(XRBodyTracker::JOINT_HIPS).has_flag(XRBodyTracker::JOINT_FLAG_POSITION_VALID);
+	const Vector3 hips_position = hips_position_valid ? tracker->get_joint_transform(XRBodyTracker::JOINT_HIPS).origin : Vector3();
+
+	for (const SkeletonTable &table : tables) {
+		Skeleton3D *skeleton = Object::cast_to<Skeleton3D>(ObjectDB::get_instance(table.skeleton));
+		if (skeleton == nullptr) {
+			continue;
+		}
+
+		global_rotations.resize(table.entries.size());
+		for (uint32_t i = 0; i < table.entries.size(); i++) {
+			const BoneEntry &entry = table.entries[i];
+			const Quaternion parent_rotation = entry.parent_entry >= 0 ? global_rotations[entry.parent_entry] * entry.parent_offset : entry.parent_offset;
+
+			if (!joint_valid[entry.joint]) {
+				global_rotations[i] = parent_rotation * entry.rest_rotation;
+				continue;
+			}
+
+			global_rotations[i] = joint_rotations[entry.joint] * entry.correction;
+			skeleton->set_bone_pose_rotation(entry.bone, parent_rotation.inverse() * global_rotations[i]);
+
+			if (entry.apply_position && hips_position_valid) {
+				skeleton->set_bone_pose_position(entry.bone, entry.parent_transform_inverse.xform(hips_position));
+			}
+		}
+	}
+}
+
+void OpenXRBodyRetargeter::set_body_tracker(const StringName &p_body_tracker) {
+	body_tracker = p_body_tracker;
+}
+
+StringName OpenXRBodyRetargeter::get_body_tracker() const {
+	return body_tracker;
+}
+
+void OpenXRBodyRetargeter::set_skeletons(const TypedArray<NodePath> &p_skeletons) {
+	skeletons = p_skeletons;
+	tables_dirty = true;
+}
+
+TypedArray<NodePath> OpenXRBodyRetargeter::get_skeletons() const {
+	return skeletons;
+}
+
+void OpenXRBodyRetargeter::set_bone_map(const Ref<BoneMap> &p_bone_map) {
+	bone_map = p_bone_map;
+	tables_dirty = true;
+}
+
+Ref<BoneMap> OpenXRBodyRetargeter::get_bone_map() const {
+	return bone_map;
+}
+
+void OpenXRBodyRetargeter::set_apply_hips_position(bool p_apply_hips_position) {
+	apply_hips_position = p_apply_hips_position;
+}
+
+bool OpenXRBodyRetargeter::get_apply_hips_position() const {
+	return apply_hips_position;
+}
+
+void OpenXRBodyRetargeter::rebuild() {
+	tables_dirty = true;
+}
@@ -0,0 +1,342 @@
+/**************************************************************************/
+/*  openxr_environment_depth_collider.cpp                                 */
+/**************************************************************************/
+/*                       This file is part of:                            */
+/*                              GODOT XR                                  */
+/*                      https://godotengine.org                           */
+/**************************************************************************/
+/* Copyright (c) 2022-present Godot XR contributors (see CONTRIBUTORS.md) */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#include "classes/openxr_environment_depth_collider.h"
+
+#include <godot_cpp/classes/engine.hpp>
+#include <godot_cpp/classes/physics_server3d.hpp>
+#include <godot_cpp/classes/worker_thread_pool.hpp>
+#include <godot_cpp/classes/world3d.hpp>
+#include <godot_cpp/core/math.hpp>
+
+#include "extensions/openxr_android_environment_depth_extension.h"
+#include "extensions/openxr_meta_environment_depth_extension.h"
+
+using namespace godot;
+
+void OpenXREnvironmentDepthCollider::_bind_methods() {
+	ClassDB::bind_method(D_METHOD("set_update_interval", "update_interval"), &OpenXREnvironmentDepthCollider::set_update_interval);
+	ClassDB::bind_method(D_METHOD("get_update_interval"), &OpenXREnvironmentDepthCollider::get_update_interval);
+
+	ClassDB::bind_method(D_METHOD("set_grid_size", "grid_size"), &OpenXREnvironmentDepthCollider::set_grid_size);
+	ClassDB::bind_method(D_METHOD("get_grid_size"), &OpenXREnvironmentDepthCollider::get_grid_size);
+
+	ClassDB::bind_method(D_METHOD("set_cell_size", "cell_size"), &OpenXREnvironmentDepthCollider::set_cell_size);
+	ClassDB::bind_method(D_METHOD("get_cell_size"), &OpenXREnvironmentDepthCollider::get_cell_size);
+
+	ClassDB::bind_method(D_METHOD("set_height_limit", "height_limit"), &OpenXREnvironmentDepthCollider::set_height_limit);
+	ClassDB::bind_method(D_METHOD("get_height_limit"), &OpenXREnvironmentDepthCollider::get_height_limit);
+
+	ClassDB::bind_method(D_METHOD("set_collision_layer", "collision_layer"), &OpenXREnvironmentDepthCollider::set_collision_layer);
+	ClassDB::bind_method(D_METHOD("get_collision_layer"), &OpenXREnvironmentDepthCollider::get_collision_layer);
+
+	ClassDB::bind_method(D_METHOD("set_collision_mask", "collision_mask"), &OpenXREnvironmentDepthCollider::set_collision_mask);
+	ClassDB::bind_method(D_METHOD("get_collision_mask"), &OpenXREnvironmentDepthCollider::get_collision_mask);
+
+	ClassDB::bind_method(D_METHOD("get_rid"), &OpenXREnvironmentDepthCollider::get_rid);
+
+	ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "update_interval", PROPERTY_HINT_RANGE, "0,5,0.01,suffix:s"), "set_update_interval", "get_update_interval");
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "grid_size", PROPERTY_HINT_RANGE, "2,256,1"), "set_grid_size", "get_grid_size");
+	ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "cell_size", PROPERTY_HINT_RANGE, "0.01,1,0.01,suffix:m"), "set_cell_size", "get_cell_size");
+	ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "height_limit", PROPERTY_HINT_RANGE, "-2,2,0.01,suffix:m"), "set_height_limit", "get_height_limit");
+
+	ADD_GROUP("Collision", "collision_");
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "collision_layer", PROPERTY_HINT_LAYERS_3D_PHYSICS), "set_collision_layer", "get_collision_layer");
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "collision_mask", PROPERTY_HINT_LAYERS_3D_PHYSICS), "set_collision_mask", "get_collision_mask");
+}
+
+void OpenXREnvironmentDepthCollider::set_update_interval(float p_update_interval) {
+	update_interval = MAX(p_update_interval, 0.0);
+}
+
+float OpenXREnvironmentDepthCollider::get_update_interval() const {
+	return update_interval;
+}
+
+void OpenXREnvironmentDepthCollider::set_grid_size(int p_grid_size) {
+	grid_size = CLAMP(p_grid_size, 2, 256);
+}
+
+int OpenXREnvironmentDepthCollider::get_grid_size() const {
+	return grid_size;
+}
+
+void OpenXREnvironmentDepthCollider::set_cell_size(float p_cell_size) {
+	ERR_FAIL_COND(p_cell_size <= 0.0);
+	cell_size = p_cell_size;
+}
+
+float OpenXREnvironmentDepthCollider::get_cell_size() const {
+	return cell_size;
+}
+
+void OpenXREnvironmentDepthCollider::set_height_limit(float p_height_limit) {
+	height_limit = p_height_limit;
+}
+
+float OpenXREnvironmentDepthCollider::get_height_limit() const {
+	return height_limit;
+}
+
+void OpenXREnvironmentDepthCollider::set_collision_layer(uint32_t p_collision_layer) {
+	collision_layer = p_collision_layer;
+	PhysicsServer3D::get_singleton()->body_set_collision_layer(body, collision_layer);
+}
+
+uint32_t OpenXREnvironmentDepthCollider::get_collision_layer() const {
+	return collision_layer;
+}
+
+void OpenXREnvironmentDepthCollider::set_collision_mask(uint32_t p_collision_mask) {
+	collision_mask = p_collision_mask;
+	PhysicsServer3D::get_singleton()->body_set_collision_mask(body, collision_mask);
+}
+
+uint32_t OpenXREnvironmentDepthCollider::get_collision_mask() const {
+	return collision_mask;
+}
+
+RID OpenXREnvironmentDepthCollider::get_rid() const {
+	return body;
+}
+
+void OpenXREnvironmentDepthCollider::_notification(int p_what) {
+	switch (p_what) {
+		case NOTIFICATION_ENTER_TREE: {
+			PhysicsServer3D::get_singleton()->body_set_space(body, get_world_3d()->get_space());
+
+			if (!Engine::get_singleton()->is_editor_hint()) {
+				_set_cpu_depth_frame_user(true);
+				set_process_internal(true);
+			}
+		} break;
+
+		case NOTIFICATION_EXIT_TREE: {
+			PhysicsServer3D::get_singleton()->body_set_space(body, RID());
+
+			if (!Engine::get_singleton()->is_editor_hint()) {
+				_set_cpu_depth_frame_user(false);
+				set_process_internal(false);
+				_cancel_build();
+			}
+		} break;
+
+		case NOTIFICATION_INTERNAL_PROCESS: {
+			time_since_update += get_process_delta_time();
+			if (time_since_update < update_interval || build_task_id >= 0) {
+				break;
+			}
+
+			const OpenXREnvironmentDepthFrame *frame = _get_cpu_depth_frame();
+			if (frame == nullptr || frame->index == last_frame_index || frame->depth.is_empty()) {
+				break;
+			}
+
+			time_since_update = 0.0;
+			last_frame_index = frame->index;
+			_start_build(*frame);
+		} break;
+	}
+}
+
+const OpenXREnvironmentDepthFrame *OpenXREnvironmentDepthCollider::_get_cpu_depth_frame() const {
+	OpenXRMetaEnvironmentDepthExtension *meta_env_depth_ext = OpenXRMetaEnvironmentDepthExtension::get_singleton();
+	if (meta_env_depth_ext && meta_env_depth_ext->is_environment_depth_started()) {
+		return &meta_env_depth_ext->get_cpu_depth_frame();
+	}
+
+	OpenXRAndroidEnvironmentDepthExtension *android_env_depth_ext = OpenXRAndroidEnvironmentDepthExtension::get_singleton();
+	if (android_env_depth_ext && android_env_depth_ext->is_environment_depth_started()) {
+		return &android_env_depth_ext->get_cpu_depth_frame();
+	}
+
+	return nullptr;
+}
+
+void OpenXREnvironmentDepthCollider::_set_cpu_depth_frame_user(bool p_user) {
+	OpenXRMetaEnvironmentDepthExtension *meta_env_depth_ext = OpenXRMetaEnvironmentDepthExtension::get_singleton();
+	if (meta_env_depth_ext) {
+		if (p_user) {
+			meta_env_depth_ext->register_cpu_depth_frame_user();
+		} else {
+			meta_env_depth_ext->unregister_cpu_depth_frame_user();
+		}
+	}
+
+	OpenXRAndroidEnvironmentDepthExtension *android_env_depth_ext = OpenXRAndroidEnvironmentDepthExtension::get_singleton();
+	if (android_env_depth_ext) {
+		if (p_user) {
+			android_env_depth_ext->register_cpu_depth_frame_user();
+		} else {
+			android_env_depth_ext->unregister_cpu_depth_frame_user();
+		}
+	}
+}
+
+void OpenXREnvironmentDepthCollider::_start_build(const OpenXREnvironmentDepthFrame &p_frame) {
+	// The task only gets the ID of this node, as the node may be freed before the task finishes.
+	Callable task = callable_mp_static(&OpenXREnvironmentDepthCollider::_build_task).bind(get_instance_id(), build_serial, p_frame.depth, p_frame.width, p_frame.height, p_frame.view_to_world, p_frame.tan_fov, p_frame.flip_y, grid_size, cell_size, height_limit);
+	build_task_id = WorkerThreadPool::get_singleton()->add_task(task, false, "Build environment depth collider");
+}
+
+void OpenXREnvironmentDepthCollider::_cancel_build() {
+	if (build_task_id >= 0) {
+		WorkerThreadPool::get_singleton()->wait_for_task_completion(build_task_id);
+		build_task_id = -1;
+	}
+
+	// The deferred call of a cancelled task is ignored.
+	build_serial++;
+}
+
+void OpenXREnvironmentDepthCollider::_build_task(uint64_t p_object_id, uint64_t p_serial, const PackedFloat32Array &p_depth, int p_width, int p_height, const Transform3D &p_view_to_world, const Vector4 &p_tan_fov, bool p_flip_y, int p_grid_size, float p_cell_size, float p_height_limit) {
+	// The grid is aligned with the world axes and centered below the depth camera, snapped to the
+	// cells so the samples don't move around between updates.
+	const Vector3 &eye = p_view_to_world.origin;
+	Vector3 center = Vector3(Math::round(eye.x / p_cell_size) * p_cell_size, 0.0, Math::round(eye.z / p_cell_size) * p_cell_size);
+	float grid_offset = (p_grid_size - 1) * 0.5f;
+	float max_point_height = eye.y + p_height_limit;
+
+	PackedFloat32Array heights;
+	heights.resize(p_grid_size * p_grid_size);
+	heights.fill(-Math_INF);
+	float *heights_ptr = heights.ptrw();
+
+	const float *depth = p_depth.ptr();
+	const Basis &basis = p_view_to_world.basis;
+	float tan_width = p_tan_fov.y - p_tan_fov.x;
+	float tan_height = p_tan_fov.w - p_tan_fov.z;
+	float min_height = Math_INF;
+	float max_height = -Math_INF;
+
+	for (int y = 0; y < p_height; y++) {
+		float tan_y = p_flip_y ? p_tan_fov.w - (y + 0.5f) * tan_height / p_height : p_tan_fov.z + (y + 0.5f) * tan_height / p_height;
+		for (int x = 0; x < p_width; x++) {
+			float texel_depth = depth[y * p_width + x];
+			if (!(texel_depth > 0.0f) || Math::is_inf(texel_depth)) {
+				continue;
+			}
+
+			float tan_x = p_tan_fov.x + (x + 0.5f) * tan_width / p_width;
+			Vector3 point = eye + basis.xform(Vector3(tan_x, tan_y, -1.0) * texel_depth);
+
+			// A heightfield can't hold anything overhanging, so points above the limit, like
+			// ceilings, are left out entirely.
+			if (point.y > max_point_height) {
+				continue;
+			}
+
+			int gx = (int)Math::round((point.x - center.x) / p_cell_size + grid_offset);
+			int gz = (int)Math::round((point.z - center.z) / p_cell_size + grid_offset);
+			if (gx < 0 || gz < 0 || gx >= p_grid_size || gz >= p_grid_size) {
+				continue;
+			}
+
+			float &height = heights_ptr[gz * p_grid_size + gx];
+			height = MAX(height, point.y);
+			min_height = MIN(min_height, point.y);
+			max_height = MAX(max_height, point.y);
+		}
+	}
+
+	if (min_height > max_height) {
+		// Nothing was seen, so the previous collider is kept.
+		heights = PackedFloat32Array();
+	} else {
+		// Samples which weren't seen are most likely floor hidden behind something.
+		for (int i = 0; i < p_grid_size * p_grid_size; i++) {
+			if (Math::is_inf(heights_ptr[i])) {
+				heights_ptr[i] = min_height;
+			}
+		}
+	}
+
+	callable_mp_static(&OpenXREnvironmentDepthCollider::_finish_build).bind(p_object_id, p_serial, p_grid_size, p_cell_size, center, heights, min_height, max_height).call_deferred();
+}
+
+void OpenXREnvironmentDepthCollider::_finish_build(uint64_t p_object_id, uint64_t p_serial, int p_grid_size, float p_cell_size, const Vector3 &p_center, const PackedFloat32Array &p_heights, float p_min_height, float p_max_height) {
+	OpenXREnvironmentDepthCollider *collider = Object::cast_to<OpenXREnvironmentDepthCollider>(ObjectDB::get_instance(p_object_id));
+	if (collider == nullptr || p_serial != collider->build_serial) {
+		return;
+	}
+
+	// The task has already finished, this only releases it.
+	WorkerThreadPool::get_singleton()->wait_for_task_completion(collider->build_task_id);
+	collider->build_task_id = -1;
+
+	if (!p_heights.is_empty()) {
+		collider->_apply_heightfield(p_grid_size, p_cell_size, p_center, p_heights, p_min_height, p_max_height);
+	}
+}
+
+void OpenXREnvironmentDepthCollider::_apply_heightfield(int p_grid_size, float p_cell_size, const Vector3 &p_center, const PackedFloat32Array &p_heights, float p_min_height, float p_max_height) {
+	PhysicsServer3D *physics_server = PhysicsServer3D::get_singleton();
+
+	Dictionary data;
+	data["width"] = p_grid_size;
+	data["depth"] = p_grid_size;
+	data["heights"] = p_heights;
+	data["min_height"] = p_min_height;
+	data["max_height"] = p_max_height;
+
+	RID new_shape = physics_server->heightmap_shape_create();
+	physics_server->shape_set_data(new_shape, data);
+
+	// Heightmap samples are one unit apart.
+	Transform3D shape_transform = Transform3D(Basis().scaled(Vector3(p_cell_size, 1.0, p_cell_size)), Vector3());
+
+	// The shape is swapped in place, so the body never goes without a collider in between.
+	if (shape.is_valid()) {
+		physics_server->body_set_shape(body, 0, new_shape);
+		physics_server->body_set_shape_transform(body, 0, shape_transform);
+		physics_server->free_rid(shape);
+	} else {
+		physics_server->body_add_shape(body, new_shape, shape_transform);
+	}
+	physics_server->body_set_state(body, PhysicsServer3D::BODY_STATE_TRANSFORM, Transform3D(Basis(), p_center));
+
+	shape = new_shape;
+}
+
+OpenXREnvironmentDepthCollider::OpenXREnvironmentDepthCollider() {
+	PhysicsServer3D *physics_server = PhysicsServer3D::get_singleton();
+	body = physics_server->body_create();
+	physics_server->body_set_mode(body, PhysicsServer3D::BODY_MODE_STATIC);
+	physics_server->body_attach_object_instance_id(body, get_instance_id());
+	physics_server->body_set_collision_layer(body, collision_layer);
+	physics_server->body_set_collision_mask(body, collision_mask);
+}
+
+OpenXREnvironmentDepthCollider::~OpenXREnvironmentDepthCollider() {
+	PhysicsServer3D *physics_server = PhysicsServer3D::get_singleton();
+	physics_server->free_rid(body);
+	if (shape.is_valid()) {
+		physics_server->free_rid(shape);
+	}
+}
@@ -0,0 +1,845 @@
+/**************************************************************************/
+/*  openxr_environment_depth_fusion.cpp                                   */
+/**************************************************************************/
+/*                       This file is part of:                            */
+/*                              GODOT XR                                  */
+/*                      https://godotengine.org                           */
+/**************************************************************************/
+/* Copyright (c) 2022-present Godot XR contributors (see CONTRIBUTORS.md) */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#include "classes/openxr_environment_depth_fusion.h"
+
+#include <godot_cpp/classes/mesh.hpp>
+#include <godot_cpp/classes/worker_thread_pool.hpp>
+#include <godot_cpp/core/class_db.hpp>
+#include <godot_cpp/core/math.hpp>
+#include <godot_cpp/templates/hash_set.hpp>
+#include <godot_cpp/templates/local_vector.hpp>
+#include <godot_cpp/templates/pair.hpp>
+#include <godot_cpp/variant/packed_int32_array.hpp>
+#include <godot_cpp/variant/packed_vector3_array.hpp>
+
+using namespace godot;
+
+static const int VOXELS_PER_BLOCK = OpenXREnvironmentDepthFusion::BLOCK_SIZE * OpenXREnvironmentDepthFusion::BLOCK_SIZE * OpenXREnvironmentDepthFusion::BLOCK_SIZE;
+static const float DISTANCE_SCALE = 32767.0;
+
+// When there are more than max_blocks blocks, this fraction of max_blocks is dropped at once, so
+// the blocks don't need to be sorted again after every frame.
+static const int EVICTION_DIVISOR = 8;
+
+// Marching cubes tables. Corner i of a cell is offset by MARCHING_CUBES_CORNERS[i] voxels, and
+// edge i connects the corners in MARCHING_CUBES_EDGES[i]. MARCHING_CUBES_TRIANGLES lists up to 5
+// triangles, as edge indices terminated by -1, for each combination of corners which are behind
+// the surface (bit i set for corner i). Triangles wind counter-clockwise when seen from in front
+// of the surface. Faces with two diagonally opposite corners behind the surface always separate
+// those corners, so neighboring cells agree and the mesh has no cracks.
+static const int MARCHING_CUBES_CORNERS[8][3] = {
+	{ 0, 0, 0 }, { 1, 0, 0 }, { 1, 1, 0 }, { 0, 1, 0 }, { 0, 0, 1 }, { 1, 0, 1 }, { 1, 1, 1 }, { 0, 1, 1 }
+};
+
+static const int MARCHING_CUBES_EDGES[12][2] = {
+	{ 0, 1 }, { 1, 2 }, { 2, 3 }, { 3, 0 }, { 4, 5 }, { 5, 6 }, { 6, 7 }, { 7, 4 }, { 0, 4 }, { 1, 5 }, { 2, 6 }, { 3, 7 }
+};
+
+static const int8_t MARCHING_CUBES_TRIANGLES[256][16] = {
+	{ -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+	{ 0, 3, 8, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+	{ 0, 9, 1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+	{ 3, 8, 9, 1, 3, 9, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+	{ 1, 10, 2, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+	{ 0, 3, 8, 1, 10, 2, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+	{ 9, 10, 2, 0, 9, 2, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+	{ 8, 9, 10, 3, 8, 10, 2, 3, 10, -1, -1, -1, -1, -1, -1, -1 },
+	{ 2, 11, 3, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+	{ 2, 11, 8, 0, 2, 8, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+	{ 0, 9, 1, 2, 11, 3, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+	{ 11, 8, 9, 2, 11, 9, 1, 2, 9, -1, -1, -1, -1, -1, -1, -1 },
+	{ 10, 11, 3, 1, 10, 3, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+	{ 10, 11, 8, 1, 10, 8, 0, 1, 8, -1, -1, -1, -1, -1, -1, -1 },
+	{ 10, 11, 3, 9, 10, 3, 0, 9, 3, -1, -1, -1, -1, -1, -1, -1 },
+	{ 9, 10, 11, 8, 9, 11, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+	{ 4, 8, 7, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+	{ 3, 7, 4, 0, 3, 4, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+	{ 0, 9, 1, 4, 8, 7, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+	{ 7, 4, 9, 3, 7, 9, 1, 3, 9, -1, -1, -1, -1, -1, -1, -1 },
+	{ 1, 10, 2, 4, 8, 7, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+	{ 3, 7, 4, 0, 3, 4, 1, 10, 2, -1, -1, -1, -1, -1, -1, -1 },
+	{ 9, 10, 2, 0, 9, 2, 4, 8, 7, -1, -1, -1, -1, -1, -1, -1 },
+	{ 4, 9, 10, 7, 4, 10, 3, 7, 10, 2, 3, 10, -1, -1, -1, -1 },
+	{ 2, 11, 3, 4, 8, 7, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+	{ 11, 7, 4, 2, 11, 4, 0, 2, 4, -1, -1, -1, -1, -1, -1, -1 },
+	{ 0, 9, 1, 2, 11, 3, 4, 8, 7, -1, -1, -1, -1, -1, -1, -1 },
+	{ 7, 4, 9, 11, 7, 9, 2, 11, 9, 1, 2, 9, -1, -1, -1, -1 },
+	{ 10, 11, 3, 1, 10, 3, 4, 8, 7, -1, -1, -1, -1, -1, -1, -1 },
+	{ 11, 7, 4, 10, 11, 4, 1, 10, 4, 0, 1, 4, -1, -1, -1, -1 },
+	{ 10, 11, 3, 9, 10, 3, 0, 9, 3, 4, 8, 7, -1, -1, -1, -1 },
+	{ 10, 11, 7, 9, 10, 7, 4, 9, 7, -1, -1, -1, -1, -1, -1, -1 },
+	{ 4, 5, 9, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+	{ 0, 3, 8, 4, 5, 9, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+	{ 4, 5, 1, 0, 4, 1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+	{ 8, 4, 5, 3, 8, 5, 1, 3, 5, -1, -1, -1, -1, -1, -1, -1 },
+	{ 1, 10, 2, 4, 5, 9, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+	{ 0, 3, 8, 1, 10, 2, 4, 5, 9, -1, -1, -1, -1, -1, -1, -1 },
+	{ 5, 10, 2, 4, 5, 2, 0, 4, 2, -1, -1, -1, -1, -1, -1, -1 },
+	{ 4, 5, 10, 8, 4, 10, 3, 8, 10, 2, 3, 10, -1, -1, -1, -1 },
+	{ 2, 11, 3, 4, 5, 9, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+	{ 2, 11, 8, 0, 2, 8, 4, 5, 9, -1, -1, -1, -1, -1, -1, -1 },
+	{ 4, 5, 1, 0, 4, 1, 2, 11, 3, -1, -1, -1, -1, -1, -1, -1 },
+	{ 8, 4, 5, 11, 8, 5, 2, 11, 5, 1, 2, 5, -1, -1, -1, -1 },
+	{ 10, 11, 3, 1, 10, 3, 4, 5, 9, -1, -1, -1, -1, -1, -1, -1 },
+	{ 10, 11, 8, 1, 10, 8, 0, 1, 8, 4, 5, 9, -1, -1, -1, -1 },
+	{ 10, 11, 3, 5, 10, 3, 4, 5, 3, 0, 4, 3, -1, -1, -1, -1 },
+	{ 10, 11, 8, 5, 10, 8, 4, 5, 8, -1, -1, -1, -1, -1, -1, -1 },
+	{ 9, 8, 7, 5, 9, 7, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+	{ 7, 5, 9, 3, 7, 9, 0, 3, 9, -1, -1, -1, -1, -1, -1, -1 },
+	{ 7, 5, 1, 8, 7, 1, 0, 8, 1, -1, -1, -1, -1, -1, -1, -1 },
+	{ 3, 7, 5, 1, 3, 5, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+	{ 1, 10, 2, 9, 8, 7, 5, 9, 7, -1, -1, -1, -1, -1, -1, -1 },
+	{ 7, 5, 9, 3, 7, 9, 0, 3, 9, 1, 10, 2, -1, -1, -1, -1 },
+	{ 5, 10, 2, 7, 5, 2, 8, 7, 2, 0, 8, 2, -1, -1, -1, -1 },
+	{ 7, 5, 10, 3, 7, 10, 2, 3, 10, -1, -1, -1, -1, -1, -1, -1 },
+	{ 2, 11, 3, 9, 8, 7, 5, 9, 7, -1, -1, -1, -1, -1, -1, -1 },
+	{ 7, 5, 9, 11, 7, 9, 2, 11, 9, 0, 2, 9, -1, -1, -1, -1 },
+	{ 7, 5, 1, 8, 7, 1, 0, 8, 1, 2, 11, 3, -1, -1, -1, -1 },
+	{ 11, 7, 5, 2, 11, 5, 1, 2, 5, -1, -1, -1, -1, -1, -1, -1 },
+	{ 10, 11, 3, 1, 10, 3, 9, 8, 7, 5, 9, 7, -1, -1, -1, -1 },
+	{ 1, 10, 11, 0, 1, 11, 7, 5, 9, 11, 7, 9, 0, 11, 9, -1 },
+	{ 8, 7, 5, 0, 8, 5, 10, 11, 3, 5, 10, 3, 0, 5, 3, -1 },
+	{ 10, 11, 7, 5, 10, 7, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+	{ 5, 6, 10, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+	{ 0, 3, 8, 5, 6, 10, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+	{ 0, 9, 1, 5, 6, 10, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+	{ 3, 8, 9, 1, 3, 9, 5, 6, 10, -1, -1, -1, -1, -1, -1, -1 },
+	{ 5, 6, 2, 1, 5, 2, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+	{ 0, 3, 8, 5, 6, 2, 1, 5, 2, -1, -1, -1, -1, -1, -1, -1 },
+	{ 5, 6, 2, 9, 5, 2, 0, 9, 2, -1, -1, -1, -1, -1, -1, -1 },
+	{ 9, 5, 6, 8, 9, 6, 3, 8, 6, 2, 3, 6, -1, -1, -1, -1 },
+	{ 2, 11, 3, 5, 6, 10, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+	{ 2, 11, 8, 0, 2, 8, 5, 6, 10, -1, -1, -1, -1, -1, -1, -1 },
+	{ 0, 9, 1, 2, 11, 3, 5, 6, 10, -1, -1, -1, -1, -1, -1, -1 },
+	{ 11, 8, 9, 2, 11, 9, 1, 2, 9, 5, 6, 10, -1, -1, -1, -1 },
+	{ 6, 11, 3, 5, 6, 3, 1, 5, 3, -1, -1, -1, -1, -1, -1, -1 },
+	{ 6, 11, 8, 5, 6, 8, 1, 5, 8, 0, 1, 8, -1, -1, -1, -1 },
+	{ 6, 11, 3, 5, 6, 3, 9, 5, 3, 0, 9, 3, -1, -1, -1, -1 },
+	{ 11, 8, 9, 6, 11, 9, 5, 6, 9, -1, -1, -1, -1, -1, -1, -1 },
+	{ 4, 8, 7, 5, 6, 10, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+	{ 3, 7, 4, 0, 3, 4, 5, 6, 10, -1, -1, -1, -1, -1, -1, -1 },
+	{ 0, 9, 1, 4, 8, 7, 5, 6, 10, -1, -1, -1, -1, -1, -1, -1 },
+	{ 7, 4, 9, 3, 7, 9, 1, 3, 9, 5, 6, 10, -1, -1, -1, -1 },
+	{ 5, 6, 2, 1, 5, 2, 4, 8, 7, -1, -1, -1, -1, -1, -1, -1 },
+	{ 3, 7, 4, 0, 3, 4, 5, 6, 2, 1, 5, 2, -1, -1, -1, -1 },
+	{ 5, 6, 2, 9, 5, 2, 0, 9, 2, 4, 8, 7, -1, -1, -1, -1 },
+	{ 7, 4, 9, 3, 7, 9, 9, 5, 6, 3, 9, 6, 2, 3, 6, -1 },
+	{ 2, 11, 3, 4, 8, 7, 5, 6, 10, -1, -1, -1, -1, -1, -1, -1 },
+	{ 11, 7, 4, 2, 11, 4, 0, 2, 4, 5, 6, 10, -1, -1, -1, -1 },
+	{ 0, 9, 1, 2, 11, 3, 4, 8, 7, 5, 6, 10, -1, -1, -1, -1 },
+	{ 7, 4, 9, 11, 7, 9, 2, 11, 9, 1, 2, 9, 5, 6, 10, -1 },
+	{ 6, 11, 3, 5, 6, 3, 1, 5, 3, 4, 8, 7, -1, -1, -1, -1 },
+	{ 5, 6, 11, 1, 5, 11, 11, 7, 4, 1, 11, 4, 0, 1, 4, -1 },
+	{ 6, 11, 3, 5, 6, 3, 9, 5, 3, 0, 9, 3, 4, 8, 7, -1 },
+	{ 5, 6, 11, 9, 5, 11, 9, 11, 7, 4, 9, 7, -1, -1, -1, -1 },
+	{ 6, 10, 9, 4, 6, 9, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+	{ 0, 3, 8, 6, 10, 9, 4, 6, 9, -1, -1, -1, -1, -1, -1, -1 },
+	{ 6, 10, 1, 4, 6, 1, 0, 4, 1, -1, -1, -1, -1, -1, -1, -1 },
+	{ 4, 6, 10, 8, 4, 10, 3, 8, 10, 1, 3, 10, -1, -1, -1, -1 },
+	{ 4, 6, 2, 9, 4, 2, 1, 9, 2, -1, -1, -1, -1, -1, -1, -1 },
+	{ 0, 3, 8, 4, 6, 2, 9, 4, 2, 1, 9, 2, -1, -1, -1, -1 },
+	{ 4, 6, 2, 0, 4, 2, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+	{ 8, 4, 6, 3, 8, 6, 2, 3, 6, -1, -1, -1, -1, -1, -1, -1 },
+	{ 2, 11, 3, 6, 10, 9, 4, 6, 9, -1, -1, -1, -1, -1, -1, -1 },
+	{ 2, 11, 8, 0, 2, 8, 6, 10, 9, 4, 6, 9, -1, -1, -1, -1 },
+	{ 6, 10, 1, 4, 6, 1, 0, 4, 1, 2, 11, 3, -1, -1, -1, -1 },
+	{ 2, 11, 8, 1, 2, 8, 4, 6, 10, 8, 4, 10, 1, 8, 10, -1 },
+	{ 6, 11, 3, 4, 6, 3, 9, 4, 3, 1, 9, 3, -1, -1, -1, -1 },
+	{ 9, 4, 6, 1, 9, 6, 6, 11, 8, 1, 6, 8, 0, 1, 8, -1 },
+	{ 6, 11, 3, 4, 6, 3, 0, 4, 3, -1, -1, -1, -1, -1, -1, -1 },
+	{ 6, 11, 8, 4, 6, 8, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+	{ 9, 8, 7, 10, 9, 7, 6, 10, 7, -1, -1, -1, -1, -1, -1, -1 },
+	{ 6, 10, 9, 7, 6, 9, 3, 7, 9, 0, 3, 9, -1, -1, -1, -1 },
+	{ 6, 10, 1, 7, 6, 1, 8, 7, 1, 0, 8, 1, -1, -1, -1, -1 },
+	{ 7, 6, 10, 3, 7, 10, 1, 3, 10, -1, -1, -1, -1, -1, -1, -1 },
+	{ 7, 6, 2, 8, 7, 2, 9, 8, 2, 1, 9, 2, -1, -1, -1, -1 },
+	{ 2, 1, 9, 6, 2, 9, 7, 6, 9, 3, 7, 9, 0, 3, 9, -1 },
+	{ 7, 6, 2, 8, 7, 2, 0, 8, 2, -1, -1, -1, -1, -1, -1, -1 },
+	{ 3, 7, 6, 2, 3, 6, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+	{ 2, 11, 3, 9, 8, 7, 10, 9, 7, 6, 10, 7, -1, -1, -1, -1 },
+	{ 6, 10, 9, 7, 6, 9, 11, 7, 9, 2, 11, 9, 0, 2, 9, -1 },
+	{ 6, 10, 1, 7, 6, 1, 8, 7, 1, 0, 8, 1, 2, 11, 3, -1 },
+	{ 2, 11, 7, 1, 2, 7, 7, 6, 10, 1, 7, 10, -1, -1, -1, -1 },
+	{ 8, 7, 6, 9, 8, 6, 6, 11, 3, 9, 6, 3, 1, 9, 3, -1 },
+	{ 0, 1, 9, 6, 11, 7, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+	{ 8, 7, 6, 0, 8, 6, 6, 11, 3, 0, 6, 3, -1, -1, -1, -1 },
+	{ 6, 11, 7, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+	{ 6, 7, 11, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+	{ 0, 3, 8, 6, 7, 11, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+	{ 0, 9, 1, 6, 7, 11, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+	{ 3, 8, 9, 1, 3, 9, 6, 7, 11, -1, -1, -1, -1, -1, -1, -1 },
+	{ 1, 10, 2, 6, 7, 11, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+	{ 0, 3, 8, 1, 10, 2, 6, 7, 11, -1, -1, -1, -1, -1, -1, -1 },
+	{ 9, 10, 2, 0, 9, 2, 6, 7, 11, -1, -1, -1, -1, -1, -1, -1 },
+	{ 8, 9, 10, 3, 8, 10, 2, 3, 10, 6, 7, 11, -1, -1, -1, -1 },
+	{ 6, 7, 3, 2, 6, 3, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+	{ 6, 7, 8, 2, 6, 8, 0, 2, 8, -1, -1, -1, -1, -1, -1, -1 },
+	{ 0, 9, 1, 6, 7, 3, 2, 6, 3, -1, -1, -1, -1, -1, -1, -1 },
+	{ 7, 8, 9, 6, 7, 9, 2, 6, 9, 1, 2, 9, -1, -1, -1, -1 },
+	{ 6, 7, 3, 10, 6, 3, 1, 10, 3, -1, -1, -1, -1, -1, -1, -1 },
+	{ 6, 7, 8, 10, 6, 8, 1, 10, 8, 0, 1, 8, -1, -1, -1, -1 },
+	{ 6, 7, 3, 10, 6, 3, 9, 10, 3, 0, 9, 3, -1, -1, -1, -1 },
+	{ 8, 9, 10, 7, 8, 10, 6, 7, 10, -1, -1, -1, -1, -1, -1, -1 },
+	{ 8, 11, 6, 4, 8, 6, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+	{ 11, 6, 4, 3, 11, 4, 0, 3, 4, -1, -1, -1, -1, -1, -1, -1 },
+	{ 0, 9, 1, 8, 11, 6, 4, 8, 6, -1, -1, -1, -1, -1, -1, -1 },
+	{ 6, 4, 9, 11, 6, 9, 3, 11, 9, 1, 3, 9, -1, -1, -1, -1 },
+	{ 1, 10, 2, 8, 11, 6, 4, 8, 6, -1, -1, -1, -1, -1, -1, -1 },
+	{ 11, 6, 4, 3, 11, 4, 0, 3, 4, 1, 10, 2, -1, -1, -1, -1 },
+	{ 9, 10, 2, 0, 9, 2, 8, 11, 6, 4, 8, 6, -1, -1, -1, -1 },
+	{ 11, 6, 4, 3, 11, 4, 4, 9, 10, 3, 4, 10, 2, 3, 10, -1 },
+	{ 4, 8, 3, 6, 4, 3, 2, 6, 3, -1, -1, -1, -1, -1, -1, -1 },
+	{ 2, 6, 4, 0, 2, 4, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+	{ 0, 9, 1, 4, 8, 3, 6, 4, 3, 2, 6, 3, -1, -1, -1, -1 },
+	{ 6, 4, 9, 2, 6, 9, 1, 2, 9, -1, -1, -1, -1, -1, -1, -1 },
+	{ 4, 8, 3, 6, 4, 3, 10, 6, 3, 1, 10, 3, -1, -1, -1, -1 },
+	{ 10, 6, 4, 1, 10, 4, 0, 1, 4, -1, -1, -1, -1, -1, -1, -1 },
+	{ 4, 8, 3, 6, 4, 3, 10, 6, 3, 9, 10, 3, 0, 9, 3, -1 },
+	{ 9, 10, 6, 4, 9, 6, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+	{ 4, 5, 9, 6, 7, 11, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+	{ 0, 3, 8, 4, 5, 9, 6, 7, 11, -1, -1, -1, -1, -1, -1, -1 },
+	{ 4, 5, 1, 0, 4, 1, 6, 7, 11, -1, -1, -1, -1, -1, -1, -1 },
+	{ 8, 4, 5, 3, 8, 5, 1, 3, 5, 6, 7, 11, -1, -1, -1, -1 },
+	{ 1, 10, 2, 4, 5, 9, 6, 7, 11, -1, -1, -1, -1, -1, -1, -1 },
+	{ 0, 3, 8, 1, 10, 2, 4, 5, 9, 6, 7, 11, -1, -1, -1, -1 },
+	{ 5, 10, 2, 4, 5, 2, 0, 4, 2, 6, 7, 11, -1, -1, -1, -1 },
+	{ 4, 5, 10, 8, 4, 10, 3, 8, 10, 2, 3, 10, 6, 7, 11, -1 },
+	{ 6, 7, 3, 2, 6, 3, 4, 5, 9, -1, -1, -1, -1, -1, -1, -1 },
+	{ 6, 7, 8, 2, 6, 8, 0, 2, 8, 4, 5, 9, -1, -1, -1, -1 },
+	{ 4, 5, 1, 0, 4, 1, 6, 7, 3, 2, 6, 3, -1, -1, -1, -1 },
+	{ 6, 7, 8, 2, 6, 8, 8, 4, 5, 2, 8, 5, 1, 2, 5, -1 },
+	{ 6, 7, 3, 10, 6, 3, 1, 10, 3, 4, 5, 9, -1, -1, -1, -1 },
+	{ 6, 7, 8, 10, 6, 8, 1, 10, 8, 0, 1, 8, 4, 5, 9, -1 },
+	{ 6, 7, 3, 10, 6, 3, 5, 10, 3, 4, 5, 3, 0, 4, 3, -1 },
+	{ 6, 7, 8, 10, 6, 8, 5, 10, 8, 4, 5, 8, -1, -1, -1, -1 },
+	{ 8, 11, 6, 9, 8, 6, 5, 9, 6, -1, -1, -1, -1, -1, -1, -1 },
+	{ 6, 5, 9, 11, 6, 9, 3, 11, 9, 0, 3, 9, -1, -1, -1, -1 },
+	{ 6, 5, 1, 11, 6, 1, 8, 11, 1, 0, 8, 1, -1, -1, -1, -1 },
+	{ 11, 6, 5, 3, 11, 5, 1, 3, 5, -1, -1, -1, -1, -1, -1, -1 },
+	{ 1, 10, 2, 8, 11, 6, 9, 8, 6, 5, 9, 6, -1, -1, -1, -1 },
+	{ 6, 5, 9, 11, 6, 9, 3, 11, 9, 0, 3, 9, 1, 10, 2, -1 },
+	{ 11, 6, 5, 8, 11, 5, 5, 10, 2, 8, 5, 2, 0, 8, 2, -1 },
+	{ 11, 6, 5, 3, 11, 5, 3, 5, 10, 2, 3, 10, -1, -1, -1, -1 },
+	{ 9, 8, 3, 5, 9, 3, 6, 5, 3, 2, 6, 3, -1, -1, -1, -1 },
+	{ 6, 5, 9, 2, 6, 9, 0, 2, 9, -1, -1, -1, -1, -1, -1, -1 },
+	{ 3, 2, 6, 8, 3, 6, 6, 5, 1, 8, 6, 1, 0, 8, 1, -1 },
+	{ 2, 6, 5, 1, 2, 5, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+	{ 9, 8, 3, 5, 9, 3, 6, 5, 3, 10, 6, 3, 1, 10, 3, -1 },
+	{ 1, 10, 6, 0, 1, 6, 6, 5, 9, 0, 6, 9, -1, -1, -1, -1 },
+	{ 0, 8, 3, 5, 10, 6, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+	{ 5, 10, 6, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+	{ 7, 11, 10, 5, 7, 10, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+	{ 0, 3, 8, 7, 11, 10, 5, 7, 10, -1, -1, -1, -1, -1, -1, -1 },
+	{ 0, 9, 1, 7, 11, 10, 5, 7, 10, -1, -1, -1, -1, -1, -1, -1 },
+	{ 3, 8, 9, 1, 3, 9, 7, 11, 10, 5, 7, 10, -1, -1, -1, -1 },
+	{ 7, 11, 2, 5, 7, 2, 1, 5, 2, -1, -1, -1, -1, -1, -1, -1 },
+	{ 0, 3, 8, 7, 11, 2, 5, 7, 2, 1, 5, 2, -1, -1, -1, -1 },
+	{ 7, 11, 2, 5, 7, 2, 9, 5, 2, 0, 9, 2, -1, -1, -1, -1 },
+	{ 3, 8, 9, 2, 3, 9, 5, 7, 11, 9, 5, 11, 2, 9, 11, -1 },
+	{ 5, 7, 3, 10, 5, 3, 2, 10, 3, -1, -1, -1, -1, -1, -1, -1 },
+	{ 5, 7, 8, 10, 5, 8, 2, 10, 8, 0, 2, 8, -1, -1, -1, -1 },
+	{ 0, 9, 1, 5, 7, 3, 10, 5, 3, 2, 10, 3, -1, -1, -1, -1 },
+	{ 10, 5, 7, 2, 10, 7, 7, 8, 9, 2, 7, 9, 1, 2, 9, -1 },
+	{ 5, 7, 3, 1, 5, 3, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+	{ 5, 7, 8, 1, 5, 8, 0, 1, 8, -1, -1, -1, -1, -1, -1, -1 },
+	{ 5, 7, 3, 9, 5, 3, 0, 9, 3, -1, -1, -1, -1, -1, -1, -1 },
+	{ 7, 8, 9, 5, 7, 9, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+	{ 11, 10, 5, 8, 11, 5, 4, 8, 5, -1, -1, -1, -1, -1, -1, -1 },
+	{ 10, 5, 4, 11, 10, 4, 3, 11, 4, 0, 3, 4, -1, -1, -1, -1 },
+	{ 0, 9, 1, 11, 10, 5, 8, 11, 5, 4, 8, 5, -1, -1, -1, -1 },
+	{ 10, 5, 4, 11, 10, 4, 11, 4, 9, 3, 11, 9, 1, 3, 9, -1 },
+	{ 8, 11, 2, 4, 8, 2, 5, 4, 2, 1, 5, 2, -1, -1, -1, -1 },
+	{ 1, 5, 4, 2, 1, 4, 11, 2, 4, 3, 11, 4, 0, 3, 4, -1 },
+	{ 8, 11, 2, 4, 8, 2, 5, 4, 2, 9, 5, 2, 0, 9, 2, -1 },
+	{ 2, 3, 11, 4, 9, 5, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+	{ 4, 8, 3, 5, 4, 3, 10, 5, 3, 2, 10, 3, -1, -1, -1, -1 },
+	{ 10, 5, 4, 2, 10, 4, 0, 2, 4, -1, -1, -1, -1, -1, -1, -1 },
+	{ 0, 9, 1, 4, 8, 3, 5, 4, 3, 10, 5, 3, 2, 10, 3, -1 },
+	{ 10, 5, 4, 2, 10, 4, 2, 4, 9, 1, 2, 9, -1, -1, -1, -1 },
+	{ 4, 8, 3, 5, 4, 3, 1, 5, 3, -1, -1, -1, -1, -1, -1, -1 },
+	{ 1, 5, 4, 0, 1, 4, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+	{ 4, 8, 3, 5, 4, 3, 9, 5, 3, 0, 9, 3, -1, -1, -1, -1 },
+	{ 4, 9, 5, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+	{ 11, 10, 9, 7, 11, 9, 4, 7, 9, -1, -1, -1, -1, -1, -1, -1 },
+	{ 0, 3, 8, 11, 10, 9, 7, 11, 9, 4, 7, 9, -1, -1, -1, -1 },
+	{ 11, 10, 1, 7, 11, 1, 4, 7, 1, 0, 4, 1, -1, -1, -1, -1 },
+	{ 7, 11, 10, 4, 7, 10, 8, 4, 10, 3, 8, 10, 1, 3, 10, -1 },
+	{ 7, 11, 2, 4, 7, 2, 9, 4, 2, 1, 9, 2, -1, -1, -1, -1 },
+	{ 0, 3, 8, 7, 11, 2, 4, 7, 2, 9, 4, 2, 1, 9, 2, -1 },
+	{ 7, 11, 2, 4, 7, 2, 0, 4, 2, -1, -1, -1, -1, -1, -1, -1 },
+	{ 3, 8, 4, 2, 3, 4, 4, 7, 11, 2, 4, 11, -1, -1, -1, -1 },
+	{ 4, 7, 3, 9, 4, 3, 10, 9, 3, 2, 10, 3, -1, -1, -1, -1 },
+	{ 9, 4, 7, 10, 9, 7, 10, 7, 8, 2, 10, 8, 0, 2, 8, -1 },
+	{ 3, 2, 10, 7, 3, 10, 7, 10, 1, 4, 7, 1, 0, 4, 1, -1 },
+	{ 1, 2, 10, 4, 7, 8, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+	{ 4, 7, 3, 9, 4, 3, 1, 9, 3, -1, -1, -1, -1, -1, -1, -1 },
+	{ 9, 4, 7, 1, 9, 7, 1, 7, 8, 0, 1, 8, -1, -1, -1, -1 },
+	{ 4, 7, 3, 0, 4, 3, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+	{ 4, 7, 8, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+	{ 11, 10, 9, 8, 11, 9, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+	{ 11, 10, 9, 3, 11, 9, 0, 3, 9, -1, -1, -1, -1, -1, -1, -1 },
+	{ 11, 10, 1, 8, 11, 1, 0, 8, 1, -1, -1, -1, -1, -1, -1, -1 },
+	{ 3, 11, 10, 1, 3, 10, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+	{ 8, 11, 2, 9, 8, 2, 1, 9, 2, -1, -1, -1, -1, -1, -1, -1 },
+	{ 2, 1, 9, 11, 2, 9, 3, 11, 9, 0, 3, 9, -1, -1, -1, -1 },
+	{ 8, 11, 2, 0, 8, 2, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+	{ 2, 3, 11, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+	{ 9, 8, 3, 10, 9, 3, 2, 10, 3, -1, -1, -1, -1, -1, -1, -1 },
+	{ 2, 10, 9, 0, 2, 9, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+	{ 3, 2, 10, 8, 3, 10, 8, 10, 1, 0, 8, 1, -1, -1, -1, -1 },
+	{ 1, 2, 10, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+	{ 9, 8, 3, 1, 9, 3, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+	{ 0, 1, 9, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+	{ 0, 8, 3, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+	{ -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+};
+
+struct BlockAgeComparator {
+	_FORCE_INLINE_ bool operator()(const Pair<uint64_t, Vector3i> &p_a, const Pair<uint64_t, Vector3i> &p_b) const {
+		return p_a.first < p_b.first;
+	}
+};
+
+static int floor_div(int p_value, int p_divisor) {
+	return (p_value >= 0 ? p_value : p_value - p_divisor + 1) / p_divisor;
+}
+
+void OpenXREnvironmentDepthFusion::_bind_methods() {
+	ClassDB::bind_method(D_METHOD("integrate_depth_image", "depth", "width", "height", "view_to_world", "tan_fov", "flip_y"), &OpenXREnvironmentDepthFusion::integrate_depth_image, DEFVAL(false));
+	ClassDB::bind_method(D_METHOD("is_integrating"), &OpenXREnvironmentDepthFusion::is_integrating);
+
+	ClassDB::bind_method(D_METHOD("get_distance", "position"), &OpenXREnvironmentDepthFusion::get_distance);
+
+	ClassDB::bind_method(D_METHOD("get_blocks"), &OpenXREnvironmentDepthFusion::get_blocks);
+	ClassDB::bind_method(D_METHOD("get_block_count"), &OpenXREnvironmentDepthFusion::get_block_count);
+	ClassDB::bind_method(D_METHOD("get_block_aabb", "block"), &OpenXREnvironmentDepthFusion::get_block_aabb);
+	ClassDB::bind_method(D_METHOD("extract_block_mesh", "block"), &OpenXREnvironmentDepthFusion::extract_block_mesh);
+
+	ClassDB::bind_method(D_METHOD("clear"), &OpenXREnvironmentDepthFusion::clear);
+
+	ClassDB::bind_method(D_METHOD("set_voxel_size", "voxel_size"), &OpenXREnvironmentDepthFusion::set_voxel_size);
+	ClassDB::bind_method(D_METHOD("get_voxel_size"), &OpenXREnvironmentDepthFusion::get_voxel_size);
+
+	ClassDB::bind_method(D_METHOD("set_truncation_distance", "truncation_distance"), &OpenXREnvironmentDepthFusion::set_truncation_distance);
+	ClassDB::bind_method(D_METHOD("get_truncation_distance"), &OpenXREnvironmentDepthFusion::get_truncation_distance);
+
+	ClassDB::bind_method(D_METHOD("set_max_depth", "max_depth"), &OpenXREnvironmentDepthFusion::set_max_depth);
+	ClassDB::bind_method(D_METHOD("get_max_depth"), &OpenXREnvironmentDepthFusion::get_max_depth);
+
+	ClassDB::bind_method(D_METHOD("set_max_weight", "max_weight"), &OpenXREnvironmentDepthFusion::set_max_weight);
+	ClassDB::bind_method(D_METHOD("get_max_weight"), &OpenXREnvironmentDepthFusion::get_max_weight);
+
+	ClassDB::bind_method(D_METHOD("set_max_blocks", "max_blocks"), &OpenXREnvironmentDepthFusion::set_max_blocks);
+	ClassDB::bind_method(D_METHOD("get_max_blocks"), &OpenXREnvironmentDepthFusion::get_max_blocks);
+
+	ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "voxel_size", PROPERTY_HINT_RANGE, "0.005,0.5,0.001,suffix:m"), "set_voxel_size", "get_voxel_size");
+	ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "truncation_distance", PROPERTY_HINT_RANGE, "0.01,1,0.001,suffix:m"), "set_truncation_distance", "get_truncation_distance");
+	ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "max_depth", PROPERTY_HINT_RANGE, "0.5,10,0.1,suffix:m"), "set_max_depth", "get_max_depth");
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "max_weight", PROPERTY_HINT_RANGE, "1,1024,1"), "set_max_weight", "get_max_weight");
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "max_blocks", PROPERTY_HINT_RANGE, "1,65536,1"), "set_max_blocks", "get_max_blocks");
+
+	ADD_SIGNAL(MethodInfo("blocks_changed", PropertyInfo(Variant::ARRAY, "changed_blocks", PROPERTY_HINT_ARRAY_TYPE, "Vector3i"), PropertyInfo(Variant::ARRAY, "removed_blocks", PROPERTY_HINT_ARRAY_TYPE, "Vector3i")));
+}
+
+void OpenXREnvironmentDepthFusion::integrate_depth_image(const PackedFloat32Array &p_depth, int p_width, int p_height, const Transform3D &p_view_to_world, const Vector4 &p_tan_fov, bool p_flip_y) {
+	ERR_FAIL_COND(p_width <= 0 || p_height <= 0);
+	ERR_FAIL_COND(p_depth.size() < (int64_t)p_width * p_height);
+	ERR_FAIL_COND(p_tan_fov.y <= p_tan_fov.x || p_tan_fov.w <= p_tan_fov.z);
+
+	Frame frame;
+	frame.depth = p_depth;
+	frame.width = p_width;
+	frame.height = p_height;
+	frame.view_to_world = p_view_to_world;
+	frame.tan_fov = p_tan_fov;
+	frame.flip_y = p_flip_y;
+
+	if (integration_task_id >= 0) {
+		// Only the newest frame is kept, rather than falling further and further behind.
+		pending_frame = frame;
+		has_pending_frame = true;
+		return;
+	}
+
+	_start_integrating(frame);
+}
+
+bool OpenXREnvironmentDepthFusion::is_integrating() const {
+	return integration_task_id >= 0;
+}
+
+float OpenXREnvironmentDepthFusion::get_distance(const Vector3 &p_position) const {
+	// Trilinear interpolation between the centers of the surrounding voxels, leaving out the
+	// ones which weren't observed.
+	Vector3 position = p_position / voxel_size - Vector3(0.5, 0.5, 0.5);
+	Vector3 base = position.floor();
+	Vector3 fraction = position - base;
+	Vector3i base_voxel = Vector3i((int)base.x, (int)base.y, (int)base.z);
+
+	float distance_sum = 0.0;
+	float weight_sum = 0.0;
+	for (int i = 0; i < 8; i++) {
+		const int *corner = MARCHING_CUBES_CORNERS[i];
+		float distance;
+		if (!_get_voxel(base_voxel + Vector3i(corner[0], corner[1], corner[2]), distance)) {
+			continue;
+		}
+
+		float weight = (corner[0] ? fraction.x : 1.0f - fraction.x) * (corner[1] ? fraction.y : 1.0f - fraction.y) * (corner[2] ? fraction.z : 1.0f - fraction.z);
+		distance_sum += distance * weight;
+		weight_sum += weight;
+	}
+
+	if (weight_sum <= 0.0f) {
+		return Math_INF;
+	}
+
+	return distance_sum / weight_sum * truncation_distance;
+}
+
+TypedArray<Vector3i> OpenXREnvironmentDepthFusion::get_blocks() const {
+	TypedArray<Vector3i> ret;
+	for (const KeyValue<Vector3i, Block> &E : blocks) {
+		ret.push_back(E.key);
+	}
+	return ret;
+}
+
+int OpenXREnvironmentDepthFusion::get_block_count() const {
+	return blocks.size();
+}
+
+AABB OpenXREnvironmentDepthFusion::get_block_aabb(const Vector3i &p_block) const {
+	float block_extent = voxel_size * BLOCK_SIZE;
+	return AABB(Vector3(p_block.x, p_block.y, p_block.z) * block_extent, Vector3(block_extent, block_extent, block_extent));
+}
+
+Array OpenXREnvironmentDepthFusion::extract_block_mesh(const Vector3i &p_block) const {
+	if (!blocks.has(p_block)) {
+		return Array();
+	}
+
+	// The cells of a block span from its own voxel centers to those of the first voxels of the
+	// next blocks along each axis.
+	const int GRID_SIZE = BLOCK_SIZE + 1;
+	float grid_distances[GRID_SIZE * GRID_SIZE * GRID_SIZE];
+	bool grid_observed[GRID_SIZE * GRID_SIZE * GRID_SIZE];
+	Vector3i first_voxel = p_block * BLOCK_SIZE;
+	for (int z = 0; z < GRID_SIZE; z++) {
+		for (int y = 0; y < GRID_SIZE; y++) {
+			for (int x = 0; x < GRID_SIZE; x++) {
+				int i = (z * GRID_SIZE + y) * GRID_SIZE + x;
+				grid_observed[i] = _get_voxel(first_voxel + Vector3i(x, y, z), grid_distances[i]);
+			}
+		}
+	}
+
+	// Neighboring voxels can't differ by more than their distance, so cells with larger jumps
+	// straddle the edge of what was observed, rather than a surface.
+	float max_cell_range = 2.0 * Math::sqrt(3.0f) * voxel_size / truncation_distance;
+
+	Vector3 grid_origin = (Vector3(first_voxel.x, first_voxel.y, first_voxel.z) + Vector3(0.5, 0.5, 0.5)) * voxel_size;
+	PackedVector3Array vertices;
+	PackedInt32Array indices;
+	HashMap<uint32_t, int32_t> edge_vertices;
+
+	for (int z = 0; z < BLOCK_SIZE; z++) {
+		for (int y = 0; y < BLOCK_SIZE; y++) {
+			for (int x = 0; x < BLOCK_SIZE; x++) {
+				int corner_indices[8];
+				int config = 0;
+				bool observed = true;
+				float min_distance = 1.0;
+				float max_distance = -1.0;
+				for (int i = 0; i < 8; i++) {
+					const int *corner = MARCHING_CUBES_CORNERS[i];
+					corner_indices[i] = ((z + corner[2]) * GRID_SIZE + y + corner[1]) * GRID_SIZE + x + corner[0];
+					if (!grid_observed[corner_indices[i]]) {
+						observed = false;
+						break;
+					}
+
+					float distance = grid_distances[corner_indices[i]];
+					if (distance < 0.0f) {
+						config |= 1 << i;
+					}
+					min_distance = MIN(min_distance, distance);
+					max_distance = MAX(max_distance, distance);
+				}
+
+				if (!observed || config == 0 || config == 255 || max_distance - min_distance > max_cell_range) {
+					continue;
+				}
+
+				const int8_t *triangles = MARCHING_CUBES_TRIANGLES[config];
+				for (int i = 0; triangles[i] != -1; i += 3) {
+					int32_t triangle[3];
+					for (int j = 0; j < 3; j++) {
+						const int *edge = MARCHING_CUBES_EDGES[triangles[i + j]];
+						int a = corner_indices[edge[0]];
+						int b = corner_indices[edge[1]];
+
+						// Vertices are shared between the cells around an edge.
+						uint32_t edge_key = MIN(a, b) * 3 + (ABS(b - a) == 1 ? 0 : (ABS(b - a) == GRID_SIZE ? 1 : 2));
+						const int32_t *existing = edge_vertices.getptr(edge_key);
+						if (existing != nullptr) {
+							triangle[j] = *existing;
+							continue;
+						}
+
+						const int *corner_a = MARCHING_CUBES_CORNERS[edge[0]];
+						const int *corner_b = MARCHING_CUBES_CORNERS[edge[1]];
+						float distance_a = grid_distances[a];
+						float distance_b = grid_distances[b];
+						float t = distance_a / (distance_a - distance_b);
+						Vector3 position_a = Vector3(x + corner_a[0], y + corner_a[1], z + corner_a[2]);
+						Vector3 position_b = Vector3(x + corner_b[0], y + corner_b[1], z + corner_b[2]);
+
+						triangle[j] = vertices.size();
+						vertices.push_back(grid_origin + position_a.lerp(position_b, t) * voxel_size);
+						edge_vertices.insert(edge_key, triangle[j]);
+					}
+
+					// Godot uses clockwise winding for front faces.
+					indices.push_back(triangle[0]);
+					indices.push_back(triangle[2]);
+					indices.push_back(triangle[1]);
+				}
+			}
+		}
+	}
+
+	if (indices.is_empty()) {
+		return Array();
+	}
+
+	// Area weighted vertex normals, pointing out of the surfaces into the observed free space.
+	PackedVector3Array normals;
+	normals.resize(vertices.size());
+	normals.fill(Vector3());
+	const Vector3 *vertices_ptr = vertices.ptr();
+	Vector3 *normals_ptr = normals.ptrw();
+	for (int64_t i = 0; i < indices.size(); i += 3) {
+		int32_t a = indices[i];
+		int32_t b = indices[i + 1];
+		int32_t c = indices[i + 2];
+		Vector3 normal = (vertices_ptr[c] - vertices_ptr[a]).cross(vertices_ptr[b] - vertices_ptr[a]);
+		normals_ptr[a] += normal;
+		normals_ptr[b] += normal;
+		normals_ptr[c] += normal;
+	}
+	for (int64_t i = 0; i < normals.size(); i++) {
+		normals_ptr[i] = normals_ptr[i].normalized();
+	}
+
+	Array arrays;
+	arrays.resize(Mesh::ARRAY_MAX);
+	arrays[Mesh::ARRAY_VERTEX] = vertices;
+	arrays[Mesh::ARRAY_NORMAL] = normals;
+	arrays[Mesh::ARRAY_INDEX] = indices;
+	return arrays;
+}
+
+void OpenXREnvironmentDepthFusion::clear() {
+	_cancel_integration();
+
+	TypedArray<Vector3i> removed_blocks = get_blocks();
+	blocks.clear();
+
+	if (!removed_blocks.is_empty()) {
+		emit_signal("blocks_changed", TypedArray<Vector3i>(), removed_blocks);
+	}
+}
+
+void OpenXREnvironmentDepthFusion::set_voxel_size(float p_voxel_size) {
+	ERR_FAIL_COND(p_voxel_size <= 0.0);
+	if (voxel_size == p_voxel_size) {
+		return;
+	}
+
+	// The existing blocks no longer line up with the new voxels.
+	clear();
+	voxel_size = p_voxel_size;
+}
+
+float OpenXREnvironmentDepthFusion::get_voxel_size() const {
+	return voxel_size;
+}
+
+void OpenXREnvironmentDepthFusion::set_truncation_distance(float p_truncation_distance) {
+	ERR_FAIL_COND(p_truncation_distance <= 0.0);
+	if (truncation_distance == p_truncation_distance) {
+		return;
+	}
+
+	// The stored distances are relative to the truncation distance.
+	clear();
+	truncation_distance = p_truncation_distance;
+}
+
+float OpenXREnvironmentDepthFusion::get_truncation_distance() const {
+	return truncation_distance;
+}
+
+void OpenXREnvironmentDepthFusion::set_max_depth(float p_max_depth) {
+	max_depth = p_max_depth;
+}
+
+float OpenXREnvironmentDepthFusion::get_max_depth() const {
+	return max_depth;
+}
+
+void OpenXREnvironmentDepthFusion::set_max_weight(int p_max_weight) {
+	max_weight = CLAMP(p_max_weight, 1, UINT16_MAX);
+}
+
+int OpenXREnvironmentDepthFusion::get_max_weight() const {
+	return max_weight;
+}
+
+void OpenXREnvironmentDepthFusion::set_max_blocks(int p_max_blocks) {
+	// Takes effect once the next frame is integrated, so the blocks aren't modified under the
+	// feet of a running task.
+	max_blocks = MAX(p_max_blocks, 1);
+}
+
+int OpenXREnvironmentDepthFusion::get_max_blocks() const {
+	return max_blocks;
+}
+
+void OpenXREnvironmentDepthFusion::_start_integrating(const Frame &p_frame) {
+	integration.frame = p_frame;
+	integration.voxel_size = voxel_size;
+	integration.truncation_distance = truncation_distance;
+	integration.max_depth = max_depth;
+	integration.max_weight = max_weight;
+
+	Callable task = callable_mp_static(&OpenXREnvironmentDepthFusion::_integrate_task).bind(Ref<OpenXREnvironmentDepthFusion>(this), integration_serial);
+	integration_task_id = WorkerThreadPool::get_singleton()->add_task(task, false, "Integrate environment depth");
+}
+
+void OpenXREnvironmentDepthFusion::_cancel_integration() {
+	if (integration_task_id >= 0) {
+		WorkerThreadPool::get_singleton()->wait_for_task_completion(integration_task_id);
+		integration_task_id = -1;
+		integration.updated_blocks.clear();
+		integration.frame = Frame();
+	}
+
+	// The deferred call of a cancelled task is ignored.
+	integration_serial++;
+	pending_frame = Frame();
+	has_pending_frame = false;
+}
+
+void OpenXREnvironmentDepthFusion::_evict_blocks(TypedArray<Vector3i> &r_removed) {
+	if ((int)blocks.size() <= max_blocks) {
+		return;
+	}
+
+	LocalVector<Pair<uint64_t, Vector3i>> ages;
+	ages.reserve(blocks.size());
+	for (const KeyValue<Vector3i, Block> &E : blocks) {
+		ages.push_back(Pair<uint64_t, Vector3i>(E.value.last_integrated_frame, E.key));
+	}
+	ages.sort_custom<BlockAgeComparator>();
+
+	uint32_t remove_count = blocks.size() - (max_blocks - max_blocks / EVICTION_DIVISOR);
+	for (uint32_t i = 0; i < remove_count; i++) {
+		blocks.erase(ages[i].second);
+		r_removed.push_back(ages[i].second);
+	}
+}
+
+bool OpenXREnvironmentDepthFusion::_get_voxel(const Vector3i &p_voxel, float &r_distance) const {
+	Vector3i block_key = Vector3i(floor_div(p_voxel.x, BLOCK_SIZE), floor_div(p_voxel.y, BLOCK_SIZE), floor_div(p_voxel.z, BLOCK_SIZE));
+	const Block *block = blocks.getptr(block_key);
+	if (block == nullptr) {
+		return false;
+	}
+
+	Vector3i local = p_voxel - block_key * BLOCK_SIZE;
+	const Voxel &voxel = reinterpret_cast<const Voxel *>(block->voxels.ptr())[(local.z * BLOCK_SIZE + local.y) * BLOCK_SIZE + local.x];
+	if (voxel.weight == 0) {
+		return false;
+	}
+
+	r_distance = voxel.distance / DISTANCE_SCALE;
+	return true;
+}
+
+void OpenXREnvironmentDepthFusion::_integrate_task(const Ref<OpenXREnvironmentDepthFusion> &p_fusion, uint64_t p_serial) {
+	Integration &integration = p_fusion->integration;
+	const Frame &frame = integration.frame;
+
+	const float *depth = frame.depth.ptr();
+	int width = frame.width;
+	int height = frame.height;
+	const Vector4 &tan_fov = frame.tan_fov;
+	float tan_width = tan_fov.y - tan_fov.x;
+	float tan_height = tan_fov.w - tan_fov.z;
+	float voxel_size = integration.voxel_size;
+	float block_extent = voxel_size * BLOCK_SIZE;
+	float truncation_distance = integration.truncation_distance;
+	float max_depth = integration.max_depth;
+
+	// Find the blocks within the truncation distance of the observed surfaces, by sampling the
+	// band around the depth of each texel at most half a block apart.
+	HashSet<Vector3i> touched_blocks;
+	int band_steps = MAX(1, (int)Math::ceil(4.0 * truncation_distance / block_extent));
+	float band_step = 2.0 * truncation_distance / band_steps;
+	const Basis &basis = frame.view_to_world.basis;
+	const Vector3 &origin = frame.view_to_world.origin;
+
+	for (int y = 0; y < height; y++) {
+		float tan_y = frame.flip_y ? tan_fov.w - (y + 0.5f) * tan_height / height : tan_fov.z + (y + 0.5f) * tan_height / height;
+		for (int x = 0; x < width; x++) {
+			float texel_depth = depth[y * width + x];
+			if (!(texel_depth > 0.0f) || texel_depth > max_depth) {
+				continue;
+			}
+
+			float tan_x = tan_fov.x + (x + 0.5f) * tan_width / width;
+			Vector3 ray = basis.xform(Vector3(tan_x, tan_y, -1.0));
+			for (int i = 0; i <= band_steps; i++) {
+				float ray_depth = texel_depth - truncation_distance + i * band_step;
+				if (ray_depth <= 0.0f) {
+					continue;
+				}
+
+				Vector3 point = (origin + ray * ray_depth) / block_extent;
+				touched_blocks.insert(Vector3i((int)Math::floor(point.x), (int)Math::floor(point.y), (int)Math::floor(point.z)));
+			}
+		}
+	}
+
+	// Update the voxels of those blocks which the depth camera sees.
+	Transform3D world_to_view = frame.view_to_world.affine_inverse();
+	for (const Vector3i &key : touched_blocks) {
+		PackedByteArray voxels;
+		const Block *block = p_fusion->blocks.getptr(key);
+		if (block != nullptr) {
+			voxels = block->voxels;
+		} else {
+			voxels.resize(VOXELS_PER_BLOCK * sizeof(Voxel));
+			voxels.fill(0);
+		}
+
+		// Copy-on-write, so the main thread keeps reading the previous voxels in the meantime.
+		Voxel *block_voxels = reinterpret_cast<Voxel *>(voxels.ptrw());
+		Vector3 block_origin = Vector3(key.x, key.y, key.z) * block_extent;
+		bool updated = false;
+
+		for (int z = 0; z < BLOCK_SIZE; z++) {
+			for (int y = 0; y < BLOCK_SIZE; y++) {
+				for (int x = 0; x < BLOCK_SIZE; x++) {
+					Vector3 point = world_to_view.xform(block_origin + Vector3(x + 0.5f, y + 0.5f, z + 0.5f) * voxel_size);
+					float point_depth = -point.z;
+					if (point_depth <= 0.0f) {
+						continue;
+					}
+
+					float v = (point.y / point_depth - tan_fov.z) / tan_height;
+					int tx = (int)Math::floor((point.x / point_depth - tan_fov.x) / tan_width * width);
+					int ty = (int)Math::floor((frame.flip_y ? 1.0f - v : v) * height);
+					if (tx < 0 || ty < 0 || tx >= width || ty >= height) {
+						continue;
+					}
+
+					float texel_depth = depth[ty * width + tx];
+					if (!(texel_depth > 0.0f) || texel_depth > max_depth) {
+						continue;
+					}
+
+					// Projective signed distance, positive in front of the surface. Voxels too far
+					// behind it may be hidden, so they're left alone.
+					float distance = texel_depth - point_depth;
+					if (distance < -truncation_distance) {
+						continue;
+					}
+
+					Voxel &voxel = block_voxels[(z * BLOCK_SIZE + y) * BLOCK_SIZE + x];
+					float weight = voxel.weight;
+					float fused = (voxel.distance / DISTANCE_SCALE * weight + MIN(distance / truncation_distance, 1.0f)) / (weight + 1.0f);
+					voxel.distance = (int16_t)Math::round(fused * DISTANCE_SCALE);
+					voxel.weight = (uint16_t)MIN(voxel.weight + 1, integration.max_weight);
+					updated = true;
+				}
+			}
+		}
+
+		if (updated) {
+			integration.updated_blocks.insert(key, voxels);
+		}
+	}
+
+	callable_mp_static(&OpenXREnvironmentDepthFusion::_finish_integrating).bind(p_fusion, p_serial).call_deferred();
+}
+
+void OpenXREnvironmentDepthFusion::_finish_integrating(const Ref<OpenXREnvironmentDepthFusion> &p_fusion, uint64_t p_serial) {
+	OpenXREnvironmentDepthFusion *fusion = p_fusion.ptr();
+	if (p_serial != fusion->integration_serial) {
+		return;
+	}
+
+	// The task has already finished, this only releases it.
+	WorkerThreadPool::get_singleton()->wait_for_task_completion(fusion->integration_task_id);
+	fusion->integration_task_id = -1;
+
+	fusion->frame_counter++;
+	for (const KeyValue<Vector3i, PackedByteArray> &E : fusion->integration.updated_blocks) {
+		Block &block = fusion->blocks[E.key];
+		block.voxels = E.value;
+		block.last_integrated_frame = fusion->frame_counter;
+	}
+
+	TypedArray<Vector3i> removed_blocks;
+	fusion->_evict_blocks(removed_blocks);
+
+	TypedArray<Vector3i> changed_blocks;
+	for (const KeyValue<Vector3i, PackedByteArray> &E : fusion->integration.updated_blocks) {
+		if (fusion->blocks.has(E.key)) {
+			changed_blocks.push_back(E.key);
+		}
+	}
+
+	fusion->integration.updated_blocks.clear();
+	fusion->integration.frame = Frame();
+
+	if (fusion->has_pending_frame) {
+		fusion->has_pending_frame = false;
+		fusion->_start_integrating(fusion->pending_frame);
+		fusion->pending_frame = Frame();
+	}
+
+	if (!changed_blocks.is_empty() || !removed_blocks.is_empty()) {
+		fusion->emit_signal("blocks_changed", changed_blocks, removed_blocks);
+	}
+}
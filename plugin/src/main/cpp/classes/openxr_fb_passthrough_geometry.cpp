@@ -32,35 +32,28 @@
 #include "extensions/openxr_fb_passthrough_extension.h"
 
 #include <godot_cpp/classes/engine.hpp>
-#include <godot_cpp/classes/shader.hpp>
-#include <godot_cpp/classes/shader_material.hpp>
 #include <godot_cpp/classes/standard_material3d.hpp>
+#include <godot_cpp/classes/world3d.hpp>
 #include <godot_cpp/classes/xr_server.hpp>
 #include <godot_cpp/variant/utility_functions.hpp>
 
 using namespace godot;
 
 const Color PREVIEW_COLOR = Color(1.0, 0.0, 1.0);
-static const char *HOLE_PUNCH_SHADER_CODE =
-		"shader_type spatial;\n"
-		"render_mode blend_mix, depth_draw_opaque, cull_back, shadow_to_opacity, shadows_disabled;\n"
-		"void fragment() {\n"
-		"\tALBEDO = vec3(0.0, 0.0, 0.0);\n"
-		"}\n";
 
 void OpenXRFbPassthroughGeometry::set_mesh(const Ref<Mesh> &p_mesh) {
 	if (p_mesh == mesh) {
 		return;
 	}
 
-	if (geometry_instance.is_valid()) {
+	if (geometry_instance.is_valid() || hole_punch_batched) {
 		destroy_passthrough_geometry();
 	}
 
 	mesh = p_mesh;
 
 	if (mesh.is_null()) {
-		if (opaque_mesh != nullptr) {
+		if (has_hole_punch()) {
 			delete_opaque_mesh();
 		}
 		return;
@@ -94,9 +87,9 @@ void OpenXRFbPassthroughGeometry::set_enable_hole_punch(bool p_enable) {
 		return;
 	}
 
-	if (opaque_mesh == nullptr && mesh.is_valid() && enable_hole_punch) {
+	if (!has_hole_punch() && mesh.is_valid() && enable_hole_punch) {
 		instatiate_opaque_mesh();
-	} else if (opaque_mesh != nullptr && !enable_hole_punch) {
+	} else if (has_hole_punch() && !enable_hole_punch) {
 		delete_opaque_mesh();
 	}
 }
@@ -114,11 +107,12 @@ void OpenXRFbPassthroughGeometry::create_passthrough_geometry() {
 		geometry_instance = OpenXRFbPassthroughExtension::get_singleton()->geometry_instance_create(mesh->surface_get_arrays(0), get_transform());
 	}
 
-	if (opaque_mesh == nullptr && enable_hole_punch) {
+	if (!has_hole_punch() && enable_hole_punch) {
 		instatiate_opaque_mesh();
 	}
 
 	set_notify_local_transform(true);
+	set_notify_transform(true);
 }
 
 void OpenXRFbPassthroughGeometry::destroy_passthrough_geometry() {
@@ -127,7 +121,7 @@ void OpenXRFbPassthroughGeometry::destroy_passthrough_geometry() {
 		geometry_instance = RID();
 	}
 
-	if (opaque_mesh != nullptr) {
+	if (has_hole_punch()) {
 		delete_opaque_mesh();
 	}
 }
@@ -139,35 +133,39 @@ void OpenXRFbPassthroughGeometry::update_passthrough_geometry_transform() {
 }
 
 void OpenXRFbPassthroughGeometry::instatiate_opaque_mesh() {
-	ERR_FAIL_COND_MSG(opaque_mesh != nullptr, "Opaque mesh child node already exists");
+	ERR_FAIL_COND_MSG(has_hole_punch(), "Opaque mesh already exists");
 	ERR_FAIL_COND_MSG(mesh.is_null(), "Mesh resource is null");
 
+	if (!Engine::get_singleton()->is_editor_hint()) {
+		// At runtime, the hole punch is drawn by the passthrough extension, which batches
+		// all passthrough geometries into as few draw calls as possible.
+		if (is_inside_tree()) {
+			OpenXRFbPassthroughExtension::get_singleton()->hole_punch_update(get_instance_id(), get_world_3d()->get_scenario(), mesh, get_global_transform());
+			hole_punch_batched = true;
+		}
+		return;
+	}
+
 	opaque_mesh = memnew(MeshInstance3D);
 	opaque_mesh->set_mesh(mesh);
 	add_child(opaque_mesh, false, Node::INTERNAL_MODE_BACK);
 
-	if (Engine::get_singleton()->is_editor_hint()) {
-		Ref<StandardMaterial3D> standard_material;
-		standard_material.instantiate();
-		standard_material->set_shading_mode(BaseMaterial3D::SHADING_MODE_UNSHADED);
-		standard_material->set_albedo(PREVIEW_COLOR);
-
-		opaque_mesh->set_surface_override_material(0, standard_material);
-	} else {
-		Ref<Shader> shader;
-		shader.instantiate();
-		shader->set_code(HOLE_PUNCH_SHADER_CODE);
+	Ref<StandardMaterial3D> standard_material;
+	standard_material.instantiate();
+	standard_material->set_shading_mode(BaseMaterial3D::SHADING_MODE_UNSHADED);
+	standard_material->set_albedo(PREVIEW_COLOR);
 
-		Ref<ShaderMaterial> shader_material;
-		shader_material.instantiate();
-		shader_material->set_shader(shader);
-
-		opaque_mesh->set_surface_override_material(0, shader_material);
-	}
+	opaque_mesh->set_surface_override_material(0, standard_material);
 }
 
 void OpenXRFbPassthroughGeometry::delete_opaque_mesh() {
-	ERR_FAIL_COND_MSG(opaque_mesh == nullptr, "Opaque mesh child node does not exist");
+	ERR_FAIL_COND_MSG(!has_hole_punch(), "Opaque mesh does not exist");
+
+	if (hole_punch_batched) {
+		OpenXRFbPassthroughExtension::get_singleton()->hole_punch_free(get_instance_id());
+		hole_punch_batched = false;
+		return;
+	}
 
 	remove_child(opaque_mesh);
 	opaque_mesh->queue_free();
@@ -186,7 +184,9 @@ void OpenXRFbPassthroughGeometry::_notification(int p_what) {
 			}
 		} break;
 		case NOTIFICATION_EXIT_TREE: {
-			if (geometry_instance.is_valid()) {
+			// A batched hole punch can exist without a geometry instance, for example when the
+			// geometry couldn't be created, so it's freed either way.
+			if (geometry_instance.is_valid() || hole_punch_batched) {
 				destroy_passthrough_geometry();
 			}
 		} break;
@@ -200,6 +200,11 @@ void OpenXRFbPassthroughGeometry::_notification(int p_what) {
 		case NOTIFICATION_LOCAL_TRANSFORM_CHANGED: {
 			update_passthrough_geometry_transform();
 		} break;
+		case NOTIFICATION_TRANSFORM_CHANGED: {
+			if (hole_punch_batched) {
+				OpenXRFbPassthroughExtension::get_singleton()->hole_punch_update(get_instance_id(), get_world_3d()->get_scenario(), mesh, get_global_transform());
+			}
+		} break;
 	}
 }
 
@@ -0,0 +1,144 @@
+/**************************************************************************/
+/*  openxr_fb_passthrough_style.cpp                                       */
+/**************************************************************************/
+/*                       This file is part of:                            */
+/*                              GODOT XR                                  */
+/*                      https://godotengine.org                           */
+/**************************************************************************/
+/* Copyright (c) 2022-present Godot XR contributors (see CONTRIBUTORS.md) */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#include "classes/openxr_fb_passthrough_style.h"
+
+using namespace godot;
+
+void OpenXRFbPassthroughStyle::_bind_methods() {
+	ClassDB::bind_method(D_METHOD("set_texture_opacity_factor", "value"), &OpenXRFbPassthroughStyle::set_texture_opacity_factor);
+	ClassDB::bind_method(D_METHOD("get_texture_opacity_factor"), &OpenXRFbPassthroughStyle::get_texture_opacity_factor);
+
+	ClassDB::bind_method(D_METHOD("set_edge_color", "color"), &OpenXRFbPassthroughStyle::set_edge_color);
+	ClassDB::bind_method(D_METHOD("get_edge_color"), &OpenXRFbPassthroughStyle::get_edge_color);
+
+	ClassDB::bind_method(D_METHOD("set_filter", "filter"), &OpenXRFbPassthroughStyle::set_filter);
+	ClassDB::bind_method(D_METHOD("get_filter"), &OpenXRFbPassthroughStyle::get_filter);
+
+	ClassDB::bind_method(D_METHOD("set_brightness", "brightness"), &OpenXRFbPassthroughStyle::set_brightness);
+	ClassDB::bind_method(D_METHOD("get_brightness"), &OpenXRFbPassthroughStyle::get_brightness);
+
+	ClassDB::bind_method(D_METHOD("set_contrast", "contrast"), &OpenXRFbPassthroughStyle::set_contrast);
+	ClassDB::bind_method(D_METHOD("get_contrast"), &OpenXRFbPassthroughStyle::get_contrast);
+
+	ClassDB::bind_method(D_METHOD("set_saturation", "saturation"), &OpenXRFbPassthroughStyle::set_saturation);
+	ClassDB::bind_method(D_METHOD("get_saturation"), &OpenXRFbPassthroughStyle::get_saturation);
+
+	ClassDB::bind_method(D_METHOD("set_color_map", "color_map"), &OpenXRFbPassthroughStyle::set_color_map);
+	ClassDB::bind_method(D_METHOD("get_color_map"), &OpenXRFbPassthroughStyle::get_color_map);
+
+	ClassDB::bind_method(D_METHOD("set_mono_map", "mono_map"), &OpenXRFbPassthroughStyle::set_mono_map);
+	ClassDB::bind_method(D_METHOD("get_mono_map"), &OpenXRFbPassthroughStyle::get_mono_map);
+
+	ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "texture_opacity_factor", PROPERTY_HINT_RANGE, "0,1,0.01"), "set_texture_opacity_factor", "get_texture_opacity_factor");
+	ADD_PROPERTY(PropertyInfo(Variant::COLOR, "edge_color"), "set_edge_color", "get_edge_color");
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "filter", PROPERTY_HINT_ENUM, "Disabled,Color Map,Mono Map,Brightness Contrast Saturation"), "set_filter", "get_filter");
+	ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "brightness", PROPERTY_HINT_RANGE, "-100,100,0.1"), "set_brightness", "get_brightness");
+	ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "contrast", PROPERTY_HINT_RANGE, "0,10,0.01,or_greater"), "set_contrast", "get_contrast");
+	ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "saturation", PROPERTY_HINT_RANGE, "0,10,0.01,or_greater"), "set_saturation", "get_saturation");
+	ADD_PROPERTY(PropertyInfo(Variant::OBJECT, "color_map", PROPERTY_HINT_RESOURCE_TYPE, "Gradient"), "set_color_map", "get_color_map");
+	ADD_PROPERTY(PropertyInfo(Variant::OBJECT, "mono_map", PROPERTY_HINT_RESOURCE_TYPE, "Curve"), "set_mono_map", "get_mono_map");
+}
+
+void OpenXRFbPassthroughStyle::set_texture_opacity_factor(float p_value) {
+	texture_opacity_factor = p_value;
+	emit_changed();
+}
+
+float OpenXRFbPassthroughStyle::get_texture_opacity_factor() const {
+	return texture_opacity_factor;
+}
+
+void OpenXRFbPassthroughStyle::set_edge_color(const Color &p_color) {
+	edge_color = p_color;
+	emit_changed();
+}
+
+Color OpenXRFbPassthroughStyle::get_edge_color() const {
+	return edge_color;
+}
+
+void OpenXRFbPassthroughStyle::set_filter(OpenXRFbPassthroughExtension::PassthroughFilter p_filter) {
+	// The LUT filters reference native color LUT handles, which can't be interpolated.
+	ERR_FAIL_COND_MSG(p_filter > OpenXRFbPassthroughExtension::PASSTHROUGH_FILTER_BRIGHTNESS_CONTRAST_SATURATION, "Passthrough styles don't support the color map LUT filters.");
+	filter = p_filter;
+	emit_changed();
+}
+
+OpenXRFbPassthroughExtension::PassthroughFilter OpenXRFbPassthroughStyle::get_filter() const {
+	return filter;
+}
+
+void OpenXRFbPassthroughStyle::set_brightness(float p_brightness) {
+	ERR_FAIL_COND_MSG(p_brightness < -100.0 || p_brightness > 100.0, vformat("Brightness value %f is not within bounds of -100 and 100", p_brightness));
+	brightness = p_brightness;
+	emit_changed();
+}
+
+float OpenXRFbPassthroughStyle::get_brightness() const {
+	return brightness;
+}
+
+void OpenXRFbPassthroughStyle::set_contrast(float p_contrast) {
+	ERR_FAIL_COND_MSG(p_contrast < 0.0, vformat("Contrast value %f is not greater than or equal to zero", p_contrast));
+	contrast = p_contrast;
+	emit_changed();
+}
+
+float OpenXRFbPassthroughStyle::get_contrast() const {
+	return contrast;
+}
+
+void OpenXRFbPassthroughStyle::set_saturation(float p_saturation) {
+	ERR_FAIL_COND_MSG(p_saturation < 0.0, vformat("Saturation value %f is not greater than or equal to zero", p_saturation));
+	saturation = p_saturation;
+	emit_changed();
+}
+
+float OpenXRFbPassthroughStyle::get_saturation() const {
+	return saturation;
+}
+
+void OpenXRFbPassthroughStyle::set_color_map(const Ref<Gradient> &p_color_map) {
+	color_map = p_color_map;
+	emit_changed();
+}
+
+Ref<Gradient> OpenXRFbPassthroughStyle::get_color_map() const {
+	return color_map;
+}
+
+void OpenXRFbPassthroughStyle::set_mono_map(const Ref<Curve> &p_mono_map) {
+	mono_map = p_mono_map;
+	emit_changed();
+}
+
+Ref<Curve> OpenXRFbPassthroughStyle::get_mono_map() const {
+	return mono_map;
+}
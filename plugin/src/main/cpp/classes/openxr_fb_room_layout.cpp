@@ -0,0 +1,510 @@
+/**************************************************************************/
+/*  openxr_fb_room_layout.cpp                                             */
+/**************************************************************************/
+/*                       This file is part of:                            */
+/*                              GODOT XR                                  */
+/*                      https://godotengine.org                           */
+/**************************************************************************/
+/* Copyright (c) 2022-present Godot XR contributors (see CONTRIBUTORS.md) */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#include "classes/openxr_fb_room_layout.h"
+
+#include <godot_cpp/templates/sort_array.hpp>
+
+#include "extensions/openxr_fb_spatial_entity_extension.h"
+
+using namespace godot;
+
+namespace {
+struct SlabWall {
+	float z = 0.0;
+	uint32_t wall = 0;
+
+	bool operator<(const SlabWall &p_other) const {
+		return z < p_other.z;
+	}
+};
+
+struct WallCentroidComparator {
+	const Vector2 *centroids = nullptr;
+	int axis = 0;
+
+	bool operator()(uint32_t p_a, uint32_t p_b) const {
+		return centroids[p_a][axis] < centroids[p_b][axis];
+	}
+};
+
+constexpr uint32_t BVH_LEAF_SIZE = 2;
+constexpr int BVH_STACK_SIZE = 64;
+} // namespace
+
+void OpenXRFbRoomLayout::_bind_methods() {
+	ClassDB::bind_method(D_METHOD("build_from_spatial_entities", "room", "entities"), &OpenXRFbRoomLayout::build_from_spatial_entities);
+	ClassDB::bind_method(D_METHOD("build_from_polygon", "floor_polygon", "floor_height", "ceiling_height"), &OpenXRFbRoomLayout::build_from_polygon);
+	ClassDB::bind_method(D_METHOD("clear"), &OpenXRFbRoomLayout::clear);
+
+	ClassDB::bind_method(D_METHOD("is_valid"), &OpenXRFbRoomLayout::is_valid);
+	ClassDB::bind_method(D_METHOD("get_floor_polygon"), &OpenXRFbRoomLayout::get_floor_polygon);
+	ClassDB::bind_method(D_METHOD("get_floor_height"), &OpenXRFbRoomLayout::get_floor_height);
+	ClassDB::bind_method(D_METHOD("get_ceiling_height"), &OpenXRFbRoomLayout::get_ceiling_height);
+	ClassDB::bind_method(D_METHOD("get_wall_count"), &OpenXRFbRoomLayout::get_wall_count);
+
+	ClassDB::bind_method(D_METHOD("is_point_inside", "point"), &OpenXRFbRoomLayout::is_point_inside);
+	ClassDB::bind_method(D_METHOD("get_distance_to_nearest_wall", "point"), &OpenXRFbRoomLayout::get_distance_to_nearest_wall);
+	ClassDB::bind_method(D_METHOD("get_closest_point_on_walls", "point"), &OpenXRFbRoomLayout::get_closest_point_on_walls);
+	ClassDB::bind_method(D_METHOD("intersect_segment", "from", "to"), &OpenXRFbRoomLayout::intersect_segment);
+}
+
+bool OpenXRFbRoomLayout::build_from_spatial_entities(const Ref<OpenXRFbSpatialEntity> &p_room, const TypedArray<OpenXRFbSpatialEntity> &p_entities) {
+	ERR_FAIL_COND_V(p_room.is_null(), false);
+
+	OpenXRFbSpatialEntityExtension *spatial_entity_extension = OpenXRFbSpatialEntityExtension::get_singleton();
+	ERR_FAIL_NULL_V(spatial_entity_extension, false);
+
+	Dictionary room_layout = p_room->get_room_layout();
+	ERR_FAIL_COND_V_MSG(room_layout.is_empty(), false, "Spatial entity doesn't have a room layout.");
+
+	StringName floor_uuid = room_layout["floor"];
+	StringName ceiling_uuid = room_layout["ceiling"];
+
+	Ref<OpenXRFbSpatialEntity> floor;
+	Ref<OpenXRFbSpatialEntity> ceiling;
+	for (int i = 0; i < p_entities.size(); i++) {
+		Ref<OpenXRFbSpatialEntity> entity = p_entities[i];
+		if (entity.is_null()) {
+			continue;
+		}
+
+		if (entity->get_uuid() == floor_uuid) {
+			floor = entity;
+		} else if (entity->get_uuid() == ceiling_uuid) {
+			ceiling = entity;
+		}
+	}
+
+	ERR_FAIL_COND_V_MSG(floor.is_null(), false, vformat("The floor of room %s isn't among the given spatial entities.", p_room->get_uuid()));
+
+	Transform3D floor_transform;
+	ERR_FAIL_COND_V_MSG(!spatial_entity_extension->locate_space(floor->get_space(), floor_transform), false, "Unable to locate the floor of the room.");
+
+	// The boundary is on the XY plane of the floor's space, with Z pointing up.
+	PackedVector2Array boundary = floor->get_boundary_2d();
+	ERR_FAIL_COND_V_MSG(boundary.size() < 3, false, "The floor of the room doesn't have a 2D boundary.");
+
+	PackedVector2Array floor_polygon;
+	floor_polygon.resize(boundary.size());
+	for (int i = 0; i < boundary.size(); i++) {
+		Vector3 vertex = floor_transform.xform(Vector3(boundary[i].x, boundary[i].y, 0.0));
+		floor_polygon.set(i, Vector2(vertex.x, vertex.z));
+	}
+
+	float ceiling_height = Math_INF;
+	Transform3D ceiling_transform;
+	if (ceiling.is_valid() && spatial_entity_extension->locate_space(ceiling->get_space(), ceiling_transform)) {
+		ceiling_height = ceiling_transform.origin.y;
+	}
+
+	return build_from_polygon(floor_polygon, floor_transform.origin.y, ceiling_height);
+}
+
+bool OpenXRFbRoomLayout::build_from_polygon(const PackedVector2Array &p_floor_polygon, float p_floor_height, float p_ceiling_height) {
+	clear();
+
+	ERR_FAIL_COND_V_MSG(p_floor_polygon.size() < 3, false, "The floor polygon needs at least 3 vertices.");
+	ERR_FAIL_COND_V_MSG(p_ceiling_height < p_floor_height, false, "The ceiling can't be below the floor.");
+
+	const Vector2 *vertices = p_floor_polygon.ptr();
+	int vertex_count = p_floor_polygon.size();
+
+	// Use the winding order to figure out which side of the walls is inside the room.
+	float signed_area = 0.0;
+	for (int i = 0; i < vertex_count; i++) {
+		signed_area += vertices[i].cross(vertices[(i + 1) % vertex_count]);
+	}
+	ERR_FAIL_COND_V_MSG(Math::is_zero_approx(signed_area), false, "The floor polygon has no area.");
+
+	walls.reserve(vertex_count);
+	for (int i = 0; i < vertex_count; i++) {
+		Wall wall;
+		wall.from = vertices[i];
+		wall.to = vertices[(i + 1) % vertex_count];
+
+		Vector2 direction = wall.to - wall.from;
+		if (direction.is_zero_approx()) {
+			continue;
+		}
+
+		direction.normalize();
+		wall.normal = signed_area > 0.0 ? Vector2(-direction.y, direction.x) : Vector2(direction.y, -direction.x);
+		walls.push_back(wall);
+	}
+
+	floor_height = p_floor_height;
+	ceiling_height = p_ceiling_height;
+
+	_build_slabs();
+	_build_bvh();
+
+	return true;
+}
+
+void OpenXRFbRoomLayout::clear() {
+	walls.clear();
+	floor_height = 0.0;
+	ceiling_height = 0.0;
+	slab_xs.clear();
+	slab_offsets.clear();
+	slab_walls.clear();
+	bvh_nodes.clear();
+	wall_order.clear();
+}
+
+bool OpenXRFbRoomLayout::is_valid() const {
+	return !walls.is_empty();
+}
+
+PackedVector2Array OpenXRFbRoomLayout::get_floor_polygon() const {
+	PackedVector2Array ret;
+	ret.resize(walls.size());
+	for (uint32_t i = 0; i < walls.size(); i++) {
+		ret.set(i, walls[i].from);
+	}
+	return ret;
+}
+
+float OpenXRFbRoomLayout::get_floor_height() const {
+	return floor_height;
+}
+
+float OpenXRFbRoomLayout::get_ceiling_height() const {
+	return ceiling_height;
+}
+
+int OpenXRFbRoomLayout::get_wall_count() const {
+	return walls.size();
+}
+
+float OpenXRFbRoomLayout::_wall_z_at(const Wall &p_wall, float p_x) {
+	float dx = p_wall.to.x - p_wall.from.x;
+	if (dx == 0.0) {
+		return MIN(p_wall.from.y, p_wall.to.y);
+	}
+	return p_wall.from.y + (p_wall.to.y - p_wall.from.y) * ((p_x - p_wall.from.x) / dx);
+}
+
+void OpenXRFbRoomLayout::_build_slabs() {
+	for (const Wall &wall : walls) {
+		slab_xs.push_back(wall.from.x);
+	}
+	slab_xs.sort();
+
+	// Remove duplicates.
+	uint32_t unique_count = 0;
+	for (uint32_t i = 0; i < slab_xs.size(); i++) {
+		if (unique_count == 0 || slab_xs[i] != slab_xs[unique_count - 1]) {
+			slab_xs[unique_count++] = slab_xs[i];
+		}
+	}
+	slab_xs.resize(unique_count);
+
+	LocalVector<SlabWall> crossing;
+	slab_offsets.reserve(slab_xs.size());
+	for (uint32_t i = 0; i + 1 < slab_xs.size(); i++) {
+		slab_offsets.push_back(slab_walls.size());
+
+		float x0 = slab_xs[i];
+		float x1 = slab_xs[i + 1];
+		float mid = (x0 + x1) * 0.5;
+
+		crossing.clear();
+		for (uint32_t w = 0; w < walls.size(); w++) {
+			const Wall &wall = walls[w];
+			if (MIN(wall.from.x, wall.to.x) <= x0 && MAX(wall.from.x, wall.to.x) >= x1) {
+				crossing.push_back({ _wall_z_at(wall, mid), w });
+			}
+		}
+
+		// Walls of a simple polygon don't cross inside of a slab, so their order is the same
+		// everywhere in it.
+		crossing.sort();
+		for (const SlabWall &slab_wall : crossing) {
+			slab_walls.push_back(slab_wall.wall);
+		}
+	}
+	slab_offsets.push_back(slab_walls.size());
+}
+
+bool OpenXRFbRoomLayout::_is_point_inside_polygon(const Vector2 &p_point) const {
+	if (slab_xs.size() < 2 || p_point.x < slab_xs[0] || p_point.x >= slab_xs[slab_xs.size() - 1]) {
+		return false;
+	}
+
+	// Find the slab containing the point.
+	uint32_t low = 0;
+	uint32_t high = slab_xs.size() - 1;
+	while (high - low > 1) {
+		uint32_t mid = (low + high) / 2;
+		if (slab_xs[mid] <= p_point.x) {
+			low = mid;
+		} else {
+			high = mid;
+		}
+	}
+
+	// Count the walls below the point; the point is inside if there's an odd number of them.
+	uint32_t begin = slab_offsets[low];
+	uint32_t end = slab_offsets[low + 1];
+	uint32_t first = begin;
+	uint32_t last = end;
+	while (first < last) {
+		uint32_t mid = (first + last) / 2;
+		if (_wall_z_at(walls[slab_walls[mid]], p_point.x) < p_point.y) {
+			first = mid + 1;
+		} else {
+			last = mid;
+		}
+	}
+
+	return ((first - begin) & 1) == 1;
+}
+
+void OpenXRFbRoomLayout::_build_bvh() {
+	LocalVector<Vector2> centroids;
+	centroids.resize(walls.size());
+	wall_order.resize(walls.size());
+	for (uint32_t i = 0; i < walls.size(); i++) {
+		centroids[i] = (walls[i].from + walls[i].to) * 0.5;
+		wall_order[i] = i;
+	}
+
+	bvh_nodes.push_back(BVHNode());
+	_build_bvh_node(0, 0, walls.size(), centroids.ptr());
+}
+
+void OpenXRFbRoomLayout::_build_bvh_node(uint32_t p_node, uint32_t p_begin, uint32_t p_end, const Vector2 *p_centroids) {
+	Rect2 bounds(walls[wall_order[p_begin]].from, Vector2());
+	for (uint32_t i = p_begin; i < p_end; i++) {
+		const Wall &wall = walls[wall_order[i]];
+		bounds.expand_to(wall.from);
+		bounds.expand_to(wall.to);
+	}
+	bvh_nodes[p_node].bounds = bounds;
+
+	uint32_t count = p_end - p_begin;
+	if (count <= BVH_LEAF_SIZE) {
+		bvh_nodes[p_node].first = p_begin;
+		bvh_nodes[p_node].count = count;
+		return;
+	}
+
+	// Split at the median along the longest axis.
+	SortArray<uint32_t, WallCentroidComparator> sorter;
+	sorter.compare.centroids = p_centroids;
+	sorter.compare.axis = bounds.size.x >= bounds.size.y ? 0 : 1;
+	sorter.sort(wall_order.ptr() + p_begin, count);
+
+	uint32_t children = bvh_nodes.size();
+	bvh_nodes.push_back(BVHNode());
+	bvh_nodes.push_back(BVHNode());
+	bvh_nodes[p_node].first = children;
+	bvh_nodes[p_node].count = 0;
+
+	uint32_t middle = p_begin + count / 2;
+	_build_bvh_node(children, p_begin, middle, p_centroids);
+	_build_bvh_node(children + 1, middle, p_end, p_centroids);
+}
+
+float OpenXRFbRoomLayout::_distance_squared_to_rect(const Vector2 &p_point, const Rect2 &p_rect) {
+	Vector2 end = p_rect.get_end();
+	float dx = MAX(MAX(p_rect.position.x - p_point.x, p_point.x - end.x), 0.0f);
+	float dy = MAX(MAX(p_rect.position.y - p_point.y, p_point.y - end.y), 0.0f);
+	return dx * dx + dy * dy;
+}
+
+bool OpenXRFbRoomLayout::_segment_intersects_rect(const Vector2 &p_from, const Vector2 &p_to, const Rect2 &p_rect) {
+	// Clip the segment against the rectangle's slabs.
+	Vector2 end = p_rect.get_end();
+	Vector2 direction = p_to - p_from;
+	float t_min = 0.0;
+	float t_max = 1.0;
+
+	for (int axis = 0; axis < 2; axis++) {
+		if (Math::is_zero_approx(direction[axis])) {
+			if (p_from[axis] < p_rect.position[axis] || p_from[axis] > end[axis]) {
+				return false;
+			}
+			continue;
+		}
+
+		float t0 = (p_rect.position[axis] - p_from[axis]) / direction[axis];
+		float t1 = (end[axis] - p_from[axis]) / direction[axis];
+		if (t0 > t1) {
+			SWAP(t0, t1);
+		}
+
+		t_min = MAX(t_min, t0);
+		t_max = MIN(t_max, t1);
+		if (t_min > t_max) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+int OpenXRFbRoomLayout::_find_nearest_wall(const Vector2 &p_point, Vector2 &r_closest) const {
+	int nearest = -1;
+	float nearest_distance_squared = Math_INF;
+
+	uint32_t stack[BVH_STACK_SIZE];
+	int stack_size = 0;
+	stack[stack_size++] = 0;
+
+	while (stack_size > 0) {
+		const BVHNode &node = bvh_nodes[stack[--stack_size]];
+		if (_distance_squared_to_rect(p_point, node.bounds) >= nearest_distance_squared) {
+			continue;
+		}
+
+		if (node.count > 0) {
+			for (uint32_t i = node.first; i < node.first + node.count; i++) {
+				const Wall &wall = walls[wall_order[i]];
+				Vector2 segment = wall.to - wall.from;
+				float t = CLAMP((p_point - wall.from).dot(segment) / segment.length_squared(), 0.0f, 1.0f);
+				Vector2 closest = wall.from + segment * t;
+				float distance_squared = p_point.distance_squared_to(closest);
+				if (distance_squared < nearest_distance_squared) {
+					nearest_distance_squared = distance_squared;
+					nearest = wall_order[i];
+					r_closest = closest;
+				}
+			}
+			continue;
+		}
+
+		ERR_FAIL_COND_V(stack_size + 2 > BVH_STACK_SIZE, nearest);
+
+		// Push the farthest child first, so the nearest one is visited first.
+		uint32_t a = node.first;
+		uint32_t b = node.first + 1;
+		if (_distance_squared_to_rect(p_point, bvh_nodes[a].bounds) < _distance_squared_to_rect(p_point, bvh_nodes[b].bounds)) {
+			SWAP(a, b);
+		}
+		stack[stack_size++] = a;
+		stack[stack_size++] = b;
+	}
+
+	return nearest;
+}
+
+bool OpenXRFbRoomLayout::is_point_inside(const Vector3 &p_point) const {
+	if (walls.is_empty() || p_point.y < floor_height || p_point.y > ceiling_height) {
+		return false;
+	}
+	return _is_point_inside_polygon(Vector2(p_point.x, p_point.z));
+}
+
+float OpenXRFbRoomLayout::get_distance_to_nearest_wall(const Vector3 &p_point) const {
+	ERR_FAIL_COND_V_MSG(walls.is_empty(), Math_INF, "Room layout hasn't been built.");
+
+	Vector2 point(p_point.x, p_point.z);
+	Vector2 closest;
+	_find_nearest_wall(point, closest);
+	return point.distance_to(closest);
+}
+
+Vector3 OpenXRFbRoomLayout::get_closest_point_on_walls(const Vector3 &p_point) const {
+	ERR_FAIL_COND_V_MSG(walls.is_empty(), p_point, "Room layout hasn't been built.");
+
+	Vector2 closest;
+	_find_nearest_wall(Vector2(p_point.x, p_point.z), closest);
+	return Vector3(closest.x, CLAMP(p_point.y, floor_height, ceiling_height), closest.y);
+}
+
+Dictionary OpenXRFbRoomLayout::intersect_segment(const Vector3 &p_from, const Vector3 &p_to) const {
+	ERR_FAIL_COND_V_MSG(walls.is_empty(), Dictionary(), "Room layout hasn't been built.");
+
+	Vector2 from(p_from.x, p_from.z);
+	Vector2 to(p_to.x, p_to.z);
+	Vector2 direction = to - from;
+
+	int hit_wall = -1;
+	float hit_fraction = 1.0;
+
+	uint32_t stack[BVH_STACK_SIZE];
+	int stack_size = 0;
+	stack[stack_size++] = 0;
+
+	while (stack_size > 0) {
+		const BVHNode &node = bvh_nodes[stack[--stack_size]];
+		if (!_segment_intersects_rect(from, from + direction * hit_fraction, node.bounds)) {
+			continue;
+		}
+
+		if (node.count > 0) {
+			for (uint32_t i = node.first; i < node.first + node.count; i++) {
+				const Wall &wall = walls[wall_order[i]];
+				Vector2 wall_direction = wall.to - wall.from;
+
+				float denominator = direction.cross(wall_direction);
+				if (Math::is_zero_approx(denominator)) {
+					continue;
+				}
+
+				Vector2 offset = wall.from - from;
+				float t = offset.cross(wall_direction) / denominator;
+				float u = offset.cross(direction) / denominator;
+				if (t < 0.0 || t > hit_fraction || u < 0.0 || u > 1.0) {
+					continue;
+				}
+
+				// Walls only go from the floor to the ceiling.
+				float y = p_from.y + (p_to.y - p_from.y) * t;
+				if (y < floor_height || y > ceiling_height) {
+					continue;
+				}
+
+				hit_wall = wall_order[i];
+				hit_fraction = t;
+			}
+			continue;
+		}
+
+		ERR_FAIL_COND_V(stack_size + 2 > BVH_STACK_SIZE, Dictionary());
+		stack[stack_size++] = node.first;
+		stack[stack_size++] = node.first + 1;
+	}
+
+	if (hit_wall < 0) {
+		return Dictionary();
+	}
+
+	const Wall &wall = walls[hit_wall];
+
+	Dictionary ret;
+	ret["position"] = p_from.lerp(p_to, hit_fraction);
+	ret["normal"] = Vector3(wall.normal.x, 0.0, wall.normal.y);
+	ret["wall_index"] = hit_wall;
+	ret["fraction"] = hit_fraction;
+	return ret;
+}
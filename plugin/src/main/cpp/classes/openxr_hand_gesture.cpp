@@ -0,0 +1,260 @@
+/**************************************************************************/
+/*  openxr_hand_gesture.cpp                                               */
+/**************************************************************************/
+/*                       This file is part of:                            */
+/*                              GODOT XR                                  */
+/*                      https://godotengine.org                           */
+/**************************************************************************/
+/* Copyright (c) 2022-present Godot XR contributors (see CONTRIBUTORS.md) */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#include "classes/openxr_hand_gesture.h"
+
+using namespace godot;
+
+void OpenXRHandGesture::_bind_methods() {
+	ClassDB::bind_method(D_METHOD("set_gesture_name", "gesture_name"), &OpenXRHandGesture::set_gesture_name);
+	ClassDB::bind_method(D_METHOD("get_gesture_name"), &OpenXRHandGesture::get_gesture_name);
+
+	ClassDB::bind_method(D_METHOD("set_distance_hysteresis", "distance_hysteresis"), &OpenXRHandGesture::set_distance_hysteresis);
+	ClassDB::bind_method(D_METHOD("get_distance_hysteresis"), &OpenXRHandGesture::get_distance_hysteresis);
+
+	ClassDB::bind_method(D_METHOD("set_angle_hysteresis", "angle_hysteresis"), &OpenXRHandGesture::set_angle_hysteresis);
+	ClassDB::bind_method(D_METHOD("get_angle_hysteresis"), &OpenXRHandGesture::get_angle_hysteresis);
+
+	ClassDB::bind_method(D_METHOD("add_distance_constraint", "joint_a", "joint_b", "min_distance", "max_distance"), &OpenXRHandGesture::add_distance_constraint);
+	ClassDB::bind_method(D_METHOD("add_angle_constraint", "joint_a", "joint_b", "joint_c", "min_angle", "max_angle"), &OpenXRHandGesture::add_angle_constraint);
+	ClassDB::bind_method(D_METHOD("remove_constraint", "index"), &OpenXRHandGesture::remove_constraint);
+	ClassDB::bind_method(D_METHOD("clear_constraints"), &OpenXRHandGesture::clear_constraints);
+	ClassDB::bind_method(D_METHOD("get_constraint_count"), &OpenXRHandGesture::get_constraint_count);
+
+	ClassDB::bind_method(D_METHOD("set_constraints", "constraints"), &OpenXRHandGesture::set_constraints);
+	ClassDB::bind_method(D_METHOD("get_constraints"), &OpenXRHandGesture::get_constraints);
+
+	ADD_PROPERTY(PropertyInfo(Variant::STRING_NAME, "gesture_name"), "set_gesture_name", "get_gesture_name");
+	ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "distance_hysteresis", PROPERTY_HINT_RANGE, "0.0,0.1,0.001,or_greater,suffix:m"), "set_distance_hysteresis", "get_distance_hysteresis");
+	ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "angle_hysteresis", PROPERTY_HINT_RANGE, "0.0,45.0,0.1,or_greater,degrees"), "set_angle_hysteresis", "get_angle_hysteresis");
+	ADD_PROPERTY(PropertyInfo(Variant::ARRAY, "constraints", PROPERTY_HINT_ARRAY_TYPE, "Dictionary"), "set_constraints", "get_constraints");
+
+	BIND_ENUM_CONSTANT(CONSTRAINT_TYPE_DISTANCE);
+	BIND_ENUM_CONSTANT(CONSTRAINT_TYPE_ANGLE);
+}
+
+void OpenXRHandGesture::_update_constraint(Constraint &r_constraint) const {
+	if (r_constraint.type == CONSTRAINT_TYPE_DISTANCE) {
+		// Compare squared distances, to avoid a square root per constraint.
+		float min_distance = MAX(r_constraint.user_min_value, 0.0f);
+		float max_distance = MAX(r_constraint.user_max_value, min_distance);
+		float release_min_distance = MAX(min_distance - distance_hysteresis, 0.0f);
+		float release_max_distance = max_distance + distance_hysteresis;
+
+		r_constraint.min_value = min_distance * min_distance;
+		r_constraint.max_value = max_distance * max_distance;
+		r_constraint.release_min_value = release_min_distance * release_min_distance;
+		r_constraint.release_max_value = release_max_distance * release_max_distance;
+	} else {
+		// The cosine decreases as the angle grows, so the minimum angle gives the maximum cosine.
+		float min_angle = CLAMP(r_constraint.user_min_value, 0.0f, 180.0f);
+		float max_angle = CLAMP(r_constraint.user_max_value, min_angle, 180.0f);
+		float release_min_angle = MAX(min_angle - angle_hysteresis, 0.0f);
+		float release_max_angle = MIN(max_angle + angle_hysteresis, 180.0f);
+
+		r_constraint.min_value = Math::cos(Math::deg_to_rad(max_angle));
+		r_constraint.max_value = Math::cos(Math::deg_to_rad(min_angle));
+		r_constraint.release_min_value = Math::cos(Math::deg_to_rad(release_max_angle));
+		r_constraint.release_max_value = Math::cos(Math::deg_to_rad(release_min_angle));
+	}
+}
+
+void OpenXRHandGesture::_update_constraints() {
+	joint_mask = 0;
+	for (Constraint &constraint : constraints) {
+		_update_constraint(constraint);
+
+		int joint_count = constraint.type == CONSTRAINT_TYPE_DISTANCE ? 2 : 3;
+		for (int i = 0; i < joint_count; i++) {
+			joint_mask |= 1u << constraint.joints[i];
+		}
+	}
+	emit_changed();
+}
+
+void OpenXRHandGesture::set_gesture_name(const StringName &p_gesture_name) {
+	gesture_name = p_gesture_name;
+	emit_changed();
+}
+
+StringName OpenXRHandGesture::get_gesture_name() const {
+	return gesture_name;
+}
+
+void OpenXRHandGesture::set_distance_hysteresis(float p_distance_hysteresis) {
+	distance_hysteresis = MAX(p_distance_hysteresis, 0.0f);
+	_update_constraints();
+}
+
+float OpenXRHandGesture::get_distance_hysteresis() const {
+	return distance_hysteresis;
+}
+
+void OpenXRHandGesture::set_angle_hysteresis(float p_angle_hysteresis) {
+	angle_hysteresis = MAX(p_angle_hysteresis, 0.0f);
+	_update_constraints();
+}
+
+float OpenXRHandGesture::get_angle_hysteresis() const {
+	return angle_hysteresis;
+}
+
+void OpenXRHandGesture::add_distance_constraint(HandJoint p_joint_a, HandJoint p_joint_b, float p_min_distance, float p_max_distance) {
+	ERR_FAIL_INDEX(p_joint_a, XRHandTracker::HAND_JOINT_MAX);
+	ERR_FAIL_INDEX(p_joint_b, XRHandTracker::HAND_JOINT_MAX);
+
+	Constraint constraint;
+	constraint.type = CONSTRAINT_TYPE_DISTANCE;
+	constraint.joints[0] = p_joint_a;
+	constraint.joints[1] = p_joint_b;
+	constraint.user_min_value = p_min_distance;
+	constraint.user_max_value = p_max_distance;
+	constraints.push_back(constraint);
+
+	_update_constraints();
+}
+
+void OpenXRHandGesture::add_angle_constraint(HandJoint p_joint_a, HandJoint p_joint_b, HandJoint p_joint_c, float p_min_angle, float p_max_angle) {
+	ERR_FAIL_INDEX(p_joint_a, XRHandTracker::HAND_JOINT_MAX);
+	ERR_FAIL_INDEX(p_joint_b, XRHandTracker::HAND_JOINT_MAX);
+	ERR_FAIL_INDEX(p_joint_c, XRHandTracker::HAND_JOINT_MAX);
+
+	Constraint constraint;
+	constraint.type = CONSTRAINT_TYPE_ANGLE;
+	constraint.joints[0] = p_joint_a;
+	constraint.joints[1] = p_joint_b;
+	constraint.joints[2] = p_joint_c;
+	constraint.user_min_value = p_min_angle;
+	constraint.user_max_value = p_max_angle;
+	constraints.push_back(constraint);
+
+	_update_constraints();
+}
+
+void OpenXRHandGesture::remove_constraint(int p_index) {
+	ERR_FAIL_INDEX(p_index, (int)constraints.size());
+	constraints.remove_at(p_index);
+	_update_constraints();
+}
+
+void OpenXRHandGesture::clear_constraints() {
+	constraints.clear();
+	_update_constraints();
+}
+
+int OpenXRHandGesture::get_constraint_count() const {
+	return constraints.size();
+}
+
+void OpenXRHandGesture::set_constraints(const TypedArray<Dictionary> &p_constraints) {
+	constraints.clear();
+
+	for (int i = 0; i < p_constraints.size(); i++) {
+		Dictionary data = p_constraints[i];
+
+		Constraint constraint;
+		constraint.type = (ConstraintType)(int)data.get("type", (int)CONSTRAINT_TYPE_DISTANCE);
+		constraint.joints[0] = (HandJoint)(int)data.get("joint_a", (int)XRHandTracker::HAND_JOINT_PALM);
+		constraint.joints[1] = (HandJoint)(int)data.get("joint_b", (int)XRHandTracker::HAND_JOINT_PALM);
+		constraint.joints[2] = (HandJoint)(int)data.get("joint_c", (int)XRHandTracker::HAND_JOINT_PALM);
+		constraint.user_min_value = data.get("min", 0.0);
+		constraint.user_max_value = data.get("max", 0.0);
+
+		if (constraint.type != CONSTRAINT_TYPE_DISTANCE && constraint.type != CONSTRAINT_TYPE_ANGLE) {
+			WARN_PRINT(vformat("Ignoring hand gesture constraint %d with invalid type %d", i, (int)constraint.type));
+			continue;
+		}
+
+		bool valid_joints = true;
+		for (int j = 0; j < 3; j++) {
+			if (constraint.joints[j] < 0 || constraint.joints[j] >= XRHandTracker::HAND_JOINT_MAX) {
+				valid_joints = false;
+			}
+		}
+		if (!valid_joints) {
+			WARN_PRINT(vformat("Ignoring hand gesture constraint %d with an invalid joint", i));
+			continue;
+		}
+
+		constraints.push_back(constraint);
+	}
+
+	_update_constraints();
+}
+
+TypedArray<Dictionary> OpenXRHandGesture::get_constraints() const {
+	TypedArray<Dictionary> ret;
+
+	for (const Constraint &constraint : constraints) {
+		Dictionary data;
+		data["type"] = (int)constraint.type;
+		data["joint_a"] = (int)constraint.joints[0];
+		data["joint_b"] = (int)constraint.joints[1];
+		if (constraint.type == CONSTRAINT_TYPE_ANGLE) {
+			data["joint_c"] = (int)constraint.joints[2];
+		}
+		data["min"] = constraint.user_min_value;
+		data["max"] = constraint.user_max_value;
+		ret.push_back(data);
+	}
+
+	return ret;
+}
+
+bool OpenXRHandGesture::evaluate(const Vector3 *p_joint_positions, bool p_active) const {
+	if (constraints.is_empty()) {
+		return false;
+	}
+
+	for (const Constraint &constraint : constraints) {
+		const float min_value = p_active ? constraint.release_min_value : constraint.min_value;
+		const float max_value = p_active ? constraint.release_max_value : constraint.max_value;
+
+		float value;
+		if (constraint.type == CONSTRAINT_TYPE_DISTANCE) {
+			value = p_joint_positions[constraint.joints[0]].distance_squared_to(p_joint_positions[constraint.joints[1]]);
+		} else {
+			const Vector3 &center = p_joint_positions[constraint.joints[1]];
+			Vector3 a = p_joint_positions[constraint.joints[0]] - center;
+			Vector3 b = p_joint_positions[constraint.joints[2]] - center;
+
+			float length_squared = a.length_squared() * b.length_squared();
+			if (length_squared <= 0.0f) {
+				return false;
+			}
+			value = a.dot(b) / Math::sqrt(length_squared);
+		}
+
+		if (value < min_value || value > max_value) {
+			return false;
+		}
+	}
+
+	return true;
+}
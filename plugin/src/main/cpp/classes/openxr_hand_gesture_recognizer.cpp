@@ -0,0 +1,209 @@
+/**************************************************************************/
+/*  openxr_hand_gesture_recognizer.cpp                                    */
+/**************************************************************************/
+/*                       This file is part of:                            */
+/*                              GODOT XR                                  */
+/*                      https://godotengine.org                           */
+/**************************************************************************/
+/* Copyright (c) 2022-present Godot XR contributors (see CONTRIBUTORS.md) */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#include "classes/openxr_hand_gesture_recognizer.h"
+
+#include <godot_cpp/classes/engine.hpp>
+#include <godot_cpp/classes/xr_server.hpp>
+
+using namespace godot;
+
+void OpenXRHandGestureRecognizer::_bind_methods() {
+	ClassDB::bind_method(D_METHOD("set_hand_tracker", "hand_tracker"), &OpenXRHandGestureRecognizer::set_hand_tracker);
+	ClassDB::bind_method(D_METHOD("get_hand_tracker"), &OpenXRHandGestureRecognizer::get_hand_tracker);
+
+	ClassDB::bind_method(D_METHOD("set_gestures", "gestures"), &OpenXRHandGestureRecognizer::set_gestures);
+	ClassDB::bind_method(D_METHOD("get_gestures"), &OpenXRHandGestureRecognizer::get_gestures);
+
+	ClassDB::bind_method(D_METHOD("is_gesture_active", "gesture_name"), &OpenXRHandGestureRecognizer::is_gesture_active);
+	ClassDB::bind_method(D_METHOD("get_active_gestures"), &OpenXRHandGestureRecognizer::get_active_gestures);
+
+	ADD_PROPERTY(PropertyInfo(Variant::STRING_NAME, "hand_tracker", PROPERTY_HINT_ENUM_SUGGESTION, "/user/hand_tracker/left,/user/hand_tracker/right"), "set_hand_tracker", "get_hand_tracker");
+	ADD_PROPERTY(PropertyInfo(Variant::ARRAY, "gestures", PROPERTY_HINT_ARRAY_TYPE, "OpenXRHandGesture"), "set_gestures", "get_gestures");
+
+	ADD_SIGNAL(MethodInfo("gesture_started", PropertyInfo(Variant::STRING_NAME, "gesture_name")));
+	ADD_SIGNAL(MethodInfo("gesture_ended", PropertyInfo(Variant::STRING_NAME, "gesture_name")));
+}
+
+void OpenXRHandGestureRecognizer::_notification(int p_what) {
+	switch (p_what) {
+		case NOTIFICATION_READY: {
+			set_process_internal(!Engine::get_singleton()->is_editor_hint());
+		} break;
+		case NOTIFICATION_INTERNAL_PROCESS: {
+			_update_gestures();
+		} break;
+		case NOTIFICATION_EXIT_TREE: {
+			_end_all_gestures();
+		} break;
+	}
+}
+
+void OpenXRHandGestureRecognizer::_update_gestures() {
+	if (gestures.is_empty()) {
+		return;
+	}
+
+	XRServer *xr_server = XRServer::get_singleton();
+	Ref<XRHandTracker> tracker;
+	if (xr_server != nullptr) {
+		tracker = xr_server->get_tracker(hand_tracker);
+	}
+	if (tracker.is_null() || !tracker->get_has_tracking_data()) {
+		_end_all_gestures();
+		return;
+	}
+
+	// Only read the joints that at least one gesture depends on.
+	uint32_t joint_mask = 0;
+	for (const Ref<OpenXRHandGesture> &gesture : gestures) {
+		if (gesture.is_valid()) {
+			joint_mask |= gesture->get_joint_mask();
+		}
+	}
+
+	uint32_t valid_mask = 0;
+	for (int i = 0; i < XRHandTracker::HAND_JOINT_MAX; i++) {
+		if (!(joint_mask & (1u << i))) {
+			continue;
+		}
+
+		const XRHandTracker::HandJoint joint = (XRHandTracker::HandJoint)i;
+		if (tracker->get_hand_joint_flags(joint).has_flag(XRHandTracker::HAND_JOINT_FLAG_POSITION_VALID)) {
+			joint_positions[i] = tracker->get_hand_joint_transform(joint).origin;
+			valid_mask |= 1u << i;
+		}
+	}
+
+	// Evaluate every gesture before emitting any signals, so that signal handlers which
+	// modify the gestures don't interfere with this frame's results.
+	next_active.resize(gestures.size());
+	for (uint32_t i = 0; i < gestures.size(); i++) {
+		const Ref<OpenXRHandGesture> &gesture = gestures[i];
+		if (gesture.is_null()) {
+			next_active[i] = false;
+			continue;
+		}
+
+		const uint32_t gesture_mask = gesture->get_joint_mask();
+		next_active[i] = (valid_mask & gesture_mask) == gesture_mask && gesture->evaluate(joint_positions, active[i]);
+	}
+
+	LocalVector<StringName> started;
+	LocalVector<StringName> ended;
+	for (uint32_t i = 0; i < gestures.size(); i++) {
+		if (next_active[i] == active[i]) {
+			continue;
+		}
+
+		active[i] = next_active[i];
+		if (active[i]) {
+			started.push_back(gestures[i]->get_gesture_name());
+		} else {
+			ended.push_back(gestures[i]->get_gesture_name());
+		}
+	}
+
+	for (const StringName &gesture_name : ended) {
+		emit_signal("gesture_ended", gesture_name);
+	}
+	for (const StringName &gesture_name : started) {
+		emit_signal("gesture_started", gesture_name);
+	}
+}
+
+void OpenXRHandGestureRecognizer::_end_all_gestures() {
+	LocalVector<StringName> ended;
+	for (uint32_t i = 0; i < gestures.size(); i++) {
+		if (active[i]) {
+			active[i] = false;
+			if (gestures[i].is_valid()) {
+				ended.push_back(gestures[i]->get_gesture_name());
+			}
+		}
+	}
+
+	for (const StringName &gesture_name : ended) {
+		emit_signal("gesture_ended", gesture_name);
+	}
+}
+
+void OpenXRHandGestureRecognizer::set_hand_tracker(const StringName &p_hand_tracker) {
+	if (hand_tracker == p_hand_tracker) {
+		return;
+	}
+
+	_end_all_gestures();
+	hand_tracker = p_hand_tracker;
+}
+
+StringName OpenXRHandGestureRecognizer::get_hand_tracker() const {
+	return hand_tracker;
+}
+
+void OpenXRHandGestureRecognizer::set_gestures(const TypedArray<OpenXRHandGesture> &p_gestures) {
+	_end_all_gestures();
+
+	gestures.clear();
+	for (int i = 0; i < p_gestures.size(); i++) {
+		gestures.push_back(p_gestures[i]);
+	}
+
+	active.resize(gestures.size());
+	for (uint32_t i = 0; i < active.size(); i++) {
+		active[i] = false;
+	}
+}
+
+TypedArray<OpenXRHandGesture> OpenXRHandGestureRecognizer::get_gestures() const {
+	TypedArray<OpenXRHandGesture> ret;
+	for (const Ref<OpenXRHandGesture> &gesture : gestures) {
+		ret.push_back(gesture);
+	}
+	return ret;
+}
+
+bool OpenXRHandGestureRecognizer::is_gesture_active(const StringName &p_gesture_name) const {
+	for (uint32_t i = 0; i < gestures.size(); i++) {
+		if (active[i] && gestures[i].is_valid() && gestures[i]->get_gesture_name() == p_gesture_name) {
+			return true;
+		}
+	}
+	return false;
+}
+
+TypedArray<StringName> OpenXRHandGestureRecognizer::get_active_gestures() const {
+	TypedArray<StringName> ret;
+	for (uint32_t i = 0; i < gestures.size(); i++) {
+		if (active[i] && gestures[i].is_valid()) {
+			ret.push_back(gestures[i]->get_gesture_name());
+		}
+	}
+	return ret;
+}
@@ -49,10 +49,18 @@ void OpenXRMetaEnvironmentDepth::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("set_reprojection_offset_exponent", "offset_exponent"), &OpenXRMetaEnvironmentDepth::set_reprojection_offset_exponent);
 	ClassDB::bind_method(D_METHOD("get_reprojection_offset_exponent"), &OpenXRMetaEnvironmentDepth::get_reprojection_offset_exponent);
 
+	ClassDB::bind_method(D_METHOD("set_downsample", "downsample"), &OpenXRMetaEnvironmentDepth::set_downsample);
+	ClassDB::bind_method(D_METHOD("get_downsample"), &OpenXRMetaEnvironmentDepth::get_downsample);
+
+	ClassDB::bind_method(D_METHOD("set_limit_to_receivers", "enabled"), &OpenXRMetaEnvironmentDepth::set_limit_to_receivers);
+	ClassDB::bind_method(D_METHOD("get_limit_to_receivers"), &OpenXRMetaEnvironmentDepth::get_limit_to_receivers);
+
 	ClassDB::bind_method(D_METHOD("set_bilinear_filtering", "enabled"), &OpenXRMetaEnvironmentDepth::set_bilinear_filtering);
 	ClassDB::bind_method(D_METHOD("get_bilinear_filtering"), &OpenXRMetaEnvironmentDepth::get_bilinear_filtering);
 
 	ADD_PROPERTY(PropertyInfo(Variant::INT, "render_priority"), "set_render_priority", "get_render_priority");
+	ADD_PROPERTY(PropertyInfo(Variant::INT, "downsample", PROPERTY_HINT_RANGE, "1,16,1"), "set_downsample", "get_downsample");
+	ADD_PROPERTY(PropertyInfo(Variant::BOOL, "limit_to_receivers"), "set_limit_to_receivers", "get_limit_to_receivers");
 	ADD_PROPERTY(PropertyInfo(Variant::BOOL, "bilinear_filtering"), "set_bilinear_filtering", "get_bilinear_filtering");
 
 	ADD_GROUP("Reprojection Offset", "reprojection_offset_");
@@ -84,6 +92,22 @@ float OpenXRMetaEnvironmentDepth::get_reprojection_offset_exponent() const {
 	return OpenXRMetaEnvironmentDepthExtension::get_singleton()->get_reprojection_offset_exponent();
 }
 
+void OpenXRMetaEnvironmentDepth::set_downsample(int p_downsample) {
+	OpenXRMetaEnvironmentDepthExtension::get_singleton()->set_reprojection_downsample(p_downsample);
+}
+
+int OpenXRMetaEnvironmentDepth::get_downsample() const {
+	return OpenXRMetaEnvironmentDepthExtension::get_singleton()->get_reprojection_downsample();
+}
+
+void OpenXRMetaEnvironmentDepth::set_limit_to_receivers(bool p_enabled) {
+	OpenXRMetaEnvironmentDepthExtension::get_singleton()->set_reprojection_limit_to_receivers(p_enabled);
+}
+
+bool OpenXRMetaEnvironmentDepth::get_limit_to_receivers() const {
+	return OpenXRMetaEnvironmentDepthExtension::get_singleton()->get_reprojection_limit_to_receivers();
+}
+
 void OpenXRMetaEnvironmentDepth::set_bilinear_filtering(bool p_enabled) {
 	OpenXRMetaEnvironmentDepthExtension::get_singleton()->set_reprojection_bilinear_filtering(p_enabled);
 }
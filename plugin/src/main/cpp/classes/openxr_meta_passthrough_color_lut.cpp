@@ -32,12 +32,26 @@
 #include "extensions/openxr_fb_passthrough_extension.h"
 
 #include <godot_cpp/classes/image.hpp>
+#include <godot_cpp/classes/worker_thread_pool.hpp>
 #include <godot_cpp/variant/utility_functions.hpp>
 
 using namespace godot;
 
+HashMap<uint64_t, OpenXRMetaPassthroughColorLut::CacheEntry> OpenXRMetaPassthroughColorLut::cache;
+uint64_t OpenXRMetaPassthroughColorLut::cache_tick = 0;
+int OpenXRMetaPassthroughColorLut::max_cache_size = 8;
+
 void OpenXRMetaPassthroughColorLut::_bind_methods() {
 	ClassDB::bind_static_method("OpenXRMetaPassthroughColorLut", D_METHOD("create_from_image", "image", "channels"), &OpenXRMetaPassthroughColorLut::create_from_image);
+	ClassDB::bind_static_method("OpenXRMetaPassthroughColorLut", D_METHOD("create_from_image_async", "image", "channels"), &OpenXRMetaPassthroughColorLut::create_from_image_async);
+
+	ClassDB::bind_static_method("OpenXRMetaPassthroughColorLut", D_METHOD("set_max_cache_size", "max_cache_size"), &OpenXRMetaPassthroughColorLut::set_max_cache_size);
+	ClassDB::bind_static_method("OpenXRMetaPassthroughColorLut", D_METHOD("get_max_cache_size"), &OpenXRMetaPassthroughColorLut::get_max_cache_size);
+	ClassDB::bind_static_method("OpenXRMetaPassthroughColorLut", D_METHOD("clear_cache"), &OpenXRMetaPassthroughColorLut::clear_cache);
+
+	ClassDB::bind_method(D_METHOD("is_prepared"), &OpenXRMetaPassthroughColorLut::is_prepared);
+
+	ADD_SIGNAL(MethodInfo("prepared"));
 
 	BIND_ENUM_CONSTANT(COLOR_LUT_CHANNELS_RGB);
 	BIND_ENUM_CONSTANT(COLOR_LUT_CHANNELS_RGBA);
@@ -50,25 +64,148 @@ OpenXRMetaPassthroughColorLut::~OpenXRMetaPassthroughColorLut() {
 }
 
 Ref<OpenXRMetaPassthroughColorLut> OpenXRMetaPassthroughColorLut::create_from_image(Ref<Image> p_image, ColorLutChannels p_channels) {
-	Ref<OpenXRMetaPassthroughColorLut> passthrough_color_lut;
+	ERR_FAIL_COND_V(p_image.is_null(), Ref<OpenXRMetaPassthroughColorLut>());
+
+	PackedByteArray image_data = p_image->get_data();
+	Ref<OpenXRMetaPassthroughColorLut> passthrough_color_lut = get_cached(p_image->get_instance_id(), image_data, p_channels);
+	if (passthrough_color_lut.is_valid()) {
+		return passthrough_color_lut;
+	}
+
+	passthrough_color_lut.instantiate();
+	passthrough_color_lut->channels = p_channels;
+
+	int image_cell_resolution = 0;
+	PackedByteArray color_lut_buffer;
+	if (prepare_buffer(p_image->get_width(), p_image->get_height(), p_image->get_format(), image_data, p_channels, image_cell_resolution, color_lut_buffer)) {
+		passthrough_color_lut->finish_preparing(image_cell_resolution, color_lut_buffer);
+		add_to_cache(p_image->get_instance_id(), image_data, passthrough_color_lut);
+	}
+
+	return passthrough_color_lut;
+}
+
+Ref<OpenXRMetaPassthroughColorLut> OpenXRMetaPassthroughColorLut::create_from_image_async(Ref<Image> p_image, ColorLutChannels p_channels) {
+	ERR_FAIL_COND_V(p_image.is_null(), Ref<OpenXRMetaPassthroughColorLut>());
+
+	PackedByteArray image_data = p_image->get_data();
+	Ref<OpenXRMetaPassthroughColorLut> passthrough_color_lut = get_cached(p_image->get_instance_id(), image_data, p_channels);
+	if (passthrough_color_lut.is_valid()) {
+		// Still signal completion, so callers can treat cached and new LUTs the same way.
+		passthrough_color_lut->call_deferred("emit_signal", "prepared");
+		return passthrough_color_lut;
+	}
+
 	passthrough_color_lut.instantiate();
-	passthrough_color_lut->populate_buffer(p_image, p_channels);
+	passthrough_color_lut->channels = p_channels;
+
+	// The image's data is copy-on-write, so the task works on a snapshot, and the image can
+	// keep being used (or changed) on this thread in the meantime. The image itself stays
+	// on this thread, only its ID is needed to cache the result.
+	Callable task = callable_mp_static(&OpenXRMetaPassthroughColorLut::_prepare_task).bind(passthrough_color_lut, (uint64_t)p_image->get_instance_id(), p_image->get_width(), p_image->get_height(), (int)p_image->get_format(), image_data);
+	WorkerThreadPool::get_singleton()->add_task(task, false, "Prepare passthrough color LUT");
+
 	return passthrough_color_lut;
 }
 
-void OpenXRMetaPassthroughColorLut::populate_buffer(const Ref<Image> &p_image, ColorLutChannels p_channels) {
-	int height = p_image->get_height();
-	int width = p_image->get_width();
+void OpenXRMetaPassthroughColorLut::_prepare_task(const Ref<OpenXRMetaPassthroughColorLut> &p_color_lut, uint64_t p_image_id, int p_width, int p_height, int p_format, const PackedByteArray &p_image_data) {
+	int image_cell_resolution = 0;
+	PackedByteArray color_lut_buffer;
+	if (!prepare_buffer(p_width, p_height, (Image::Format)p_format, p_image_data, p_color_lut->channels, image_cell_resolution, color_lut_buffer)) {
+		callable_mp_static(&OpenXRMetaPassthroughColorLut::_fail_preparing).bind(p_color_lut).call_deferred();
+		return;
+	}
+
+	callable_mp_static(&OpenXRMetaPassthroughColorLut::_finish_preparing).bind(p_color_lut, p_image_id, p_image_data, image_cell_resolution, color_lut_buffer).call_deferred();
+}
+
+void OpenXRMetaPassthroughColorLut::_finish_preparing(const Ref<OpenXRMetaPassthroughColorLut> &p_color_lut, uint64_t p_image_id, const PackedByteArray &p_image_data, int p_image_cell_resolution, const PackedByteArray &p_buffer) {
+	p_color_lut->finish_preparing(p_image_cell_resolution, p_buffer);
+	add_to_cache(p_image_id, p_image_data, p_color_lut);
+	p_color_lut->emit_signal("prepared");
+}
+
+void OpenXRMetaPassthroughColorLut::_fail_preparing(const Ref<OpenXRMetaPassthroughColorLut> &p_color_lut) {
+	ERR_PRINT("Failed to prepare passthrough color LUT from image.");
+	// Still signal completion so callers don't wait forever; is_prepared() stays false.
+	p_color_lut->emit_signal("prepared");
+}
+
+void OpenXRMetaPassthroughColorLut::finish_preparing(int p_image_cell_resolution, const PackedByteArray &p_buffer) {
+	image_cell_resolution = p_image_cell_resolution;
+	buffer = p_buffer;
+	color_lut_handle = OpenXRFbPassthroughExtension::get_singleton()->color_lut_create(channels, image_cell_resolution, buffer);
+	prepared = true;
+}
+
+Ref<OpenXRMetaPassthroughColorLut> OpenXRMetaPassthroughColorLut::get_cached(uint64_t p_image_id, const PackedByteArray &p_image_data, ColorLutChannels p_channels) {
+	CacheEntry *entry = cache.getptr(p_image_id);
+	if (entry == nullptr) {
+		return Ref<OpenXRMetaPassthroughColorLut>();
+	}
+
+	// If the image has been changed since, its data won't be the same buffer anymore.
+	if (entry->image_data.ptr() != p_image_data.ptr() || entry->color_lut->get_channels() != p_channels) {
+		cache.erase(p_image_id);
+		return Ref<OpenXRMetaPassthroughColorLut>();
+	}
+
+	entry->last_used = ++cache_tick;
+	return entry->color_lut;
+}
+
+void OpenXRMetaPassthroughColorLut::add_to_cache(uint64_t p_image_id, const PackedByteArray &p_image_data, const Ref<OpenXRMetaPassthroughColorLut> &p_color_lut) {
+	if (max_cache_size <= 0) {
+		return;
+	}
+
+	while (cache.size() >= (uint32_t)max_cache_size && !cache.has(p_image_id)) {
+		uint64_t oldest_key = 0;
+		uint64_t oldest_tick = UINT64_MAX;
+		for (const KeyValue<uint64_t, CacheEntry> &E : cache) {
+			if (E.value.last_used < oldest_tick) {
+				oldest_key = E.key;
+				oldest_tick = E.value.last_used;
+			}
+		}
+		cache.erase(oldest_key);
+	}
+
+	CacheEntry &entry = cache[p_image_id];
+	entry.image_data = p_image_data;
+	entry.color_lut = p_color_lut;
+	entry.last_used = ++cache_tick;
+}
+
+void OpenXRMetaPassthroughColorLut::set_max_cache_size(int p_max_cache_size) {
+	max_cache_size = p_max_cache_size;
+	if (max_cache_size <= 0) {
+		clear_cache();
+	}
+}
+
+int OpenXRMetaPassthroughColorLut::get_max_cache_size() {
+	return max_cache_size;
+}
+
+void OpenXRMetaPassthroughColorLut::clear_cache() {
+	cache.clear();
+}
+
+bool OpenXRMetaPassthroughColorLut::prepare_buffer(int p_width, int p_height, Image::Format p_format, const PackedByteArray &p_image_data, ColorLutChannels p_channels, int &r_image_cell_resolution, PackedByteArray &r_buffer) {
+	int height = p_height;
+	int width = p_width;
+	int image_cell_resolution = 0;
 
 	if (height != width) { // Rectangular image
 		if ((height & (height - 1)) != 0) {
 			UtilityFunctions::print("Color LUT cell resolution must be a power of 2, current resolution: ", height);
-			return;
+			return false;
 		}
 
 		if (width != (height * height)) {
 			UtilityFunctions::print("Color LUT image is incorrect size");
-			return;
+			return false;
 		}
 
 		image_cell_resolution = height;
@@ -85,49 +222,45 @@ void OpenXRMetaPassthroughColorLut::populate_buffer(const Ref<Image> &p_image, C
 			} break;
 			default: {
 				UtilityFunctions::print("Square color LUT image must be of total resolution 8x8, 64x64, or 512x512");
-				return;
+				return false;
 			} break;
 		}
 	}
 
-	channels = p_channels;
-	switch (p_channels) {
-		case COLOR_LUT_CHANNELS_RGB: {
-			if (p_image->get_format() != Image::FORMAT_RGB8) {
-				p_image->convert(Image::FORMAT_RGB8);
-			}
-		} break;
-		case COLOR_LUT_CHANNELS_RGBA: {
-			if (p_image->get_format() != Image::FORMAT_RGBA8) {
-				p_image->convert(Image::FORMAT_RGBA8);
-			}
-		} break;
+	Image::Format format = p_channels == COLOR_LUT_CHANNELS_RGBA ? Image::FORMAT_RGBA8 : Image::FORMAT_RGB8;
+
+	PackedByteArray image_data = p_image_data;
+	if (p_format != format) {
+		// Convert a private copy, rather than the caller's image.
+		Ref<Image> converted_image = Image::create_from_data(width, height, false, p_format, p_image_data);
+		ERR_FAIL_COND_V(converted_image.is_null(), false);
+		converted_image->convert(format);
+		image_data = converted_image->get_data();
 	}
+	ERR_FAIL_COND_V(image_data.size() < width * height * p_channels, false);
 
-	PackedByteArray image_data = p_image->get_data();
 	const uint8_t *image_ptr = image_data.ptr();
 
 	int res_sq = image_cell_resolution * image_cell_resolution;
 	int res_sqrt = (int)sqrt((double)image_cell_resolution);
 	int res_cubed = res_sq * image_cell_resolution;
 
-	int buffer_size = res_cubed * p_channels;
-	buffer.resize(buffer_size);
-	uint8_t *color_lut_buffer_ptr = buffer.ptrw();
+	r_buffer.resize(res_cubed * p_channels);
+	uint8_t *color_lut_buffer_ptr = r_buffer.ptrw();
 
+	// Within a cell, a row of the image maps to a contiguous run in the runtime's layout, so
+	// the reorder is done one cell row at a time rather than one pixel at a time.
+	int cells_per_row = width / image_cell_resolution;
+	size_t cell_row_size = image_cell_resolution * p_channels;
 	for (int y = 0; y < height; y++) {
 		int y_val = res_sqrt * res_sq * (y / image_cell_resolution) + image_cell_resolution * (y % image_cell_resolution);
-		for (int x = 0; x < width; x++) {
-			const uint8_t *pixel = image_ptr + (y * width * p_channels) + (x * p_channels);
-			int x_val = res_sq * (x / image_cell_resolution) + (x % image_cell_resolution);
-			int start_index = (x_val + y_val) * p_channels;
-
-			for (int i = 0; i < p_channels; i++) {
-				color_lut_buffer_ptr[start_index + i] = pixel[i];
-			}
+		const uint8_t *row = image_ptr + (y * width * p_channels);
+		for (int cell_x = 0; cell_x < cells_per_row; cell_x++) {
+			int x_val = res_sq * cell_x;
+			memcpy(color_lut_buffer_ptr + (x_val + y_val) * p_channels, row + cell_x * cell_row_size, cell_row_size);
 		}
 	}
 
-	color_lut_handle = OpenXRFbPassthroughExtension::get_singleton()->color_lut_create(channels, image_cell_resolution, buffer);
-	;
+	r_image_cell_resolution = image_cell_resolution;
+	return true;
 }
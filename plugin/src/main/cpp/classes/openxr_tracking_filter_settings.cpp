@@ -0,0 +1,87 @@
+/**************************************************************************/
+/*  openxr_tracking_filter_settings.cpp                                   */
+/**************************************************************************/
+/*                       This file is part of:                            */
+/*                              GODOT XR                                  */
+/*                      https://godotengine.org                           */
+/**************************************************************************/
+/* Copyright (c) 2022-present Godot XR contributors (see CONTRIBUTORS.md) */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#include "classes/openxr_tracking_filter_settings.h"
+
+using namespace godot;
+
+void OpenXRTrackingFilterSettings::_bind_methods() {
+	ClassDB::bind_method(D_METHOD("set_min_cutoff", "min_cutoff"), &OpenXRTrackingFilterSettings::set_min_cutoff);
+	ClassDB::bind_method(D_METHOD("get_min_cutoff"), &OpenXRTrackingFilterSettings::get_min_cutoff);
+
+	ClassDB::bind_method(D_METHOD("set_beta", "beta"), &OpenXRTrackingFilterSettings::set_beta);
+	ClassDB::bind_method(D_METHOD("get_beta"), &OpenXRTrackingFilterSettings::get_beta);
+
+	ClassDB::bind_method(D_METHOD("set_derivative_cutoff", "derivative_cutoff"), &OpenXRTrackingFilterSettings::set_derivative_cutoff);
+	ClassDB::bind_method(D_METHOD("get_derivative_cutoff"), &OpenXRTrackingFilterSettings::get_derivative_cutoff);
+
+	ClassDB::bind_method(D_METHOD("set_prediction_time", "prediction_time"), &OpenXRTrackingFilterSettings::set_prediction_time);
+	ClassDB::bind_method(D_METHOD("get_prediction_time"), &OpenXRTrackingFilterSettings::get_prediction_time);
+
+	ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "min_cutoff", PROPERTY_HINT_RANGE, "0.01,10.0,0.01,or_greater,suffix:Hz"), "set_min_cutoff", "get_min_cutoff");
+	ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "beta", PROPERTY_HINT_RANGE, "0.0,10.0,0.001,or_greater"), "set_beta", "get_beta");
+	ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "derivative_cutoff", PROPERTY_HINT_RANGE, "0.01,10.0,0.01,or_greater,suffix:Hz"), "set_derivative_cutoff", "get_derivative_cutoff");
+	ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "prediction_time", PROPERTY_HINT_RANGE, "0.0,0.1,0.001,or_greater,suffix:s"), "set_prediction_time", "get_prediction_time");
+}
+
+void OpenXRTrackingFilterSettings::set_min_cutoff(float p_min_cutoff) {
+	parameters.min_cutoff = MAX(p_min_cutoff, 0.001f);
+	emit_changed();
+}
+
+float OpenXRTrackingFilterSettings::get_min_cutoff() const {
+	return parameters.min_cutoff;
+}
+
+void OpenXRTrackingFilterSettings::set_beta(float p_beta) {
+	parameters.beta = MAX(p_beta, 0.0f);
+	emit_changed();
+}
+
+float OpenXRTrackingFilterSettings::get_beta() const {
+	return parameters.beta;
+}
+
+void OpenXRTrackingFilterSettings::set_derivative_cutoff(float p_derivative_cutoff) {
+	parameters.derivative_cutoff = MAX(p_derivative_cutoff, 0.001f);
+	emit_changed();
+}
+
+float OpenXRTrackingFilterSettings::get_derivative_cutoff() const {
+	return parameters.derivative_cutoff;
+}
+
+void OpenXRTrackingFilterSettings::set_prediction_time(float p_prediction_time) {
+	parameters.prediction_time = MAX(p_prediction_time, 0.0f);
+	emit_changed();
+}
+
+float OpenXRTrackingFilterSettings::get_prediction_time() const {
+	return parameters.prediction_time;
+}
@@ -37,6 +37,7 @@
 #include <godot_cpp/classes/project_settings.hpp>
 #include <godot_cpp/classes/rendering_device.hpp>
 #include <godot_cpp/classes/rendering_server.hpp>
+#include <godot_cpp/classes/xr_server.hpp>
 #include <godot_cpp/templates/vector.hpp>
 #include <godot_cpp/variant/utility_functions.hpp>
 
@@ -67,15 +68,39 @@ uniform highp float depth_offset_scale = 0.0;
 uniform highp float depth_offset_exponent = 1.0;
 #endif // USE_DEPTH_OFFSET_EXPONENT
 #endif // USE_DEPTH_OFFSET_SCALE
+#ifdef USE_DOWNSAMPLE
+uniform int downsample = 1;
+#endif // USE_DOWNSAMPLE
+#ifdef USE_REGION
+uniform highp vec4 region_left = vec4(-1.0, -1.0, 1.0, 1.0);
+uniform highp vec4 region_right = vec4(-1.0, -1.0, 1.0, 1.0);
+#endif // USE_REGION
 void vertex() {
 	highp vec4 tanfov = VIEW_INDEX == VIEW_MONO_LEFT ? ANDROID_ENVIRONMENT_DEPTH_TANFOV_LEFT : ANDROID_ENVIRONMENT_DEPTH_TANFOV_RIGHT;
 	highp mat4 depth_to_world = VIEW_INDEX == VIEW_MONO_LEFT ? ANDROID_ENVIRONMENT_DEPTH_CAMERA_TO_WORLD_LEFT : ANDROID_ENVIRONMENT_DEPTH_CAMERA_TO_WORLD_RIGHT;
+#ifdef USE_DOWNSAMPLE
+	// Each point covers a block of downsample x downsample texels, and uses the farthest depth in
+	// it, so the edges of real world objects don't grow over what's behind them.
+	int points_per_row = (ANDROID_ENVIRONMENT_DEPTH_RESOLUTION + downsample - 1) / downsample;
+	ivec2 block_begin = ivec2(VERTEX_ID % points_per_row, VERTEX_ID / points_per_row) * downsample;
+	ivec2 block_end = min(block_begin + downsample, ivec2(ANDROID_ENVIRONMENT_DEPTH_RESOLUTION));
+	highp vec2 uv = (vec2(block_begin + block_end) * 0.5) / float(ANDROID_ENVIRONMENT_DEPTH_RESOLUTION);
+
+	highp float depth = 0.0;
+	for (int y = block_begin.y; y < block_end.y; y++) {
+		for (int x = block_begin.x; x < block_end.x; x++) {
+			// Depth texel corresponds to top left so we need to flip v.
+			depth = max(depth, texelFetch(ANDROID_ENVIRONMENT_DEPTH_TEXTURE, ivec3(x, ANDROID_ENVIRONMENT_DEPTH_RESOLUTION - 1 - y, VIEW_INDEX), 0).x);
+		}
+	}
+#else
 	highp vec2 uv = vec2((float(VERTEX_ID % ANDROID_ENVIRONMENT_DEPTH_RESOLUTION) + 0.5) / float(ANDROID_ENVIRONMENT_DEPTH_RESOLUTION), (float(VERTEX_ID / ANDROID_ENVIRONMENT_DEPTH_RESOLUTION) + 0.5) / float(ANDROID_ENVIRONMENT_DEPTH_RESOLUTION));
 
 	// Depth texel corresponds to top left so we need to flip v.
 	highp vec2 uvFlipped = vec2(uv.x, 1.0 - uv.y);
 
 	highp float depth = texture(ANDROID_ENVIRONMENT_DEPTH_TEXTURE, vec3(uvFlipped, float(VIEW_INDEX))).x;
+#endif // USE_DOWNSAMPLE
 
 	// The depth camera's near plane at z=-1 is parameterized by
 	// z = -1
@@ -84,7 +109,22 @@ void vertex() {
 	highp vec3 depth_pose = depth * vec3(mix(tanfov.xz, tanfov.yw, uv), -1.0);
 
 	VERTEX = (depth_to_world * vec4(depth_pose, 1.0)).xyz;
+#ifdef USE_DOWNSAMPLE
+	// Fewer points have to cover the same area.
+	POINT_SIZE = 20.0 * float(downsample);
+#else
 	POINT_SIZE = 20.0;
+#endif // USE_DOWNSAMPLE
+
+#ifdef USE_REGION
+	highp vec4 region = VIEW_INDEX == VIEW_MONO_LEFT ? region_left : region_right;
+	highp vec4 clip = PROJECTION_MATRIX * (VIEW_MATRIX * vec4(VERTEX, 1.0));
+	highp vec2 ndc = clip.xy / clip.w;
+	if (clip.w <= 0.0 || any(lessThan(ndc, region.xy)) || any(greaterThan(ndc, region.zw))) {
+		// Move the point onto the camera plane, where it gets clipped.
+		VERTEX = INV_VIEW_MATRIX[3].xyz;
+	}
+#endif // USE_REGION
 }
 void fragment() {
 	// VERTEX is automatically transformed from world to view space; find the clip space coordinate
@@ -128,6 +168,15 @@ OpenXRAndroidEnvironmentDepthExtension::OpenXRAndroidEnvironmentDepthExtension()
 
 	request_extensions[XR_ANDROID_DEPTH_TEXTURE_EXTENSION_NAME] = &android_environment_depth_ext;
 	singleton = this;
+
+	global_shader_parameter_names.resize(GLOBAL_SHADER_PARAMETER_MAX);
+	global_shader_parameter_names[GLOBAL_SHADER_PARAMETER_AVAILABLE] = StringName(ANDROID_ENVIRONMENT_DEPTH_AVAILABLE_NAME);
+	global_shader_parameter_names[GLOBAL_SHADER_PARAMETER_TEXTURE] = StringName(ANDROID_ENVIRONMENT_DEPTH_TEXTURE_NAME);
+	global_shader_parameter_names[GLOBAL_SHADER_PARAMETER_RESOLUTION] = StringName(ANDROID_ENVIRONMENT_DEPTH_RESOLUTION_NAME);
+	global_shader_parameter_names[GLOBAL_SHADER_PARAMETER_TANFOV + 0] = StringName(ANDROID_ENVIRONMENT_DEPTH_TANFOV_LEFT_NAME);
+	global_shader_parameter_names[GLOBAL_SHADER_PARAMETER_TANFOV + 1] = StringName(ANDROID_ENVIRONMENT_DEPTH_TANFOV_RIGHT_NAME);
+	global_shader_parameter_names[GLOBAL_SHADER_PARAMETER_CAMERA_TO_WORLD + 0] = StringName(ANDROID_ENVIRONMENT_DEPTH_CAMERA_TO_WORLD_LEFT_NAME);
+	global_shader_parameter_names[GLOBAL_SHADER_PARAMETER_CAMERA_TO_WORLD + 1] = StringName(ANDROID_ENVIRONMENT_DEPTH_CAMERA_TO_WORLD_RIGHT_NAME);
 }
 
 OpenXRAndroidEnvironmentDepthExtension::~OpenXRAndroidEnvironmentDepthExtension() {
@@ -147,6 +196,31 @@ void OpenXRAndroidEnvironmentDepthExtension::_bind_methods() {
 
 	ClassDB::bind_method(D_METHOD("set_smooth", "smooth"), &OpenXRAndroidEnvironmentDepthExtension::set_smooth);
 
+	ClassDB::bind_method(D_METHOD("set_temporal_filter_enabled", "enabled"), &OpenXRAndroidEnvironmentDepthExtension::set_temporal_filter_enabled);
+	ClassDB::bind_method(D_METHOD("get_temporal_filter_enabled"), &OpenXRAndroidEnvironmentDepthExtension::get_temporal_filter_enabled);
+	ClassDB::bind_method(D_METHOD("set_temporal_filter_history_weight", "history_weight"), &OpenXRAndroidEnvironmentDepthExtension::set_temporal_filter_history_weight);
+	ClassDB::bind_method(D_METHOD("get_temporal_filter_history_weight"), &OpenXRAndroidEnvironmentDepthExtension::get_temporal_filter_history_weight);
+
+	ClassDB::bind_method(D_METHOD("set_hand_mask_enabled", "enabled"), &OpenXRAndroidEnvironmentDepthExtension::set_hand_mask_enabled);
+	ClassDB::bind_method(D_METHOD("get_hand_mask_enabled"), &OpenXRAndroidEnvironmentDepthExtension::get_hand_mask_enabled);
+
+	ClassDB::bind_method(D_METHOD("register_occlusion_receiver", "receiver"), &OpenXRAndroidEnvironmentDepthExtension::register_occlusion_receiver);
+	ClassDB::bind_method(D_METHOD("unregister_occlusion_receiver", "receiver"), &OpenXRAndroidEnvironmentDepthExtension::unregister_occlusion_receiver);
+
+	ClassDB::bind_method(D_METHOD("set_occlusion_queries_enabled", "enabled"), &OpenXRAndroidEnvironmentDepthExtension::set_occlusion_queries_enabled);
+	ClassDB::bind_method(D_METHOD("get_occlusion_queries_enabled"), &OpenXRAndroidEnvironmentDepthExtension::get_occlusion_queries_enabled);
+	ClassDB::bind_method(D_METHOD("test_occlusion_spheres", "spheres", "bias"), &OpenXRAndroidEnvironmentDepthExtension::test_occlusion_spheres, DEFVAL(0.05));
+	ClassDB::bind_method(D_METHOD("test_occlusion_aabbs", "aabbs", "bias"), &OpenXRAndroidEnvironmentDepthExtension::test_occlusion_aabbs, DEFVAL(0.05));
+
+	ClassDB::bind_method(D_METHOD("set_depth_fusion", "depth_fusion"), &OpenXRAndroidEnvironmentDepthExtension::set_depth_fusion);
+	ClassDB::bind_method(D_METHOD("get_depth_fusion"), &OpenXRAndroidEnvironmentDepthExtension::get_depth_fusion);
+
+	ClassDB::bind_method(D_METHOD("set_depth_queries_enabled", "enabled"), &OpenXRAndroidEnvironmentDepthExtension::set_depth_queries_enabled);
+	ClassDB::bind_method(D_METHOD("get_depth_queries_enabled"), &OpenXRAndroidEnvironmentDepthExtension::get_depth_queries_enabled);
+	ClassDB::bind_method(D_METHOD("depth_raycast_batch", "rays", "max_distance"), &OpenXRAndroidEnvironmentDepthExtension::depth_raycast_batch, DEFVAL(10.0));
+	ClassDB::bind_method(D_METHOD("estimate_depth_plane", "position", "radius"), &OpenXRAndroidEnvironmentDepthExtension::estimate_depth_plane, DEFVAL(0.1));
+	ClassDB::bind_method(D_METHOD("estimate_depth_planes", "positions", "radius"), &OpenXRAndroidEnvironmentDepthExtension::estimate_depth_planes, DEFVAL(0.1));
+
 	ADD_SIGNAL(MethodInfo("openxr_android_environment_depth_started"));
 	ADD_SIGNAL(MethodInfo("openxr_android_environment_depth_stopped"));
 
@@ -249,6 +323,21 @@ void OpenXRAndroidEnvironmentDepthExtension::_on_session_destroyed() {
 	supported_resolutions.clear();
 }
 
+void OpenXRAndroidEnvironmentDepthExtension::_on_process() {
+	if (hand_mask_enabled && depth_provider_started) {
+		RenderingServer *rs = RenderingServer::get_singleton();
+		ERR_FAIL_NULL(rs);
+		rs->call_on_render_thread(callable_mp(this, &OpenXRAndroidEnvironmentDepthExtension::_set_hand_mask_capsules_rt).bind(OpenXREnvironmentDepthHandMask::gather_capsules()));
+	}
+
+	if (!reprojection_limit_to_receivers || reprojection_material.is_null() || !depth_provider_started) {
+		return;
+	}
+
+	reprojection_material->set_shader_parameter("region_left", occlusion_receivers.get_region(0));
+	reprojection_material->set_shader_parameter("region_right", occlusion_receivers.get_region(1));
+}
+
 void OpenXRAndroidEnvironmentDepthExtension::_on_pre_render() {
 #ifndef ANDROID_ENABLED
 	return;
@@ -272,9 +361,6 @@ void OpenXRAndroidEnvironmentDepthExtension::_on_pre_render() {
 		update_reprojection_material();
 	}
 
-	rs->global_shader_parameter_set(ANDROID_ENVIRONMENT_DEPTH_AVAILABLE_NAME, false);
-	rs->global_shader_parameter_set(ANDROID_ENVIRONMENT_DEPTH_TEXTURE_NAME, RID());
-
 	XrDepthAcquireInfoANDROID acquire_info = {
 		XR_TYPE_DEPTH_ACQUIRE_INFO_ANDROID, // type
 		nullptr, // next
@@ -304,12 +390,15 @@ void OpenXRAndroidEnvironmentDepthExtension::_on_pre_render() {
 	XrResult result = xrAcquireDepthSwapchainImagesANDROID(depth_camera_data.swapchain, &acquire_info, &acquire_result);
 	if (result != XR_SUCCESS) {
 		UtilityFunctions::printerr("OpenXR: unable to acquire depth swapchain images; ", get_openxr_api()->get_error_string(result));
+		_update_depth_globals(RID());
 		return;
 	}
 
 	const float *image_data_raw = smooth ? depth_camera_data.xr_images[acquire_result.acquiredIndex].smoothDepthImage : depth_camera_data.xr_images[acquire_result.acquiredIndex].rawDepthImage;
+	const uint8_t *confidence_data_raw = smooth ? depth_camera_data.xr_images[acquire_result.acquiredIndex].smoothDepthConfidenceImage : depth_camera_data.xr_images[acquire_result.acquiredIndex].rawDepthConfidenceImage;
 	if (image_data_raw == nullptr) {
 		UtilityFunctions::printerr("OpenXR: unable to acquire depth swapchain images; no raw depth image");
+		_update_depth_globals(RID());
 		return;
 	}
 
@@ -329,6 +418,7 @@ void OpenXRAndroidEnvironmentDepthExtension::_on_pre_render() {
 			default:
 				// this should never happen
 				UtilityFunctions::printerr("OpenXR: invalid DepthCameraResolution; ", resolution);
+				_update_depth_globals(RID());
 				return;
 		}
 
@@ -342,8 +432,23 @@ void OpenXRAndroidEnvironmentDepthExtension::_on_pre_render() {
 	}
 	ERR_FAIL_COND(!cache.rid.is_valid());
 
-	rs->global_shader_parameter_set(ANDROID_ENVIRONMENT_DEPTH_AVAILABLE_NAME, true);
-	rs->global_shader_parameter_set(ANDROID_ENVIRONMENT_DEPTH_TEXTURE_NAME, cache.rid);
+	Transform3D world_origin;
+	XRServer *xr_server = XRServer::get_singleton();
+	if (xr_server != nullptr) {
+		world_origin = xr_server->get_world_origin();
+	}
+
+	// The depth image holds linear depth, with the first row at the top.
+	environment_depth_uniforms.set_depth_format(Vector4(1.0, 0.0, 0.0, 1.0), Vector2(1.0 / cache.images[0]->get_width(), 1.0 / cache.images[0]->get_height()), true);
+
+	if (!temporal_filter_enabled && !temporal_filter.is_empty()) {
+		temporal_filter.reset();
+		filtered_acquired_index = -1;
+	}
+
+	// The runtime hands back the same image until it has new depth, which mustn't be blended
+	// into the history again.
+	bool new_depth_image = (int64_t)acquire_result.acquiredIndex != filtered_acquired_index;
 
 	for (int i = 0; i < 2; ++i) {
 		const Ref<Image> &image = cache.images[i];
@@ -353,17 +458,12 @@ void OpenXRAndroidEnvironmentDepthExtension::_on_pre_render() {
 		Image::Format image_format = image->get_format();
 		int image_size_bytes = image->get_data_size();
 
-		image_data_cache.resize(image_size_bytes);
-		memcpy(image_data_cache.ptrw(), image_data_raw + image_width * image_height * i, image_size_bytes);
-		image->set_data(image_width, image_height, image_mipmaps, image_format, image_data_cache);
-		rs->texture_2d_update(cache.rid, image, i);
-
 		Vector4 tan_fov = Vector4(
 				tan(acquire_result.views[i].fov.angleLeft),
 				tan(acquire_result.views[i].fov.angleRight),
 				tan(acquire_result.views[i].fov.angleDown),
 				tan(acquire_result.views[i].fov.angleUp));
-		rs->global_shader_parameter_set(i == 0 ? ANDROID_ENVIRONMENT_DEPTH_TANFOV_LEFT_NAME : ANDROID_ENVIRONMENT_DEPTH_TANFOV_RIGHT_NAME, tan_fov);
+		rs->global_shader_parameter_set(global_shader_parameter_names[GLOBAL_SHADER_PARAMETER_TANFOV + i], tan_fov);
 
 		Transform3D camera_to_world;
 		const XrPosef &pose = acquire_result.views[i].pose;
@@ -371,7 +471,72 @@ void OpenXRAndroidEnvironmentDepthExtension::_on_pre_render() {
 		camera_to_world.origin.y = pose.position.y;
 		camera_to_world.origin.z = pose.position.z;
 		camera_to_world.basis = Basis{ Quaternion{ pose.orientation.x, pose.orientation.y, pose.orientation.z, pose.orientation.w } };
-		rs->global_shader_parameter_set(i == 0 ? ANDROID_ENVIRONMENT_DEPTH_CAMERA_TO_WORLD_LEFT_NAME : ANDROID_ENVIRONMENT_DEPTH_CAMERA_TO_WORLD_RIGHT_NAME, camera_to_world);
+		rs->global_shader_parameter_set(global_shader_parameter_names[GLOBAL_SHADER_PARAMETER_CAMERA_TO_WORLD + i], camera_to_world);
+
+		const float *view_depth = image_data_raw + image_width * image_height * i;
+		if (temporal_filter_enabled) {
+			const float *filtered_depth = new_depth_image ? nullptr : temporal_filter.get_filtered(i, image_width, image_height);
+			if (filtered_depth == nullptr) {
+				const uint8_t *view_confidence = confidence_data_raw != nullptr ? confidence_data_raw + image_width * image_height * i : nullptr;
+				filtered_depth = temporal_filter.filter(i, view_depth, view_confidence, image_width, image_height, camera_to_world, tan_fov);
+			}
+			view_depth = filtered_depth;
+		}
+
+		image_data_cache.resize(image_size_bytes);
+		memcpy(image_data_cache.ptrw(), view_depth, image_size_bytes);
+		image->set_data(image_width, image_height, image_mipmaps, image_format, image_data_cache);
+		rs->texture_2d_update(cache.rid, image, i);
+
+		environment_depth_uniforms.set_view(i, world_origin * camera_to_world, tan_fov);
+
+		if (hand_mask_enabled) {
+			hand_mask.render_view(i, world_origin * camera_to_world, tan_fov);
+		}
+
+		if (render_occlusion_queries_enabled) {
+			// The images are tiny, so the pyramid is built right here from the raw data, and only
+			// the (much smaller) result is handed over to the main thread.
+			Vector2i pyramid_size;
+			PackedFloat32Array pyramid_levels = OpenXREnvironmentDepthPyramid::build_levels(view_depth, image_width, image_height, pyramid_size);
+			callable_mp(this, &OpenXRAndroidEnvironmentDepthExtension::_set_depth_pyramid_view).call_deferred(i, pyramid_size, pyramid_levels, (world_origin * camera_to_world).affine_inverse(), tan_fov);
+		}
+
+		// Both views see nearly the same, so only the first one is kept on the CPU.
+		if (cpu_depth_frames_enabled && i == 0) {
+			PackedFloat32Array frame_depth;
+			frame_depth.resize(image_width * image_height);
+			memcpy(frame_depth.ptrw(), view_depth, image_width * image_height * sizeof(float));
+			callable_mp(this, &OpenXRAndroidEnvironmentDepthExtension::_set_cpu_depth_frame).call_deferred(frame_depth, image_width, image_height, world_origin * camera_to_world, tan_fov);
+		}
+	}
+
+	if (temporal_filter_enabled) {
+		filtered_acquired_index = acquire_result.acquiredIndex;
+	}
+
+	if (hand_mask_enabled) {
+		environment_depth_uniforms.set_hand_mask(hand_mask.update());
+	} else {
+		environment_depth_uniforms.set_hand_mask(RID());
+		hand_mask.clear();
+	}
+
+	_update_depth_globals(cache.rid);
+}
+
+void OpenXRAndroidEnvironmentDepthExtension::_update_depth_globals(const RID &p_depth_texture) {
+	bool was_available = environment_depth_uniforms.is_available();
+	if (!environment_depth_uniforms.update(p_depth_texture)) {
+		return;
+	}
+
+	RenderingServer *rs = RenderingServer::get_singleton();
+	ERR_FAIL_NULL(rs);
+
+	rs->global_shader_parameter_set(global_shader_parameter_names[GLOBAL_SHADER_PARAMETER_TEXTURE], p_depth_texture);
+	if (p_depth_texture.is_valid() != was_available) {
+		rs->global_shader_parameter_set(global_shader_parameter_names[GLOBAL_SHADER_PARAMETER_AVAILABLE], p_depth_texture.is_valid());
 	}
 }
 
@@ -432,10 +597,22 @@ bool OpenXRAndroidEnvironmentDepthExtension::start_environment_depth() {
 }
 
 void OpenXRAndroidEnvironmentDepthExtension::stop_environment_depth() {
+	_update_depth_globals(RID());
+	environment_depth_uniforms.clear();
+
 	// Always clear depth_camera_data, even when depth_provider_started is false, since
 	// set_resolution() and set_smooth() can allocate when depth_provider_started is false too.
 	// This provides the user the capability of "undoing" the allocations.
 	depth_camera_data.reset();
+	depth_pyramid.clear();
+	// So depth queries don't keep answering from the last image.
+	cpu_depth_frame = OpenXREnvironmentDepthFrame();
+
+	// The filter and the hand mask are in use on the render thread.
+	RenderingServer *rs = RenderingServer::get_singleton();
+	if (rs != nullptr) {
+		rs->call_on_render_thread(callable_mp(this, &OpenXRAndroidEnvironmentDepthExtension::_stop_environment_depth_rt));
+	}
 
 	if (!depth_provider_started) {
 		return;
@@ -487,6 +664,34 @@ bool OpenXRAndroidEnvironmentDepthExtension::set_smooth(bool p_smooth) {
 	return true;
 }
 
+void OpenXRAndroidEnvironmentDepthExtension::set_temporal_filter_enabled(bool p_enabled) {
+	temporal_filter_enabled = p_enabled;
+}
+
+bool OpenXRAndroidEnvironmentDepthExtension::get_temporal_filter_enabled() const {
+	return temporal_filter_enabled;
+}
+
+void OpenXRAndroidEnvironmentDepthExtension::set_temporal_filter_history_weight(float p_history_weight) {
+	temporal_filter.set_history_weight(p_history_weight);
+}
+
+float OpenXRAndroidEnvironmentDepthExtension::get_temporal_filter_history_weight() const {
+	return temporal_filter.get_history_weight();
+}
+
+void OpenXRAndroidEnvironmentDepthExtension::set_hand_mask_enabled(bool p_enabled) {
+	hand_mask_enabled = p_enabled;
+}
+
+bool OpenXRAndroidEnvironmentDepthExtension::get_hand_mask_enabled() const {
+	return hand_mask_enabled;
+}
+
+void OpenXRAndroidEnvironmentDepthExtension::_set_hand_mask_capsules_rt(const PackedFloat32Array &p_capsules) {
+	hand_mask.set_capsules(p_capsules);
+}
+
 RID OpenXRAndroidEnvironmentDepthExtension::get_reprojection_mesh() {
 	if (reprojection_mesh.is_null()) {
 		reprojection_shader.instantiate();
@@ -516,6 +721,12 @@ void OpenXRAndroidEnvironmentDepthExtension::update_reprojection_material(bool p
 	if (reprojection_offset_exponent != 1.0) {
 		defines.append("#define USE_DEPTH_OFFSET_EXPONENT");
 	}
+	if (reprojection_downsample > 1) {
+		defines.append("#define USE_DOWNSAMPLE");
+	}
+	if (reprojection_limit_to_receivers) {
+		defines.append("#define USE_REGION");
+	}
 
 	shader_code = shader_code.replace("//DEFINES", String("\n").join(defines));
 
@@ -531,6 +742,9 @@ void OpenXRAndroidEnvironmentDepthExtension::update_reprojection_material(bool p
 	if (reprojection_offset_exponent != 1.0) {
 		reprojection_material->set_shader_parameter("depth_offset_exponent", reprojection_offset_exponent);
 	}
+	if (reprojection_downsample > 1) {
+		reprojection_material->set_shader_parameter("downsample", reprojection_downsample);
+	}
 
 	reprojection_material_dirty = false;
 }
@@ -565,53 +779,163 @@ float OpenXRAndroidEnvironmentDepthExtension::get_reprojection_offset_exponent()
 	return reprojection_offset_exponent;
 }
 
-static void create_shader_global_uniform(const String &p_name, RenderingServer::GlobalShaderParameterType p_type, Variant p_value, RenderingServer *p_rendering_server, ProjectSettings *p_project_settings, bool p_is_editor) {
-	String setting_name = "shader_globals/" + p_name;
-	if (!p_project_settings->has_setting(setting_name)) {
-		p_rendering_server->global_shader_parameter_add(p_name, p_type, p_value);
-		if (p_is_editor) {
-			String type_name;
-			switch (p_type) {
-				case RenderingServer::GLOBAL_VAR_TYPE_BOOL: {
-					type_name = "bool";
-				} break;
-				case RenderingServer::GLOBAL_VAR_TYPE_INT: {
-					type_name = "int";
-				} break;
-				case RenderingServer::GLOBAL_VAR_TYPE_SAMPLER2DARRAY: {
-					type_name = "sampler2DArray";
-				} break;
-				case RenderingServer::GLOBAL_VAR_TYPE_MAT4: {
-					type_name = "mat4";
-				} break;
-				case RenderingServer::GLOBAL_VAR_TYPE_VEC4: {
-					type_name = "vec4";
-				} break;
-			}
+void OpenXRAndroidEnvironmentDepthExtension::set_occlusion_queries_enabled(bool p_enabled) {
+	RenderingServer *rs = RenderingServer::get_singleton();
+	ERR_FAIL_NULL(rs);
 
-			Variant setting_value = p_value;
-			if (p_type == RenderingServer::GLOBAL_VAR_TYPE_SAMPLER2DARRAY) {
-				// In ProjectSettings, this uses a path as a value.
-				setting_value = "";
-			}
+	occlusion_queries_enabled = p_enabled;
+	if (!p_enabled) {
+		depth_pyramid.clear();
+	}
 
-			Dictionary d;
-			d["type"] = type_name;
-			d["value"] = setting_value;
-			p_project_settings->set(setting_name, d);
-		}
+	rs->call_on_render_thread(callable_mp(this, &OpenXRAndroidEnvironmentDepthExtension::_set_occlusion_queries_enabled_rt).bind(p_enabled));
+}
+
+bool OpenXRAndroidEnvironmentDepthExtension::get_occlusion_queries_enabled() const {
+	return occlusion_queries_enabled;
+}
+
+PackedByteArray OpenXRAndroidEnvironmentDepthExtension::test_occlusion_spheres(const PackedFloat32Array &p_spheres, float p_bias) const {
+	return depth_pyramid.test_spheres(p_spheres, p_bias);
+}
+
+PackedByteArray OpenXRAndroidEnvironmentDepthExtension::test_occlusion_aabbs(const PackedFloat32Array &p_aabbs, float p_bias) const {
+	return depth_pyramid.test_aabbs(p_aabbs, p_bias);
+}
+
+void OpenXRAndroidEnvironmentDepthExtension::_stop_environment_depth_rt() {
+	temporal_filter.reset();
+	filtered_acquired_index = -1;
+	hand_mask.clear();
+}
+
+void OpenXRAndroidEnvironmentDepthExtension::_set_occlusion_queries_enabled_rt(bool p_enabled) {
+	render_occlusion_queries_enabled = p_enabled;
+}
+
+void OpenXRAndroidEnvironmentDepthExtension::_set_depth_pyramid_view(int p_view, const Vector2i &p_size, const PackedFloat32Array &p_levels, const Transform3D &p_world_to_view, const Vector4 &p_tan_fov) {
+	if (!occlusion_queries_enabled || !depth_provider_started) {
+		return;
 	}
+
+	// The first row of the depth image is the top one.
+	depth_pyramid.set_view(p_view, p_size, p_levels, p_world_to_view, p_tan_fov, true);
 }
 
-static void remove_shader_global_uniform(const String &p_name, RenderingServer *p_rendering_server, ProjectSettings *p_project_settings) {
-	String setting_name = "shader_globals/" + p_name;
-	if (p_project_settings->has_setting(setting_name)) {
-		p_rendering_server->global_shader_parameter_remove(p_name);
-		p_project_settings->clear(setting_name);
+void OpenXRAndroidEnvironmentDepthExtension::set_depth_fusion(const Ref<OpenXREnvironmentDepthFusion> &p_depth_fusion) {
+	depth_fusion = p_depth_fusion;
+	_update_cpu_depth_frames_enabled();
+}
+
+Ref<OpenXREnvironmentDepthFusion> OpenXRAndroidEnvironmentDepthExtension::get_depth_fusion() const {
+	return depth_fusion;
+}
+
+void OpenXRAndroidEnvironmentDepthExtension::set_depth_queries_enabled(bool p_enabled) {
+	if (p_enabled == depth_queries_enabled) {
+		return;
+	}
+
+	depth_queries_enabled = p_enabled;
+	if (p_enabled) {
+		register_cpu_depth_frame_user();
+	} else {
+		unregister_cpu_depth_frame_user();
 	}
 }
 
+bool OpenXRAndroidEnvironmentDepthExtension::get_depth_queries_enabled() const {
+	return depth_queries_enabled;
+}
+
+PackedFloat32Array OpenXRAndroidEnvironmentDepthExtension::depth_raycast_batch(const PackedFloat32Array &p_rays, float p_max_distance) const {
+	return OpenXREnvironmentDepthQueries::raycast(cpu_depth_frame, p_rays, p_max_distance);
+}
+
+Dictionary OpenXRAndroidEnvironmentDepthExtension::estimate_depth_plane(const Vector3 &p_position, float p_radius) const {
+	return OpenXREnvironmentDepthQueries::estimate_plane(cpu_depth_frame, p_position, p_radius);
+}
+
+PackedFloat32Array OpenXRAndroidEnvironmentDepthExtension::estimate_depth_planes(const PackedFloat32Array &p_positions, float p_radius) const {
+	return OpenXREnvironmentDepthQueries::estimate_planes(cpu_depth_frame, p_positions, p_radius);
+}
+
+void OpenXRAndroidEnvironmentDepthExtension::register_cpu_depth_frame_user() {
+	cpu_depth_frame_users++;
+	_update_cpu_depth_frames_enabled();
+}
+
+void OpenXRAndroidEnvironmentDepthExtension::unregister_cpu_depth_frame_user() {
+	ERR_FAIL_COND(cpu_depth_frame_users <= 0);
+	cpu_depth_frame_users--;
+	_update_cpu_depth_frames_enabled();
+}
+
+const OpenXREnvironmentDepthFrame &OpenXRAndroidEnvironmentDepthExtension::get_cpu_depth_frame() const {
+	return cpu_depth_frame;
+}
+
+void OpenXRAndroidEnvironmentDepthExtension::_update_cpu_depth_frames_enabled() {
+	cpu_depth_frames_enabled = depth_fusion.is_valid() || cpu_depth_frame_users > 0;
+	if (!cpu_depth_frames_enabled) {
+		cpu_depth_frame.depth = PackedFloat32Array();
+	}
+}
+
+void OpenXRAndroidEnvironmentDepthExtension::_set_cpu_depth_frame(const PackedFloat32Array &p_depth, int p_width, int p_height, const Transform3D &p_view_to_world, const Vector4 &p_tan_fov) {
+	if (!cpu_depth_frames_enabled || !depth_provider_started) {
+		return;
+	}
+
+	cpu_depth_frame.depth = p_depth;
+	cpu_depth_frame.width = p_width;
+	cpu_depth_frame.height = p_height;
+	cpu_depth_frame.view_to_world = p_view_to_world;
+	cpu_depth_frame.tan_fov = p_tan_fov;
+	// The first row of the depth image is the top one.
+	cpu_depth_frame.flip_y = true;
+	cpu_depth_frame.index++;
+
+	if (depth_fusion.is_valid()) {
+		depth_fusion->integrate_depth_image(p_depth, p_width, p_height, p_view_to_world, p_tan_fov, true);
+	}
+}
+
+void OpenXRAndroidEnvironmentDepthExtension::set_reprojection_downsample(int p_downsample) {
+	p_downsample = CLAMP(p_downsample, 1, 4);
+	if (reprojection_downsample == p_downsample) {
+		return;
+	}
+
+	reprojection_downsample = p_downsample;
+	reprojection_material_dirty = true;
+	_update_mesh();
+}
+
+int OpenXRAndroidEnvironmentDepthExtension::get_reprojection_downsample() const {
+	return reprojection_downsample;
+}
+
+void OpenXRAndroidEnvironmentDepthExtension::set_reprojection_limit_to_receivers(bool p_enabled) {
+	reprojection_limit_to_receivers = p_enabled;
+	reprojection_material_dirty = true;
+}
+
+bool OpenXRAndroidEnvironmentDepthExtension::get_reprojection_limit_to_receivers() const {
+	return reprojection_limit_to_receivers;
+}
+
+void OpenXRAndroidEnvironmentDepthExtension::register_occlusion_receiver(VisualInstance3D *p_receiver) {
+	occlusion_receivers.add(p_receiver);
+}
+
+void OpenXRAndroidEnvironmentDepthExtension::unregister_occlusion_receiver(VisualInstance3D *p_receiver) {
+	occlusion_receivers.remove(p_receiver);
+}
+
 void OpenXRAndroidEnvironmentDepthExtension::setup_global_uniforms() {
+	OpenXREnvironmentDepthUniforms::setup_global_uniforms();
+
 	RenderingServer *rs = RenderingServer::get_singleton();
 	ERR_FAIL_NULL(rs);
 
@@ -620,13 +944,13 @@ void OpenXRAndroidEnvironmentDepthExtension::setup_global_uniforms() {
 
 	bool enabled = project_settings->get_setting_with_override("xr/openxr/extensions/androidxr/environment_depth");
 	if (!enabled) {
-		remove_shader_global_uniform(ANDROID_ENVIRONMENT_DEPTH_AVAILABLE_NAME, rs, project_settings);
-		remove_shader_global_uniform(ANDROID_ENVIRONMENT_DEPTH_TEXTURE_NAME, rs, project_settings);
-		remove_shader_global_uniform(ANDROID_ENVIRONMENT_DEPTH_RESOLUTION_NAME, rs, project_settings);
-		remove_shader_global_uniform(ANDROID_ENVIRONMENT_DEPTH_TANFOV_LEFT_NAME, rs, project_settings);
-		remove_shader_global_uniform(ANDROID_ENVIRONMENT_DEPTH_TANFOV_RIGHT_NAME, rs, project_settings);
-		remove_shader_global_uniform(ANDROID_ENVIRONMENT_DEPTH_CAMERA_TO_WORLD_LEFT_NAME, rs, project_settings);
-		remove_shader_global_uniform(ANDROID_ENVIRONMENT_DEPTH_CAMERA_TO_WORLD_RIGHT_NAME, rs, project_settings);
+		OpenXREnvironmentDepthUniforms::remove_shader_global_uniform(ANDROID_ENVIRONMENT_DEPTH_AVAILABLE_NAME, rs, project_settings);
+		OpenXREnvironmentDepthUniforms::remove_shader_global_uniform(ANDROID_ENVIRONMENT_DEPTH_TEXTURE_NAME, rs, project_settings);
+		OpenXREnvironmentDepthUniforms::remove_shader_global_uniform(ANDROID_ENVIRONMENT_DEPTH_RESOLUTION_NAME, rs, project_settings);
+		OpenXREnvironmentDepthUniforms::remove_shader_global_uniform(ANDROID_ENVIRONMENT_DEPTH_TANFOV_LEFT_NAME, rs, project_settings);
+		OpenXREnvironmentDepthUniforms::remove_shader_global_uniform(ANDROID_ENVIRONMENT_DEPTH_TANFOV_RIGHT_NAME, rs, project_settings);
+		OpenXREnvironmentDepthUniforms::remove_shader_global_uniform(ANDROID_ENVIRONMENT_DEPTH_CAMERA_TO_WORLD_LEFT_NAME, rs, project_settings);
+		OpenXREnvironmentDepthUniforms::remove_shader_global_uniform(ANDROID_ENVIRONMENT_DEPTH_CAMERA_TO_WORLD_RIGHT_NAME, rs, project_settings);
 
 		already_setup_global_uniforms = false;
 		return;
@@ -644,13 +968,13 @@ void OpenXRAndroidEnvironmentDepthExtension::setup_global_uniforms() {
 	// Set this right away, to prevent getting in a loop of project settings changes.
 	already_setup_global_uniforms = true;
 
-	create_shader_global_uniform(ANDROID_ENVIRONMENT_DEPTH_AVAILABLE_NAME, RenderingServer::GLOBAL_VAR_TYPE_BOOL, false, rs, project_settings, is_editor);
-	create_shader_global_uniform(ANDROID_ENVIRONMENT_DEPTH_TEXTURE_NAME, RenderingServer::GLOBAL_VAR_TYPE_SAMPLER2DARRAY, Variant(), rs, project_settings, is_editor);
-	create_shader_global_uniform(ANDROID_ENVIRONMENT_DEPTH_RESOLUTION_NAME, RenderingServer::GLOBAL_VAR_TYPE_INT, 0, rs, project_settings, is_editor);
-	create_shader_global_uniform(ANDROID_ENVIRONMENT_DEPTH_TANFOV_LEFT_NAME, RenderingServer::GLOBAL_VAR_TYPE_VEC4, Vector4(), rs, project_settings, is_editor);
-	create_shader_global_uniform(ANDROID_ENVIRONMENT_DEPTH_TANFOV_RIGHT_NAME, RenderingServer::GLOBAL_VAR_TYPE_VEC4, Vector4(), rs, project_settings, is_editor);
-	create_shader_global_uniform(ANDROID_ENVIRONMENT_DEPTH_CAMERA_TO_WORLD_LEFT_NAME, RenderingServer::GLOBAL_VAR_TYPE_MAT4, Transform3D(), rs, project_settings, is_editor);
-	create_shader_global_uniform(ANDROID_ENVIRONMENT_DEPTH_CAMERA_TO_WORLD_RIGHT_NAME, RenderingServer::GLOBAL_VAR_TYPE_MAT4, Transform3D(), rs, project_settings, is_editor);
+	OpenXREnvironmentDepthUniforms::create_shader_global_uniform(ANDROID_ENVIRONMENT_DEPTH_AVAILABLE_NAME, RenderingServer::GLOBAL_VAR_TYPE_BOOL, false, rs, project_settings, is_editor);
+	OpenXREnvironmentDepthUniforms::create_shader_global_uniform(ANDROID_ENVIRONMENT_DEPTH_TEXTURE_NAME, RenderingServer::GLOBAL_VAR_TYPE_SAMPLER2DARRAY, Variant(), rs, project_settings, is_editor);
+	OpenXREnvironmentDepthUniforms::create_shader_global_uniform(ANDROID_ENVIRONMENT_DEPTH_RESOLUTION_NAME, RenderingServer::GLOBAL_VAR_TYPE_INT, 0, rs, project_settings, is_editor);
+	OpenXREnvironmentDepthUniforms::create_shader_global_uniform(ANDROID_ENVIRONMENT_DEPTH_TANFOV_LEFT_NAME, RenderingServer::GLOBAL_VAR_TYPE_VEC4, Vector4(), rs, project_settings, is_editor);
+	OpenXREnvironmentDepthUniforms::create_shader_global_uniform(ANDROID_ENVIRONMENT_DEPTH_TANFOV_RIGHT_NAME, RenderingServer::GLOBAL_VAR_TYPE_VEC4, Vector4(), rs, project_settings, is_editor);
+	OpenXREnvironmentDepthUniforms::create_shader_global_uniform(ANDROID_ENVIRONMENT_DEPTH_CAMERA_TO_WORLD_LEFT_NAME, RenderingServer::GLOBAL_VAR_TYPE_MAT4, Transform3D(), rs, project_settings, is_editor);
+	OpenXREnvironmentDepthUniforms::create_shader_global_uniform(ANDROID_ENVIRONMENT_DEPTH_CAMERA_TO_WORLD_RIGHT_NAME, RenderingServer::GLOBAL_VAR_TYPE_MAT4, Transform3D(), rs, project_settings, is_editor);
 }
 
 bool OpenXRAndroidEnvironmentDepthExtension::initialize_android_environment_depth_extension(const XrInstance &p_instance) {
@@ -825,16 +1149,22 @@ void OpenXRAndroidEnvironmentDepthExtension::_update_mesh() {
 	}
 
 	// the shader will reposition these vertices
+	int points_per_row = (res + reprojection_downsample - 1) / reprojection_downsample;
 	PackedVector3Array vertices;
-	vertices.resize(res * res);
+	vertices.resize(points_per_row * points_per_row);
 
 	Array arr;
 	arr.resize(RenderingServer::ARRAY_MAX);
 	arr[RenderingServer::ARRAY_VERTEX] = vertices;
 
-	reprojection_mesh.instantiate();
+	// Keep the same mesh once created, so nodes using it don't need to be updated.
+	if (reprojection_mesh.is_null()) {
+		reprojection_mesh.instantiate();
+		reprojection_mesh->set_custom_aabb(AABB(Vector3(-1000, -1000, -1000), Vector3(2000, 2000, 2000)));
+	} else {
+		reprojection_mesh->clear_surfaces();
+	}
 	reprojection_mesh->add_surface_from_arrays(Mesh::PRIMITIVE_POINTS, arr);
 	reprojection_mesh->surface_set_material(0, reprojection_material);
-	reprojection_mesh->set_custom_aabb(AABB(Vector3(-1000, -1000, -1000), Vector3(2000, 2000, 2000)));
-	rs->global_shader_parameter_set(ANDROID_ENVIRONMENT_DEPTH_RESOLUTION_NAME, res);
+	rs->global_shader_parameter_set(global_shader_parameter_names[GLOBAL_SHADER_PARAMETER_RESOLUTION], res);
 }
@@ -142,6 +142,16 @@ bool OpenXRAndroidEyeTrackingExtension::_initialize_openxr_android_eye_tracking_
 }
 
 void OpenXRAndroidEyeTrackingExtension::_bind_methods() {
+	ClassDB::bind_method(D_METHOD("set_filter_settings", "filter_settings"), &OpenXRAndroidEyeTrackingExtension::set_filter_settings);
+	ClassDB::bind_method(D_METHOD("get_filter_settings"), &OpenXRAndroidEyeTrackingExtension::get_filter_settings);
+}
+
+void OpenXRAndroidEyeTrackingExtension::set_filter_settings(const Ref<OpenXRTrackingFilterSettings> &p_filter_settings) {
+	filter_settings = p_filter_settings;
+}
+
+Ref<OpenXRTrackingFilterSettings> OpenXRAndroidEyeTrackingExtension::get_filter_settings() const {
+	return filter_settings;
 }
 
 void OpenXRAndroidEyeTrackingExtension::_on_process() {
@@ -186,11 +196,44 @@ void OpenXRAndroidEyeTrackingExtension::_on_process() {
 	bool tracking_left_eye = (result == XR_SUCCESS) && (eyes.mode == XR_EYE_TRACKING_MODE_BOTH_ANDROID || eyes.mode == XR_EYE_TRACKING_MODE_LEFT_ANDROID);
 	bool tracking_right_eye = (result == XR_SUCCESS) && (eyes.mode == XR_EYE_TRACKING_MODE_BOTH_ANDROID || eyes.mode == XR_EYE_TRACKING_MODE_RIGHT_ANDROID);
 
-	_populate_eye_tracker(xr_eye_tracker[0].ptr(), tracking_left_eye, eyes.eyes[0]);
-	_populate_eye_tracker(xr_eye_tracker[1].ptr(), tracking_right_eye, eyes.eyes[1]);
+	const bool tracking_status[2] = { tracking_left_eye, tracking_right_eye };
+	bool valid[2];
+	Transform3D eye_transforms[2];
+	for (int i = 0; i < 2; i++) {
+		valid[i] = tracking_status[i] && (eyes.eyes[i].eyeState == XR_EYE_STATE_SHUT_ANDROID || eyes.eyes[i].eyeState == XR_EYE_STATE_GAZING_ANDROID);
+		if (valid[i]) {
+			eye_transforms[i] = OpenXRUtilities::xrPosef_to_godot_transform3d(eyes.eyes[i].eyePose);
+		}
+	}
+
+	// Smooth the eye poses if requested
+	if (filter_settings.is_valid()) {
+		Vector3 positions[2];
+		Quaternion rotations[2];
+		for (int i = 0; i < 2; i++) {
+			positions[i] = eye_transforms[i].origin;
+			rotations[i] = valid[i] ? eye_transforms[i].basis.get_rotation_quaternion() : Quaternion();
+		}
+
+		const OpenXROneEuroFilter::Parameters &parameters = filter_settings->get_parameters();
+		position_filter.filter_positions(positions, 2, get_info.time, parameters, valid);
+		rotation_filter.filter_rotations(rotations, 2, get_info.time, parameters, valid);
+
+		for (int i = 0; i < 2; i++) {
+			if (valid[i]) {
+				eye_transforms[i] = Transform3D(Basis(rotations[i]), positions[i]);
+			}
+		}
+	} else {
+		position_filter.reset();
+		rotation_filter.reset();
+	}
+
+	_populate_eye_tracker(xr_eye_tracker[0].ptr(), tracking_left_eye, eyes.eyes[0].eyeState, eye_transforms[0]);
+	_populate_eye_tracker(xr_eye_tracker[1].ptr(), tracking_right_eye, eyes.eyes[1].eyeState, eye_transforms[1]);
 }
 
-void OpenXRAndroidEyeTrackingExtension::_populate_eye_tracker(XRControllerTracker *tracker, bool tracking_status, const XrEyeANDROID &xr_eye) {
+void OpenXRAndroidEyeTrackingExtension::_populate_eye_tracker(XRControllerTracker *tracker, bool tracking_status, XrEyeStateANDROID eye_state, const Transform3D &eye_transform) {
 	// handle lost scenario where eye was not tracked
 	if (!tracking_status) {
 		tracker->invalidate_pose("default");
@@ -198,14 +241,14 @@ void OpenXRAndroidEyeTrackingExtension::_populate_eye_tracker(XRControllerTracke
 	}
 
 	// set state
-	switch (xr_eye.eyeState) {
+	switch (eye_state) {
 		case XR_EYE_STATE_SHUT_ANDROID: {
-			tracker->set_pose("default", OpenXRUtilities::xrPosef_to_godot_transform3d(xr_eye.eyePose), Vector3(), Vector3(), godot::XRPose::XR_TRACKING_CONFIDENCE_HIGH);
+			tracker->set_pose("default", eye_transform, Vector3(), Vector3(), godot::XRPose::XR_TRACKING_CONFIDENCE_HIGH);
 			tracker->set_input("blink", true);
 			break;
 		}
 		case XR_EYE_STATE_GAZING_ANDROID: {
-			tracker->set_pose("default", OpenXRUtilities::xrPosef_to_godot_transform3d(xr_eye.eyePose), Vector3(), Vector3(), godot::XRPose::XR_TRACKING_CONFIDENCE_HIGH);
+			tracker->set_pose("default", eye_transform, Vector3(), Vector3(), godot::XRPose::XR_TRACKING_CONFIDENCE_HIGH);
 			tracker->set_input("blink", false);
 			break;
 		}
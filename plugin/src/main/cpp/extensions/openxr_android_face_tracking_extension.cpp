@@ -154,12 +154,22 @@ bool OpenXRAndroidFaceTrackingExtension::_initialize_openxr_android_face_trackin
 
 void OpenXRAndroidFaceTrackingExtension::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("get_face_calibration_state"), &OpenXRAndroidFaceTrackingExtension::get_face_calibration_state);
+	ClassDB::bind_method(D_METHOD("set_filter_settings", "filter_settings"), &OpenXRAndroidFaceTrackingExtension::set_filter_settings);
+	ClassDB::bind_method(D_METHOD("get_filter_settings"), &OpenXRAndroidFaceTrackingExtension::get_filter_settings);
 
 	BIND_ENUM_CONSTANT(CALIBRATION_STATE_UNAVAILABLE);
 	BIND_ENUM_CONSTANT(CALIBRATION_STATE_UNCALIBRATED);
 	BIND_ENUM_CONSTANT(CALIBRATION_STATE_CALIBRATED);
 }
 
+void OpenXRAndroidFaceTrackingExtension::set_filter_settings(const Ref<OpenXRTrackingFilterSettings> &p_filter_settings) {
+	filter_settings = p_filter_settings;
+}
+
+Ref<OpenXRTrackingFilterSettings> OpenXRAndroidFaceTrackingExtension::get_filter_settings() const {
+	return filter_settings;
+}
+
 OpenXRAndroidFaceTrackingExtension::CalibrationState OpenXRAndroidFaceTrackingExtension::get_face_calibration_state() const {
 	return calibration_state;
 }
@@ -387,6 +397,16 @@ void OpenXRAndroidFaceTrackingExtension::_on_process() {
 	xr_weights[XRFaceTracker::FT_MOUTH_TIGHTENER] = average(xr_weights[XRFaceTracker::FT_MOUTH_TIGHTENER_RIGHT], xr_weights[XRFaceTracker::FT_MOUTH_TIGHTENER_LEFT]);
 	xr_weights[XRFaceTracker::FT_MOUTH_PRESS] = average(xr_weights[XRFaceTracker::FT_MOUTH_PRESS_RIGHT], xr_weights[XRFaceTracker::FT_MOUTH_PRESS_LEFT]);
 
+	// Smooth the weights if requested
+	if (filter_settings.is_valid()) {
+		weight_filter.filter(xr_weights, XRFaceTracker::FT_MAX, 1, get_info.time, filter_settings->get_parameters());
+		for (float &weight : xr_weights) {
+			weight = CLAMP(weight, 0.0f, 1.0f);
+		}
+	} else {
+		weight_filter.reset();
+	}
+
 	// Populate the XRFaceTracker
 	PackedFloat32Array xr_weights_array;
 	xr_weights_array.resize(XRFaceTracker::FT_MAX);
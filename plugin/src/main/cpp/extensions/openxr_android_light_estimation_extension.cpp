@@ -31,6 +31,9 @@
 
 #include <godot_cpp/classes/open_xrapi_extension.hpp>
 #include <godot_cpp/classes/os.hpp>
+#include <godot_cpp/classes/project_settings.hpp>
+#include <godot_cpp/classes/rendering_server.hpp>
+#include <godot_cpp/variant/typed_array.hpp>
 #include <godot_cpp/variant/utility_functions.hpp>
 
 using namespace godot;
@@ -84,7 +87,11 @@ void OpenXRAndroidLightEstimationExtension::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("is_spherical_harmonics_total_valid"), &OpenXRAndroidLightEstimationExtension::is_spherical_harmonics_total_valid);
 	ClassDB::bind_method(D_METHOD("get_spherical_harmonics_total_coefficients"), &OpenXRAndroidLightEstimationExtension::get_spherical_harmonics_total_coefficients);
 
+	ClassDB::bind_method(D_METHOD("set_global_shader_parameters_enabled", "enabled"), &OpenXRAndroidLightEstimationExtension::set_global_shader_parameters_enabled);
+	ClassDB::bind_method(D_METHOD("is_global_shader_parameters_enabled"), &OpenXRAndroidLightEstimationExtension::is_global_shader_parameters_enabled);
+
 	ADD_PROPERTY(PropertyInfo(Variant::INT, "light_estimate_types", PROPERTY_HINT_FLAGS, "Directional Light,Ambient,Spherical Harmonics (Ambient),Spherical Harmonics (Total),Cubemap"), "set_light_estimate_types", "get_light_estimate_types");
+	ADD_PROPERTY(PropertyInfo(Variant::BOOL, "global_shader_parameters_enabled"), "set_global_shader_parameters_enabled", "is_global_shader_parameters_enabled");
 
 	BIND_ENUM_CONSTANT(LIGHT_ESTIMATE_TYPE_DIRECTIONAL_LIGHT);
 	BIND_ENUM_CONSTANT(LIGHT_ESTIMATE_TYPE_AMBIENT);
@@ -100,6 +107,12 @@ void OpenXRAndroidLightEstimationExtension::_on_instance_created(uint64_t instan
 		if (!result) {
 			UtilityFunctions::printerr("Failed to initialize XR_ANDROID_light_estimation extension");
 			android_light_estimation_ext = false;
+			return;
+		}
+
+		bool enable_global_shader_parameters = (bool)ProjectSettings::get_singleton()->get_setting_with_override("xr/openxr/extensions/androidxr/light_estimation/global_shader_parameters");
+		if (enable_global_shader_parameters) {
+			set_global_shader_parameters_enabled(true);
 		}
 	}
 }
@@ -191,6 +204,9 @@ bool OpenXRAndroidLightEstimationExtension::start_light_estimation() {
 		return false;
 	}
 
+	light_estimation_start_time = get_openxr_api()->get_predicted_display_time();
+	global_shader_parameters_time = 0;
+
 	return true;
 }
 
@@ -263,7 +279,109 @@ void OpenXRAndroidLightEstimationExtension::_on_process() {
 		return;
 	}
 
-	// @todo Check previous update time and update the the global shader uniforms (if enabled)
+	if (global_shader_parameters_enabled && is_estimate_valid() && estimate_info.lastUpdatedTime > global_shader_parameters_time) {
+		global_shader_parameters_time = estimate_info.lastUpdatedTime;
+		update_global_shader_parameters();
+	}
+}
+
+void OpenXRAndroidLightEstimationExtension::set_global_shader_parameters_enabled(bool p_enabled) {
+	global_shader_parameters_enabled = p_enabled;
+	if (global_shader_parameters_enabled) {
+		register_global_shader_parameters();
+		global_shader_parameters_time = 0;
+	}
+}
+
+bool OpenXRAndroidLightEstimationExtension::is_global_shader_parameters_enabled() const {
+	return global_shader_parameters_enabled;
+}
+
+void OpenXRAndroidLightEstimationExtension::register_global_shader_parameters() {
+	if (!global_shader_parameter_names.is_empty()) {
+		return;
+	}
+
+	global_shader_parameter_names.resize(GLOBAL_SHADER_PARAMETER_MAX);
+	global_shader_parameter_names[GLOBAL_SHADER_PARAMETER_DIRECTIONAL_LIGHT_DIRECTION] = StringName("openxr_light_estimate_directional_light_direction");
+	global_shader_parameter_names[GLOBAL_SHADER_PARAMETER_DIRECTIONAL_LIGHT_INTENSITY] = StringName("openxr_light_estimate_directional_light_intensity");
+	global_shader_parameter_names[GLOBAL_SHADER_PARAMETER_AMBIENT_LIGHT_INTENSITY] = StringName("openxr_light_estimate_ambient_light_intensity");
+	global_shader_parameter_names[GLOBAL_SHADER_PARAMETER_AMBIENT_LIGHT_COLOR_CORRECTION] = StringName("openxr_light_estimate_ambient_light_color_correction");
+	global_shader_parameter_names[GLOBAL_SHADER_PARAMETER_TIMESTAMP] = StringName("openxr_light_estimate_timestamp");
+	for (int i = 0; i < 9; i++) {
+		global_shader_parameter_names[GLOBAL_SHADER_PARAMETER_SPHERICAL_HARMONICS_AMBIENT + i] = StringName(vformat("openxr_light_estimate_sh_ambient_%d", i));
+		global_shader_parameter_names[GLOBAL_SHADER_PARAMETER_SPHERICAL_HARMONICS_TOTAL + i] = StringName(vformat("openxr_light_estimate_sh_total_%d", i));
+		global_shader_parameter_names[GLOBAL_SHADER_PARAMETER_SPHERICAL_HARMONICS_SMOOTHED + i] = StringName(vformat("openxr_light_estimate_sh_smoothed_%d", i));
+	}
+	global_shader_parameter_names[GLOBAL_SHADER_PARAMETER_SPHERICAL_HARMONICS_ROTATION] = StringName("openxr_light_estimate_sh_rotation");
+
+	// Shaders need these to exist when they're compiled, so they should also be declared under
+	// Shader Globals in the project settings; only add the ones that are missing.
+	RenderingServer *rendering_server = RenderingServer::get_singleton();
+	ERR_FAIL_NULL(rendering_server);
+
+	TypedArray<StringName> existing = rendering_server->global_shader_parameter_get_list();
+	for (uint32_t i = 0; i < global_shader_parameter_names.size(); i++) {
+		if (existing.has(global_shader_parameter_names[i])) {
+			continue;
+		}
+
+		if (i == GLOBAL_SHADER_PARAMETER_TIMESTAMP) {
+			rendering_server->global_shader_parameter_add(global_shader_parameter_names[i], RenderingServer::GLOBAL_VAR_TYPE_FLOAT, 0.0);
+		} else if (i == GLOBAL_SHADER_PARAMETER_SPHERICAL_HARMONICS_ROTATION) {
+			rendering_server->global_shader_parameter_add(global_shader_parameter_names[i], RenderingServer::GLOBAL_VAR_TYPE_MAT3, Basis());
+		} else {
+			rendering_server->global_shader_parameter_add(global_shader_parameter_names[i], RenderingServer::GLOBAL_VAR_TYPE_VEC3, Vector3());
+		}
+	}
+}
+
+void OpenXRAndroidLightEstimationExtension::update_global_shader_parameters() {
+	RenderingServer *rendering_server = RenderingServer::get_singleton();
+	ERR_FAIL_NULL(rendering_server);
+
+	if (is_directional_light_valid()) {
+		rendering_server->global_shader_parameter_set(global_shader_parameter_names[GLOBAL_SHADER_PARAMETER_DIRECTIONAL_LIGHT_DIRECTION], get_directional_light_direction());
+		const XrVector3f &intensity = directional_light_info.intensity;
+		rendering_server->global_shader_parameter_set(global_shader_parameter_names[GLOBAL_SHADER_PARAMETER_DIRECTIONAL_LIGHT_INTENSITY], Vector3(intensity.x, intensity.y, intensity.z));
+	}
+
+	if (is_ambient_light_valid()) {
+		const XrVector3f &intensity = ambient_light_info.intensity;
+		const XrVector3f &color_correction = ambient_light_info.colorCorrection;
+		rendering_server->global_shader_parameter_set(global_shader_parameter_names[GLOBAL_SHADER_PARAMETER_AMBIENT_LIGHT_INTENSITY], Vector3(intensity.x, intensity.y, intensity.z));
+		rendering_server->global_shader_parameter_set(global_shader_parameter_names[GLOBAL_SHADER_PARAMETER_AMBIENT_LIGHT_COLOR_CORRECTION], Vector3(color_correction.x, color_correction.y, color_correction.z));
+	}
+
+	if (is_spherical_harmonics_ambient_valid()) {
+		for (int i = 0; i < 9; i++) {
+			const float *coefficient = spherical_harmonics_ambient_info.coefficients[i];
+			rendering_server->global_shader_parameter_set(global_shader_parameter_names[GLOBAL_SHADER_PARAMETER_SPHERICAL_HARMONICS_AMBIENT + i], Vector3(coefficient[0], coefficient[1], coefficient[2]));
+		}
+	}
+
+	if (is_spherical_harmonics_total_valid()) {
+		for (int i = 0; i < 9; i++) {
+			const float *coefficient = spherical_harmonics_total_info.coefficients[i];
+			rendering_server->global_shader_parameter_set(global_shader_parameter_names[GLOBAL_SHADER_PARAMETER_SPHERICAL_HARMONICS_TOTAL + i], Vector3(coefficient[0], coefficient[1], coefficient[2]));
+		}
+	}
+
+	// Seconds since light estimation started, which keeps enough precision for a float.
+	double timestamp = (double)(estimate_info.lastUpdatedTime - light_estimation_start_time) / 1000000000.0;
+	rendering_server->global_shader_parameter_set(global_shader_parameter_names[GLOBAL_SHADER_PARAMETER_TIMESTAMP], timestamp);
+}
+
+void OpenXRAndroidLightEstimationExtension::set_smoothed_spherical_harmonics_global_shader_parameters(const Vector3 *p_coefficients, const Basis &p_rotation) {
+	register_global_shader_parameters();
+
+	RenderingServer *rendering_server = RenderingServer::get_singleton();
+	ERR_FAIL_NULL(rendering_server);
+
+	for (int i = 0; i < 9; i++) {
+		rendering_server->global_shader_parameter_set(global_shader_parameter_names[GLOBAL_SHADER_PARAMETER_SPHERICAL_HARMONICS_SMOOTHED + i], p_coefficients[i]);
+	}
+	rendering_server->global_shader_parameter_set(global_shader_parameter_names[GLOBAL_SHADER_PARAMETER_SPHERICAL_HARMONICS_ROTATION], p_rotation);
 }
 
 void OpenXRAndroidLightEstimationExtension::set_light_estimate_types(BitField<LightEstimateType> p_estimate_types) {
@@ -361,6 +361,34 @@ void OpenXRAndroidTrackablesExtension::find_and_update_all_trackers(XrTrackableT
 	}
 }
 
+bool OpenXRAndroidTrackablesExtension::get_all_xrtrackables(XrTrackableTrackerANDROID p_xrtrackable_tracker, LocalVector<XrTrackableANDROID> &r_xrtrackables, uint32_t &r_count) {
+	r_count = 0;
+	if (p_xrtrackable_tracker == XR_NULL_HANDLE) {
+		return false;
+	}
+
+	XrResult result = XR_ERROR_SIZE_INSUFFICIENT;
+	if (!r_xrtrackables.is_empty()) {
+		result = xrGetAllTrackablesANDROID(p_xrtrackable_tracker, r_xrtrackables.size(), &r_count, r_xrtrackables.ptr());
+	}
+
+	if (result == XR_ERROR_SIZE_INSUFFICIENT) {
+		result = xrGetAllTrackablesANDROID(p_xrtrackable_tracker, 0, &r_count, nullptr);
+		if (result == XR_SUCCESS && 0 < r_count) {
+			r_xrtrackables.resize(r_count);
+			result = xrGetAllTrackablesANDROID(p_xrtrackable_tracker, r_xrtrackables.size(), &r_count, r_xrtrackables.ptr());
+		}
+	}
+
+	if (result != XR_SUCCESS) {
+		UtilityFunctions::printerr("OpenXR: Failed to query trackables; ", get_openxr_api()->get_error_string(result));
+		r_count = 0;
+		return false;
+	}
+
+	return true;
+}
+
 void OpenXRAndroidTrackablesExtension::maybe_destroy_trackable_tracker(XrTrackableTrackerANDROID &trackable_tracker, HashMap<XrTrackableANDROID, Ref<OpenXRAndroidTrackableTracker>> &p_current_trackables) {
 	XRServer *xr_server = XRServer::get_singleton();
 	for (auto &[xrtrackable, tracker] : p_current_trackables) {
@@ -36,6 +36,7 @@
 #include <godot_cpp/classes/open_xrapi_extension.hpp>
 #include <godot_cpp/classes/os.hpp>
 #include <godot_cpp/classes/project_settings.hpp>
+#include <godot_cpp/classes/xr_server.hpp>
 #include <godot_cpp/core/class_db.hpp>
 #include <godot_cpp/core/error_macros.hpp>
 #include <godot_cpp/core/memory.hpp>
@@ -152,11 +153,16 @@ void OpenXRAndroidTrackablesObjectExtension::_on_session_destroyed() {
 		default_object_context = RID();
 	}
 
-	List<RID> object_context_rids;
-	object_context_owner.get_owned_list(&object_context_rids);
+	// free_object_context() removes from object_contexts, so iterate over a copy
+	LocalVector<RID> object_context_rids = object_contexts;
 	for (const RID &object_context_rid : object_context_rids) {
 		free_object_context(object_context_rid);
 	}
+
+	tracked_object_transforms.clear();
+	tracked_object_extents.clear();
+	tracked_object_labels.clear();
+	tracked_object_trackers.clear();
 }
 
 bool OpenXRAndroidTrackablesObjectExtension::is_trackables_object_supported() const {
@@ -187,26 +193,184 @@ void OpenXRAndroidTrackablesObjectExtension::set_object_tracker_discovery_cooldo
 void OpenXRAndroidTrackablesObjectExtension::discover_object_trackers(bool p_update_trackers, RID p_object_context) {
 	ERR_FAIL_COND(!is_trackables_object_supported() || !permissions_granted);
 
+	if (p_object_context.is_valid()) {
+		// The packed arrays describe every object context, so a single context can't republish them.
+		_update_object_context(p_object_context, p_update_trackers, false);
+		return;
+	}
+
+	// ensure the default object context is created
+	get_default_object_context();
+
+	// update every object context (which includes the default object context) in a single pass
+	pending_objects.transforms.clear();
+	pending_objects.extents.clear();
+	pending_objects.labels.clear();
+	pending_objects.trackers.clear();
+
+	for (const RID &object_context_rid : object_contexts) {
+		_update_object_context(object_context_rid, p_update_trackers, true);
+	}
+
+	if (p_update_trackers) {
+		_publish_tracked_objects();
+	}
+}
+
+void OpenXRAndroidTrackablesObjectExtension::_update_object_context(RID p_object_context, bool p_update_trackers, bool p_collect_objects) {
+	ObjectContext *object_context = object_context_owner.get_or_null(p_object_context);
+	ERR_FAIL_NULL(object_context);
+
 	OpenXRAndroidTrackablesExtension *wrapper = OpenXRAndroidTrackablesExtension::get_singleton();
 	ERR_FAIL_NULL(wrapper);
 
-	ObjectContext *object_context = object_context_owner.get_or_null(p_object_context);
-	if (object_context == nullptr) {
-		// ensure the default object context is created
-		get_default_object_context();
-
-		// update every object context (which includes the default object context)
-		List<RID> object_context_rids;
-		object_context_owner.get_owned_list(&object_context_rids);
-		for (const RID &object_context_rid : object_context_rids) {
-			object_context = object_context_owner.get_or_null(object_context_rid);
-			wrapper->find_and_update_all_trackers(object_context->xrtrackable_tracker, XR_TRACKABLE_TYPE_OBJECT_ANDROID, p_update_trackers, object_context->xrtrackable_to_tracker);
+	XRServer *xr_server = XRServer::get_singleton();
+	ERR_FAIL_NULL(xr_server);
+
+	uint32_t xrtrackable_count = 0;
+	if (!wrapper->get_all_xrtrackables(object_context->xrtrackable_tracker, xrtrackables, xrtrackable_count)) {
+		return;
+	}
+
+	XrTrackableGetInfoANDROID get_info = {
+		XR_TYPE_TRACKABLE_GET_INFO_ANDROID, // type
+		nullptr, // next
+		XR_NULL_TRACKABLE_ANDROID, // trackable
+		(XrSpace)get_openxr_api()->get_play_space(), // baseSpace
+		(XrTime)get_openxr_api()->get_predicted_display_time(), // time
+	};
+
+	// Taken before new trackers are added, so it only differs from the number of trackables
+	// still reported when some have disappeared.
+	uint32_t previous_count = object_context->xrtrackable_to_tracker.size();
+	uint32_t existing_count = 0;
+	for (uint32_t i = 0; i < xrtrackable_count; i++) {
+		XrTrackableANDROID xrtrackable = xrtrackables[i];
+
+		Ref<OpenXRAndroidTrackableTracker> *tracker = object_context->xrtrackable_to_tracker.getptr(xrtrackable);
+		if (tracker != nullptr) {
+			existing_count++;
+		} else {
+			Ref<OpenXRAndroidTrackableTracker> new_tracker = OpenXRAndroidTrackableObjectTracker::create(xrtrackable, object_context->xrtrackable_tracker);
+			if (new_tracker.is_null()) {
+				continue;
+			}
+			tracker = &object_context->xrtrackable_to_tracker.insert(xrtrackable, new_tracker)->value;
+			xr_server->add_tracker(new_tracker);
+		}
+
+		if (!p_update_trackers) {
+			continue;
+		}
+
+		// Query the object once, and share the result between the tracker and the packed arrays.
+		get_info.trackable = xrtrackable;
+		XrTrackableObjectANDROID xr_trackable_object = {
+			XR_TYPE_TRACKABLE_OBJECT_ANDROID, // type
+			nullptr, // next
+			XR_TRACKING_STATE_PAUSED_ANDROID, // trackingState
+			{}, // centerPose
+			{}, // extents
+			XR_OBJECT_LABEL_UNKNOWN_ANDROID, // objectLabel
+			0, // lastUpdatedTime
+		};
+		XrResult result = xrGetTrackableObjectANDROID(object_context->xrtrackable_tracker, &get_info, &xr_trackable_object);
+		if (result != XR_SUCCESS) {
+			UtilityFunctions::printerr("OpenXR: Failed to get trackable object; ", get_openxr_api()->get_error_string(result));
+			continue;
+		}
+
+		OpenXRAndroidTrackableObjectTracker *object_tracker = Object::cast_to<OpenXRAndroidTrackableObjectTracker>(tracker->ptr());
+		ERR_CONTINUE(object_tracker == nullptr);
+		object_tracker->update_from_xrtrackable_object(xr_trackable_object);
+
+		if (!p_collect_objects || xr_trackable_object.trackingState != XR_TRACKING_STATE_TRACKING_ANDROID) {
+			continue;
+		}
+
+		// Stored as 3x4 row-major transforms, which is the MultiMesh buffer layout.
+		const Transform3D &transform = object_tracker->get_center_pose();
+		for (int row = 0; row < 3; row++) {
+			pending_objects.transforms.push_back(transform.basis.rows[row].x);
+			pending_objects.transforms.push_back(transform.basis.rows[row].y);
+			pending_objects.transforms.push_back(transform.basis.rows[row].z);
+			pending_objects.transforms.push_back(transform.origin[row]);
+		}
+		pending_objects.extents.push_back(object_tracker->get_extents());
+		pending_objects.labels.push_back(object_tracker->get_object_label());
+		pending_objects.trackers.push_back(*tracker);
+	}
+
+	// remove trackers whose trackables the runtime no longer reports
+	if (existing_count < previous_count) {
+		LocalVector<XrTrackableANDROID> removed;
+		for (const KeyValue<XrTrackableANDROID, Ref<OpenXRAndroidTrackableTracker>> &E : object_context->xrtrackable_to_tracker) {
+			bool found = false;
+			for (uint32_t i = 0; i < xrtrackable_count; i++) {
+				if (xrtrackables[i] == E.key) {
+					found = true;
+					break;
+				}
+			}
+			if (!found) {
+				removed.push_back(E.key);
+			}
+		}
+
+		for (XrTrackableANDROID xrtrackable : removed) {
+			Ref<OpenXRAndroidTrackableTracker> tracker = object_context->xrtrackable_to_tracker[xrtrackable];
+			tracker->deinit();
+			object_context->xrtrackable_to_tracker.erase(xrtrackable);
+			xr_server->remove_tracker(tracker);
 		}
-	} else {
-		wrapper->find_and_update_all_trackers(object_context->xrtrackable_tracker, XR_TRACKABLE_TYPE_OBJECT_ANDROID, p_update_trackers, object_context->xrtrackable_to_tracker);
 	}
 }
 
+void OpenXRAndroidTrackablesObjectExtension::_publish_tracked_objects() {
+	tracked_object_transforms.resize(pending_objects.transforms.size());
+	if (!pending_objects.transforms.is_empty()) {
+		memcpy(tracked_object_transforms.ptrw(), pending_objects.transforms.ptr(), pending_objects.transforms.size() * sizeof(float));
+	}
+
+	tracked_object_extents.resize(pending_objects.extents.size());
+	if (!pending_objects.extents.is_empty()) {
+		memcpy(tracked_object_extents.ptrw(), pending_objects.extents.ptr(), pending_objects.extents.size() * sizeof(Vector3));
+	}
+
+	tracked_object_labels.resize(pending_objects.labels.size());
+	if (!pending_objects.labels.is_empty()) {
+		memcpy(tracked_object_labels.ptrw(), pending_objects.labels.ptr(), pending_objects.labels.size() * sizeof(int32_t));
+	}
+
+	tracked_object_trackers = Array();
+	tracked_object_trackers.resize(pending_objects.trackers.size());
+	for (uint32_t i = 0; i < pending_objects.trackers.size(); i++) {
+		tracked_object_trackers[i] = pending_objects.trackers[i];
+	}
+
+	emit_signal("tracked_objects_updated");
+}
+
+int OpenXRAndroidTrackablesObjectExtension::get_tracked_object_count() const {
+	return tracked_object_labels.size();
+}
+
+PackedFloat32Array OpenXRAndroidTrackablesObjectExtension::get_tracked_object_transforms() const {
+	return tracked_object_transforms;
+}
+
+PackedVector3Array OpenXRAndroidTrackablesObjectExtension::get_tracked_object_extents() const {
+	return tracked_object_extents;
+}
+
+PackedInt32Array OpenXRAndroidTrackablesObjectExtension::get_tracked_object_labels() const {
+	return tracked_object_labels;
+}
+
+Array OpenXRAndroidTrackablesObjectExtension::get_tracked_object_trackers() const {
+	return tracked_object_trackers;
+}
+
 RID OpenXRAndroidTrackablesObjectExtension::get_default_object_context() {
 	ERR_FAIL_COND_V(!is_trackables_object_supported() || !permissions_granted, RID());
 
@@ -261,9 +425,7 @@ RID OpenXRAndroidTrackablesObjectExtension::create_object_context(Array p_object
 }
 
 RID OpenXRAndroidTrackablesObjectExtension::get_object_context(XrTrackableTrackerANDROID p_xrtrackable_tracker) {
-	List<RID> object_context_rids;
-	object_context_owner.get_owned_list(&object_context_rids);
-	for (const RID &object_context_rid : object_context_rids) {
+	for (const RID &object_context_rid : object_contexts) {
 		ObjectContext *object_context = object_context_owner.get_or_null(object_context_rid);
 		if (object_context != nullptr && object_context->xrtrackable_tracker == p_xrtrackable_tracker) {
 			return object_context_rid;
@@ -284,6 +446,7 @@ void OpenXRAndroidTrackablesObjectExtension::free_object_context(RID p_object_co
 
 	wrapper->maybe_destroy_trackable_tracker(object_context->xrtrackable_tracker, object_context->xrtrackable_to_tracker);
 	object_context_owner.free(p_object_context);
+	object_contexts.erase(p_object_context);
 }
 
 void OpenXRAndroidTrackablesObjectExtension::_bind_methods() {
@@ -295,6 +458,14 @@ void OpenXRAndroidTrackablesObjectExtension::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("get_default_object_context"), &OpenXRAndroidTrackablesObjectExtension::get_default_object_context);
 	ClassDB::bind_method(D_METHOD("create_object_context", "object_labels"), &OpenXRAndroidTrackablesObjectExtension::create_object_context);
 	ClassDB::bind_method(D_METHOD("free_object_context", "object_context"), &OpenXRAndroidTrackablesObjectExtension::free_object_context);
+
+	ClassDB::bind_method(D_METHOD("get_tracked_object_count"), &OpenXRAndroidTrackablesObjectExtension::get_tracked_object_count);
+	ClassDB::bind_method(D_METHOD("get_tracked_object_transforms"), &OpenXRAndroidTrackablesObjectExtension::get_tracked_object_transforms);
+	ClassDB::bind_method(D_METHOD("get_tracked_object_extents"), &OpenXRAndroidTrackablesObjectExtension::get_tracked_object_extents);
+	ClassDB::bind_method(D_METHOD("get_tracked_object_labels"), &OpenXRAndroidTrackablesObjectExtension::get_tracked_object_labels);
+	ClassDB::bind_method(D_METHOD("get_tracked_object_trackers"), &OpenXRAndroidTrackablesObjectExtension::get_tracked_object_trackers);
+
+	ADD_SIGNAL(MethodInfo("tracked_objects_updated"));
 }
 
 bool OpenXRAndroidTrackablesObjectExtension::_initialize_openxr_android_trackables_object_extension() {
@@ -307,5 +478,7 @@ RID OpenXRAndroidTrackablesObjectExtension::_make_object_context(XrTrackableTrac
 		p_xrtrackable_tracker, // xrtrackable_tracker
 		{}, // xrtrackable_to_tracker
 	};
-	return object_context_owner.make_rid(object_context);
+	RID object_context_rid = object_context_owner.make_rid(object_context);
+	object_contexts.push_back(object_context_rid);
+	return object_context_rid;
 }
@@ -169,6 +169,9 @@ OpenXRFbBodyTrackingExtension::~OpenXRFbBodyTrackingExtension() {
 void OpenXRFbBodyTrackingExtension::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("is_full_body_tracking_supported"), &OpenXRFbBodyTrackingExtension::is_full_body_tracking_supported);
 
+	ClassDB::bind_method(D_METHOD("set_filter_settings", "filter_settings"), &OpenXRFbBodyTrackingExtension::set_filter_settings);
+	ClassDB::bind_method(D_METHOD("get_filter_settings"), &OpenXRFbBodyTrackingExtension::get_filter_settings);
+
 // @todo GH Issue 304: Remove check for meta headers when feature becomes part of OpenXR spec.
 #ifdef META_HEADERS_ENABLED
 	ClassDB::bind_method(D_METHOD("is_body_tracking_fidelity_supported"), &OpenXRFbBodyTrackingExtension::is_body_tracking_fidelity_supported);
@@ -384,7 +387,15 @@ void OpenXRFbBodyTrackingExtension::_on_process() {
 	// Set the tracking active flag
 	xr_body_tracker->set_has_tracking_data(locations.isActive);
 
-	// Process all joints
+	// Gather all joints into contiguous arrays
+	constexpr uint32_t joint_table_size = sizeof(joint_table) / sizeof(joint_table[0]);
+	uint32_t joint_count = 0;
+	Vector3 positions[joint_table_size];
+	Quaternion rotations[joint_table_size];
+	bool positions_valid[joint_table_size];
+	bool rotations_valid[joint_table_size];
+	int64_t joint_flags[joint_table_size];
+
 	for (const JointMapEntry &entry : joint_table) {
 		// Skip full body joints if extension is not supported.
 		if (!is_full_body_supported && entry.fb_joint >= XR_BODY_JOINT_COUNT_FB) {
@@ -394,28 +405,46 @@ void OpenXRFbBodyTrackingExtension::_on_process() {
 		// Process the joint pose
 		const XrBodyJointLocationFB &location = fb_locations[entry.fb_joint];
 		const XrPosef &pose = location.pose;
-		Transform3D transform;
 		BitField<XRBodyTracker::JointFlags> flags(0);
 
+		positions_valid[joint_count] = location.locationFlags & XR_SPACE_LOCATION_POSITION_VALID_BIT;
+		rotations_valid[joint_count] = location.locationFlags & XR_SPACE_LOCATION_ORIENTATION_VALID_BIT;
+		positions[joint_count] = positions_valid[joint_count] ? Vector3(pose.position.x, pose.position.y, pose.position.z) : Vector3();
+		rotations[joint_count] = rotations_valid[joint_count] ? Quaternion(pose.orientation.x, pose.orientation.y, pose.orientation.z, pose.orientation.w) * entry.rotation : Quaternion();
+
 		// Analyze the available joint data
-		if (location.locationFlags & XR_SPACE_LOCATION_ORIENTATION_VALID_BIT) {
+		if (rotations_valid[joint_count]) {
 			flags.set_flag(XRBodyTracker::JOINT_FLAG_ORIENTATION_VALID);
-			transform.basis = Basis(Quaternion(pose.orientation.x, pose.orientation.y, pose.orientation.z, pose.orientation.w) * entry.rotation);
 		}
 		if (location.locationFlags & XR_SPACE_LOCATION_ORIENTATION_TRACKED_BIT) {
 			flags.set_flag(XRBodyTracker::JOINT_FLAG_ORIENTATION_TRACKED);
 		}
-		if (location.locationFlags & XR_SPACE_LOCATION_POSITION_VALID_BIT) {
+		if (positions_valid[joint_count]) {
 			flags.set_flag(XRBodyTracker::JOINT_FLAG_POSITION_VALID);
-			transform.origin = Vector3(pose.position.x, pose.position.y, pose.position.z);
 		}
 		if (location.locationFlags & XR_SPACE_LOCATION_POSITION_TRACKED_BIT) {
 			flags.set_flag(XRBodyTracker::JOINT_FLAG_POSITION_TRACKED);
 		}
 
-		// Set the joint information
-		xr_body_tracker->set_joint_flags(entry.xr_joint, flags);
-		xr_body_tracker->set_joint_transform(entry.xr_joint, transform);
+		joint_flags[joint_count] = flags;
+		joint_count++;
+	}
+
+	// Smooth the joints if requested
+	if (filter_settings.is_valid() && locations.isActive) {
+		const OpenXROneEuroFilter::Parameters &parameters = filter_settings->get_parameters();
+		position_filter.filter_positions(positions, joint_count, display_time, parameters, positions_valid);
+		rotation_filter.filter_rotations(rotations, joint_count, display_time, parameters, rotations_valid);
+	} else {
+		position_filter.reset();
+		rotation_filter.reset();
+	}
+
+	// Set the joint information
+	for (uint32_t i = 0; i < joint_count; i++) {
+		const XRBodyTracker::Joint xr_joint = joint_table[i].xr_joint;
+		xr_body_tracker->set_joint_flags(xr_joint, BitField<XRBodyTracker::JointFlags>(joint_flags[i]));
+		xr_body_tracker->set_joint_transform(xr_joint, Transform3D(Basis(rotations[i]), positions[i]));
 	}
 
 	// If the location data is good then we need to apply some corrections
@@ -488,6 +517,14 @@ bool OpenXRFbBodyTrackingExtension::initialize_fb_body_tracking_extension(const
 
 // META_body_tracking_full_body extension.
 
+void OpenXRFbBodyTrackingExtension::set_filter_settings(const Ref<OpenXRTrackingFilterSettings> &p_filter_settings) {
+	filter_settings = p_filter_settings;
+}
+
+Ref<OpenXRTrackingFilterSettings> OpenXRFbBodyTrackingExtension::get_filter_settings() const {
+	return filter_settings;
+}
+
 bool OpenXRFbBodyTrackingExtension::is_full_body_tracking_supported() {
 	return system_body_tracking_full_body_properties.supportsFullBodyTracking;
 }
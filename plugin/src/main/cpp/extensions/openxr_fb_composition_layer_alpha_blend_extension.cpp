@@ -234,34 +234,36 @@ uint64_t OpenXRFbCompositionLayerAlphaBlendExtension::_set_projection_layer_and_
 }
 
 uint64_t OpenXRFbCompositionLayerAlphaBlendExtension::_set_viewport_composition_layer_and_get_next_pointer(const void *p_layer, const Dictionary &p_property_values, void *p_next_pointer) {
-	if (!fb_composition_layer_alpha_blend || !p_property_values.get(ENABLE_ALPHA_BLEND_EXTENSION_PROPERTY_NAME, false)) {
+	if (!fb_composition_layer_alpha_blend) {
 		return reinterpret_cast<uint64_t>(p_next_pointer);
 	}
 
-	const XrCompositionLayerBaseHeader *layer = reinterpret_cast<const XrCompositionLayerBaseHeader *>(p_layer);
+	bool changed = false;
+	OpenXRFbCompositionLayerStructCache<XrCompositionLayerAlphaBlendFB>::Entry *entry = layer_structs.get_entry(p_layer, p_property_values, (int64_t)get_openxr_api()->get_predicted_display_time(), changed);
 
-	if (!layer_structs.has(layer)) {
-		layer_structs[layer] = {
+	if (changed) {
+		entry->enabled = p_property_values.get(ENABLE_ALPHA_BLEND_EXTENSION_PROPERTY_NAME, false);
+		entry->data = {
 			XR_TYPE_COMPOSITION_LAYER_ALPHA_BLEND_FB, // type
-			p_next_pointer, // next
+			nullptr, // next
+			_from_blend_factor((BlendFactor)(int)p_property_values.get(SOURCE_COLOR_BLEND_FACTOR_PROPERTY_NAME, BLEND_FACTOR_ONE)), // srcFactorColor
+			_from_blend_factor((BlendFactor)(int)p_property_values.get(DESTINATION_COLOR_BLEND_FACTOR_PROPERTY_NAME, BLEND_FACTOR_ZERO)), // dstFactorColor
+			_from_blend_factor((BlendFactor)(int)p_property_values.get(SOURCE_ALPHA_BLEND_FACTOR_PROPERTY_NAME, BLEND_FACTOR_ONE)), // srcFactorAlpha
+			_from_blend_factor((BlendFactor)(int)p_property_values.get(DESTINATION_ALPHA_BLEND_FACTOR_PROPERTY_NAME, BLEND_FACTOR_ZERO)), // dstFactorAlpha
 		};
 	}
 
-	XrCompositionLayerAlphaBlendFB *alpha_blend = layer_structs.getptr(layer);
-
-	alpha_blend->srcFactorColor = _from_blend_factor((BlendFactor)(int)p_property_values.get(SOURCE_COLOR_BLEND_FACTOR_PROPERTY_NAME, BLEND_FACTOR_ONE));
-	alpha_blend->dstFactorColor = _from_blend_factor((BlendFactor)(int)p_property_values.get(DESTINATION_COLOR_BLEND_FACTOR_PROPERTY_NAME, BLEND_FACTOR_ZERO));
-	alpha_blend->srcFactorAlpha = _from_blend_factor((BlendFactor)(int)p_property_values.get(SOURCE_ALPHA_BLEND_FACTOR_PROPERTY_NAME, BLEND_FACTOR_ONE));
-	alpha_blend->dstFactorAlpha = _from_blend_factor((BlendFactor)(int)p_property_values.get(DESTINATION_ALPHA_BLEND_FACTOR_PROPERTY_NAME, BLEND_FACTOR_ZERO));
+	if (!entry->enabled) {
+		return reinterpret_cast<uint64_t>(p_next_pointer);
+	}
 
-	alpha_blend->next = p_next_pointer;
-	return reinterpret_cast<uint64_t>(alpha_blend);
+	entry->data.next = p_next_pointer;
+	return reinterpret_cast<uint64_t>(&entry->data);
 }
 
 void OpenXRFbCompositionLayerAlphaBlendExtension::_on_viewport_composition_layer_destroyed(const void *p_layer) {
 	if (fb_composition_layer_alpha_blend) {
-		const XrCompositionLayerBaseHeader *layer = reinterpret_cast<const XrCompositionLayerBaseHeader *>(p_layer);
-		layer_structs.erase(layer);
+		layer_structs.erase(p_layer);
 	}
 }
 
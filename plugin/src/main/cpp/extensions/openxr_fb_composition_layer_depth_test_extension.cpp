@@ -139,24 +139,29 @@ Dictionary OpenXRFbCompositionLayerDepthTestExtension::_get_requested_extensions
 }
 
 uint64_t OpenXRFbCompositionLayerDepthTestExtension::_set_viewport_composition_layer_and_get_next_pointer(const void *p_layer, const Dictionary &p_property_values, void *p_next_pointer) {
-	if (!fb_composition_layer_depth_test_ext || !(bool)p_property_values.get(ENABLE_PROPERTY_NAME, false)) {
+	if (!fb_composition_layer_depth_test_ext) {
 		return reinterpret_cast<uint64_t>(p_next_pointer);
 	}
 
-	const XrCompositionLayerBaseHeader *layer = reinterpret_cast<const XrCompositionLayerBaseHeader *>(p_layer);
+	bool changed = false;
+	OpenXRFbCompositionLayerStructCache<XrCompositionLayerDepthTestFB>::Entry *entry = layer_structs.get_entry(p_layer, p_property_values, (int64_t)get_openxr_api()->get_predicted_display_time(), changed);
 
-	if (!layer_structs.has(layer)) {
-		layer_structs[layer] = {
+	if (changed) {
+		entry->enabled = p_property_values.get(ENABLE_PROPERTY_NAME, false);
+		entry->data = {
 			XR_TYPE_COMPOSITION_LAYER_DEPTH_TEST_FB, // type
-			p_next_pointer, // next
+			nullptr, // next
 			true, // depthMask
 			XR_COMPARE_OP_LESS_FB // compareOp - Less depth = closer to the screen = keep this fragment
 		};
 	}
 
-	XrCompositionLayerDepthTestFB *depth_test = layer_structs.getptr(layer);
-	depth_test->next = p_next_pointer;
-	return reinterpret_cast<uint64_t>(depth_test);
+	if (!entry->enabled) {
+		return reinterpret_cast<uint64_t>(p_next_pointer);
+	}
+
+	entry->data.next = p_next_pointer;
+	return reinterpret_cast<uint64_t>(&entry->data);
 }
 
 uint64_t OpenXRFbCompositionLayerDepthTestExtension::_set_projection_layer_and_get_next_pointer(void *p_next_pointer) {
@@ -170,8 +175,7 @@ uint64_t OpenXRFbCompositionLayerDepthTestExtension::_set_projection_layer_and_g
 
 void OpenXRFbCompositionLayerDepthTestExtension::_on_viewport_composition_layer_destroyed(const void *p_layer) {
 	if (fb_composition_layer_depth_test_ext) {
-		const XrCompositionLayerBaseHeader *layer = reinterpret_cast<const XrCompositionLayerBaseHeader *>(p_layer);
-		layer_structs.erase(layer);
+		layer_structs.erase(p_layer);
 	}
 }
 
@@ -150,32 +150,26 @@ uint64_t OpenXRFbCompositionLayerImageLayoutExtension::_set_viewport_composition
 		return reinterpret_cast<uint64_t>(p_next_pointer);
 	}
 
-	const XrCompositionLayerBaseHeader *layer = reinterpret_cast<const XrCompositionLayerBaseHeader *>(p_layer);
+	bool changed = false;
+	OpenXRFbCompositionLayerStructCache<XrCompositionLayerImageLayoutFB>::Entry *entry = layer_structs.get_entry(p_layer, p_property_values, (int64_t)get_openxr_api()->get_predicted_display_time(), changed);
 
-	if (!layer_structs.has(layer)) {
-		layer_structs[layer] = {
+	if (changed) {
+		// The struct is always chained, so that turning the flip off is passed on too.
+		entry->enabled = true;
+		entry->data = {
 			XR_TYPE_COMPOSITION_LAYER_IMAGE_LAYOUT_FB, // type
-			p_next_pointer, // next
+			nullptr, // next
+			(bool)p_property_values.get(VERTICAL_FLIP_PROPERTY_NAME, false) ? XR_COMPOSITION_LAYER_IMAGE_LAYOUT_VERTICAL_FLIP_BIT_FB : 0, // flags
 		};
 	}
 
-	XrCompositionLayerImageLayoutFB *image_layout = layer_structs.getptr(layer);
-
-	image_layout->next = p_next_pointer;
-
-	if (p_property_values.get(VERTICAL_FLIP_PROPERTY_NAME, false)) {
-		image_layout->flags = XR_COMPOSITION_LAYER_IMAGE_LAYOUT_VERTICAL_FLIP_BIT_FB;
-	} else {
-		image_layout->flags = 0;
-	}
-
-	return reinterpret_cast<uint64_t>(image_layout);
+	entry->data.next = p_next_pointer;
+	return reinterpret_cast<uint64_t>(&entry->data);
 }
 
 void OpenXRFbCompositionLayerImageLayoutExtension::_on_viewport_composition_layer_destroyed(const void *p_layer) {
 	if (fb_composition_layer_image_layout) {
-		const XrCompositionLayerBaseHeader *layer = reinterpret_cast<const XrCompositionLayerBaseHeader *>(p_layer);
-		layer_structs.erase(layer);
+		layer_structs.erase(p_layer);
 	}
 }
 
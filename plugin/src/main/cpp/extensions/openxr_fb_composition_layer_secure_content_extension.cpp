@@ -164,43 +164,44 @@ uint64_t OpenXRFbCompositionLayerSecureContentExtension::_set_viewport_compositi
 		return reinterpret_cast<uint64_t>(p_next_pointer);
 	}
 
-	ExternalOutput external_output = (ExternalOutput)(int)p_property_values.get(EXTERNAL_OUTPUT_PROPERTY_NAME, EXTERNAL_OUTPUT_DISPLAY);
-	if (external_output == EXTERNAL_OUTPUT_DISPLAY) {
-		return reinterpret_cast<uint64_t>(p_next_pointer);
-	}
-
-	const XrCompositionLayerBaseHeader *layer = reinterpret_cast<const XrCompositionLayerBaseHeader *>(p_layer);
+	bool changed = false;
+	OpenXRFbCompositionLayerStructCache<XrCompositionLayerSecureContentFB>::Entry *entry = layer_structs.get_entry(p_layer, p_property_values, (int64_t)get_openxr_api()->get_predicted_display_time(), changed);
+
+	if (changed) {
+		XrCompositionLayerSecureContentFlagsFB flags = 0;
+
+		ExternalOutput external_output = (ExternalOutput)(int)p_property_values.get(EXTERNAL_OUTPUT_PROPERTY_NAME, EXTERNAL_OUTPUT_DISPLAY);
+		switch (external_output) {
+			case EXTERNAL_OUTPUT_DISPLAY: {
+				// Nothing to chain; this is the default behavior.
+			} break;
+			case EXTERNAL_OUTPUT_EXCLUDE: {
+				flags = XR_COMPOSITION_LAYER_SECURE_CONTENT_EXCLUDE_LAYER_BIT_FB;
+			} break;
+			case EXTERNAL_OUTPUT_REPLACE: {
+				flags = XR_COMPOSITION_LAYER_SECURE_CONTENT_REPLACE_LAYER_BIT_FB;
+			} break;
+		};
 
-	if (!layer_structs.has(layer)) {
-		layer_structs[layer] = {
+		entry->enabled = flags != 0;
+		entry->data = {
 			XR_TYPE_COMPOSITION_LAYER_SECURE_CONTENT_FB, // type
-			p_next_pointer, // next
-			0, // flags
+			nullptr, // next
+			flags, // flags
 		};
 	}
 
-	XrCompositionLayerSecureContentFB *secure_content = layer_structs.getptr(layer);
-
-	switch (external_output) {
-		case EXTERNAL_OUTPUT_DISPLAY: {
-			// We'll never reach this - it would have been handled above.
-		} break;
-		case EXTERNAL_OUTPUT_EXCLUDE: {
-			secure_content->flags = XR_COMPOSITION_LAYER_SECURE_CONTENT_EXCLUDE_LAYER_BIT_FB;
-		} break;
-		case EXTERNAL_OUTPUT_REPLACE: {
-			secure_content->flags = XR_COMPOSITION_LAYER_SECURE_CONTENT_REPLACE_LAYER_BIT_FB;
-		} break;
-	};
+	if (!entry->enabled) {
+		return reinterpret_cast<uint64_t>(p_next_pointer);
+	}
 
-	secure_content->next = p_next_pointer;
-	return reinterpret_cast<uint64_t>(secure_content);
+	entry->data.next = p_next_pointer;
+	return reinterpret_cast<uint64_t>(&entry->data);
 }
 
 void OpenXRFbCompositionLayerSecureContentExtension::_on_viewport_composition_layer_destroyed(const void *p_layer) {
 	if (fb_composition_layer_secure_content) {
-		const XrCompositionLayerBaseHeader *layer = reinterpret_cast<const XrCompositionLayerBaseHeader *>(p_layer);
-		layer_structs.erase(layer);
+		layer_structs.erase(p_layer);
 	}
 }
 
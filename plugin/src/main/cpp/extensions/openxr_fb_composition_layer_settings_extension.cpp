@@ -225,43 +225,47 @@ uint64_t OpenXRFbCompositionLayerSettingsExtension::_set_viewport_composition_la
 		return reinterpret_cast<uint64_t>(p_next_pointer);
 	}
 
-	const XrCompositionLayerBaseHeader *layer = reinterpret_cast<const XrCompositionLayerBaseHeader *>(p_layer);
-
-	if (!layer_structs.has(layer)) {
-		layer_structs[layer] = {
-			XR_TYPE_COMPOSITION_LAYER_SETTINGS_FB, // type
-			p_next_pointer, // next
-			0, // layerFlags
-		};
+	// Whether the automatic layer filter is available is part of what the structs are resolved from.
+	if (resolved_meta_automatic_layer_filter != meta_automatic_layer_filter) {
+		resolved_meta_automatic_layer_filter = meta_automatic_layer_filter;
+		layer_structs.invalidate();
 	}
 
-	XrCompositionLayerSettingsFB *settings = layer_structs.getptr(layer);
+	bool changed = false;
+	OpenXRFbCompositionLayerStructCache<XrCompositionLayerSettingsFB>::Entry *entry = layer_structs.get_entry(p_layer, p_property_values, (int64_t)get_openxr_api()->get_predicted_display_time(), changed);
 
-	settings->layerFlags = 0;
+	if (changed) {
+		XrCompositionLayerSettingsFlagsFB layer_flags = 0;
 
-	// Auto will always take priority over manual if auto is enabled and at least one auto option flag is selected.
-	if (meta_automatic_layer_filter && p_property_values.get(ENABLE_AUTO_FILTER_PROPERTY_NAME, false) && (int)p_property_values.get(AUTO_OPTIONS_PROPERTY_NAME, 0)) {
-		settings->layerFlags |= XR_COMPOSITION_LAYER_SETTINGS_AUTO_LAYER_FILTER_BIT_META;
-		settings->layerFlags |= (int)p_property_values.get(AUTO_OPTIONS_PROPERTY_NAME, 0);
+		// Auto will always take priority over manual if auto is enabled and at least one auto option flag is selected.
+		int auto_options = p_property_values.get(AUTO_OPTIONS_PROPERTY_NAME, 0);
+		if (meta_automatic_layer_filter && (bool)p_property_values.get(ENABLE_AUTO_FILTER_PROPERTY_NAME, false) && auto_options) {
+			layer_flags |= XR_COMPOSITION_LAYER_SETTINGS_AUTO_LAYER_FILTER_BIT_META;
+			layer_flags |= auto_options;
+		} else {
+			layer_flags |= _from_supersampling_mode((SupersamplingMode)(int)p_property_values.get(SUPERSAMPLING_MODE_PROPERTY_NAME, SUPERSAMPLING_MODE_DISABLED));
+			layer_flags |= _from_sharpening_mode((SharpeningMode)(int)p_property_values.get(SHARPENING_MODE_PROPERTY_NAME, SHARPENING_MODE_DISABLED));
+		}
 
-		return reinterpret_cast<uint64_t>(settings);
+		entry->enabled = layer_flags != 0;
+		entry->data = {
+			XR_TYPE_COMPOSITION_LAYER_SETTINGS_FB, // type
+			nullptr, // next
+			layer_flags, // layerFlags
+		};
 	}
 
-	settings->layerFlags |= _from_supersampling_mode((SupersamplingMode)(int)p_property_values.get(SUPERSAMPLING_MODE_PROPERTY_NAME, SUPERSAMPLING_MODE_DISABLED));
-	settings->layerFlags |= _from_sharpening_mode((SharpeningMode)(int)p_property_values.get(SHARPENING_MODE_PROPERTY_NAME, SHARPENING_MODE_DISABLED));
-
-	if (settings->layerFlags == 0) {
+	if (!entry->enabled) {
 		return reinterpret_cast<uint64_t>(p_next_pointer);
 	}
 
-	settings->next = p_next_pointer;
-	return reinterpret_cast<uint64_t>(settings);
+	entry->data.next = p_next_pointer;
+	return reinterpret_cast<uint64_t>(&entry->data);
 }
 
 void OpenXRFbCompositionLayerSettingsExtension::_on_viewport_composition_layer_destroyed(const void *p_layer) {
 	if (fb_composition_layer_settings) {
-		const XrCompositionLayerBaseHeader *layer = reinterpret_cast<const XrCompositionLayerBaseHeader *>(p_layer);
-		layer_structs.erase(layer);
+		layer_structs.erase(p_layer);
 	}
 }
 
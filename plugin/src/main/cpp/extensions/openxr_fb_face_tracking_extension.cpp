@@ -65,6 +65,16 @@ OpenXRFbFaceTrackingExtension::~OpenXRFbFaceTrackingExtension() {
 }
 
 void OpenXRFbFaceTrackingExtension::_bind_methods() {
+	ClassDB::bind_method(D_METHOD("set_filter_settings", "filter_settings"), &OpenXRFbFaceTrackingExtension::set_filter_settings);
+	ClassDB::bind_method(D_METHOD("get_filter_settings"), &OpenXRFbFaceTrackingExtension::get_filter_settings);
+}
+
+void OpenXRFbFaceTrackingExtension::set_filter_settings(const Ref<OpenXRTrackingFilterSettings> &p_filter_settings) {
+	filter_settings = p_filter_settings;
+}
+
+Ref<OpenXRTrackingFilterSettings> OpenXRFbFaceTrackingExtension::get_filter_settings() const {
+	return filter_settings;
 }
 
 void OpenXRFbFaceTrackingExtension::cleanup() {
@@ -344,6 +354,16 @@ void OpenXRFbFaceTrackingExtension::_on_process() {
 	xr_weights[XRFaceTracker::FT_MOUTH_TIGHTENER] = average(xr_weights[XRFaceTracker::FT_MOUTH_TIGHTENER_RIGHT], xr_weights[XRFaceTracker::FT_MOUTH_TIGHTENER_LEFT]);
 	xr_weights[XRFaceTracker::FT_MOUTH_PRESS] = average(xr_weights[XRFaceTracker::FT_MOUTH_PRESS_RIGHT], xr_weights[XRFaceTracker::FT_MOUTH_PRESS_LEFT]);
 
+	// Smooth the weights if requested
+	if (filter_settings.is_valid()) {
+		weight_filter.filter(xr_weights, XRFaceTracker::FT_MAX, 1, display_time, filter_settings->get_parameters());
+		for (float &weight : xr_weights) {
+			weight = CLAMP(weight, 0.0f, 1.0f);
+		}
+	} else {
+		weight_filter.reset();
+	}
+
 	// Populate the XRFaceTracker
 	PackedFloat32Array xr_weights_array;
 	xr_weights_array.resize(XRFaceTracker::FT_MAX);
@@ -29,12 +29,15 @@
 
 #include "extensions/openxr_fb_passthrough_extension.h"
 
+#include "classes/openxr_fb_passthrough_style.h"
+
 #include <godot_cpp/classes/image.hpp>
 #include <godot_cpp/classes/main_loop.hpp>
 #include <godot_cpp/classes/open_xrapi_extension.hpp>
 #include <godot_cpp/classes/os.hpp>
 #include <godot_cpp/classes/rendering_server.hpp>
 #include <godot_cpp/classes/scene_tree.hpp>
+#include <godot_cpp/classes/time.hpp>
 #include <godot_cpp/classes/viewport.hpp>
 #include <godot_cpp/classes/xr_server.hpp>
 #include <godot_cpp/templates/local_vector.hpp>
@@ -64,6 +67,8 @@ OpenXRFbPassthroughExtension::OpenXRFbPassthroughExtension() :
 }
 
 OpenXRFbPassthroughExtension::~OpenXRFbPassthroughExtension() {
+	// Cached color LUTs free themselves through this singleton, so they must go first.
+	OpenXRMetaPassthroughColorLut::clear_cache();
 	cleanup();
 	singleton = nullptr;
 }
@@ -84,8 +89,15 @@ void OpenXRFbPassthroughExtension::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("get_current_passthrough_filter"), &OpenXRFbPassthroughExtension::get_current_passthrough_filter);
 	ClassDB::bind_method(D_METHOD("set_color_map", "gradient"), &OpenXRFbPassthroughExtension::set_color_map);
 	ClassDB::bind_method(D_METHOD("set_mono_map", "curve"), &OpenXRFbPassthroughExtension::set_mono_map);
+	ClassDB::bind_method(D_METHOD("set_color_map_from_array", "colors"), &OpenXRFbPassthroughExtension::set_color_map_from_array);
+	ClassDB::bind_method(D_METHOD("set_mono_map_from_array", "values"), &OpenXRFbPassthroughExtension::set_mono_map_from_array);
 	ClassDB::bind_method(D_METHOD("set_brightness_contrast_saturation", "brightness", "contrast", "saturation"), &OpenXRFbPassthroughExtension::set_brightness_contrast_saturation);
 
+	ClassDB::bind_method(D_METHOD("set_style", "style"), &OpenXRFbPassthroughExtension::set_style);
+	ClassDB::bind_method(D_METHOD("animate_style", "style", "duration", "ease_curve"), &OpenXRFbPassthroughExtension::animate_style, DEFVAL(1.0));
+	ClassDB::bind_method(D_METHOD("stop_style_animation"), &OpenXRFbPassthroughExtension::stop_style_animation);
+	ClassDB::bind_method(D_METHOD("is_style_animating"), &OpenXRFbPassthroughExtension::is_style_animating);
+
 	ClassDB::bind_method(D_METHOD("has_passthrough_capability"), &OpenXRFbPassthroughExtension::has_passthrough_capability);
 	ClassDB::bind_method(D_METHOD("has_color_passthrough_capability"), &OpenXRFbPassthroughExtension::has_color_passthrough_capability);
 	ClassDB::bind_method(D_METHOD("has_layer_depth_passthrough_capability"), &OpenXRFbPassthroughExtension::has_layer_depth_passthrough_capability);
@@ -99,6 +111,7 @@ void OpenXRFbPassthroughExtension::_bind_methods() {
 	ADD_SIGNAL(MethodInfo("openxr_fb_projected_passthrough_layer_created"));
 	ADD_SIGNAL(MethodInfo("openxr_fb_passthrough_stopped"));
 	ADD_SIGNAL(MethodInfo("openxr_fb_passthrough_state_changed", PropertyInfo(Variant::INT, "event_type")));
+	ADD_SIGNAL(MethodInfo("openxr_fb_passthrough_style_animation_finished"));
 
 	BIND_ENUM_CONSTANT(LAYER_PURPOSE_NONE);
 	BIND_ENUM_CONSTANT(LAYER_PURPOSE_RECONSTRUCTION);
@@ -226,6 +239,8 @@ void OpenXRFbPassthroughExtension::_on_process() {
 		return;
 	}
 
+	_update_style_animation();
+
 	XRInterface::EnvironmentBlendMode blend_mode = get_blend_mode();
 
 	// Reconstruction layer will always take priority
@@ -450,16 +465,27 @@ void OpenXRFbPassthroughExtension::_stop_passthrough_rt() {
 }
 
 RID OpenXRFbPassthroughExtension::geometry_instance_create(const Array &p_array_mesh, const Transform3D &p_transform) {
+	ERR_FAIL_COND_V(p_array_mesh.size() != Mesh::ARRAY_MAX, RID());
+
+	// The surface arrays already hold packed arrays, so this doesn't copy anything.
+	return geometry_instance_create(p_array_mesh[Mesh::ARRAY_VERTEX], p_array_mesh[Mesh::ARRAY_INDEX], p_transform);
+}
+
+RID OpenXRFbPassthroughExtension::geometry_instance_create(const PackedVector3Array &p_vertices, const PackedInt32Array &p_indices, const Transform3D &p_transform) {
+	ERR_FAIL_COND_V_MSG(p_vertices.is_empty(), RID(), "Passthrough geometry needs at least one triangle.");
+	ERR_FAIL_COND_V_MSG(p_indices.is_empty() && p_vertices.size() % 3 != 0, RID(), "Passthrough geometry vertex count must be a multiple of 3 when no indices are given.");
+	ERR_FAIL_COND_V_MSG(p_indices.size() % 3 != 0, RID(), "Passthrough geometry index count must be a multiple of 3.");
+
 	if (current_passthrough_layer != LAYER_PURPOSE_PROJECTED) {
 		start_passthrough_layer(LAYER_PURPOSE_PROJECTED);
 	}
 
 	RID ret = geometry_instances.make_rid();
-	RenderingServer::get_singleton()->call_on_render_thread(callable_mp(this, &OpenXRFbPassthroughExtension::_geometry_instance_initialize_rt).bind(ret, p_array_mesh, p_transform));
+	RenderingServer::get_singleton()->call_on_render_thread(callable_mp(this, &OpenXRFbPassthroughExtension::_geometry_instance_initialize_rt).bind(ret, p_vertices, p_indices, p_transform));
 	return ret;
 }
 
-void OpenXRFbPassthroughExtension::_geometry_instance_initialize_rt(RID p_geometry_instance, const Array &p_array_mesh, const Transform3D &p_transform) {
+void OpenXRFbPassthroughExtension::_geometry_instance_initialize_rt(RID p_geometry_instance, const PackedVector3Array &p_vertices, const PackedInt32Array &p_indices, const Transform3D &p_transform) {
 	GeometryInstance *geometry_instance = geometry_instances.get_or_null(p_geometry_instance);
 
 	if (geometry_instance == nullptr) {
@@ -476,23 +502,37 @@ void OpenXRFbPassthroughExtension::_geometry_instance_initialize_rt(RID p_geomet
 		return;
 	}
 
-	Array vertex_array = p_array_mesh[Mesh::ARRAY_VERTEX];
-	LocalVector<XrVector3f> vertices;
-	vertices.resize(vertex_array.size());
-	for (int j = 0; j < vertex_array.size(); j++) {
-		Vector3 vertex = vertex_array[j];
-		vertices[j] = {
-			static_cast<float>(vertex.x),
-			static_cast<float>(vertex.y),
-			static_cast<float>(vertex.z)
+#ifdef REAL_T_IS_DOUBLE
+	LocalVector<XrVector3f> vertex_buffer;
+	vertex_buffer.resize(p_vertices.size());
+	const Vector3 *vertex_ptr = p_vertices.ptr();
+	for (int64_t i = 0; i < p_vertices.size(); i++) {
+		vertex_buffer[i] = {
+			static_cast<float>(vertex_ptr[i].x),
+			static_cast<float>(vertex_ptr[i].y),
+			static_cast<float>(vertex_ptr[i].z)
 		};
 	}
-
-	Array index_array = p_array_mesh[Mesh::ARRAY_INDEX];
-	LocalVector<uint32_t> indices;
-	indices.resize(index_array.size());
-	for (int j = 0; j < index_array.size(); j++) {
-		indices[j] = index_array[j];
+	const XrVector3f *vertices = vertex_buffer.ptr();
+#else
+	// With single precision, Vector3 has the same layout as XrVector3f, so the packed array can be handed over as is.
+	static_assert(sizeof(Vector3) == sizeof(XrVector3f));
+	const XrVector3f *vertices = reinterpret_cast<const XrVector3f *>(p_vertices.ptr());
+#endif
+
+	LocalVector<uint32_t> index_buffer;
+	const uint32_t *indices = nullptr;
+	uint32_t index_count = 0;
+	if (p_indices.is_empty()) {
+		index_buffer.resize(p_vertices.size());
+		for (uint32_t i = 0; i < index_buffer.size(); i++) {
+			index_buffer[i] = i;
+		}
+		indices = index_buffer.ptr();
+		index_count = index_buffer.size();
+	} else {
+		indices = reinterpret_cast<const uint32_t *>(p_indices.ptr());
+		index_count = p_indices.size();
 	}
 
 	XrTriangleMeshFB mesh = XR_NULL_HANDLE;
@@ -501,10 +541,10 @@ void OpenXRFbPassthroughExtension::_geometry_instance_initialize_rt(RID p_geomet
 		nullptr, // next
 		0, // flags
 		XR_WINDING_ORDER_CW_FB, // windingOrder
-		(uint32_t)vertex_array.size(), // vertexCount
-		vertices.ptr(), // vertexBuffer
-		(uint32_t)index_array.size(), // triangleCount
-		indices.ptr(), // indexBuffer
+		(uint32_t)p_vertices.size(), // vertexCount
+		vertices, // vertexBuffer
+		index_count / 3, // triangleCount
+		indices, // indexBuffer
 	};
 
 	XrResult result = xrCreateTriangleMeshFB(SESSION, &triangle_mesh_info, &mesh);
@@ -623,52 +663,56 @@ void OpenXRFbPassthroughExtension::_geometry_instance_free_rt(RID p_geometry_ins
 	geometry_instances.free(p_geometry_instance);
 }
 
-void OpenXRFbPassthroughExtension::set_texture_opacity_factor(float p_value) {
-	texture_opacity_factor = p_value;
-	RenderingServer::get_singleton()->call_on_render_thread(callable_mp(this, &OpenXRFbPassthroughExtension::_set_texture_opacity_factor_rt).bind(p_value));
+void OpenXRFbPassthroughExtension::hole_punch_update(uint64_t p_owner, RID p_scenario, const Ref<Mesh> &p_mesh, const Transform3D &p_transform) {
+	if (hole_punch_batcher.update(p_owner, p_scenario, p_mesh, p_transform)) {
+		_queue_hole_punch_flush();
+	}
 }
 
-void OpenXRFbPassthroughExtension::_set_texture_opacity_factor_rt(float p_value) {
-	render_state.passthrough_style.textureOpacityFactor = p_value;
+void OpenXRFbPassthroughExtension::hole_punch_free(uint64_t p_owner) {
+	if (hole_punch_batcher.remove(p_owner)) {
+		_queue_hole_punch_flush();
+	}
+}
 
-	if (render_state.passthrough_started) {
-		XrResult result = xrPassthroughLayerSetStyleFB(render_state.passthrough_layer[render_state.current_passthrough_layer], &render_state.passthrough_style);
-		if (XR_FAILED(result)) {
-			UtilityFunctions::print("Failed to set passthrough style, error code: ", result);
-		}
+void OpenXRFbPassthroughExtension::_queue_hole_punch_flush() {
+	if (hole_punch_flush_queued) {
+		return;
 	}
+
+	hole_punch_flush_queued = true;
+	callable_mp(this, &OpenXRFbPassthroughExtension::_flush_hole_punch).call_deferred();
 }
 
-float OpenXRFbPassthroughExtension::get_texture_opacity_factor() {
-	return texture_opacity_factor;
+void OpenXRFbPassthroughExtension::_flush_hole_punch() {
+	hole_punch_flush_queued = false;
+	hole_punch_batcher.flush();
 }
 
-void OpenXRFbPassthroughExtension::set_edge_color(Color p_color) {
-	edge_color = p_color;
-	RenderingServer::get_singleton()->call_on_render_thread(callable_mp(this, &OpenXRFbPassthroughExtension::_set_edge_color_rt).bind(p_color));
+void OpenXRFbPassthroughExtension::set_texture_opacity_factor(float p_value) {
+	style_state.texture_opacity_factor = p_value;
+	_queue_style_update();
 }
 
-void OpenXRFbPassthroughExtension::_set_edge_color_rt(Color p_color) {
-	render_state.passthrough_style.edgeColor = { p_color.r, p_color.g, p_color.b, p_color.a };
+float OpenXRFbPassthroughExtension::get_texture_opacity_factor() {
+	return style_state.texture_opacity_factor;
+}
 
-	if (render_state.passthrough_started) {
-		XrResult result = xrPassthroughLayerSetStyleFB(render_state.passthrough_layer[current_passthrough_layer], &render_state.passthrough_style);
-		if (XR_FAILED(result)) {
-			UtilityFunctions::print("Failed to set passthrough style, error code: ", result);
-		}
-	}
+void OpenXRFbPassthroughExtension::set_edge_color(Color p_color) {
+	style_state.edge_color = p_color;
+	_queue_style_update();
 }
 
 Color OpenXRFbPassthroughExtension::get_edge_color() {
-	return edge_color;
+	return style_state.edge_color;
 }
 
 void OpenXRFbPassthroughExtension::set_passthrough_filter(PassthroughFilter p_filter) {
-	current_passthrough_filter = p_filter;
-	RenderingServer::get_singleton()->call_on_render_thread(callable_mp(this, &OpenXRFbPassthroughExtension::_set_passthrough_filter_rt).bind(p_filter));
+	style_state.filter = p_filter;
+	_queue_style_update();
 }
 
-void OpenXRFbPassthroughExtension::_set_passthrough_filter_rt(PassthroughFilter p_filter) {
+bool OpenXRFbPassthroughExtension::_update_passthrough_filter_rt(PassthroughFilter p_filter) {
 	switch (p_filter) {
 		case PASSTHROUGH_FILTER_DISABLED: {
 			render_state.passthrough_style.next = nullptr;
@@ -685,21 +729,30 @@ void OpenXRFbPassthroughExtension::_set_passthrough_filter_rt(PassthroughFilter
 		case PASSTHROUGH_FILTER_COLOR_MAP_LUT: {
 			if (render_state.color_lut_handle == XR_NULL_HANDLE) {
 				UtilityFunctions::print("Cannot set filter to color map LUT, color LUT has not been previously set");
-				return;
+				return false;
 			}
 			render_state.passthrough_style.next = &render_state.color_map_lut;
 		} break;
 		case PASSTHROUGH_FILTER_COLOR_MAP_INTERPOLATED_LUT: {
 			if (render_state.source_color_lut_handle == XR_NULL_HANDLE || render_state.target_color_lut_handle == XR_NULL_HANDLE) {
 				UtilityFunctions::print("Cannot set filter to color map interpolated LUT, interpolated color LUT has not been previously set");
-				return;
+				return false;
 			}
 			render_state.passthrough_style.next = &render_state.color_map_interpolated_lut;
 		} break;
 	}
 
 	render_state.current_passthrough_filter = p_filter;
+	return true;
+}
 
+void OpenXRFbPassthroughExtension::_set_passthrough_filter_rt(PassthroughFilter p_filter) {
+	if (_update_passthrough_filter_rt(p_filter)) {
+		_submit_passthrough_style_rt();
+	}
+}
+
+void OpenXRFbPassthroughExtension::_submit_passthrough_style_rt() {
 	if (render_state.passthrough_started) {
 		XrResult result = xrPassthroughLayerSetStyleFB(render_state.passthrough_layer[render_state.current_passthrough_layer], &render_state.passthrough_style);
 		if (XR_FAILED(result)) {
@@ -710,47 +763,114 @@ void OpenXRFbPassthroughExtension::_set_passthrough_filter_rt(PassthroughFilter
 
 void OpenXRFbPassthroughExtension::set_color_map(const Ref<Gradient> &p_gradient) {
 	ERR_FAIL_COND(p_gradient.is_null());
-	current_passthrough_filter = PASSTHROUGH_FILTER_COLOR_MAP;
-	RenderingServer::get_singleton()->call_on_render_thread(callable_mp(this, &OpenXRFbPassthroughExtension::_set_color_map_rt).bind(p_gradient));
+	style_state.filter = PASSTHROUGH_FILTER_COLOR_MAP;
+	style_state.color_map = _get_color_map_table(p_gradient);
+	_queue_style_update();
 }
 
-void OpenXRFbPassthroughExtension::_set_color_map_rt(const Ref<Gradient> &p_gradient) {
-	for (int i = 0; i < XR_PASSTHROUGH_COLOR_MAP_MONO_SIZE_FB; i++) {
-		Color sample_color = p_gradient->sample((double)i / (double)XR_PASSTHROUGH_COLOR_MAP_MONO_SIZE_FB);
-		render_state.color_map.textureColorMap[i] = { sample_color.r, sample_color.g, sample_color.b, sample_color.a };
+void OpenXRFbPassthroughExtension::set_color_map_from_array(const PackedColorArray &p_colors) {
+	ERR_FAIL_COND_MSG(p_colors.size() != XR_PASSTHROUGH_COLOR_MAP_MONO_SIZE_FB, vformat("Color map must contain exactly %d colors", XR_PASSTHROUGH_COLOR_MAP_MONO_SIZE_FB));
+	style_state.filter = PASSTHROUGH_FILTER_COLOR_MAP;
+	style_state.color_map = p_colors;
+	_queue_style_update();
+}
+
+void OpenXRFbPassthroughExtension::set_mono_map(const Ref<Curve> &p_curve) {
+	ERR_FAIL_COND(p_curve.is_null());
+	style_state.filter = PASSTHROUGH_FILTER_MONO_MAP;
+	style_state.mono_map = _get_mono_map_table(p_curve);
+	_queue_style_update();
+}
+
+void OpenXRFbPassthroughExtension::set_mono_map_from_array(const PackedByteArray &p_values) {
+	ERR_FAIL_COND_MSG(p_values.size() != XR_PASSTHROUGH_COLOR_MAP_MONO_SIZE_FB, vformat("Mono map must contain exactly %d values", XR_PASSTHROUGH_COLOR_MAP_MONO_SIZE_FB));
+	style_state.filter = PASSTHROUGH_FILTER_MONO_MAP;
+	style_state.mono_map = p_values;
+	_queue_style_update();
+}
+
+PackedColorArray OpenXRFbPassthroughExtension::_get_color_map_table(const Ref<Gradient> &p_gradient) {
+	uint64_t id = p_gradient->get_instance_id();
+
+	ColorMapTable *entry = color_map_tables.getptr(id);
+	if (entry == nullptr) {
+		_prune_map_tables();
+		entry = &color_map_tables.insert(id, ColorMapTable())->value;
+		p_gradient->connect("changed", callable_mp(this, &OpenXRFbPassthroughExtension::_on_color_map_changed).bind(id));
+	}
+
+	if (entry->dirty) {
+		entry->table.resize(XR_PASSTHROUGH_COLOR_MAP_MONO_SIZE_FB);
+		Color *table = entry->table.ptrw();
+		for (int i = 0; i < XR_PASSTHROUGH_COLOR_MAP_MONO_SIZE_FB; i++) {
+			// Same normalization as the identity maps, so a black to white gradient is the identity.
+			table[i] = p_gradient->sample((double)i / (double)(XR_PASSTHROUGH_COLOR_MAP_MONO_SIZE_FB - 1));
+		}
+		entry->dirty = false;
 	}
 
-	render_state.current_passthrough_filter = PASSTHROUGH_FILTER_COLOR_MAP;
-	render_state.passthrough_style.next = &render_state.color_map;
+	return entry->table;
+}
 
-	if (render_state.passthrough_started) {
-		XrResult result = xrPassthroughLayerSetStyleFB(render_state.passthrough_layer[render_state.current_passthrough_layer], &render_state.passthrough_style);
-		if (XR_FAILED(result)) {
-			UtilityFunctions::print("Failed to set passthrough style, error code: ", result);
+PackedByteArray OpenXRFbPassthroughExtension::_get_mono_map_table(const Ref<Curve> &p_curve) {
+	uint64_t id = p_curve->get_instance_id();
+
+	MonoMapTable *entry = mono_map_tables.getptr(id);
+	if (entry == nullptr) {
+		_prune_map_tables();
+		entry = &mono_map_tables.insert(id, MonoMapTable())->value;
+		p_curve->connect("changed", callable_mp(this, &OpenXRFbPassthroughExtension::_on_mono_map_changed).bind(id));
+	}
+
+	if (entry->dirty) {
+		entry->table.resize(XR_PASSTHROUGH_COLOR_MAP_MONO_SIZE_FB);
+		uint8_t *table = entry->table.ptrw();
+		for (int i = 0; i < XR_PASSTHROUGH_COLOR_MAP_MONO_SIZE_FB; i++) {
+			// Clamp, since samples outside of 0 to 1 would otherwise wrap around.
+			double value = p_curve->sample((double)i / (double)(XR_PASSTHROUGH_COLOR_MAP_MONO_SIZE_FB - 1));
+			table[i] = CLAMP(Math::round(value * 255.0), 0.0, 255.0);
 		}
+		entry->dirty = false;
 	}
+
+	return entry->table;
 }
 
-void OpenXRFbPassthroughExtension::set_mono_map(const Ref<Curve> &p_curve) {
-	ERR_FAIL_COND(p_curve.is_null());
-	current_passthrough_filter = PASSTHROUGH_FILTER_MONO_MAP;
-	RenderingServer::get_singleton()->call_on_render_thread(callable_mp(this, &OpenXRFbPassthroughExtension::_set_mono_map_rt).bind(p_curve));
+void OpenXRFbPassthroughExtension::_on_color_map_changed(uint64_t p_id) {
+	ColorMapTable *entry = color_map_tables.getptr(p_id);
+	if (entry) {
+		entry->dirty = true;
+	}
 }
 
-void OpenXRFbPassthroughExtension::_set_mono_map_rt(const Ref<Curve> &p_curve) {
-	for (int i = 0; i < XR_PASSTHROUGH_COLOR_MAP_MONO_SIZE_FB; i++) {
-		render_state.mono_map.textureColorMap[i] = p_curve->sample((double)i / (double)XR_PASSTHROUGH_COLOR_MAP_MONO_SIZE_FB) * XR_PASSTHROUGH_COLOR_MAP_MONO_SIZE_FB;
+void OpenXRFbPassthroughExtension::_on_mono_map_changed(uint64_t p_id) {
+	MonoMapTable *entry = mono_map_tables.getptr(p_id);
+	if (entry) {
+		entry->dirty = true;
 	}
+}
 
-	render_state.current_passthrough_filter = PASSTHROUGH_FILTER_MONO_MAP;
-	render_state.passthrough_style.next = &render_state.mono_map;
+void OpenXRFbPassthroughExtension::_prune_map_tables() {
+	// Drop the tables of resources that have since been freed.
+	LocalVector<uint64_t> freed;
+	for (const KeyValue<uint64_t, ColorMapTable> &E : color_map_tables) {
+		if (ObjectDB::get_instance(E.key) == nullptr) {
+			freed.push_back(E.key);
+		}
+	}
+	for (uint64_t id : freed) {
+		color_map_tables.erase(id);
+	}
 
-	if (render_state.passthrough_started) {
-		XrResult result = xrPassthroughLayerSetStyleFB(render_state.passthrough_layer[render_state.current_passthrough_layer], &render_state.passthrough_style);
-		if (XR_FAILED(result)) {
-			UtilityFunctions::print("Failed to set passthrough style, error code: ", result);
+	freed.clear();
+	for (const KeyValue<uint64_t, MonoMapTable> &E : mono_map_tables) {
+		if (ObjectDB::get_instance(E.key) == nullptr) {
+			freed.push_back(E.key);
 		}
 	}
+	for (uint64_t id : freed) {
+		mono_map_tables.erase(id);
+	}
 }
 
 void OpenXRFbPassthroughExtension::set_brightness_contrast_saturation(float p_brightness, float p_contrast, float p_saturation) {
@@ -760,27 +880,267 @@ void OpenXRFbPassthroughExtension::set_brightness_contrast_saturation(float p_br
 	ERR_FAIL_COND_MSG(p_contrast < 0.0, vformat("Contrast value %d is not greater than or equal to zero", p_contrast));
 	ERR_FAIL_COND_MSG(p_saturation < 0.0, vformat("Saturation value %d is not greater than or equal to zero", p_saturation));
 
-	current_passthrough_filter = PASSTHROUGH_FILTER_BRIGHTNESS_CONTRAST_SATURATION;
+	style_state.filter = PASSTHROUGH_FILTER_BRIGHTNESS_CONTRAST_SATURATION;
+	style_state.brightness_contrast_saturation = Vector3(p_brightness, p_contrast, p_saturation);
+	_queue_style_update();
+}
 
-	RenderingServer::get_singleton()->call_on_render_thread(callable_mp(this, &OpenXRFbPassthroughExtension::_set_brightness_contrast_saturation_rt).bind(p_brightness, p_contrast, p_saturation));
+void OpenXRFbPassthroughExtension::_queue_style_update() {
+	if (style_update_queued) {
+		return;
+	}
+
+	// Flushed once at the end of the frame, so any number of style changes made
+	// this frame result in a single xrPassthroughLayerSetStyleFB() call.
+	style_update_queued = true;
+	callable_mp(this, &OpenXRFbPassthroughExtension::_flush_style_update).call_deferred();
 }
 
-void OpenXRFbPassthroughExtension::_set_brightness_contrast_saturation_rt(float p_brightness, float p_contrast, float p_saturation) {
-	render_state.brightness_contrast_saturation.brightness = p_brightness;
-	render_state.brightness_contrast_saturation.contrast = p_contrast;
-	render_state.brightness_contrast_saturation.saturation = p_saturation;
+void OpenXRFbPassthroughExtension::_flush_style_update() {
+	style_update_queued = false;
 
-	render_state.current_passthrough_filter = PASSTHROUGH_FILTER_BRIGHTNESS_CONTRAST_SATURATION;
-	render_state.passthrough_style.next = &render_state.brightness_contrast_saturation;
+	RenderingServer::get_singleton()->call_on_render_thread(callable_mp(this, &OpenXRFbPassthroughExtension::_set_passthrough_style_rt).bind(style_state.texture_opacity_factor, style_state.edge_color, (int)style_state.filter, style_state.brightness_contrast_saturation, style_state.color_map, style_state.mono_map));
+}
 
-	if (render_state.passthrough_started) {
-		XrResult result = xrPassthroughLayerSetStyleFB(render_state.passthrough_layer[render_state.current_passthrough_layer], &render_state.passthrough_style);
-		if (XR_FAILED(result)) {
-			UtilityFunctions::print("Failed to set passthrough style, error code: ", result);
+void OpenXRFbPassthroughExtension::_set_passthrough_style_rt(float p_texture_opacity_factor, const Color &p_edge_color, int p_filter, const Vector3 &p_brightness_contrast_saturation, const PackedColorArray &p_color_map, const PackedByteArray &p_mono_map) {
+	render_state.passthrough_style.textureOpacityFactor = p_texture_opacity_factor;
+	render_state.passthrough_style.edgeColor = { p_edge_color.r, p_edge_color.g, p_edge_color.b, p_edge_color.a };
+
+	PassthroughFilter filter = (PassthroughFilter)p_filter;
+	switch (filter) {
+		case PASSTHROUGH_FILTER_COLOR_MAP: {
+			if (p_color_map.size() == XR_PASSTHROUGH_COLOR_MAP_MONO_SIZE_FB) {
+				const Color *table = p_color_map.ptr();
+				for (int i = 0; i < XR_PASSTHROUGH_COLOR_MAP_MONO_SIZE_FB; i++) {
+					render_state.color_map.textureColorMap[i] = { table[i].r, table[i].g, table[i].b, table[i].a };
+				}
+			}
+		} break;
+		case PASSTHROUGH_FILTER_MONO_MAP: {
+			if (p_mono_map.size() == XR_PASSTHROUGH_COLOR_MAP_MONO_SIZE_FB) {
+				memcpy(render_state.mono_map.textureColorMap, p_mono_map.ptr(), XR_PASSTHROUGH_COLOR_MAP_MONO_SIZE_FB);
+			}
+		} break;
+		case PASSTHROUGH_FILTER_BRIGHTNESS_CONTRAST_SATURATION: {
+			render_state.brightness_contrast_saturation.brightness = p_brightness_contrast_saturation.x;
+			render_state.brightness_contrast_saturation.contrast = p_brightness_contrast_saturation.y;
+			render_state.brightness_contrast_saturation.saturation = p_brightness_contrast_saturation.z;
+		} break;
+		default:
+			break;
+	}
+
+	// Even if the filter can't be applied, the opacity and edge color still need submitting.
+	if (!_update_passthrough_filter_rt(filter)) {
+		_update_passthrough_filter_rt(PASSTHROUGH_FILTER_DISABLED);
+		callable_mp(this, &OpenXRFbPassthroughExtension::_reset_color_lut_filter).call_deferred();
+	}
+	_submit_passthrough_style_rt();
+}
+
+void OpenXRFbPassthroughExtension::_reset_color_lut_filter() {
+	// The color LUT the filter referenced is gone, so don't keep asking for it on every style update.
+	if (style_state.filter == PASSTHROUGH_FILTER_COLOR_MAP_LUT || style_state.filter == PASSTHROUGH_FILTER_COLOR_MAP_INTERPOLATED_LUT) {
+		style_state.filter = PASSTHROUGH_FILTER_DISABLED;
+	}
+}
+
+OpenXRFbPassthroughExtension::StyleState OpenXRFbPassthroughExtension::_make_style_state(const Ref<OpenXRFbPassthroughStyle> &p_style) {
+	StyleState state;
+	state.texture_opacity_factor = p_style->get_texture_opacity_factor();
+	state.edge_color = p_style->get_edge_color();
+	state.filter = p_style->get_filter();
+	state.brightness_contrast_saturation = Vector3(p_style->get_brightness(), p_style->get_contrast(), p_style->get_saturation());
+
+	if (state.filter == PASSTHROUGH_FILTER_COLOR_MAP) {
+		if (p_style->get_color_map().is_valid()) {
+			state.color_map = _get_color_map_table(p_style->get_color_map());
+		} else {
+			state.color_map = _get_identity_color_map();
+		}
+	} else if (state.filter == PASSTHROUGH_FILTER_MONO_MAP) {
+		if (p_style->get_mono_map().is_valid()) {
+			state.mono_map = _get_mono_map_table(p_style->get_mono_map());
+		} else {
+			state.mono_map = _get_identity_mono_map();
+		}
+	}
+
+	return state;
+}
+
+PackedColorArray OpenXRFbPassthroughExtension::_get_identity_color_map() {
+	PackedColorArray table;
+	table.resize(XR_PASSTHROUGH_COLOR_MAP_MONO_SIZE_FB);
+	Color *ptr = table.ptrw();
+	for (int i = 0; i < XR_PASSTHROUGH_COLOR_MAP_MONO_SIZE_FB; i++) {
+		float value = (float)i / (float)(XR_PASSTHROUGH_COLOR_MAP_MONO_SIZE_FB - 1);
+		ptr[i] = Color(value, value, value, 1.0);
+	}
+	return table;
+}
+
+PackedByteArray OpenXRFbPassthroughExtension::_get_identity_mono_map() {
+	PackedByteArray table;
+	table.resize(XR_PASSTHROUGH_COLOR_MAP_MONO_SIZE_FB);
+	uint8_t *ptr = table.ptrw();
+	for (int i = 0; i < XR_PASSTHROUGH_COLOR_MAP_MONO_SIZE_FB; i++) {
+		ptr[i] = i;
+	}
+	return table;
+}
+
+void OpenXRFbPassthroughExtension::set_style(const Ref<OpenXRFbPassthroughStyle> &p_style) {
+	ERR_FAIL_COND(p_style.is_null());
+
+	stop_style_animation();
+	style_state = _make_style_state(p_style);
+	_queue_style_update();
+}
+
+void OpenXRFbPassthroughExtension::animate_style(const Ref<OpenXRFbPassthroughStyle> &p_style, float p_duration, float p_ease_curve) {
+	ERR_FAIL_COND(p_style.is_null());
+	ERR_FAIL_COND_MSG(p_duration < 0.0, "Style animation duration must not be negative.");
+
+	// Sample the style now, so later edits to the resource don't affect queued keyframes.
+	StyleKeyframe keyframe;
+	keyframe.target = _make_style_state(p_style);
+	keyframe.duration = p_duration;
+	keyframe.ease_curve = p_ease_curve;
+	style_keyframes.push_back(keyframe);
+}
+
+void OpenXRFbPassthroughExtension::stop_style_animation() {
+	style_keyframes.clear();
+	style_animation.active = false;
+}
+
+bool OpenXRFbPassthroughExtension::is_style_animating() const {
+	return !style_keyframes.is_empty();
+}
+
+void OpenXRFbPassthroughExtension::_begin_style_keyframe() {
+	const StyleState &target = style_keyframes[0].target;
+
+	style_animation.from = style_state;
+	style_animation.to = target;
+	style_animation.filter = target.filter;
+	style_animation.elapsed = 0.0;
+	style_animation.last_ticks = Time::get_singleton()->get_ticks_usec();
+	style_animation.active = true;
+
+	// Only one filter can be active at a time, so pick a filter both ends can be
+	// expressed in. A disabled filter becomes the identity of the other filter, and
+	// a mono map can be promoted to a color map. Any other change of filter snaps,
+	// while the opacity and edge color still interpolate.
+	PassthroughFilter from_filter = style_animation.from.filter;
+	PassthroughFilter to_filter = target.filter;
+	if (from_filter == to_filter) {
+		return;
+	}
+
+	StyleState &from = style_animation.from;
+	StyleState &to = style_animation.to;
+	if (from_filter == PASSTHROUGH_FILTER_DISABLED) {
+		from.filter = to_filter;
+		from.brightness_contrast_saturation = Vector3(0.0, 1.0, 1.0);
+		from.color_map = _get_identity_color_map();
+		from.mono_map = _get_identity_mono_map();
+	} else if (to_filter == PASSTHROUGH_FILTER_DISABLED && from_filter <= PASSTHROUGH_FILTER_BRIGHTNESS_CONTRAST_SATURATION) {
+		style_animation.filter = from_filter;
+		to.brightness_contrast_saturation = Vector3(0.0, 1.0, 1.0);
+		to.color_map = _get_identity_color_map();
+		to.mono_map = _get_identity_mono_map();
+	} else if ((from_filter == PASSTHROUGH_FILTER_MONO_MAP && to_filter == PASSTHROUGH_FILTER_COLOR_MAP) || (from_filter == PASSTHROUGH_FILTER_COLOR_MAP && to_filter == PASSTHROUGH_FILTER_MONO_MAP)) {
+		StyleState &mono = from_filter == PASSTHROUGH_FILTER_MONO_MAP ? from : to;
+		if (mono.mono_map.size() == XR_PASSTHROUGH_COLOR_MAP_MONO_SIZE_FB) {
+			mono.color_map.resize(XR_PASSTHROUGH_COLOR_MAP_MONO_SIZE_FB);
+			const uint8_t *src = mono.mono_map.ptr();
+			Color *dst = mono.color_map.ptrw();
+			for (int i = 0; i < XR_PASSTHROUGH_COLOR_MAP_MONO_SIZE_FB; i++) {
+				float value = (float)src[i] / 255.0;
+				dst[i] = Color(value, value, value, 1.0);
+			}
+		} else {
+			mono.color_map = _get_identity_color_map();
 		}
+		style_animation.filter = PASSTHROUGH_FILTER_COLOR_MAP;
+	} else {
+		// Snap the filter, but keep fading the opacity and edge color.
+		from.filter = target.filter;
+		from.brightness_contrast_saturation = target.brightness_contrast_saturation;
+		from.color_map = target.color_map;
+		from.mono_map = target.mono_map;
 	}
 }
 
+void OpenXRFbPassthroughExtension::_update_style_animation() {
+	if (style_keyframes.is_empty()) {
+		return;
+	}
+
+	if (!style_animation.active) {
+		_begin_style_keyframe();
+	}
+
+	uint64_t now = Time::get_singleton()->get_ticks_usec();
+	style_animation.elapsed += (now - style_animation.last_ticks) / 1000000.0;
+	style_animation.last_ticks = now;
+
+	const StyleKeyframe &keyframe = style_keyframes[0];
+	if (style_animation.elapsed >= keyframe.duration) {
+		style_state = keyframe.target;
+		style_keyframes.remove_at(0);
+		style_animation.active = false;
+		_queue_style_update();
+
+		if (style_keyframes.is_empty()) {
+			emit_signal("openxr_fb_passthrough_style_animation_finished");
+		}
+		return;
+	}
+
+	float weight = UtilityFunctions::ease(style_animation.elapsed / keyframe.duration, keyframe.ease_curve);
+	const StyleState &from = style_animation.from;
+	const StyleState &to = style_animation.to;
+
+	style_state.texture_opacity_factor = Math::lerp(from.texture_opacity_factor, to.texture_opacity_factor, weight);
+	style_state.edge_color = from.edge_color.lerp(to.edge_color, weight);
+	style_state.filter = style_animation.filter;
+
+	switch (style_animation.filter) {
+		case PASSTHROUGH_FILTER_COLOR_MAP: {
+			style_state.color_map = to.color_map;
+			if (from.color_map.size() == XR_PASSTHROUGH_COLOR_MAP_MONO_SIZE_FB && to.color_map.size() == XR_PASSTHROUGH_COLOR_MAP_MONO_SIZE_FB) {
+				const Color *src = from.color_map.ptr();
+				const Color *dst = to.color_map.ptr();
+				Color *table = style_state.color_map.ptrw();
+				for (int i = 0; i < XR_PASSTHROUGH_COLOR_MAP_MONO_SIZE_FB; i++) {
+					table[i] = src[i].lerp(dst[i], weight);
+				}
+			}
+		} break;
+		case PASSTHROUGH_FILTER_MONO_MAP: {
+			style_state.mono_map = to.mono_map;
+			if (from.mono_map.size() == XR_PASSTHROUGH_COLOR_MAP_MONO_SIZE_FB && to.mono_map.size() == XR_PASSTHROUGH_COLOR_MAP_MONO_SIZE_FB) {
+				const uint8_t *src = from.mono_map.ptr();
+				const uint8_t *dst = to.mono_map.ptr();
+				uint8_t *table = style_state.mono_map.ptrw();
+				for (int i = 0; i < XR_PASSTHROUGH_COLOR_MAP_MONO_SIZE_FB; i++) {
+					table[i] = Math::round(Math::lerp((float)src[i], (float)dst[i], weight));
+				}
+			}
+		} break;
+		case PASSTHROUGH_FILTER_BRIGHTNESS_CONTRAST_SATURATION: {
+			style_state.brightness_contrast_saturation = from.brightness_contrast_saturation.lerp(to.brightness_contrast_saturation, weight);
+		} break;
+		default:
+			break;
+	}
+
+	_queue_style_update();
+}
+
 bool OpenXRFbPassthroughExtension::has_passthrough_capability() {
 	return system_passthrough_properties.capabilities & XR_PASSTHROUGH_CAPABILITY_BIT_FB;
 }
@@ -820,7 +1180,10 @@ void OpenXRFbPassthroughExtension::set_color_lut(float p_weight, const Ref<OpenX
 		return;
 	}
 
-	current_passthrough_filter = PASSTHROUGH_FILTER_COLOR_MAP_LUT;
+	ERR_FAIL_COND(p_color_lut.is_null());
+	ERR_FAIL_COND_MSG(!p_color_lut->is_prepared(), "Color LUT is still being prepared; wait for its \"prepared\" signal.");
+
+	style_state.filter = PASSTHROUGH_FILTER_COLOR_MAP_LUT;
 
 	RenderingServer::get_singleton()->call_on_render_thread(callable_mp(this, &OpenXRFbPassthroughExtension::_set_color_lut_rt).bind(p_weight, p_color_lut));
 }
@@ -849,8 +1212,9 @@ void OpenXRFbPassthroughExtension::set_interpolated_color_lut(float p_weight, co
 
 	ERR_FAIL_COND(p_source_color_lut.is_null());
 	ERR_FAIL_COND(p_target_color_lut.is_null());
+	ERR_FAIL_COND_MSG(!p_source_color_lut->is_prepared() || !p_target_color_lut->is_prepared(), "Color LUT is still being prepared; wait for its \"prepared\" signal.");
 
-	current_passthrough_filter = PASSTHROUGH_FILTER_COLOR_MAP_INTERPOLATED_LUT;
+	style_state.filter = PASSTHROUGH_FILTER_COLOR_MAP_INTERPOLATED_LUT;
 
 	RenderingServer::get_singleton()->call_on_render_thread(callable_mp(this, &OpenXRFbPassthroughExtension::_set_interpolated_color_lut_rt).bind(p_weight, p_source_color_lut, p_target_color_lut));
 }
@@ -947,18 +1311,21 @@ void OpenXRFbPassthroughExtension::_color_lut_free_rt(RID p_color_lut) {
 		render_state.color_lut_handle = XR_NULL_HANDLE;
 		if (render_state.current_passthrough_filter == PASSTHROUGH_FILTER_COLOR_MAP_LUT) {
 			_set_passthrough_filter_rt(PASSTHROUGH_FILTER_DISABLED);
+			callable_mp(this, &OpenXRFbPassthroughExtension::_reset_color_lut_filter).call_deferred();
 		}
 	}
 	if (render_state.source_color_lut_handle == handle) {
 		render_state.source_color_lut_handle = XR_NULL_HANDLE;
 		if (render_state.current_passthrough_filter == PASSTHROUGH_FILTER_COLOR_MAP_INTERPOLATED_LUT) {
 			_set_passthrough_filter_rt(PASSTHROUGH_FILTER_DISABLED);
+			callable_mp(this, &OpenXRFbPassthroughExtension::_reset_color_lut_filter).call_deferred();
 		}
 	}
 	if (render_state.target_color_lut_handle == handle) {
 		render_state.target_color_lut_handle = XR_NULL_HANDLE;
 		if (render_state.current_passthrough_filter == PASSTHROUGH_FILTER_COLOR_MAP_INTERPOLATED_LUT) {
 			_set_passthrough_filter_rt(PASSTHROUGH_FILTER_DISABLED);
+			callable_mp(this, &OpenXRFbPassthroughExtension::_reset_color_lut_filter).call_deferred();
 		}
 	}
 
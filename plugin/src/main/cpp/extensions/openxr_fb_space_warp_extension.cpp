@@ -29,10 +29,15 @@
 
 #include "extensions/openxr_fb_space_warp_extension.h"
 
+#include "classes/openxr_vendor_performance_metrics.h"
+
+#include <godot_cpp/classes/engine.hpp>
 #include <godot_cpp/classes/open_xr_interface.hpp>
 #include <godot_cpp/classes/open_xrapi_extension.hpp>
 #include <godot_cpp/classes/project_settings.hpp>
 #include <godot_cpp/classes/rendering_server.hpp>
+#include <godot_cpp/classes/scene_tree.hpp>
+#include <godot_cpp/classes/window.hpp>
 #include <godot_cpp/classes/xr_server.hpp>
 #include <godot_cpp/variant/utility_functions.hpp>
 
@@ -42,6 +47,9 @@
 #define VK_FORMAT_R16G16B16A16_SFLOAT 97
 #define VK_FORMAT_D24_UNORM_S8_UINT 129
 
+static const char *CPU_FRAME_TIME_COUNTER_PATH = "/perfmetrics_meta/app/cpu_frametime";
+static const char *GPU_FRAME_TIME_COUNTER_PATH = "/perfmetrics_meta/app/gpu_frametime";
+
 OpenXRFbSpaceWarpExtension *OpenXRFbSpaceWarpExtension::singleton = nullptr;
 
 OpenXRFbSpaceWarpExtension *OpenXRFbSpaceWarpExtension::get_singleton() {
@@ -84,7 +92,9 @@ uint64_t OpenXRFbSpaceWarpExtension::_set_system_properties_and_get_next_pointer
 }
 
 uint64_t OpenXRFbSpaceWarpExtension::_set_projection_views_and_get_next_pointer(int p_view_index, void *p_next_pointer) {
-	if (is_enabled()) {
+	// The governor may toggle space warp while a frame is in flight, so only chain the space warp
+	// info for frames that actually rendered into the motion vector swapchains.
+	if (render_state.swapchains_acquired && p_view_index < (int)space_warp_info.size()) {
 		space_warp_info[p_view_index].next = p_next_pointer;
 		return reinterpret_cast<uint64_t>(&space_warp_info[p_view_index]);
 	} else {
@@ -119,10 +129,15 @@ void OpenXRFbSpaceWarpExtension::_on_session_destroyed() {
 
 	get_openxr_api()->unregister_projection_views_extension(this);
 	space_warp_info.clear();
+
+	governor.frames_over_budget = 0;
+	governor.frames_under_budget = 0;
+	_stop_measuring_render_time();
 }
 
 void OpenXRFbSpaceWarpExtension::_on_state_ready() {
-	if (!is_enabled()) {
+	// In automatic mode space warp may be engaged later on, so the swapchains are needed up front.
+	if (!is_enabled() && !(fb_space_warp_ext && governor.enabled)) {
 		return;
 	}
 
@@ -194,6 +209,8 @@ void OpenXRFbSpaceWarpExtension::_on_main_swapchains_created() {
 }
 
 void OpenXRFbSpaceWarpExtension::_on_pre_draw_viewport(const RID &p_render_target) {
+	render_state.swapchains_acquired = false;
+
 	Ref<OpenXRAPIExtension> openxr_api = get_openxr_api();
 	ERR_FAIL_COND(openxr_api.is_null());
 
@@ -206,7 +223,7 @@ void OpenXRFbSpaceWarpExtension::_on_pre_draw_viewport(const RID &p_render_targe
 	int view_count = openxr_interface->get_view_count();
 	ERR_FAIL_COND(view_count != space_warp_info.size());
 
-	if (!is_enabled()) {
+	if (!is_enabled() || motion_vector_swapchain_info == 0) {
 		openxr_api->set_velocity_texture(RID());
 		openxr_api->set_velocity_depth_texture(RID());
 		return;
@@ -214,6 +231,7 @@ void OpenXRFbSpaceWarpExtension::_on_pre_draw_viewport(const RID &p_render_targe
 
 	openxr_api->openxr_swapchain_acquire(motion_vector_swapchain_info);
 	openxr_api->openxr_swapchain_acquire(motion_vector_depth_swapchain_info);
+	render_state.swapchains_acquired = true;
 
 	RID motion_vector_swapchain_image = openxr_api->openxr_swapchain_get_image(motion_vector_swapchain_info);
 	openxr_api->set_velocity_texture(motion_vector_swapchain_image);
@@ -252,7 +270,10 @@ void OpenXRFbSpaceWarpExtension::_on_pre_draw_viewport(const RID &p_render_targe
 }
 
 void OpenXRFbSpaceWarpExtension::_on_post_draw_viewport(const RID &p_render_target) {
-	if (!is_enabled()) {
+	// The governor may toggle space warp between pre and post draw, so release based on what was acquired.
+	// The flag stays set until the next pre draw, so the layer submission for this frame still chains
+	// the space warp info.
+	if (!render_state.swapchains_acquired) {
 		return;
 	}
 
@@ -260,6 +281,128 @@ void OpenXRFbSpaceWarpExtension::_on_post_draw_viewport(const RID &p_render_targ
 	get_openxr_api()->openxr_swapchain_release(motion_vector_depth_swapchain_info);
 }
 
+void OpenXRFbSpaceWarpExtension::_on_process() {
+	if (!fb_space_warp_ext || !governor.enabled) {
+		return;
+	}
+
+	_update_governor();
+}
+
+bool OpenXRFbSpaceWarpExtension::_measure_frame_times(float &r_cpu_ms, float &r_gpu_ms) {
+	// Prefer the runtime's own app frame timings when a vendor provider is capturing them.
+	OpenXRVendorPerformanceMetrics *performance_metrics = OpenXRVendorPerformanceMetrics::get_singleton();
+	if (performance_metrics->is_capturing_performance_metrics()) {
+		// The counter paths don't change while capturing, so they're only checked once.
+		if (!governor.frame_time_counters_checked) {
+			PackedStringArray counter_paths = performance_metrics->get_performance_metrics_counter_paths();
+			governor.has_frame_time_counters = counter_paths.has(CPU_FRAME_TIME_COUNTER_PATH) && counter_paths.has(GPU_FRAME_TIME_COUNTER_PATH);
+			governor.frame_time_counters_checked = true;
+		}
+
+		if (governor.has_frame_time_counters) {
+			Dictionary cpu_counter = performance_metrics->query_performance_metrics_counter(CPU_FRAME_TIME_COUNTER_PATH);
+			Dictionary gpu_counter = performance_metrics->query_performance_metrics_counter(GPU_FRAME_TIME_COUNTER_PATH);
+			if (cpu_counter.has("float_value") && gpu_counter.has("float_value")) {
+				r_cpu_ms = cpu_counter["float_value"];
+				r_gpu_ms = gpu_counter["float_value"];
+				_stop_measuring_render_time();
+				return true;
+			}
+		}
+	} else {
+		governor.frame_time_counters_checked = false;
+	}
+
+	// Otherwise fall back on the render timestamps of the main viewport.
+	SceneTree *scene_tree = Object::cast_to<SceneTree>(Engine::get_singleton()->get_main_loop());
+	if (scene_tree == nullptr || scene_tree->get_root() == nullptr) {
+		return false;
+	}
+
+	RenderingServer *rendering_server = RenderingServer::get_singleton();
+	RID viewport = scene_tree->get_root()->get_viewport_rid();
+	if (governor.measured_viewport != viewport) {
+		_stop_measuring_render_time();
+		rendering_server->viewport_set_measure_render_time(viewport, true);
+		governor.measured_viewport = viewport;
+		return false;
+	}
+
+	r_cpu_ms = rendering_server->get_frame_setup_time_cpu() + rendering_server->viewport_get_measured_render_time_cpu(viewport);
+	r_gpu_ms = rendering_server->viewport_get_measured_render_time_gpu(viewport);
+	return r_gpu_ms > 0.0;
+}
+
+void OpenXRFbSpaceWarpExtension::_stop_measuring_render_time() {
+	if (governor.measured_viewport.is_valid()) {
+		RenderingServer::get_singleton()->viewport_set_measure_render_time(governor.measured_viewport, false);
+		governor.measured_viewport = RID();
+	}
+}
+
+void OpenXRFbSpaceWarpExtension::_update_governor() {
+	Ref<OpenXRInterface> openxr_interface = XRServer::get_singleton()->find_interface("OpenXR");
+	if (openxr_interface.is_null()) {
+		return;
+	}
+
+	float refresh_rate = openxr_interface->get_display_refresh_rate();
+	if (refresh_rate <= 0.0) {
+		return;
+	}
+
+	float cpu_ms = 0.0;
+	float gpu_ms = 0.0;
+	if (!_measure_frame_times(cpu_ms, gpu_ms)) {
+		return;
+	}
+
+	governor.cpu_frame_time = cpu_ms;
+	governor.gpu_frame_time = gpu_ms;
+
+	// Frame times reflect the app's own work, so they're compared against the full display
+	// rate budget even while space warp has the runtime rendering at half rate.
+	float budget_ms = 1000.0 / refresh_rate;
+	float frame_time = MAX(cpu_ms, gpu_ms);
+
+	if (!enabled) {
+		governor.frames_under_budget = 0;
+		if (frame_time > budget_ms * governor.engage_threshold) {
+			governor.frames_over_budget++;
+		} else {
+			governor.frames_over_budget = 0;
+		}
+
+		if (governor.frames_over_budget >= governor.engage_frame_count) {
+			governor.frames_over_budget = 0;
+			if (motion_vector_swapchain_info == 0) {
+				// The swapchains are only created when the session gets ready, so automatic mode
+				// can't engage space warp if it was turned on later than that.
+				WARN_PRINT_ONCE("OpenXR: Not engaging space warp; automatic mode was enabled after the session started, so there are no motion vector swapchains");
+				return;
+			}
+			governor.engage_count++;
+			enabled = true;
+			emit_signal("openxr_fb_space_warp_engaged", cpu_ms, gpu_ms);
+		}
+	} else {
+		governor.frames_over_budget = 0;
+		if (frame_time < budget_ms * governor.disengage_threshold) {
+			governor.frames_under_budget++;
+		} else {
+			governor.frames_under_budget = 0;
+		}
+
+		if (governor.frames_under_budget >= governor.disengage_frame_count) {
+			governor.frames_under_budget = 0;
+			governor.disengage_count++;
+			enabled = false;
+			emit_signal("openxr_fb_space_warp_disengaged", cpu_ms, gpu_ms);
+		}
+	}
+}
+
 bool OpenXRFbSpaceWarpExtension::is_enabled() {
 	return fb_space_warp_ext && enabled;
 }
@@ -268,6 +411,70 @@ void OpenXRFbSpaceWarpExtension::set_space_warp_enabled(bool p_enable) {
 	enabled = p_enable;
 }
 
+void OpenXRFbSpaceWarpExtension::set_automatic_mode_enabled(bool p_enable) {
+	governor.enabled = p_enable;
+	governor.frames_over_budget = 0;
+	governor.frames_under_budget = 0;
+
+	if (!p_enable) {
+		_stop_measuring_render_time();
+	}
+}
+
+bool OpenXRFbSpaceWarpExtension::is_automatic_mode_enabled() const {
+	return governor.enabled;
+}
+
+void OpenXRFbSpaceWarpExtension::set_engage_threshold(float p_threshold) {
+	ERR_FAIL_COND_MSG(p_threshold <= 0.0, "The engage threshold must be greater than zero.");
+	governor.engage_threshold = p_threshold;
+}
+
+float OpenXRFbSpaceWarpExtension::get_engage_threshold() const {
+	return governor.engage_threshold;
+}
+
+void OpenXRFbSpaceWarpExtension::set_disengage_threshold(float p_threshold) {
+	ERR_FAIL_COND_MSG(p_threshold <= 0.0, "The disengage threshold must be greater than zero.");
+	governor.disengage_threshold = p_threshold;
+}
+
+float OpenXRFbSpaceWarpExtension::get_disengage_threshold() const {
+	return governor.disengage_threshold;
+}
+
+void OpenXRFbSpaceWarpExtension::set_engage_frame_count(int p_count) {
+	governor.engage_frame_count = MAX(p_count, 1);
+}
+
+int OpenXRFbSpaceWarpExtension::get_engage_frame_count() const {
+	return governor.engage_frame_count;
+}
+
+void OpenXRFbSpaceWarpExtension::set_disengage_frame_count(int p_count) {
+	governor.disengage_frame_count = MAX(p_count, 1);
+}
+
+int OpenXRFbSpaceWarpExtension::get_disengage_frame_count() const {
+	return governor.disengage_frame_count;
+}
+
+float OpenXRFbSpaceWarpExtension::get_cpu_frame_time() const {
+	return governor.cpu_frame_time;
+}
+
+float OpenXRFbSpaceWarpExtension::get_gpu_frame_time() const {
+	return governor.gpu_frame_time;
+}
+
+int OpenXRFbSpaceWarpExtension::get_engage_count() const {
+	return governor.engage_count;
+}
+
+int OpenXRFbSpaceWarpExtension::get_disengage_count() const {
+	return governor.disengage_count;
+}
+
 void OpenXRFbSpaceWarpExtension::_skip_space_warp_frame() {
 	render_state.skip_space_warp_frame = true;
 }
@@ -284,6 +491,25 @@ void OpenXRFbSpaceWarpExtension::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("set_space_warp_enabled", "enable"), &OpenXRFbSpaceWarpExtension::set_space_warp_enabled);
 	ClassDB::bind_method(D_METHOD("is_enabled"), &OpenXRFbSpaceWarpExtension::is_enabled);
 	ClassDB::bind_method(D_METHOD("skip_space_warp_frame"), &OpenXRFbSpaceWarpExtension::skip_space_warp_frame);
+
+	ClassDB::bind_method(D_METHOD("set_automatic_mode_enabled", "enable"), &OpenXRFbSpaceWarpExtension::set_automatic_mode_enabled);
+	ClassDB::bind_method(D_METHOD("is_automatic_mode_enabled"), &OpenXRFbSpaceWarpExtension::is_automatic_mode_enabled);
+	ClassDB::bind_method(D_METHOD("set_engage_threshold", "threshold"), &OpenXRFbSpaceWarpExtension::set_engage_threshold);
+	ClassDB::bind_method(D_METHOD("get_engage_threshold"), &OpenXRFbSpaceWarpExtension::get_engage_threshold);
+	ClassDB::bind_method(D_METHOD("set_disengage_threshold", "threshold"), &OpenXRFbSpaceWarpExtension::set_disengage_threshold);
+	ClassDB::bind_method(D_METHOD("get_disengage_threshold"), &OpenXRFbSpaceWarpExtension::get_disengage_threshold);
+	ClassDB::bind_method(D_METHOD("set_engage_frame_count", "count"), &OpenXRFbSpaceWarpExtension::set_engage_frame_count);
+	ClassDB::bind_method(D_METHOD("get_engage_frame_count"), &OpenXRFbSpaceWarpExtension::get_engage_frame_count);
+	ClassDB::bind_method(D_METHOD("set_disengage_frame_count", "count"), &OpenXRFbSpaceWarpExtension::set_disengage_frame_count);
+	ClassDB::bind_method(D_METHOD("get_disengage_frame_count"), &OpenXRFbSpaceWarpExtension::get_disengage_frame_count);
+
+	ClassDB::bind_method(D_METHOD("get_cpu_frame_time"), &OpenXRFbSpaceWarpExtension::get_cpu_frame_time);
+	ClassDB::bind_method(D_METHOD("get_gpu_frame_time"), &OpenXRFbSpaceWarpExtension::get_gpu_frame_time);
+	ClassDB::bind_method(D_METHOD("get_engage_count"), &OpenXRFbSpaceWarpExtension::get_engage_count);
+	ClassDB::bind_method(D_METHOD("get_disengage_count"), &OpenXRFbSpaceWarpExtension::get_disengage_count);
+
+	ADD_SIGNAL(MethodInfo("openxr_fb_space_warp_engaged", PropertyInfo(Variant::FLOAT, "cpu_frame_time"), PropertyInfo(Variant::FLOAT, "gpu_frame_time")));
+	ADD_SIGNAL(MethodInfo("openxr_fb_space_warp_disengaged", PropertyInfo(Variant::FLOAT, "cpu_frame_time"), PropertyInfo(Variant::FLOAT, "gpu_frame_time")));
 }
 
 void OpenXRFbSpaceWarpExtension::cleanup() {
@@ -61,6 +61,13 @@ OpenXRFbSpatialEntityExtension::~OpenXRFbSpatialEntityExtension() {
 
 void OpenXRFbSpatialEntityExtension::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("is_spatial_entity_supported"), &OpenXRFbSpatialEntityExtension::is_spatial_entity_supported);
+
+	ClassDB::bind_method(D_METHOD("set_request_timeout", "timeout"), &OpenXRFbSpatialEntityExtension::set_request_timeout);
+	ClassDB::bind_method(D_METHOD("get_request_timeout"), &OpenXRFbSpatialEntityExtension::get_request_timeout);
+	ClassDB::bind_method(D_METHOD("get_pending_request_count"), &OpenXRFbSpatialEntityExtension::get_pending_request_count);
+	ClassDB::bind_method(D_METHOD("get_request_statistics"), &OpenXRFbSpatialEntityExtension::get_request_statistics);
+	ClassDB::bind_method(D_METHOD("reset_request_statistics"), &OpenXRFbSpatialEntityExtension::reset_request_statistics);
+	ClassDB::bind_method(D_METHOD("cancel_pending_requests"), &OpenXRFbSpatialEntityExtension::cancel_pending_requests);
 }
 
 void OpenXRFbSpatialEntityExtension::cleanup() {
@@ -90,7 +97,19 @@ void OpenXRFbSpatialEntityExtension::_on_instance_destroyed() {
 	cleanup();
 }
 
+void OpenXRFbSpatialEntityExtension::_on_session_destroyed() {
+	request_tracker.cancel_all_requests();
+}
+
+void OpenXRFbSpatialEntityExtension::_on_state_stopping() {
+	// The runtime won't deliver the completion events of any pending requests once the session
+	// stops, so fail them now rather than letting them time out.
+	request_tracker.cancel_all_requests();
+}
+
 void OpenXRFbSpatialEntityExtension::_on_process() {
+	request_tracker.process();
+
 	for (KeyValue<StringName, TrackedEntity> &E : tracked_entities) {
 		if (E.value.tracker.is_null()) {
 			E.value.tracker.instantiate();
@@ -192,25 +211,65 @@ bool OpenXRFbSpatialEntityExtension::create_spatial_anchor(const Transform3D &p_
 		return false;
 	}
 
-	spatial_anchor_creation_info[request_id] = SpatialAnchorCreationInfo(p_callback, p_userdata);
+	SpatialAnchorCreationInfo *info = memnew(SpatialAnchorCreationInfo(p_callback, p_userdata));
+	request_tracker.add_request(request_id, OpenXRFbAsyncRequestTracker::REQUEST_TYPE_CREATE_SPATIAL_ANCHOR, info, &OpenXRFbSpatialEntityExtension::_on_spatial_anchor_creation_abandoned);
 	return true;
 }
 
 void OpenXRFbSpatialEntityExtension::on_spatial_anchor_created(const XrEventDataSpatialAnchorCreateCompleteFB *event) {
-	if (!spatial_anchor_creation_info.has(event->requestId)) {
+	SpatialAnchorCreationInfo *info = (SpatialAnchorCreationInfo *)request_tracker.complete_request(event->requestId, OpenXRFbAsyncRequestTracker::REQUEST_TYPE_CREATE_SPATIAL_ANCHOR);
+	if (info == nullptr) {
 		WARN_PRINT("Received unexpected XR_TYPE_EVENT_DATA_SPATIAL_ANCHOR_CREATE_COMPLETE_FB");
+		// The request may have been abandoned after the runtime created the anchor, in which case
+		// nobody else will ever destroy it.
+		if (XR_SUCCEEDED(event->result) && event->space != XR_NULL_HANDLE) {
+			xrDestroySpace(event->space);
+		}
 		return;
 	}
 
-	SpatialAnchorCreationInfo *info = spatial_anchor_creation_info.getptr(event->requestId);
 	info->callback(event->result, event->space, &event->uuid, info->userdata);
-	spatial_anchor_creation_info.erase(event->requestId);
+	memdelete(info);
+}
+
+void OpenXRFbSpatialEntityExtension::_on_spatial_anchor_creation_abandoned(XrResult p_result, void *p_request_data, bool p_report) {
+	SpatialAnchorCreationInfo *info = (SpatialAnchorCreationInfo *)p_request_data;
+	if (p_report) {
+		info->callback(p_result, XR_NULL_HANDLE, nullptr, info->userdata);
+	}
+	memdelete(info);
 }
 
 bool OpenXRFbSpatialEntityExtension::destroy_space(const XrSpace &p_space) {
 	return XR_SUCCEEDED(xrDestroySpace(p_space));
 }
 
+bool OpenXRFbSpatialEntityExtension::locate_space(const XrSpace &p_space, Transform3D &r_transform) {
+	XrSpaceLocation location = {
+		XR_TYPE_SPACE_LOCATION, // type
+		nullptr, // next
+		0, // locationFlags
+		{
+				{ 0.0, 0.0, 0.0, 0.0 }, // orientation
+				{ 0.0, 0.0, 0.0 } // position
+		} // pose
+	};
+
+	XrResult result = xrLocateSpace(p_space, reinterpret_cast<XrSpace>(get_openxr_api()->get_play_space()), get_openxr_api()->get_predicted_display_time(), &location);
+	if (XR_FAILED(result)) {
+		WARN_PRINT("OpenXR: failed to locate space");
+		WARN_PRINT(get_openxr_api()->get_error_string(result));
+		return false;
+	}
+
+	if (!(location.locationFlags & XR_SPACE_LOCATION_POSITION_VALID_BIT) || !(location.locationFlags & XR_SPACE_LOCATION_ORIENTATION_VALID_BIT)) {
+		return false;
+	}
+
+	r_transform = OpenXRUtilities::xrPosef_to_godot_transform3d(location.pose);
+	return true;
+}
+
 Vector<XrSpaceComponentTypeFB> OpenXRFbSpatialEntityExtension::get_support_components(const XrSpace &space) {
 	Vector<XrSpaceComponentTypeFB> components;
 
@@ -243,20 +302,53 @@ bool OpenXRFbSpatialEntityExtension::set_component_enabled(const XrSpace &p_spac
 		return false;
 	}
 
-	set_component_enabled_info[request_id] = SetComponentEnabledInfo(p_callback, p_userdata);
+	SetComponentEnabledInfo *info = memnew(SetComponentEnabledInfo(p_callback, p_userdata, p_component, p_enabled));
+	request_tracker.add_request(request_id, OpenXRFbAsyncRequestTracker::REQUEST_TYPE_SET_COMPONENT_ENABLED, info, &OpenXRFbSpatialEntityExtension::_on_set_component_enabled_abandoned);
 
 	return true;
 }
 
 void OpenXRFbSpatialEntityExtension::on_set_component_enabled_complete(const XrEventDataSpaceSetStatusCompleteFB *event) {
-	if (!set_component_enabled_info.has(event->requestId)) {
+	SetComponentEnabledInfo *info = (SetComponentEnabledInfo *)request_tracker.complete_request(event->requestId, OpenXRFbAsyncRequestTracker::REQUEST_TYPE_SET_COMPONENT_ENABLED);
+	if (info == nullptr) {
 		WARN_PRINT("Received unexpected XR_TYPE_EVENT_DATA_SPACE_SET_STATUS_COMPLETE_FB");
 		return;
 	}
 
-	SetComponentEnabledInfo *info = set_component_enabled_info.getptr(event->requestId);
 	info->callback(event->result, event->componentType, event->enabled, info->userdata);
-	set_component_enabled_info.erase(event->requestId);
+	memdelete(info);
+}
+
+void OpenXRFbSpatialEntityExtension::_on_set_component_enabled_abandoned(XrResult p_result, void *p_request_data, bool p_report) {
+	SetComponentEnabledInfo *info = (SetComponentEnabledInfo *)p_request_data;
+	if (p_report) {
+		info->callback(p_result, info->component, info->enabled, info->userdata);
+	}
+	memdelete(info);
+}
+
+void OpenXRFbSpatialEntityExtension::set_request_timeout(double p_timeout) {
+	request_tracker.set_default_timeout(p_timeout);
+}
+
+double OpenXRFbSpatialEntityExtension::get_request_timeout() const {
+	return request_tracker.get_default_timeout();
+}
+
+int OpenXRFbSpatialEntityExtension::get_pending_request_count() const {
+	return request_tracker.get_pending_request_count();
+}
+
+Dictionary OpenXRFbSpatialEntityExtension::get_request_statistics() const {
+	return request_tracker.get_statistics();
+}
+
+void OpenXRFbSpatialEntityExtension::reset_request_statistics() {
+	request_tracker.reset_statistics();
+}
+
+void OpenXRFbSpatialEntityExtension::cancel_pending_requests() {
+	request_tracker.cancel_all_requests();
 }
 
 void OpenXRFbSpatialEntityExtension::track_entity(const StringName &p_name, const XrSpace &p_space) {
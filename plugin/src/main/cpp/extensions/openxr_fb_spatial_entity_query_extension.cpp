@@ -29,6 +29,8 @@
 
 #include "extensions/openxr_fb_spatial_entity_query_extension.h"
 
+#include "extensions/openxr_fb_spatial_entity_extension.h"
+
 #include <godot_cpp/classes/object.hpp>
 #include <godot_cpp/classes/open_xrapi_extension.hpp>
 #include <godot_cpp/variant/utility_functions.hpp>
@@ -120,16 +122,45 @@ bool OpenXRFbSpatialEntityQueryExtension::query_spatial_entities(const XrSpaceQu
 		return false;
 	}
 
-	queries[request_id] = QueryInfo(p_callback, p_userdata);
+	// Never give up on the query before the runtime does.
+	OpenXRFbAsyncRequestTracker *request_tracker = OpenXRFbSpatialEntityExtension::get_singleton()->get_request_tracker();
+	double timeout = request_tracker->get_default_timeout();
+	if (timeout > 0.0 && p_info->type == XR_TYPE_SPACE_QUERY_INFO_FB) {
+		const XrSpaceQueryInfoFB *query_info = (const XrSpaceQueryInfoFB *)p_info;
+		if (query_info->timeout == XR_INFINITE_DURATION) {
+			timeout = 0.0;
+		} else {
+			timeout = MAX(timeout, (double)query_info->timeout / 1000000000.0 + 1.0);
+		}
+	}
+
+	QueryInfo *query = memnew(QueryInfo(p_callback, p_userdata));
+	request_tracker->add_request(request_id, OpenXRFbAsyncRequestTracker::REQUEST_TYPE_QUERY_SPACES, query, &OpenXRFbSpatialEntityQueryExtension::_on_query_abandoned, timeout);
 	return true;
 }
 
 void OpenXRFbSpatialEntityQueryExtension::on_space_query_results(const XrEventDataSpaceQueryResultsAvailableFB *event) {
-	if (!queries.has(event->requestId)) {
+	OpenXRFbSpatialEntityExtension *spatial_entity_extension = OpenXRFbSpatialEntityExtension::get_singleton();
+	QueryInfo *query = (QueryInfo *)spatial_entity_extension->get_request_tracker()->get_request_data(event->requestId, OpenXRFbAsyncRequestTracker::REQUEST_TYPE_QUERY_SPACES);
+	if (query == nullptr) {
 		WARN_PRINT("Received unexpected XR_TYPE_EVENT_DATA_SPACE_QUERY_RESULTS_AVAILABLE_FB");
+
+		// The query may have been abandoned after the runtime found spaces, in which case nobody
+		// else will ever destroy them.
+		Vector<XrSpaceQueryResultFB> late_results;
+		_retrieve_results(event->requestId, late_results);
+		for (const XrSpaceQueryResultFB &late_result : late_results) {
+			if (late_result.space != XR_NULL_HANDLE) {
+				spatial_entity_extension->destroy_space(late_result.space);
+			}
+		}
 		return;
 	}
 
+	_retrieve_results(event->requestId, query->results);
+}
+
+void OpenXRFbSpatialEntityQueryExtension::_retrieve_results(XrAsyncRequestIdFB p_request_id, Vector<XrSpaceQueryResultFB> &r_results) {
 	// Query the results that are now available using two-call idiom
 	XrSpaceQueryResultsFB queryResults{
 		XR_TYPE_SPACE_QUERY_RESULTS_FB, // type
@@ -138,22 +169,20 @@ void OpenXRFbSpatialEntityQueryExtension::on_space_query_results(const XrEventDa
 		0, // resultCapacityOutput
 		nullptr, // results
 	};
-	XrResult result = xrRetrieveSpaceQueryResultsFB(SESSION, event->requestId, &queryResults);
+	XrResult result = xrRetrieveSpaceQueryResultsFB(SESSION, p_request_id, &queryResults);
 	if (!XR_SUCCEEDED(result)) {
 		WARN_PRINT("xrRetrieveSpaceQueryResultsFB failed to get result count!");
 		WARN_PRINT(get_openxr_api()->get_error_string(result));
 		return;
 	}
 
-	QueryInfo *query = queries.getptr(event->requestId);
-
-	query->results.resize(queryResults.resultCountOutput);
+	r_results.resize(queryResults.resultCountOutput);
 	queryResults.resultCapacityInput = queryResults.resultCountOutput;
-	queryResults.results = query->results.ptrw();
+	queryResults.results = r_results.ptrw();
 
-	result = xrRetrieveSpaceQueryResultsFB(SESSION, event->requestId, &queryResults);
+	result = xrRetrieveSpaceQueryResultsFB(SESSION, p_request_id, &queryResults);
 	if (!XR_SUCCEEDED(result)) {
-		query->results.clear();
+		r_results.clear();
 		WARN_PRINT("xrRetrieveSpaceQueryResultsFB failed to get results!");
 		WARN_PRINT(get_openxr_api()->get_error_string(result));
 		return;
@@ -161,11 +190,31 @@ void OpenXRFbSpatialEntityQueryExtension::on_space_query_results(const XrEventDa
 }
 
 void OpenXRFbSpatialEntityQueryExtension::on_space_query_complete(const XrEventDataSpaceQueryCompleteFB *event) {
-	if (!queries.has(event->requestId)) {
+	QueryInfo *query = (QueryInfo *)OpenXRFbSpatialEntityExtension::get_singleton()->get_request_tracker()->complete_request(event->requestId, OpenXRFbAsyncRequestTracker::REQUEST_TYPE_QUERY_SPACES);
+	if (query == nullptr) {
 		WARN_PRINT("Received unexpected XR_TYPE_EVENT_DATA_SPACE_QUERY_COMPLETE_FB");
 		return;
 	}
-	QueryInfo *query = queries.getptr(event->requestId);
+
 	query->callback(query->results, query->userdata);
-	queries.erase(event->requestId);
+	memdelete(query);
+}
+
+void OpenXRFbSpatialEntityQueryExtension::_on_query_abandoned(XrResult p_result, void *p_request_data, bool p_report) {
+	QueryInfo *query = (QueryInfo *)p_request_data;
+
+	// Nobody else will ever destroy the spaces found so far. Only do so while the extension is
+	// still around, since the session takes its spaces with it otherwise.
+	if (p_report) {
+		OpenXRFbSpatialEntityExtension *spatial_entity_extension = OpenXRFbSpatialEntityExtension::get_singleton();
+		for (const XrSpaceQueryResultFB &result : query->results) {
+			if (result.space != XR_NULL_HANDLE) {
+				spatial_entity_extension->destroy_space(result.space);
+			}
+		}
+
+		// Any partial results can't be trusted, so report an empty result set, same as when the query fails to start.
+		query->callback({}, query->userdata);
+	}
+	memdelete(query);
 }
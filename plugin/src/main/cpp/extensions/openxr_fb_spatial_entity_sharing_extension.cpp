@@ -29,6 +29,8 @@
 
 #include "extensions/openxr_fb_spatial_entity_sharing_extension.h"
 
+#include "extensions/openxr_fb_spatial_entity_extension.h"
+
 #include <godot_cpp/classes/object.hpp>
 #include <godot_cpp/classes/open_xrapi_extension.hpp>
 #include <godot_cpp/templates/vector.hpp>
@@ -115,17 +117,26 @@ bool OpenXRFbSpatialEntitySharingExtension::share_spaces(const XrSpaceShareInfoF
 		return false;
 	}
 
-	requests[request_id] = RequestInfo(p_callback, p_userdata);
+	RequestInfo *request = memnew(RequestInfo(p_callback, p_userdata));
+	OpenXRFbSpatialEntityExtension::get_singleton()->get_request_tracker()->add_request(request_id, OpenXRFbAsyncRequestTracker::REQUEST_TYPE_SHARE_SPACES, request, &OpenXRFbSpatialEntitySharingExtension::_on_request_abandoned);
 	return true;
 }
 
 void OpenXRFbSpatialEntitySharingExtension::on_space_share_complete(const XrEventDataSpaceShareCompleteFB *event) {
-	if (!requests.has(event->requestId)) {
+	RequestInfo *request = (RequestInfo *)OpenXRFbSpatialEntityExtension::get_singleton()->get_request_tracker()->complete_request(event->requestId, OpenXRFbAsyncRequestTracker::REQUEST_TYPE_SHARE_SPACES);
+	if (request == nullptr) {
 		WARN_PRINT("Received unexpected XR_TYPE_EVENT_DATA_SPACE_SHARE_COMPLETE_FB");
 		return;
 	}
 
-	RequestInfo *request = requests.getptr(event->requestId);
 	request->callback(event->result, request->userdata);
-	requests.erase(event->requestId);
+	memdelete(request);
+}
+
+void OpenXRFbSpatialEntitySharingExtension::_on_request_abandoned(XrResult p_result, void *p_request_data, bool p_report) {
+	RequestInfo *request = (RequestInfo *)p_request_data;
+	if (p_report) {
+		request->callback(p_result, request->userdata);
+	}
+	memdelete(request);
 }
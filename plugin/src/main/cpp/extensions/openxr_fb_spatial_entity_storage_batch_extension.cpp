@@ -29,6 +29,8 @@
 
 #include "extensions/openxr_fb_spatial_entity_storage_batch_extension.h"
 
+#include "extensions/openxr_fb_spatial_entity_extension.h"
+
 #include <godot_cpp/classes/object.hpp>
 #include <godot_cpp/classes/open_xrapi_extension.hpp>
 #include <godot_cpp/templates/vector.hpp>
@@ -115,17 +117,26 @@ bool OpenXRFbSpatialEntityStorageBatchExtension::save_spaces(const XrSpaceListSa
 		return false;
 	}
 
-	requests[request_id] = RequestInfo(p_callback, p_userdata, p_info->location);
+	RequestInfo *request = memnew(RequestInfo(p_callback, p_userdata, p_info->location));
+	OpenXRFbSpatialEntityExtension::get_singleton()->get_request_tracker()->add_request(request_id, OpenXRFbAsyncRequestTracker::REQUEST_TYPE_SAVE_SPACE_LIST, request, &OpenXRFbSpatialEntityStorageBatchExtension::_on_request_abandoned);
 	return true;
 }
 
 void OpenXRFbSpatialEntityStorageBatchExtension::on_space_list_save_complete(const XrEventDataSpaceListSaveCompleteFB *event) {
-	if (!requests.has(event->requestId)) {
+	RequestInfo *request = (RequestInfo *)OpenXRFbSpatialEntityExtension::get_singleton()->get_request_tracker()->complete_request(event->requestId, OpenXRFbAsyncRequestTracker::REQUEST_TYPE_SAVE_SPACE_LIST);
+	if (request == nullptr) {
 		WARN_PRINT("Received unexpected XR_TYPE_EVENT_DATA_SPACE_LIST_SAVE_COMPLETE_FB");
 		return;
 	}
 
-	RequestInfo *request = requests.getptr(event->requestId);
 	request->callback(event->result, request->location, request->userdata);
-	requests.erase(event->requestId);
+	memdelete(request);
+}
+
+void OpenXRFbSpatialEntityStorageBatchExtension::_on_request_abandoned(XrResult p_result, void *p_request_data, bool p_report) {
+	RequestInfo *request = (RequestInfo *)p_request_data;
+	if (p_report) {
+		request->callback(p_result, request->location, request->userdata);
+	}
+	memdelete(request);
 }
@@ -29,6 +29,8 @@
 
 #include "extensions/openxr_fb_spatial_entity_storage_extension.h"
 
+#include "extensions/openxr_fb_spatial_entity_extension.h"
+
 #include <godot_cpp/classes/object.hpp>
 #include <godot_cpp/classes/open_xrapi_extension.hpp>
 #include <godot_cpp/variant/utility_functions.hpp>
@@ -120,7 +122,8 @@ bool OpenXRFbSpatialEntityStorageExtension::save_space(const XrSpaceSaveInfoFB *
 		return false;
 	}
 
-	requests[request_id] = RequestInfo(p_callback, p_userdata);
+	RequestInfo *request = memnew(RequestInfo(p_callback, p_userdata, p_info->location));
+	OpenXRFbSpatialEntityExtension::get_singleton()->get_request_tracker()->add_request(request_id, OpenXRFbAsyncRequestTracker::REQUEST_TYPE_SAVE_SPACE, request, &OpenXRFbSpatialEntityStorageExtension::_on_request_abandoned);
 	return true;
 }
 
@@ -135,28 +138,37 @@ bool OpenXRFbSpatialEntityStorageExtension::erase_space(const XrSpaceEraseInfoFB
 		return false;
 	}
 
-	requests[request_id] = RequestInfo(p_callback, p_userdata);
+	RequestInfo *request = memnew(RequestInfo(p_callback, p_userdata, p_info->location));
+	OpenXRFbSpatialEntityExtension::get_singleton()->get_request_tracker()->add_request(request_id, OpenXRFbAsyncRequestTracker::REQUEST_TYPE_ERASE_SPACE, request, &OpenXRFbSpatialEntityStorageExtension::_on_request_abandoned);
 	return true;
 }
 
 void OpenXRFbSpatialEntityStorageExtension::on_space_save_complete(const XrEventDataSpaceSaveCompleteFB *event) {
-	if (!requests.has(event->requestId)) {
+	RequestInfo *request = (RequestInfo *)OpenXRFbSpatialEntityExtension::get_singleton()->get_request_tracker()->complete_request(event->requestId, OpenXRFbAsyncRequestTracker::REQUEST_TYPE_SAVE_SPACE);
+	if (request == nullptr) {
 		WARN_PRINT("Received unexpected XR_TYPE_EVENT_DATA_SPACE_SAVE_COMPLETE_FB");
 		return;
 	}
 
-	RequestInfo *request = requests.getptr(event->requestId);
 	request->callback(event->result, event->location, request->userdata);
-	requests.erase(event->requestId);
+	memdelete(request);
 }
 
 void OpenXRFbSpatialEntityStorageExtension::on_space_erase_complete(const XrEventDataSpaceEraseCompleteFB *event) {
-	if (!requests.has(event->requestId)) {
+	RequestInfo *request = (RequestInfo *)OpenXRFbSpatialEntityExtension::get_singleton()->get_request_tracker()->complete_request(event->requestId, OpenXRFbAsyncRequestTracker::REQUEST_TYPE_ERASE_SPACE);
+	if (request == nullptr) {
 		WARN_PRINT("Received unexpected XR_TYPE_EVENT_DATA_SPACE_ERASE_COMPLETE_FB");
 		return;
 	}
 
-	RequestInfo *request = requests.getptr(event->requestId);
 	request->callback(event->result, event->location, request->userdata);
-	requests.erase(event->requestId);
+	memdelete(request);
+}
+
+void OpenXRFbSpatialEntityStorageExtension::_on_request_abandoned(XrResult p_result, void *p_request_data, bool p_report) {
+	RequestInfo *request = (RequestInfo *)p_request_data;
+	if (p_report) {
+		request->callback(p_result, request->location, request->userdata);
+	}
+	memdelete(request);
 }
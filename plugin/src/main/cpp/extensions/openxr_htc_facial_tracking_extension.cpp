@@ -66,6 +66,16 @@ OpenXRHtcFacialTrackingExtension::~OpenXRHtcFacialTrackingExtension() {
 
 void OpenXRHtcFacialTrackingExtension::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("is_enabled"), &OpenXRHtcFacialTrackingExtension::is_enabled);
+	ClassDB::bind_method(D_METHOD("set_filter_settings", "filter_settings"), &OpenXRHtcFacialTrackingExtension::set_filter_settings);
+	ClassDB::bind_method(D_METHOD("get_filter_settings"), &OpenXRHtcFacialTrackingExtension::get_filter_settings);
+}
+
+void OpenXRHtcFacialTrackingExtension::set_filter_settings(const Ref<OpenXRTrackingFilterSettings> &p_filter_settings) {
+	filter_settings = p_filter_settings;
+}
+
+Ref<OpenXRTrackingFilterSettings> OpenXRHtcFacialTrackingExtension::get_filter_settings() const {
+	return filter_settings;
 }
 
 void OpenXRHtcFacialTrackingExtension::cleanup() {
@@ -378,6 +388,16 @@ void OpenXRHtcFacialTrackingExtension::_on_process() {
 	xr_weights[XRFaceTracker::FT_MOUTH_TIGHTENER] = 0.0f; // Not measured by XR_htc_facial_tracking
 	xr_weights[XRFaceTracker::FT_MOUTH_PRESS] = 0.0f; // Not measured by XR_htc_facial_tracking
 
+	// Smooth the weights if requested
+	if (filter_settings.is_valid()) {
+		weight_filter.filter(xr_weights, XRFaceTracker::FT_MAX, 1, display_time, filter_settings->get_parameters());
+		for (float &weight : xr_weights) {
+			weight = CLAMP(weight, 0.0f, 1.0f);
+		}
+	} else {
+		weight_filter.reset();
+	}
+
 	// Populate the XRFaceTracker
 	PackedFloat32Array xr_weights_array;
 	xr_weights_array.resize(XRFaceTracker::FT_MAX);
@@ -44,10 +44,18 @@
 
 #include <openxr/internal/xr_linear.h>
 
+#include <cstring>
+
 #include <godot_cpp/classes/camera3d.hpp>
 #include <godot_cpp/classes/engine.hpp>
 #include <godot_cpp/classes/open_xrapi_extension.hpp>
 #include <godot_cpp/classes/project_settings.hpp>
+#include <godot_cpp/classes/rd_sampler_state.hpp>
+#include <godot_cpp/classes/rd_shader_source.hpp>
+#include <godot_cpp/classes/rd_shader_spirv.hpp>
+#include <godot_cpp/classes/rd_texture_format.hpp>
+#include <godot_cpp/classes/rd_texture_view.hpp>
+#include <godot_cpp/classes/rd_uniform.hpp>
 #include <godot_cpp/classes/rendering_device.hpp>
 #include <godot_cpp/classes/rendering_server.hpp>
 #include <godot_cpp/classes/window.hpp>
@@ -58,6 +66,10 @@
 
 using namespace godot;
 
+// Caps the reprojection grid, so a large render target or a small downsample factor can't
+// turn it into hundreds of thousands of vertices, each sampling the depth map.
+static const int MAX_REPROJECTION_GRID_CELLS = 128;
+
 static const char *META_ENVIRONMENT_DEPTH_AVAILABLE_NAME = "META_ENVIRONMENT_DEPTH_AVAILABLE";
 static const char *META_ENVIRONMENT_DEPTH_TEXTURE_NAME = "META_ENVIRONMENT_DEPTH_TEXTURE";
 static const char *META_ENVIRONMENT_DEPTH_TEXEL_SIZE_NAME = "META_ENVIRONMENT_DEPTH_TEXEL_SIZE";
@@ -86,10 +98,16 @@ uniform highp float depth_offset_scale = 0.0;
 uniform highp float depth_offset_exponent = 1.0;
 #endif // USE_DEPTH_OFFSET_EXPONENT
 #endif // USE_DEPTH_OFFSET_SCALE
-void vertex() {
-	UV = VERTEX.xy * 0.5 + 0.5;
-	POSITION = vec4(VERTEX.xyz, 1.0);
-}
+#ifdef USE_REGION
+uniform highp vec4 region_left = vec4(-1.0, -1.0, 1.0, 1.0);
+uniform highp vec4 region_right = vec4(-1.0, -1.0, 1.0, 1.0);
+#endif // USE_REGION
+#ifdef USE_VERTEX_REPROJECTION
+// Depth texels further apart than this ratio are considered to be on different surfaces.
+const highp float DISCONTINUITY_RATIO = 1.1;
+varying highp float reprojected_depth;
+varying highp float reprojected_valid;
+#endif // USE_VERTEX_REPROJECTION
 float get_depth_bilinear(vec2 uv, uint view_index) {
 	vec2 p = uv / META_ENVIRONMENT_DEPTH_TEXEL_SIZE;
 	vec2 f = fract(p);
@@ -100,30 +118,50 @@ float get_depth_bilinear(vec2 uv, uint view_index) {
 	vec2 uv01 = uv00 + vec2(0.0, META_ENVIRONMENT_DEPTH_TEXEL_SIZE.y);
 	vec2 uv11 = uv00 + META_ENVIRONMENT_DEPTH_TEXEL_SIZE;
 
-	float d00 = texture(META_ENVIRONMENT_DEPTH_TEXTURE, vec3(uv00, float(view_index))).r;
-	float d10 = texture(META_ENVIRONMENT_DEPTH_TEXTURE, vec3(uv10, float(view_index))).r;
-	float d01 = texture(META_ENVIRONMENT_DEPTH_TEXTURE, vec3(uv01, float(view_index))).r;
-	float d11 = texture(META_ENVIRONMENT_DEPTH_TEXTURE, vec3(uv11, float(view_index))).r;
+	float d00 = textureLod(META_ENVIRONMENT_DEPTH_TEXTURE, vec3(uv00, float(view_index)), 0.0).r;
+	float d10 = textureLod(META_ENVIRONMENT_DEPTH_TEXTURE, vec3(uv10, float(view_index)), 0.0).r;
+	float d01 = textureLod(META_ENVIRONMENT_DEPTH_TEXTURE, vec3(uv01, float(view_index)), 0.0).r;
+	float d11 = textureLod(META_ENVIRONMENT_DEPTH_TEXTURE, vec3(uv11, float(view_index)), 0.0).r;
+
+#ifdef USE_VERTEX_REPROJECTION
+	// Don't blend across depth discontinuities, or the edges of real world objects would be
+	// stretched over everything behind them. Use the farthest depth instead, which keeps virtual
+	// objects visible right up to the edge. A depth of 0 means no data, and 1 is the far plane.
+	float d_min = min(min(d00, d10), min(d01, d11));
+	float d_max = max(max(d00, d10), max(d01, d11));
+	if (d_min <= 0.0) {
+		return 0.0;
+	}
+	if ((1.0 - d_min) > (1.0 - d_max) * DISCONTINUITY_RATIO) {
+		return d_max;
+	}
+#endif // USE_VERTEX_REPROJECTION
 
 	return mix(mix(d00, d10, f.x), mix(d01, d11, f.x), f.y);
 }
-void fragment() {
-	highp mat4 camera_to_depth_proj = (VIEW_INDEX == VIEW_MONO_LEFT) ? META_ENVIRONMENT_DEPTH_FROM_CAMERA_PROJECTION_LEFT : META_ENVIRONMENT_DEPTH_FROM_CAMERA_PROJECTION_RIGHT;
-	highp mat4 depth_to_camera_proj = (VIEW_INDEX == VIEW_MONO_LEFT) ? META_ENVIRONMENT_DEPTH_TO_CAMERA_PROJECTION_LEFT : META_ENVIRONMENT_DEPTH_TO_CAMERA_PROJECTION_RIGHT;
-	highp vec4 clip = vec4(UV * 2.0 - 1.0, 1.0, 1.0);
-	highp vec4 reprojected = camera_to_depth_proj * clip;
-	reprojected /= reprojected.w;
-	highp vec2 reprojected_uv = reprojected.xy * 0.5 + 0.5;
-	highp float depth = 0.0;
-	if (reprojected_uv.x >= 0.0 && reprojected_uv.y >= 0.0 && reprojected_uv.x <= 1.0 && reprojected_uv.y <= 1.0) {
+float get_depth(vec2 uv, uint view_index) {
+	if (uv.x < 0.0 || uv.y < 0.0 || uv.x > 1.0 || uv.y > 1.0) {
+		return 0.0;
+	}
 #ifdef USE_BILINEAR_FILTERING
-		depth = get_depth_bilinear(reprojected_uv, uint(VIEW_INDEX));
+	return get_depth_bilinear(uv, view_index);
 #else
-		depth = texture(META_ENVIRONMENT_DEPTH_TEXTURE, vec3(reprojected_uv, float(VIEW_INDEX))).r;
+	return textureLod(META_ENVIRONMENT_DEPTH_TEXTURE, vec3(uv, float(view_index)), 0.0).r;
 #endif
-	}
-	if (depth == 0.0) {
-		discard;
+}
+// Returns the value to write to DEPTH for the environment depth seen at the given camera clip
+// space position, or 0.0 if there is no depth available there.
+highp float reproject(highp vec2 clip_xy, int view_index, out bool valid) {
+	highp mat4 camera_to_depth_proj = (view_index == 0) ? META_ENVIRONMENT_DEPTH_FROM_CAMERA_PROJECTION_LEFT : META_ENVIRONMENT_DEPTH_FROM_CAMERA_PROJECTION_RIGHT;
+	highp mat4 depth_to_camera_proj = (view_index == 0) ? META_ENVIRONMENT_DEPTH_TO_CAMERA_PROJECTION_LEFT : META_ENVIRONMENT_DEPTH_TO_CAMERA_PROJECTION_RIGHT;
+	highp vec4 clip = vec4(clip_xy, 1.0, 1.0);
+	highp vec4 reprojected = camera_to_depth_proj * clip;
+	reprojected /= reprojected.w;
+	highp vec2 reprojected_uv = reprojected.xy * 0.5 + 0.5;
+	highp float depth = get_depth(reprojected_uv, uint(view_index));
+	valid = depth != 0.0;
+	if (!valid) {
+		return 0.0;
 	}
 	highp vec4 clip_back = vec4(reprojected.xy, depth * 2.0 - 1.0, 1.0);
 	clip_back = depth_to_camera_proj * clip_back;
@@ -142,15 +180,88 @@ void fragment() {
 
 	highp float camera_ndc_z = clip_back.z / clip_back.w;
 #if CURRENT_RENDERER == RENDERER_COMPATIBILITY
-	highp float camera_depth = 1.0 - (camera_ndc_z * 0.5 + 0.5);
+	return 1.0 - (camera_ndc_z * 0.5 + 0.5);
 #else
-	highp float camera_depth = camera_ndc_z;
+	return camera_ndc_z;
 #endif
+}
+void vertex() {
+	highp vec2 clip_xy = VERTEX.xy;
+#ifdef USE_REGION
+	highp vec4 region = (VIEW_INDEX == VIEW_MONO_LEFT) ? region_left : region_right;
+	clip_xy = mix(region.xy, region.zw, VERTEX.xy * 0.5 + 0.5);
+#endif // USE_REGION
+	UV = clip_xy * 0.5 + 0.5;
+	POSITION = vec4(clip_xy, VERTEX.z, 1.0);
+#ifdef USE_VERTEX_REPROJECTION
+	bool valid;
+	reprojected_depth = reproject(clip_xy, VIEW_INDEX, valid);
+	reprojected_valid = valid ? 1.0 : 0.0;
+#endif // USE_VERTEX_REPROJECTION
+}
+void fragment() {
+#ifdef USE_VERTEX_REPROJECTION
+	// Drop the parts of cells bordering on texels without depth data.
+	if (reprojected_valid < 0.999) {
+		discard;
+	}
+	highp float camera_depth = reprojected_depth;
+#else
+	bool valid;
+	highp float camera_depth = reproject(UV * 2.0 - 1.0, VIEW_INDEX, valid);
+	if (!valid) {
+		discard;
+	}
+#endif // USE_VERTEX_REPROJECTION
 	ALBEDO = vec3(0.0, 0.0, 0.0);
 	DEPTH = camera_depth;
 }
 )";
 
+// Reduces each TILE_SIZE x TILE_SIZE block of the depth swapchain image to the min and max linear
+// depth, which is the first level of the depth pyramid used for occlusion queries.
+static const char *META_ENVIRONMENT_DEPTH_PYRAMID_SHADER_CODE = R"(
+#version 450
+//DEFINES
+layout(local_size_x = 8, local_size_y = 8, local_size_z = 1) in;
+layout(set = 0, binding = 0) uniform sampler2DArray depth_texture;
+layout(set = 0, binding = 1, rg32f) uniform restrict writeonly image2DArray min_max_image;
+layout(push_constant, std430) uniform Params {
+	ivec2 depth_size;
+	float near_z;
+	float far_z;
+} params;
+float get_linear_depth(float depth) {
+	if (depth <= 0.0 || depth >= 1.0) {
+		return uintBitsToFloat(0x7f800000u);
+	}
+	float ndc_z = depth * 2.0 - 1.0;
+	if (params.far_z > params.near_z) {
+		return 2.0 * params.far_z * params.near_z / (params.far_z + params.near_z - ndc_z * (params.far_z - params.near_z));
+	}
+	// Infinite far plane.
+	return 2.0 * params.near_z / (1.0 - ndc_z);
+}
+void main() {
+	ivec3 dst = ivec3(gl_GlobalInvocationID);
+	if (any(greaterThanEqual(dst.xy, imageSize(min_max_image).xy))) {
+		return;
+	}
+	ivec2 src_begin = dst.xy * TILE_SIZE;
+	ivec2 src_end = min(src_begin + TILE_SIZE, params.depth_size);
+	float min_depth = uintBitsToFloat(0x7f800000u);
+	float max_depth = 0.0;
+	for (int y = src_begin.y; y < src_end.y; y++) {
+		for (int x = src_begin.x; x < src_end.x; x++) {
+			float depth = get_linear_depth(texelFetch(depth_texture, ivec3(x, y, dst.z), 0).r);
+			min_depth = min(min_depth, depth);
+			max_depth = max(max_depth, depth);
+		}
+	}
+	imageStore(min_max_image, dst, vec4(min_depth, max_depth, 0.0, 0.0));
+}
+)";
+
 OpenXRMetaEnvironmentDepthExtension *OpenXRMetaEnvironmentDepthExtension::singleton = nullptr;
 
 OpenXRMetaEnvironmentDepthExtension *OpenXRMetaEnvironmentDepthExtension::get_singleton() {
@@ -167,6 +278,19 @@ OpenXRMetaEnvironmentDepthExtension::OpenXRMetaEnvironmentDepthExtension() :
 	request_extensions[XR_META_ENVIRONMENT_DEPTH_EXTENSION_NAME] = &meta_environment_depth_ext;
 	singleton = this;
 
+	global_shader_parameter_names.resize(GLOBAL_SHADER_PARAMETER_MAX);
+	global_shader_parameter_names[GLOBAL_SHADER_PARAMETER_AVAILABLE] = StringName(META_ENVIRONMENT_DEPTH_AVAILABLE_NAME);
+	global_shader_parameter_names[GLOBAL_SHADER_PARAMETER_TEXTURE] = StringName(META_ENVIRONMENT_DEPTH_TEXTURE_NAME);
+	global_shader_parameter_names[GLOBAL_SHADER_PARAMETER_TEXEL_SIZE] = StringName(META_ENVIRONMENT_DEPTH_TEXEL_SIZE_NAME);
+	global_shader_parameter_names[GLOBAL_SHADER_PARAMETER_PROJECTION_VIEW + 0] = StringName(META_ENVIRONMENT_DEPTH_PROJECTION_VIEW_LEFT_NAME);
+	global_shader_parameter_names[GLOBAL_SHADER_PARAMETER_PROJECTION_VIEW + 1] = StringName(META_ENVIRONMENT_DEPTH_PROJECTION_VIEW_RIGHT_NAME);
+	global_shader_parameter_names[GLOBAL_SHADER_PARAMETER_INV_PROJECTION_VIEW + 0] = StringName(META_ENVIRONMENT_DEPTH_INV_PROJECTION_VIEW_LEFT_NAME);
+	global_shader_parameter_names[GLOBAL_SHADER_PARAMETER_INV_PROJECTION_VIEW + 1] = StringName(META_ENVIRONMENT_DEPTH_INV_PROJECTION_VIEW_RIGHT_NAME);
+	global_shader_parameter_names[GLOBAL_SHADER_PARAMETER_FROM_CAMERA_PROJECTION + 0] = StringName(META_ENVIRONMENT_DEPTH_FROM_CAMERA_PROJECTION_LEFT_NAME);
+	global_shader_parameter_names[GLOBAL_SHADER_PARAMETER_FROM_CAMERA_PROJECTION + 1] = StringName(META_ENVIRONMENT_DEPTH_FROM_CAMERA_PROJECTION_RIGHT_NAME);
+	global_shader_parameter_names[GLOBAL_SHADER_PARAMETER_TO_CAMERA_PROJECTION + 0] = StringName(META_ENVIRONMENT_DEPTH_TO_CAMERA_PROJECTION_LEFT_NAME);
+	global_shader_parameter_names[GLOBAL_SHADER_PARAMETER_TO_CAMERA_PROJECTION + 1] = StringName(META_ENVIRONMENT_DEPTH_TO_CAMERA_PROJECTION_RIGHT_NAME);
+
 #ifndef ANDROID_ENABLED
 	render_state.graphics_api = GRAPHICS_API_UNSUPPORTED;
 #endif // ANDROID_ENABLED
@@ -188,8 +312,31 @@ void OpenXRMetaEnvironmentDepthExtension::_bind_methods() {
 	ClassDB::bind_method(D_METHOD("set_hand_removal_enabled", "enable"), &OpenXRMetaEnvironmentDepthExtension::set_hand_removal_enabled);
 	ClassDB::bind_method(D_METHOD("get_hand_removal_enabled"), &OpenXRMetaEnvironmentDepthExtension::get_hand_removal_enabled);
 
+	ClassDB::bind_method(D_METHOD("set_hand_mask_enabled", "enabled"), &OpenXRMetaEnvironmentDepthExtension::set_hand_mask_enabled);
+	ClassDB::bind_method(D_METHOD("get_hand_mask_enabled"), &OpenXRMetaEnvironmentDepthExtension::get_hand_mask_enabled);
+
+	ClassDB::bind_method(D_METHOD("set_depth_acquisition_rate", "rate"), &OpenXRMetaEnvironmentDepthExtension::set_depth_acquisition_rate);
+	ClassDB::bind_method(D_METHOD("get_depth_acquisition_rate"), &OpenXRMetaEnvironmentDepthExtension::get_depth_acquisition_rate);
+
 	ClassDB::bind_method(D_METHOD("get_environment_depth_map_async", "callback"), &OpenXRMetaEnvironmentDepthExtension::get_environment_depth_map_async);
 
+	ClassDB::bind_method(D_METHOD("register_occlusion_receiver", "receiver"), &OpenXRMetaEnvironmentDepthExtension::register_occlusion_receiver);
+	ClassDB::bind_method(D_METHOD("unregister_occlusion_receiver", "receiver"), &OpenXRMetaEnvironmentDepthExtension::unregister_occlusion_receiver);
+
+	ClassDB::bind_method(D_METHOD("set_occlusion_queries_enabled", "enabled"), &OpenXRMetaEnvironmentDepthExtension::set_occlusion_queries_enabled);
+	ClassDB::bind_method(D_METHOD("get_occlusion_queries_enabled"), &OpenXRMetaEnvironmentDepthExtension::get_occlusion_queries_enabled);
+	ClassDB::bind_method(D_METHOD("test_occlusion_spheres", "spheres", "bias"), &OpenXRMetaEnvironmentDepthExtension::test_occlusion_spheres, DEFVAL(0.05));
+	ClassDB::bind_method(D_METHOD("test_occlusion_aabbs", "aabbs", "bias"), &OpenXRMetaEnvironmentDepthExtension::test_occlusion_aabbs, DEFVAL(0.05));
+
+	ClassDB::bind_method(D_METHOD("set_depth_fusion", "depth_fusion"), &OpenXRMetaEnvironmentDepthExtension::set_depth_fusion);
+	ClassDB::bind_method(D_METHOD("get_depth_fusion"), &OpenXRMetaEnvironmentDepthExtension::get_depth_fusion);
+
+	ClassDB::bind_method(D_METHOD("set_depth_queries_enabled", "enabled"), &OpenXRMetaEnvironmentDepthExtension::set_depth_queries_enabled);
+	ClassDB::bind_method(D_METHOD("get_depth_queries_enabled"), &OpenXRMetaEnvironmentDepthExtension::get_depth_queries_enabled);
+	ClassDB::bind_method(D_METHOD("depth_raycast_batch", "rays", "max_distance"), &OpenXRMetaEnvironmentDepthExtension::depth_raycast_batch, DEFVAL(10.0));
+	ClassDB::bind_method(D_METHOD("estimate_depth_plane", "position", "radius"), &OpenXRMetaEnvironmentDepthExtension::estimate_depth_plane, DEFVAL(0.1));
+	ClassDB::bind_method(D_METHOD("estimate_depth_planes", "positions", "radius"), &OpenXRMetaEnvironmentDepthExtension::estimate_depth_planes, DEFVAL(0.1));
+
 	ADD_SIGNAL(MethodInfo("openxr_meta_environment_depth_started"));
 	ADD_SIGNAL(MethodInfo("openxr_meta_environment_depth_stopped"));
 }
@@ -224,6 +371,44 @@ void OpenXRMetaEnvironmentDepthExtension::_on_session_destroyed() {
 	_destroy_depth_provider_rt();
 }
 
+void OpenXRMetaEnvironmentDepthExtension::_on_state_ready() {
+	// The render target size is only known once the session has begun.
+	if (reprojection_downsample > 1) {
+		_update_mesh();
+	}
+}
+
+void OpenXRMetaEnvironmentDepthExtension::_on_process() {
+	if (hand_mask_enabled && depth_provider_started) {
+		RenderingServer *rs = RenderingServer::get_singleton();
+		ERR_FAIL_NULL(rs);
+		rs->call_on_render_thread(callable_mp(this, &OpenXRMetaEnvironmentDepthExtension::_set_hand_mask_capsules_rt).bind(OpenXREnvironmentDepthHandMask::gather_capsules()));
+	}
+
+	if (!reprojection_limit_to_receivers || reprojection_material.is_null() || !depth_provider_started) {
+		return;
+	}
+
+	reprojection_material->set_shader_parameter("region_left", occlusion_receivers.get_region(0));
+	reprojection_material->set_shader_parameter("region_right", occlusion_receivers.get_region(1));
+}
+
+#ifdef ANDROID_ENABLED
+static bool is_same_depth_image(const XrEnvironmentDepthImageMETA &p_a, const XrEnvironmentDepthImageMETA &p_b) {
+	if (p_a.swapchainIndex != p_b.swapchainIndex || p_a.nearZ != p_b.nearZ || p_a.farZ != p_b.farZ) {
+		return false;
+	}
+
+	for (int i = 0; i < 2; i++) {
+		if (memcmp(&p_a.views[i].pose, &p_b.views[i].pose, sizeof(XrPosef)) != 0 || memcmp(&p_a.views[i].fov, &p_b.views[i].fov, sizeof(XrFovf)) != 0) {
+			return false;
+		}
+	}
+
+	return true;
+}
+#endif // ANDROID_ENABLED
+
 void OpenXRMetaEnvironmentDepthExtension::_on_pre_render() {
 #ifdef ANDROID_ENABLED
 	RenderingServer *rs = RenderingServer::get_singleton();
@@ -233,11 +418,8 @@ void OpenXRMetaEnvironmentDepthExtension::_on_pre_render() {
 		update_reprojection_material();
 	}
 
-	rs->global_shader_parameter_set(META_ENVIRONMENT_DEPTH_AVAILABLE_NAME, false);
-	rs->global_shader_parameter_set(META_ENVIRONMENT_DEPTH_TEXTURE_NAME, RID());
-	rs->global_shader_parameter_set(META_ENVIRONMENT_DEPTH_TEXEL_SIZE_NAME, Vector2());
-
 	if (render_state.depth_provider == XR_NULL_HANDLE || !render_state.depth_provider_started) {
+		_update_depth_globals_rt(RID());
 		return;
 	}
 
@@ -250,43 +432,120 @@ void OpenXRMetaEnvironmentDepthExtension::_on_pre_render() {
 	Ref<XRInterface> openxr_interface = xr_server->find_interface("OpenXR");
 	ERR_FAIL_COND(openxr_interface.is_null());
 
-	XrEnvironmentDepthImageAcquireInfoMETA acquire_info = {
-		XR_TYPE_ENVIRONMENT_DEPTH_IMAGE_ACQUIRE_INFO_META, // type
-		nullptr, // next
-		(XrSpace)openxr_api->get_play_space(),
-		openxr_api->get_predicted_display_time(),
-	};
+	XrTime display_time = openxr_api->get_predicted_display_time();
+
+	// In between acquisitions, the last depth image is reused.
+	bool should_acquire = !render_state.depth_image_valid || render_state.depth_acquisition_interval <= 0 || display_time - render_state.depth_image_acquire_time >= render_state.depth_acquisition_interval;
+
+	bool depth_image_changed = false;
+	if (should_acquire) {
+		XrEnvironmentDepthImageAcquireInfoMETA acquire_info = {
+			XR_TYPE_ENVIRONMENT_DEPTH_IMAGE_ACQUIRE_INFO_META, // type
+			nullptr, // next
+			(XrSpace)openxr_api->get_play_space(),
+			display_time,
+		};
+
+		XrEnvironmentDepthImageMETA depth_image = {
+			XR_TYPE_ENVIRONMENT_DEPTH_IMAGE_META, // type
+			nullptr, // next
+			0, // swapchainIndex
+			0.0, // nearZ
+			0.0, // farZ
+			{
+					// views
+					{
+							XR_TYPE_ENVIRONMENT_DEPTH_IMAGE_VIEW_META, // type
+							nullptr, // next
+					},
+					{
+							XR_TYPE_ENVIRONMENT_DEPTH_IMAGE_VIEW_META, // type
+							nullptr, // next
+					},
+			}
+		};
 
-	XrEnvironmentDepthImageMETA depth_image = {
-		XR_TYPE_ENVIRONMENT_DEPTH_IMAGE_META, // type
-		nullptr, // next
-		0, // swapchainIndex
-		0.0, // nearZ
-		0.0, // farZ
-		{
-				// views
-				{
-						XR_TYPE_ENVIRONMENT_DEPTH_IMAGE_VIEW_META, // type
-						nullptr, // next
-				},
-				{
-						XR_TYPE_ENVIRONMENT_DEPTH_IMAGE_VIEW_META, // type
-						nullptr, // next
-				},
+		XrResult result = xrAcquireEnvironmentDepthImageMETA(render_state.depth_provider, &acquire_info, &depth_image);
+		if (XR_FAILED(result)) {
+			UtilityFunctions::printerr("Failed to acquire environment depth image: ", openxr_api->get_error_string(result));
+			render_state.depth_image_valid = false;
+			_update_depth_globals_rt(RID());
+			return;
 		}
-	};
 
-	XrResult result = xrAcquireEnvironmentDepthImageMETA(render_state.depth_provider, &acquire_info, &depth_image);
-	if (XR_FAILED(result)) {
-		UtilityFunctions::printerr("Failed to acquire environment depth image: ", openxr_api->get_error_string(result));
+		render_state.depth_image_acquire_time = display_time;
+
+		// The depth sensor updates at a much lower rate than the display, so most of the time
+		// this is the same image as last frame.
+		if (result != XR_ENVIRONMENT_DEPTH_NOT_AVAILABLE_META && (!render_state.depth_image_valid || !is_same_depth_image(depth_image, render_state.depth_image))) {
+			render_state.depth_image = depth_image;
+			render_state.depth_image_valid = true;
+			depth_image_changed = true;
+		}
+	}
+
+	if (!render_state.depth_image_valid) {
+		_update_depth_globals_rt(RID());
 		return;
 	}
 
-	rs->global_shader_parameter_set(META_ENVIRONMENT_DEPTH_AVAILABLE_NAME, true);
-	rs->global_shader_parameter_set(META_ENVIRONMENT_DEPTH_TEXTURE_NAME, render_state.depth_swapchain_textures[depth_image.swapchainIndex]);
-	rs->global_shader_parameter_set(META_ENVIRONMENT_DEPTH_TEXEL_SIZE_NAME, render_state.depth_swapchain_texel_size);
+	const XrEnvironmentDepthImageMETA &depth_image = render_state.depth_image;
 
 	Transform3D world_origin = xr_server->get_world_origin();
+	if (world_origin != render_state.depth_image_world_origin) {
+		render_state.depth_image_world_origin = world_origin;
+		depth_image_changed = true;
+	}
+
+	// Everything that only depends on the depth image is left alone until it changes.
+	if (depth_image_changed) {
+		// The depth image holds window space depth of an OpenGL style projection, which is linearized
+		// by 1.0 / ((1.0 / far - 1.0 / near) * depth + 1.0 / near).
+		float inv_near_z = 1.0 / depth_image.nearZ;
+		float inv_far_z = std::isfinite(depth_image.farZ) ? 1.0 / depth_image.farZ : 0.0;
+		render_state.environment_depth_uniforms.set_depth_format(Vector4(0.0, 1.0, inv_far_z - inv_near_z, inv_near_z), render_state.depth_swapchain_texel_size, false);
+
+		for (int i = 0; i < 2; i++) {
+			XrPosef local_from_depth_eye = depth_image.views[i].pose;
+			XrPosef depth_eye_from_local;
+			XrPosef_Invert(&depth_eye_from_local, &local_from_depth_eye);
+
+			XrMatrix4x4f view_mat;
+			XrMatrix4x4f_CreateFromRigidTransform(&view_mat, &depth_eye_from_local);
+
+			XrMatrix4x4f projection_mat;
+			XrMatrix4x4f_CreateProjectionFov(
+					&projection_mat,
+					GRAPHICS_OPENGL,
+					depth_image.views[i].fov,
+					depth_image.nearZ,
+					std::isfinite(depth_image.farZ) ? depth_image.farZ : 0);
+
+			// Copy into Godot projections.
+			Projection godot_view_mat;
+			OpenXRUtilities::xrMatrix4x4f_to_godot_projection(&view_mat, godot_view_mat);
+			Projection godot_projection_mat;
+			OpenXRUtilities::xrMatrix4x4f_to_godot_projection(&projection_mat, godot_projection_mat);
+
+			render_state.depth_proj_view[i] = godot_projection_mat * godot_view_mat;
+			render_state.depth_inv_proj_view[i] = render_state.depth_proj_view[i].inverse();
+			rs->global_shader_parameter_set(global_shader_parameter_names[GLOBAL_SHADER_PARAMETER_PROJECTION_VIEW + i], render_state.depth_proj_view[i]);
+			rs->global_shader_parameter_set(global_shader_parameter_names[GLOBAL_SHADER_PARAMETER_INV_PROJECTION_VIEW + i], render_state.depth_inv_proj_view[i]);
+
+			const XrFovf &fov = depth_image.views[i].fov;
+			render_state.depth_tan_fov[i] = Vector4(tan(fov.angleLeft), tan(fov.angleRight), tan(fov.angleDown), tan(fov.angleUp));
+
+			Transform3D depth_to_local;
+			depth_to_local.origin = Vector3(local_from_depth_eye.position.x, local_from_depth_eye.position.y, local_from_depth_eye.position.z);
+			depth_to_local.basis = Basis(Quaternion(local_from_depth_eye.orientation.x, local_from_depth_eye.orientation.y, local_from_depth_eye.orientation.z, local_from_depth_eye.orientation.w));
+			render_state.depth_to_world[i] = world_origin * depth_to_local;
+
+			render_state.environment_depth_uniforms.set_view(i, render_state.depth_to_world[i], render_state.depth_tan_fov[i]);
+		}
+
+		render_state.depth_pyramid_dirty = true;
+	}
+
 	Vector2 viewport_size = openxr_interface->get_render_target_size();
 	float aspect = viewport_size.width / viewport_size.height;
 
@@ -295,32 +554,10 @@ void OpenXRMetaEnvironmentDepthExtension::_on_pre_render() {
 
 	Array callback_data;
 
+	// The camera moves every frame, even when the depth image doesn't.
 	for (int i = 0; i < 2; i++) {
-		XrPosef local_from_depth_eye = depth_image.views[i].pose;
-		XrPosef depth_eye_from_local;
-		XrPosef_Invert(&depth_eye_from_local, &local_from_depth_eye);
-
-		XrMatrix4x4f view_mat;
-		XrMatrix4x4f_CreateFromRigidTransform(&view_mat, &depth_eye_from_local);
-
-		XrMatrix4x4f projection_mat;
-		XrMatrix4x4f_CreateProjectionFov(
-				&projection_mat,
-				GRAPHICS_OPENGL,
-				depth_image.views[i].fov,
-				depth_image.nearZ,
-				std::isfinite(depth_image.farZ) ? depth_image.farZ : 0);
-
-		// Copy into Godot projections.
-		Projection godot_view_mat;
-		OpenXRUtilities::xrMatrix4x4f_to_godot_projection(&view_mat, godot_view_mat);
-		Projection godot_projection_mat;
-		OpenXRUtilities::xrMatrix4x4f_to_godot_projection(&projection_mat, godot_projection_mat);
-
-		Projection depth_proj_view = godot_projection_mat * godot_view_mat;
-		Projection depth_inv_proj_view = depth_proj_view.inverse();
-		rs->global_shader_parameter_set(i == 0 ? META_ENVIRONMENT_DEPTH_PROJECTION_VIEW_LEFT_NAME : META_ENVIRONMENT_DEPTH_PROJECTION_VIEW_RIGHT_NAME, depth_proj_view);
-		rs->global_shader_parameter_set(i == 0 ? META_ENVIRONMENT_DEPTH_INV_PROJECTION_VIEW_LEFT_NAME : META_ENVIRONMENT_DEPTH_INV_PROJECTION_VIEW_RIGHT_NAME, depth_inv_proj_view);
+		const Projection &depth_proj_view = render_state.depth_proj_view[i];
+		const Projection &depth_inv_proj_view = render_state.depth_inv_proj_view[i];
 
 		Projection camera_proj_view = openxr_interface->get_projection_for_view(i, aspect, z_near, z_far) * openxr_interface->get_transform_for_view(i, world_origin).affine_inverse();
 
@@ -330,8 +567,8 @@ void OpenXRMetaEnvironmentDepthExtension::_on_pre_render() {
 			camera_proj_view = correction * camera_proj_view;
 		}
 
-		rs->global_shader_parameter_set(i == 0 ? META_ENVIRONMENT_DEPTH_FROM_CAMERA_PROJECTION_LEFT_NAME : META_ENVIRONMENT_DEPTH_FROM_CAMERA_PROJECTION_RIGHT_NAME, depth_proj_view * camera_proj_view.inverse());
-		rs->global_shader_parameter_set(i == 0 ? META_ENVIRONMENT_DEPTH_TO_CAMERA_PROJECTION_LEFT_NAME : META_ENVIRONMENT_DEPTH_TO_CAMERA_PROJECTION_RIGHT_NAME, camera_proj_view * depth_inv_proj_view);
+		rs->global_shader_parameter_set(global_shader_parameter_names[GLOBAL_SHADER_PARAMETER_FROM_CAMERA_PROJECTION + i], depth_proj_view * camera_proj_view.inverse());
+		rs->global_shader_parameter_set(global_shader_parameter_names[GLOBAL_SHADER_PARAMETER_TO_CAMERA_PROJECTION + i], camera_proj_view * depth_inv_proj_view);
 
 		if (render_state.depth_map_callbacks.size() > 0) {
 			Dictionary data;
@@ -343,6 +580,26 @@ void OpenXRMetaEnvironmentDepthExtension::_on_pre_render() {
 
 			callback_data.push_back(data);
 		}
+
+		if (render_state.hand_mask_enabled) {
+			render_state.hand_mask.render_view(i, render_state.depth_to_world[i], render_state.depth_tan_fov[i]);
+		}
+	}
+
+	if (render_state.hand_mask_enabled) {
+		render_state.environment_depth_uniforms.set_hand_mask(render_state.hand_mask.update());
+	}
+
+	_update_depth_globals_rt(render_state.depth_swapchain_textures[depth_image.swapchainIndex]);
+
+	// Only one pyramid is in flight at a time, the readback typically lags a frame or two behind.
+	if (render_state.depth_pyramid_dirty && render_state.occlusion_queries_enabled && render_state.depth_pyramid_readbacks_pending == 0) {
+		Transform3D pyramid_world_to_view[2];
+		for (int i = 0; i < 2; i++) {
+			pyramid_world_to_view[i] = render_state.depth_to_world[i].affine_inverse();
+		}
+		_dispatch_depth_pyramid_rt(depth_image.swapchainIndex, depth_image.nearZ, std::isfinite(depth_image.farZ) ? depth_image.farZ : 0, pyramid_world_to_view, render_state.depth_tan_fov);
+		render_state.depth_pyramid_dirty = false;
 	}
 
 	if (render_state.depth_map_callbacks.size() > 0) {
@@ -385,6 +642,9 @@ void OpenXRMetaEnvironmentDepthExtension::stop_environment_depth() {
 	ERR_FAIL_COND(!depth_provider_started);
 
 	depth_provider_started = false;
+	depth_pyramid.clear();
+	// So depth queries don't keep answering from the last image.
+	cpu_depth_frame = OpenXREnvironmentDepthFrame();
 
 	rs->call_on_render_thread(callable_mp(this, &OpenXRMetaEnvironmentDepthExtension::_stop_environment_depth_rt));
 
@@ -406,6 +666,33 @@ bool OpenXRMetaEnvironmentDepthExtension::get_hand_removal_enabled() const {
 	return hand_removal_enabled;
 }
 
+void OpenXRMetaEnvironmentDepthExtension::set_hand_mask_enabled(bool p_enabled) {
+	RenderingServer *rs = RenderingServer::get_singleton();
+	ERR_FAIL_NULL(rs);
+	hand_mask_enabled = p_enabled;
+	rs->call_on_render_thread(callable_mp(this, &OpenXRMetaEnvironmentDepthExtension::_set_hand_mask_enabled_rt).bind(p_enabled));
+}
+
+bool OpenXRMetaEnvironmentDepthExtension::get_hand_mask_enabled() const {
+	return hand_mask_enabled;
+}
+
+void OpenXRMetaEnvironmentDepthExtension::set_depth_acquisition_rate(float p_rate) {
+	ERR_FAIL_COND(p_rate < 0.0);
+
+	RenderingServer *rs = RenderingServer::get_singleton();
+	ERR_FAIL_NULL(rs);
+	depth_acquisition_rate = p_rate;
+
+	// XrTime is in nanoseconds.
+	int64_t interval = p_rate > 0.0 ? (int64_t)(1000000000.0 / p_rate) : 0;
+	rs->call_on_render_thread(callable_mp(this, &OpenXRMetaEnvironmentDepthExtension::_set_depth_acquisition_interval_rt).bind(interval));
+}
+
+float OpenXRMetaEnvironmentDepthExtension::get_depth_acquisition_rate() const {
+	return depth_acquisition_rate;
+}
+
 RID OpenXRMetaEnvironmentDepthExtension::get_reprojection_mesh() {
 	if (reprojection_mesh.is_null()) {
 		reprojection_shader.instantiate();
@@ -415,25 +702,84 @@ RID OpenXRMetaEnvironmentDepthExtension::get_reprojection_mesh() {
 
 		reprojection_material->set_render_priority(reprojection_render_priority);
 
-		PackedVector3Array vertices;
-		vertices.resize(3);
-		vertices[0] = Vector3(-1.0f, -1.0f, 1.0f);
-		vertices[1] = Vector3(3.0f, -1.0f, 1.0f);
-		vertices[2] = Vector3(-1.0f, 3.0f, 1.0f);
-
-		Array arr;
-		arr.resize(RenderingServer::ARRAY_MAX);
-		arr[RenderingServer::ARRAY_VERTEX] = vertices;
-
 		reprojection_mesh.instantiate();
-		reprojection_mesh->add_surface_from_arrays(Mesh::PRIMITIVE_TRIANGLES, arr);
-		reprojection_mesh->surface_set_material(0, reprojection_material);
 		reprojection_mesh->set_custom_aabb(AABB(Vector3(-1000, -1000, -1000), Vector3(2000, 2000, 2000)));
+		_update_mesh();
 	}
 
 	return reprojection_mesh->get_rid();
 }
 
+void OpenXRMetaEnvironmentDepthExtension::_update_mesh() {
+	if (reprojection_mesh.is_null()) {
+		return;
+	}
+
+	// The shader positions these vertices in clip space.
+	PackedVector3Array vertices;
+	PackedInt32Array indices;
+
+	if (reprojection_downsample <= 1 && !reprojection_limit_to_receivers) {
+		// A single triangle covering the whole screen, reprojected per pixel.
+		vertices.push_back(Vector3(-1.0f, -1.0f, 1.0f));
+		vertices.push_back(Vector3(3.0f, -1.0f, 1.0f));
+		vertices.push_back(Vector3(-1.0f, 3.0f, 1.0f));
+	} else {
+		// A grid covering exactly [-1, 1], so it can be remapped to the region covered by the
+		// receivers. When downsampling, each vertex is reprojected, and the cells only interpolate.
+		Vector2i cells(1, 1);
+		if (reprojection_downsample > 1) {
+			Vector2 render_target_size(2048, 2048);
+			XRServer *xr_server = XRServer::get_singleton();
+			Ref<XRInterface> openxr_interface = xr_server ? xr_server->find_interface("OpenXR") : Ref<XRInterface>();
+			if (openxr_interface.is_valid() && openxr_interface->get_render_target_size().x > 0) {
+				render_target_size = openxr_interface->get_render_target_size();
+			}
+			cells.x = CLAMP(int(render_target_size.x) / reprojection_downsample, 1, MAX_REPROJECTION_GRID_CELLS);
+			cells.y = CLAMP(int(render_target_size.y) / reprojection_downsample, 1, MAX_REPROJECTION_GRID_CELLS);
+		}
+
+		vertices.resize((cells.x + 1) * (cells.y + 1));
+		Vector3 *vertices_ptrw = vertices.ptrw();
+		for (int y = 0; y <= cells.y; y++) {
+			for (int x = 0; x <= cells.x; x++) {
+				vertices_ptrw[y * (cells.x + 1) + x] = Vector3(float(x) / cells.x * 2.0f - 1.0f, float(y) / cells.y * 2.0f - 1.0f, 1.0f);
+			}
+		}
+
+		indices.resize(cells.x * cells.y * 6);
+		int32_t *indices_ptrw = indices.ptrw();
+		for (int y = 0; y < cells.y; y++) {
+			for (int x = 0; x < cells.x; x++) {
+				int32_t i00 = y * (cells.x + 1) + x;
+				int32_t i10 = i00 + 1;
+				int32_t i01 = i00 + cells.x + 1;
+				int32_t i11 = i01 + 1;
+
+				int32_t *cell = indices_ptrw + (y * cells.x + x) * 6;
+				cell[0] = i00;
+				cell[1] = i10;
+				cell[2] = i11;
+				cell[3] = i00;
+				cell[4] = i11;
+				cell[5] = i01;
+			}
+		}
+	}
+
+	Array arr;
+	arr.resize(RenderingServer::ARRAY_MAX);
+	arr[RenderingServer::ARRAY_VERTEX] = vertices;
+	if (!indices.is_empty()) {
+		arr[RenderingServer::ARRAY_INDEX] = indices;
+	}
+
+	// Keep the same mesh, so nodes using it don't need to be updated.
+	reprojection_mesh->clear_surfaces();
+	reprojection_mesh->add_surface_from_arrays(Mesh::PRIMITIVE_TRIANGLES, arr);
+	reprojection_mesh->surface_set_material(0, reprojection_material);
+}
+
 void OpenXRMetaEnvironmentDepthExtension::update_reprojection_material(bool p_creation) {
 	if (reprojection_shader.is_null() || reprojection_material.is_null()) {
 		return;
@@ -451,6 +797,12 @@ void OpenXRMetaEnvironmentDepthExtension::update_reprojection_material(bool p_cr
 	if (reprojection_bilinear_filtering) {
 		defines.append("#define USE_BILINEAR_FILTERING");
 	}
+	if (reprojection_downsample > 1) {
+		defines.append("#define USE_VERTEX_REPROJECTION");
+	}
+	if (reprojection_limit_to_receivers) {
+		defines.append("#define USE_REGION");
+	}
 
 	shader_code = shader_code.replace("//DEFINES", String("\n").join(defines));
 
@@ -509,6 +861,43 @@ bool OpenXRMetaEnvironmentDepthExtension::get_reprojection_bilinear_filtering()
 	return reprojection_bilinear_filtering;
 }
 
+void OpenXRMetaEnvironmentDepthExtension::set_reprojection_downsample(int p_downsample) {
+	p_downsample = CLAMP(p_downsample, 1, 16);
+	if (reprojection_downsample == p_downsample) {
+		return;
+	}
+
+	reprojection_downsample = p_downsample;
+	reprojection_material_dirty = true;
+	_update_mesh();
+}
+
+int OpenXRMetaEnvironmentDepthExtension::get_reprojection_downsample() const {
+	return reprojection_downsample;
+}
+
+void OpenXRMetaEnvironmentDepthExtension::set_reprojection_limit_to_receivers(bool p_enabled) {
+	if (reprojection_limit_to_receivers == p_enabled) {
+		return;
+	}
+
+	reprojection_limit_to_receivers = p_enabled;
+	reprojection_material_dirty = true;
+	_update_mesh();
+}
+
+bool OpenXRMetaEnvironmentDepthExtension::get_reprojection_limit_to_receivers() const {
+	return reprojection_limit_to_receivers;
+}
+
+void OpenXRMetaEnvironmentDepthExtension::register_occlusion_receiver(VisualInstance3D *p_receiver) {
+	occlusion_receivers.add(p_receiver);
+}
+
+void OpenXRMetaEnvironmentDepthExtension::unregister_occlusion_receiver(VisualInstance3D *p_receiver) {
+	occlusion_receivers.remove(p_receiver);
+}
+
 void OpenXRMetaEnvironmentDepthExtension::get_environment_depth_map_async(const Callable &p_callback) {
 	RenderingServer *rs = RenderingServer::get_singleton();
 	ERR_FAIL_NULL(rs);
@@ -516,50 +905,134 @@ void OpenXRMetaEnvironmentDepthExtension::get_environment_depth_map_async(const
 	rs->call_on_render_thread(callable_mp(this, &OpenXRMetaEnvironmentDepthExtension::_add_depth_map_callback_rt).bind(p_callback));
 }
 
-static void create_shader_global_uniform(const String &p_name, RenderingServer::GlobalShaderParameterType p_type, Variant p_value, RenderingServer *p_rendering_server, ProjectSettings *p_project_settings, bool p_is_editor) {
-	String setting_name = "shader_globals/" + p_name;
-	if (!p_project_settings->has_setting(setting_name)) {
-		p_rendering_server->global_shader_parameter_add(p_name, p_type, p_value);
-		if (p_is_editor) {
-			String type_name;
-			switch (p_type) {
-				case RenderingServer::GLOBAL_VAR_TYPE_BOOL: {
-					type_name = "bool";
-				} break;
-				case RenderingServer::GLOBAL_VAR_TYPE_SAMPLER2DARRAY: {
-					type_name = "sampler2DArray";
-				} break;
-				case RenderingServer::GLOBAL_VAR_TYPE_VEC2: {
-					type_name = "vec2";
-				} break;
-				case RenderingServer::GLOBAL_VAR_TYPE_MAT4: {
-					type_name = "mat4";
-				} break;
-			}
+void OpenXRMetaEnvironmentDepthExtension::set_occlusion_queries_enabled(bool p_enabled) {
+	RenderingServer *rs = RenderingServer::get_singleton();
+	ERR_FAIL_NULL(rs);
 
-			Variant setting_value = p_value;
-			if (p_type == RenderingServer::GLOBAL_VAR_TYPE_SAMPLER2DARRAY) {
-				// In ProjectSettings, this uses a path as a value.
-				setting_value = "";
-			}
+	if (p_enabled && get_graphics_api() != GRAPHICS_API_VULKAN) {
+		WARN_PRINT("Environment depth occlusion queries require the Vulkan renderer.");
+		return;
+	}
+
+	occlusion_queries_enabled = p_enabled;
+	if (!p_enabled) {
+		depth_pyramid.clear();
+	}
+
+	rs->call_on_render_thread(callable_mp(this, &OpenXRMetaEnvironmentDepthExtension::_set_occlusion_queries_enabled_rt).bind(p_enabled));
+}
+
+bool OpenXRMetaEnvironmentDepthExtension::get_occlusion_queries_enabled() const {
+	return occlusion_queries_enabled;
+}
+
+PackedByteArray OpenXRMetaEnvironmentDepthExtension::test_occlusion_spheres(const PackedFloat32Array &p_spheres, float p_bias) const {
+	return depth_pyramid.test_spheres(p_spheres, p_bias);
+}
 
-			Dictionary d;
-			d["type"] = type_name;
-			d["value"] = setting_value;
-			p_project_settings->set(setting_name, d);
+PackedByteArray OpenXRMetaEnvironmentDepthExtension::test_occlusion_aabbs(const PackedFloat32Array &p_aabbs, float p_bias) const {
+	return depth_pyramid.test_aabbs(p_aabbs, p_bias);
+}
+
+void OpenXRMetaEnvironmentDepthExtension::_set_depth_pyramid_view(int p_view, const Vector2i &p_size, const PackedFloat32Array &p_levels, const Transform3D &p_world_to_view, const Vector4 &p_tan_fov) {
+	if (!occlusion_queries_enabled || !depth_provider_started) {
+		return;
+	}
+
+	// The first row of the depth image is the bottom one.
+	depth_pyramid.set_view(p_view, p_size, p_levels, p_world_to_view, p_tan_fov, false);
+
+	// The depth image itself never leaves the GPU, so the CPU gets the nearest depth of each tile
+	// of the first pyramid level instead. Both views see nearly the same, so the first one is enough.
+	if (cpu_depth_frames_enabled && p_view == 0) {
+		int texel_count = p_size.x * p_size.y;
+		ERR_FAIL_COND(p_levels.size() < texel_count * 2);
+
+		PackedFloat32Array frame_depth;
+		frame_depth.resize(texel_count);
+		const float *levels = p_levels.ptr();
+		float *depth = frame_depth.ptrw();
+		for (int i = 0; i < texel_count; i++) {
+			depth[i] = levels[i * 2];
+		}
+
+		cpu_depth_frame.depth = frame_depth;
+		cpu_depth_frame.width = p_size.x;
+		cpu_depth_frame.height = p_size.y;
+		cpu_depth_frame.view_to_world = p_world_to_view.affine_inverse();
+		cpu_depth_frame.tan_fov = p_tan_fov;
+		cpu_depth_frame.flip_y = false;
+		cpu_depth_frame.index++;
+
+		if (depth_fusion.is_valid()) {
+			depth_fusion->integrate_depth_image(frame_depth, p_size.x, p_size.y, cpu_depth_frame.view_to_world, p_tan_fov, false);
 		}
 	}
 }
 
-static void remove_shader_global_uniform(const String &p_name, RenderingServer *p_rendering_server, ProjectSettings *p_project_settings) {
-	String setting_name = "shader_globals/" + p_name;
-	if (p_project_settings->has_setting(setting_name)) {
-		p_rendering_server->global_shader_parameter_remove(p_name);
-		p_project_settings->clear(setting_name);
+void OpenXRMetaEnvironmentDepthExtension::set_depth_fusion(const Ref<OpenXREnvironmentDepthFusion> &p_depth_fusion) {
+	depth_fusion = p_depth_fusion;
+	_update_cpu_depth_frames_enabled();
+}
+
+Ref<OpenXREnvironmentDepthFusion> OpenXRMetaEnvironmentDepthExtension::get_depth_fusion() const {
+	return depth_fusion;
+}
+
+void OpenXRMetaEnvironmentDepthExtension::set_depth_queries_enabled(bool p_enabled) {
+	if (p_enabled == depth_queries_enabled) {
+		return;
+	}
+
+	depth_queries_enabled = p_enabled;
+	if (p_enabled) {
+		register_cpu_depth_frame_user();
+	} else {
+		unregister_cpu_depth_frame_user();
+	}
+}
+
+bool OpenXRMetaEnvironmentDepthExtension::get_depth_queries_enabled() const {
+	return depth_queries_enabled;
+}
+
+PackedFloat32Array OpenXRMetaEnvironmentDepthExtension::depth_raycast_batch(const PackedFloat32Array &p_rays, float p_max_distance) const {
+	return OpenXREnvironmentDepthQueries::raycast(cpu_depth_frame, p_rays, p_max_distance);
+}
+
+Dictionary OpenXRMetaEnvironmentDepthExtension::estimate_depth_plane(const Vector3 &p_position, float p_radius) const {
+	return OpenXREnvironmentDepthQueries::estimate_plane(cpu_depth_frame, p_position, p_radius);
+}
+
+PackedFloat32Array OpenXRMetaEnvironmentDepthExtension::estimate_depth_planes(const PackedFloat32Array &p_positions, float p_radius) const {
+	return OpenXREnvironmentDepthQueries::estimate_planes(cpu_depth_frame, p_positions, p_radius);
+}
+
+void OpenXRMetaEnvironmentDepthExtension::register_cpu_depth_frame_user() {
+	cpu_depth_frame_users++;
+	_update_cpu_depth_frames_enabled();
+}
+
+void OpenXRMetaEnvironmentDepthExtension::unregister_cpu_depth_frame_user() {
+	ERR_FAIL_COND(cpu_depth_frame_users <= 0);
+	cpu_depth_frame_users--;
+	_update_cpu_depth_frames_enabled();
+}
+
+const OpenXREnvironmentDepthFrame &OpenXRMetaEnvironmentDepthExtension::get_cpu_depth_frame() const {
+	return cpu_depth_frame;
+}
+
+void OpenXRMetaEnvironmentDepthExtension::_update_cpu_depth_frames_enabled() {
+	cpu_depth_frames_enabled = depth_fusion.is_valid() || cpu_depth_frame_users > 0;
+	if (!cpu_depth_frames_enabled) {
+		cpu_depth_frame.depth = PackedFloat32Array();
 	}
 }
 
 void OpenXRMetaEnvironmentDepthExtension::setup_global_uniforms() {
+	OpenXREnvironmentDepthUniforms::setup_global_uniforms();
+
 	RenderingServer *rs = RenderingServer::get_singleton();
 	ERR_FAIL_NULL(rs);
 
@@ -569,17 +1042,17 @@ void OpenXRMetaEnvironmentDepthExtension::setup_global_uniforms() {
 	bool enabled = project_settings->get_setting_with_override("xr/openxr/extensions/meta/environment_depth");
 
 	if (!enabled) {
-		remove_shader_global_uniform(META_ENVIRONMENT_DEPTH_AVAILABLE_NAME, rs, project_settings);
-		remove_shader_global_uniform(META_ENVIRONMENT_DEPTH_TEXTURE_NAME, rs, project_settings);
-		remove_shader_global_uniform(META_ENVIRONMENT_DEPTH_TEXEL_SIZE_NAME, rs, project_settings);
-		remove_shader_global_uniform(META_ENVIRONMENT_DEPTH_PROJECTION_VIEW_LEFT_NAME, rs, project_settings);
-		remove_shader_global_uniform(META_ENVIRONMENT_DEPTH_PROJECTION_VIEW_RIGHT_NAME, rs, project_settings);
-		remove_shader_global_uniform(META_ENVIRONMENT_DEPTH_INV_PROJECTION_VIEW_LEFT_NAME, rs, project_settings);
-		remove_shader_global_uniform(META_ENVIRONMENT_DEPTH_INV_PROJECTION_VIEW_RIGHT_NAME, rs, project_settings);
-		remove_shader_global_uniform(META_ENVIRONMENT_DEPTH_FROM_CAMERA_PROJECTION_LEFT_NAME, rs, project_settings);
-		remove_shader_global_uniform(META_ENVIRONMENT_DEPTH_FROM_CAMERA_PROJECTION_RIGHT_NAME, rs, project_settings);
-		remove_shader_global_uniform(META_ENVIRONMENT_DEPTH_TO_CAMERA_PROJECTION_LEFT_NAME, rs, project_settings);
-		remove_shader_global_uniform(META_ENVIRONMENT_DEPTH_TO_CAMERA_PROJECTION_RIGHT_NAME, rs, project_settings);
+		OpenXREnvironmentDepthUniforms::remove_shader_global_uniform(META_ENVIRONMENT_DEPTH_AVAILABLE_NAME, rs, project_settings);
+		OpenXREnvironmentDepthUniforms::remove_shader_global_uniform(META_ENVIRONMENT_DEPTH_TEXTURE_NAME, rs, project_settings);
+		OpenXREnvironmentDepthUniforms::remove_shader_global_uniform(META_ENVIRONMENT_DEPTH_TEXEL_SIZE_NAME, rs, project_settings);
+		OpenXREnvironmentDepthUniforms::remove_shader_global_uniform(META_ENVIRONMENT_DEPTH_PROJECTION_VIEW_LEFT_NAME, rs, project_settings);
+		OpenXREnvironmentDepthUniforms::remove_shader_global_uniform(META_ENVIRONMENT_DEPTH_PROJECTION_VIEW_RIGHT_NAME, rs, project_settings);
+		OpenXREnvironmentDepthUniforms::remove_shader_global_uniform(META_ENVIRONMENT_DEPTH_INV_PROJECTION_VIEW_LEFT_NAME, rs, project_settings);
+		OpenXREnvironmentDepthUniforms::remove_shader_global_uniform(META_ENVIRONMENT_DEPTH_INV_PROJECTION_VIEW_RIGHT_NAME, rs, project_settings);
+		OpenXREnvironmentDepthUniforms::remove_shader_global_uniform(META_ENVIRONMENT_DEPTH_FROM_CAMERA_PROJECTION_LEFT_NAME, rs, project_settings);
+		OpenXREnvironmentDepthUniforms::remove_shader_global_uniform(META_ENVIRONMENT_DEPTH_FROM_CAMERA_PROJECTION_RIGHT_NAME, rs, project_settings);
+		OpenXREnvironmentDepthUniforms::remove_shader_global_uniform(META_ENVIRONMENT_DEPTH_TO_CAMERA_PROJECTION_LEFT_NAME, rs, project_settings);
+		OpenXREnvironmentDepthUniforms::remove_shader_global_uniform(META_ENVIRONMENT_DEPTH_TO_CAMERA_PROJECTION_RIGHT_NAME, rs, project_settings);
 
 		already_setup_global_uniforms = false;
 		return;
@@ -597,17 +1070,17 @@ void OpenXRMetaEnvironmentDepthExtension::setup_global_uniforms() {
 	// Set this right away, to prevent getting in a loop of project settings changes.
 	already_setup_global_uniforms = true;
 
-	create_shader_global_uniform(META_ENVIRONMENT_DEPTH_AVAILABLE_NAME, RenderingServer::GLOBAL_VAR_TYPE_BOOL, false, rs, project_settings, is_editor);
-	create_shader_global_uniform(META_ENVIRONMENT_DEPTH_TEXTURE_NAME, RenderingServer::GLOBAL_VAR_TYPE_SAMPLER2DARRAY, Variant(), rs, project_settings, is_editor);
-	create_shader_global_uniform(META_ENVIRONMENT_DEPTH_TEXEL_SIZE_NAME, RenderingServer::GLOBAL_VAR_TYPE_VEC2, Vector2(), rs, project_settings, is_editor);
-	create_shader_global_uniform(META_ENVIRONMENT_DEPTH_PROJECTION_VIEW_LEFT_NAME, RenderingServer::GLOBAL_VAR_TYPE_MAT4, Projection(), rs, project_settings, is_editor);
-	create_shader_global_uniform(META_ENVIRONMENT_DEPTH_PROJECTION_VIEW_RIGHT_NAME, RenderingServer::GLOBAL_VAR_TYPE_MAT4, Projection(), rs, project_settings, is_editor);
-	create_shader_global_uniform(META_ENVIRONMENT_DEPTH_INV_PROJECTION_VIEW_LEFT_NAME, RenderingServer::GLOBAL_VAR_TYPE_MAT4, Projection(), rs, project_settings, is_editor);
-	create_shader_global_uniform(META_ENVIRONMENT_DEPTH_INV_PROJECTION_VIEW_RIGHT_NAME, RenderingServer::GLOBAL_VAR_TYPE_MAT4, Projection(), rs, project_settings, is_editor);
-	create_shader_global_uniform(META_ENVIRONMENT_DEPTH_FROM_CAMERA_PROJECTION_LEFT_NAME, RenderingServer::GLOBAL_VAR_TYPE_MAT4, Projection(), rs, project_settings, is_editor);
-	create_shader_global_uniform(META_ENVIRONMENT_DEPTH_FROM_CAMERA_PROJECTION_RIGHT_NAME, RenderingServer::GLOBAL_VAR_TYPE_MAT4, Projection(), rs, project_settings, is_editor);
-	create_shader_global_uniform(META_ENVIRONMENT_DEPTH_TO_CAMERA_PROJECTION_LEFT_NAME, RenderingServer::GLOBAL_VAR_TYPE_MAT4, Projection(), rs, project_settings, is_editor);
-	create_shader_global_uniform(META_ENVIRONMENT_DEPTH_TO_CAMERA_PROJECTION_RIGHT_NAME, RenderingServer::GLOBAL_VAR_TYPE_MAT4, Projection(), rs, project_settings, is_editor);
+	OpenXREnvironmentDepthUniforms::create_shader_global_uniform(META_ENVIRONMENT_DEPTH_AVAILABLE_NAME, RenderingServer::GLOBAL_VAR_TYPE_BOOL, false, rs, project_settings, is_editor);
+	OpenXREnvironmentDepthUniforms::create_shader_global_uniform(META_ENVIRONMENT_DEPTH_TEXTURE_NAME, RenderingServer::GLOBAL_VAR_TYPE_SAMPLER2DARRAY, Variant(), rs, project_settings, is_editor);
+	OpenXREnvironmentDepthUniforms::create_shader_global_uniform(META_ENVIRONMENT_DEPTH_TEXEL_SIZE_NAME, RenderingServer::GLOBAL_VAR_TYPE_VEC2, Vector2(), rs, project_settings, is_editor);
+	OpenXREnvironmentDepthUniforms::create_shader_global_uniform(META_ENVIRONMENT_DEPTH_PROJECTION_VIEW_LEFT_NAME, RenderingServer::GLOBAL_VAR_TYPE_MAT4, Projection(), rs, project_settings, is_editor);
+	OpenXREnvironmentDepthUniforms::create_shader_global_uniform(META_ENVIRONMENT_DEPTH_PROJECTION_VIEW_RIGHT_NAME, RenderingServer::GLOBAL_VAR_TYPE_MAT4, Projection(), rs, project_settings, is_editor);
+	OpenXREnvironmentDepthUniforms::create_shader_global_uniform(META_ENVIRONMENT_DEPTH_INV_PROJECTION_VIEW_LEFT_NAME, RenderingServer::GLOBAL_VAR_TYPE_MAT4, Projection(), rs, project_settings, is_editor);
+	OpenXREnvironmentDepthUniforms::create_shader_global_uniform(META_ENVIRONMENT_DEPTH_INV_PROJECTION_VIEW_RIGHT_NAME, RenderingServer::GLOBAL_VAR_TYPE_MAT4, Projection(), rs, project_settings, is_editor);
+	OpenXREnvironmentDepthUniforms::create_shader_global_uniform(META_ENVIRONMENT_DEPTH_FROM_CAMERA_PROJECTION_LEFT_NAME, RenderingServer::GLOBAL_VAR_TYPE_MAT4, Projection(), rs, project_settings, is_editor);
+	OpenXREnvironmentDepthUniforms::create_shader_global_uniform(META_ENVIRONMENT_DEPTH_FROM_CAMERA_PROJECTION_RIGHT_NAME, RenderingServer::GLOBAL_VAR_TYPE_MAT4, Projection(), rs, project_settings, is_editor);
+	OpenXREnvironmentDepthUniforms::create_shader_global_uniform(META_ENVIRONMENT_DEPTH_TO_CAMERA_PROJECTION_LEFT_NAME, RenderingServer::GLOBAL_VAR_TYPE_MAT4, Projection(), rs, project_settings, is_editor);
+	OpenXREnvironmentDepthUniforms::create_shader_global_uniform(META_ENVIRONMENT_DEPTH_TO_CAMERA_PROJECTION_RIGHT_NAME, RenderingServer::GLOBAL_VAR_TYPE_MAT4, Projection(), rs, project_settings, is_editor);
 }
 
 bool OpenXRMetaEnvironmentDepthExtension::initialize_meta_environment_depth_extension(const XrInstance &p_instance) {
@@ -688,6 +1161,7 @@ bool OpenXRMetaEnvironmentDepthExtension::_create_depth_provider_rt() {
 	}
 
 	render_state.depth_swapchain_texel_size = Vector2(1.0 / swapchain_state.width, 1.0 / swapchain_state.height);
+	render_state.depth_swapchain_size = Vector2i(swapchain_state.width, swapchain_state.height);
 
 	uint32_t swapchain_length = 0;
 
@@ -766,6 +1240,7 @@ bool OpenXRMetaEnvironmentDepthExtension::_create_depth_provider_rt() {
 			RID texture = rs->texture_rd_create(rd_texture, RenderingServer::TextureLayeredType::TEXTURE_LAYERED_2D_ARRAY);
 
 			render_state.depth_swapchain_textures.push_back(texture);
+			render_state.depth_swapchain_rd_textures.push_back(rd_texture);
 		}
 	}
 
@@ -789,6 +1264,22 @@ OpenXRMetaEnvironmentDepthExtension::GraphicsAPI OpenXRMetaEnvironmentDepthExten
 	return GRAPHICS_API_UNSUPPORTED;
 }
 
+void OpenXRMetaEnvironmentDepthExtension::_update_depth_globals_rt(const RID &p_depth_texture) {
+	bool was_available = render_state.environment_depth_uniforms.is_available();
+	if (!render_state.environment_depth_uniforms.update(p_depth_texture)) {
+		return;
+	}
+
+	RenderingServer *rs = RenderingServer::get_singleton();
+	ERR_FAIL_NULL(rs);
+
+	rs->global_shader_parameter_set(global_shader_parameter_names[GLOBAL_SHADER_PARAMETER_TEXTURE], p_depth_texture);
+	if (p_depth_texture.is_valid() != was_available) {
+		rs->global_shader_parameter_set(global_shader_parameter_names[GLOBAL_SHADER_PARAMETER_AVAILABLE], p_depth_texture.is_valid());
+		rs->global_shader_parameter_set(global_shader_parameter_names[GLOBAL_SHADER_PARAMETER_TEXEL_SIZE], p_depth_texture.is_valid() ? render_state.depth_swapchain_texel_size : Vector2());
+	}
+}
+
 void OpenXRMetaEnvironmentDepthExtension::_start_environment_depth_rt() {
 	ERR_FAIL_COND(render_state.depth_provider_started);
 
@@ -804,6 +1295,7 @@ void OpenXRMetaEnvironmentDepthExtension::_start_environment_depth_rt() {
 		return;
 	}
 
+	render_state.depth_image_valid = false;
 	render_state.depth_provider_started = true;
 }
 
@@ -840,10 +1332,183 @@ void OpenXRMetaEnvironmentDepthExtension::_set_hand_removal_enabled_rt(bool p_en
 	}
 }
 
+void OpenXRMetaEnvironmentDepthExtension::_set_hand_mask_enabled_rt(bool p_enabled) {
+	render_state.hand_mask_enabled = p_enabled;
+	if (!p_enabled) {
+		render_state.environment_depth_uniforms.set_hand_mask(RID());
+		render_state.hand_mask.clear();
+	}
+}
+
+void OpenXRMetaEnvironmentDepthExtension::_set_depth_acquisition_interval_rt(int64_t p_interval) {
+	render_state.depth_acquisition_interval = p_interval;
+}
+
+void OpenXRMetaEnvironmentDepthExtension::_set_hand_mask_capsules_rt(const PackedFloat32Array &p_capsules) {
+	render_state.hand_mask.set_capsules(p_capsules);
+}
+
 void OpenXRMetaEnvironmentDepthExtension::_add_depth_map_callback_rt(const Callable &p_callback) {
 	render_state.depth_map_callbacks.push_back(p_callback);
 }
 
+void OpenXRMetaEnvironmentDepthExtension::_set_occlusion_queries_enabled_rt(bool p_enabled) {
+	render_state.occlusion_queries_enabled = p_enabled;
+
+	if (!p_enabled) {
+		_free_depth_pyramid_rt();
+	}
+}
+
+bool OpenXRMetaEnvironmentDepthExtension::_create_depth_pyramid_rt() {
+	if (render_state.depth_pyramid_pipeline.is_valid()) {
+		return true;
+	}
+
+	ERR_FAIL_COND_V(render_state.graphics_api != GRAPHICS_API_VULKAN, false);
+
+	RenderingDevice *rd = RenderingServer::get_singleton()->get_rendering_device();
+	ERR_FAIL_NULL_V(rd, false);
+
+	String shader_code = String(META_ENVIRONMENT_DEPTH_PYRAMID_SHADER_CODE).replace("//DEFINES", vformat("#define TILE_SIZE %d", OpenXREnvironmentDepthPyramid::BASE_TILE_SIZE));
+
+	Ref<RDShaderSource> shader_source;
+	shader_source.instantiate();
+	shader_source->set_language(RenderingDevice::SHADER_LANGUAGE_GLSL);
+	shader_source->set_stage_source(RenderingDevice::SHADER_STAGE_COMPUTE, shader_code);
+
+	Ref<RDShaderSPIRV> shader_spirv = rd->shader_compile_spirv_from_source(shader_source);
+	ERR_FAIL_COND_V(shader_spirv.is_null(), false);
+
+	String compile_error = shader_spirv->get_stage_compile_error(RenderingDevice::SHADER_STAGE_COMPUTE);
+	if (!compile_error.is_empty()) {
+		UtilityFunctions::printerr("Failed to compile environment depth pyramid shader: ", compile_error);
+		return false;
+	}
+
+	render_state.depth_pyramid_shader = rd->shader_create_from_spirv(shader_spirv, "EnvironmentDepthPyramid");
+	ERR_FAIL_COND_V(!render_state.depth_pyramid_shader.is_valid(), false);
+
+	render_state.depth_pyramid_pipeline = rd->compute_pipeline_create(render_state.depth_pyramid_shader);
+
+	Ref<RDSamplerState> sampler_state;
+	sampler_state.instantiate();
+	render_state.depth_pyramid_sampler = rd->sampler_create(sampler_state);
+
+	render_state.depth_pyramid_size = Vector2i(
+			(render_state.depth_swapchain_size.x + OpenXREnvironmentDepthPyramid::BASE_TILE_SIZE - 1) / OpenXREnvironmentDepthPyramid::BASE_TILE_SIZE,
+			(render_state.depth_swapchain_size.y + OpenXREnvironmentDepthPyramid::BASE_TILE_SIZE - 1) / OpenXREnvironmentDepthPyramid::BASE_TILE_SIZE);
+
+	Ref<RDTextureFormat> texture_format;
+	texture_format.instantiate();
+	texture_format->set_texture_type(RenderingDevice::TEXTURE_TYPE_2D_ARRAY);
+	texture_format->set_format(RenderingDevice::DATA_FORMAT_R32G32_SFLOAT);
+	texture_format->set_width(render_state.depth_pyramid_size.x);
+	texture_format->set_height(render_state.depth_pyramid_size.y);
+	texture_format->set_array_layers(2);
+	texture_format->set_usage_bits(RenderingDevice::TEXTURE_USAGE_STORAGE_BIT | RenderingDevice::TEXTURE_USAGE_CAN_COPY_FROM_BIT);
+
+	Ref<RDTextureView> texture_view;
+	texture_view.instantiate();
+	render_state.depth_pyramid_texture = rd->texture_create(texture_format, texture_view);
+
+	render_state.depth_pyramid_uniform_sets.resize(render_state.depth_swapchain_rd_textures.size());
+	for (uint32_t i = 0; i < render_state.depth_swapchain_rd_textures.size(); i++) {
+		Ref<RDUniform> depth_uniform;
+		depth_uniform.instantiate();
+		depth_uniform->set_uniform_type(RenderingDevice::UNIFORM_TYPE_SAMPLER_WITH_TEXTURE);
+		depth_uniform->set_binding(0);
+		depth_uniform->add_id(render_state.depth_pyramid_sampler);
+		depth_uniform->add_id(render_state.depth_swapchain_rd_textures[i]);
+
+		Ref<RDUniform> image_uniform;
+		image_uniform.instantiate();
+		image_uniform->set_uniform_type(RenderingDevice::UNIFORM_TYPE_IMAGE);
+		image_uniform->set_binding(1);
+		image_uniform->add_id(render_state.depth_pyramid_texture);
+
+		TypedArray<RDUniform> uniforms;
+		uniforms.push_back(depth_uniform);
+		uniforms.push_back(image_uniform);
+		render_state.depth_pyramid_uniform_sets[i] = rd->uniform_set_create(uniforms, render_state.depth_pyramid_shader, 0);
+	}
+
+	return true;
+}
+
+void OpenXRMetaEnvironmentDepthExtension::_free_depth_pyramid_rt() {
+	render_state.depth_pyramid_uniform_sets.clear();
+	render_state.depth_pyramid_readbacks_pending = 0;
+
+	if (!render_state.depth_pyramid_shader.is_valid()) {
+		return;
+	}
+
+	RenderingDevice *rd = RenderingServer::get_singleton()->get_rendering_device();
+	ERR_FAIL_NULL(rd);
+
+	// Freeing the texture and shader also frees the uniform sets and pipeline depending on them.
+	rd->free_rid(render_state.depth_pyramid_texture);
+	rd->free_rid(render_state.depth_pyramid_sampler);
+	rd->free_rid(render_state.depth_pyramid_shader);
+
+	render_state.depth_pyramid_texture = RID();
+	render_state.depth_pyramid_sampler = RID();
+	render_state.depth_pyramid_shader = RID();
+	render_state.depth_pyramid_pipeline = RID();
+}
+
+void OpenXRMetaEnvironmentDepthExtension::_dispatch_depth_pyramid_rt(uint32_t p_swapchain_index, float p_near_z, float p_far_z, const Transform3D *p_world_to_view, const Vector4 *p_tan_fov) {
+	if (!_create_depth_pyramid_rt()) {
+		// Don't try again every frame.
+		UtilityFunctions::printerr("Failed to create the environment depth pyramid, disabling occlusion queries.");
+		render_state.occlusion_queries_enabled = false;
+		callable_mp(this, &OpenXRMetaEnvironmentDepthExtension::set_occlusion_queries_enabled).call_deferred(false);
+		return;
+	}
+
+	ERR_FAIL_UNSIGNED_INDEX(p_swapchain_index, render_state.depth_pyramid_uniform_sets.size());
+
+	RenderingDevice *rd = RenderingServer::get_singleton()->get_rendering_device();
+	ERR_FAIL_NULL(rd);
+
+	PackedByteArray push_constant;
+	push_constant.resize(16);
+	push_constant.encode_s32(0, render_state.depth_swapchain_size.x);
+	push_constant.encode_s32(4, render_state.depth_swapchain_size.y);
+	push_constant.encode_float(8, p_near_z);
+	push_constant.encode_float(12, p_far_z);
+
+	int64_t compute_list = rd->compute_list_begin();
+	rd->compute_list_bind_compute_pipeline(compute_list, render_state.depth_pyramid_pipeline);
+	rd->compute_list_bind_uniform_set(compute_list, render_state.depth_pyramid_uniform_sets[p_swapchain_index], 0);
+	rd->compute_list_set_push_constant(compute_list, push_constant, push_constant.size());
+	rd->compute_list_dispatch(compute_list, (render_state.depth_pyramid_size.x + 7) / 8, (render_state.depth_pyramid_size.y + 7) / 8, 2);
+	rd->compute_list_end();
+
+	for (int i = 0; i < 2; i++) {
+		Error err = rd->texture_get_data_async(render_state.depth_pyramid_texture, i, callable_mp(this, &OpenXRMetaEnvironmentDepthExtension::_on_depth_pyramid_readback_rt).bind(i, p_world_to_view[i], p_tan_fov[i]));
+		if (err == OK) {
+			render_state.depth_pyramid_readbacks_pending++;
+		}
+	}
+}
+
+void OpenXRMetaEnvironmentDepthExtension::_on_depth_pyramid_readback_rt(const PackedByteArray &p_data, int p_view, const Transform3D &p_world_to_view, const Vector4 &p_tan_fov) {
+	if (render_state.depth_pyramid_readbacks_pending > 0) {
+		render_state.depth_pyramid_readbacks_pending--;
+	}
+
+	const Vector2i &size = render_state.depth_pyramid_size;
+	if (!render_state.occlusion_queries_enabled || p_data.size() != size.x * size.y * 2 * (int64_t)sizeof(float)) {
+		return;
+	}
+
+	// Build the remaining levels here, and only hand the result over to the main thread.
+	PackedFloat32Array levels = OpenXREnvironmentDepthPyramid::build_levels_from_min_max(reinterpret_cast<const float *>(p_data.ptr()), size.x, size.y);
+	callable_mp(this, &OpenXRMetaEnvironmentDepthExtension::_set_depth_pyramid_view).call_deferred(p_view, size, levels, p_world_to_view, p_tan_fov);
+}
+
 void OpenXRMetaEnvironmentDepthExtension::_destroy_depth_provider_rt() {
 	if (render_state.depth_provider_started) {
 		_stop_environment_depth_rt();
@@ -857,7 +1522,14 @@ void OpenXRMetaEnvironmentDepthExtension::_destroy_depth_provider_rt() {
 		render_state.depth_swapchain = XR_NULL_HANDLE;
 	}
 
+	_free_depth_pyramid_rt();
+
+	_update_depth_globals_rt(RID());
+	render_state.environment_depth_uniforms.clear();
+	render_state.hand_mask.clear();
+
 	render_state.depth_swapchain_textures.clear();
+	render_state.depth_swapchain_rd_textures.clear();
 
 	if (render_state.depth_provider != XR_NULL_HANDLE) {
 		XrResult result = xrDestroyEnvironmentDepthProviderMETA(render_state.depth_provider);
@@ -874,4 +1546,5 @@ void OpenXRMetaEnvironmentDepthExtension::_destroy_depth_provider_rt() {
 void OpenXRMetaEnvironmentDepthExtension::reset_state() {
 	depth_provider_started = false;
 	hand_removal_enabled = false;
+	depth_pyramid.clear();
 }
@@ -62,6 +62,7 @@ public:
 		AMBIENT_LIGHT_MODE_COLOR,
 		AMBIENT_LIGHT_MODE_SPHERICAL_HARMONICS,
 		AMBIENT_LIGHT_MODE_CUBEMAP,
+		AMBIENT_LIGHT_MODE_SPHERICAL_HARMONICS_GLOBAL_SHADER,
 	};
 
 	void set_directional_light(DirectionalLight3D *p_directional_light);
@@ -82,6 +83,15 @@ public:
 	void set_ambient_light_energy_multiplier(float p_value);
 	float get_ambient_light_energy_multiplier();
 
+	void set_smoothing_time(float p_smoothing_time);
+	float get_smoothing_time() const;
+
+	void set_sky_update_threshold(float p_threshold);
+	float get_sky_update_threshold() const;
+
+	void set_max_sky_update_rate(float p_rate);
+	float get_max_sky_update_rate() const;
+
 private:
 	ObjectID directional_light_id;
 	ObjectID world_environment_id;
@@ -93,6 +103,32 @@ private:
 	float directional_light_energy_multiplier = 1.0f;
 	float ambient_light_energy_multiplier = 1.0f;
 
+	float smoothing_time = 0.0f;
+	float sky_update_threshold = 0.0f;
+	float max_sky_update_rate = 0.0f;
+
+	struct DirectionalLightState {
+		bool valid = false;
+		bool dirty = false;
+		Vector3 target_direction;
+		Color target_intensity;
+		Vector3 direction;
+		Color intensity;
+	} directional_light_state;
+
+	struct SphericalHarmonicsState {
+		bool valid = false;
+		bool dirty = false;
+		Vector3 target_coefficients[9];
+		Vector3 coefficients[9];
+
+		// What was last pushed to the sky material or global shader parameters.
+		PackedVector3Array applied_coefficients;
+		Basis applied_rotation;
+		float applied_energy_multiplier = 0.0f;
+		uint64_t last_applied_usec = 0;
+	} spherical_harmonics_state;
+
 	Ref<Shader> sky_shader;
 	Ref<ShaderMaterial> sky_material;
 	Ref<Sky> sky;
@@ -101,6 +137,9 @@ private:
 	void start_or_stop();
 	void configure_light_estimate_types();
 	void update_light_estimate();
+	void update_directional_light(float p_weight);
+	void update_spherical_harmonics(float p_weight);
+	bool needs_spherical_harmonics_update(const Basis &p_rotation, float p_threshold) const;
 	void reset_sky();
 };
 
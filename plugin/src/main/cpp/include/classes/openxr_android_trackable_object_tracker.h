@@ -52,6 +52,10 @@ public:
 
 	static Ref<OpenXRAndroidTrackableTracker> create(XrTrackableANDROID p_trackable, XrTrackableTrackerANDROID p_trackable_tracker);
 
+	// Updates the tracker from object data that has already been queried this frame, so it
+	// doesn't query the runtime again.
+	void update_from_xrtrackable_object(const XrTrackableObjectANDROID &p_xr_trackable_object);
+
 	Vector3 get_extents();
 	ObjectLabel get_object_label();
 	RID get_object_context();
@@ -62,6 +66,7 @@ protected:
 private:
 	void _ensure_updated() override;
 	bool _get_xrtrackable_info(XrTrackableObjectANDROID &p_xr_trackable_object);
+	void _apply_xrtrackable_object(const XrTrackableObjectANDROID &p_xr_trackable_object);
 
 	uint64_t last_frame = -1;
 
@@ -0,0 +1,108 @@
+/**************************************************************************/
+/*  openxr_body_retargeter.h                                              */
+/**************************************************************************/
+/*                       This file is part of:                            */
+/*                              GODOT XR                                  */
+/*                      https://godotengine.org                           */
+/**************************************************************************/
+/* Copyright (c) 2022-present Godot XR contributors (see CONTRIBUTORS.md) */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#pragma once
+
+#include <godot_cpp/classes/bone_map.hpp>
+#include <godot_cpp/classes/node.hpp>
+#include <godot_cpp/classes/skeleton3d.hpp>
+#include <godot_cpp/classes/skeleton_profile.hpp>
+#include <godot_cpp/classes/xr_body_tracker.hpp>
+#include <godot_cpp/templates/local_vector.hpp>
+
+namespace godot {
+class OpenXRBodyRetargeter : public Node {
+	GDCLASS(OpenXRBodyRetargeter, Node);
+
+	// A skeleton bone driven by a body tracker joint, with everything needed to pose it precomputed.
+	struct BoneEntry {
+		int bone = -1;
+		XRBodyTracker::Joint joint = XRBodyTracker::JOINT_ROOT;
+
+		// The closest ancestor entry, or -1 if no ancestor of this bone is driven.
+		int parent_entry = -1;
+
+		// Rotation from the parent entry's bone (or the skeleton, if there is no parent entry)
+		// to this bone's parent, assuming any bones in between stay at rest.
+		Quaternion parent_offset;
+
+		// Maps the joint's rotation onto this bone, accounting for the difference between the
+		// skeleton's rest pose and the humanoid reference pose the joints are expressed in.
+		Quaternion correction;
+
+		Quaternion rest_rotation;
+
+		// Only used for the hips: transform from the skeleton to the bone's parent.
+		Transform3D parent_transform_inverse;
+		bool apply_position = false;
+	};
+
+	struct SkeletonTable {
+		ObjectID skeleton;
+		LocalVector<BoneEntry> entries;
+	};
+
+	StringName body_tracker = "/user/body_tracker";
+	TypedArray<NodePath> skeletons;
+	Ref<BoneMap> bone_map;
+	bool apply_hips_position = true;
+
+	LocalVector<SkeletonTable> tables;
+	bool tables_dirty = true;
+
+	// Scratch buffers, reused every frame.
+	Quaternion joint_rotations[XRBodyTracker::JOINT_MAX];
+	bool joint_valid[XRBodyTracker::JOINT_MAX] = {};
+	LocalVector<Quaternion> global_rotations;
+
+	void _build_table(Skeleton3D *p_skeleton, const Ref<SkeletonProfile> &p_profile, const LocalVector<Quaternion> &p_reference_rotations, SkeletonTable &r_table) const;
+	void _build_tables();
+	void _update_skeletons();
+
+protected:
+	void _notification(int p_what);
+
+	static void _bind_methods();
+
+public:
+	void set_body_tracker(const StringName &p_body_tracker);
+	StringName get_body_tracker() const;
+
+	void set_skeletons(const TypedArray<NodePath> &p_skeletons);
+	TypedArray<NodePath> get_skeletons() const;
+
+	void set_bone_map(const Ref<BoneMap> &p_bone_map);
+	Ref<BoneMap> get_bone_map() const;
+
+	void set_apply_hips_position(bool p_apply_hips_position);
+	bool get_apply_hips_position() const;
+
+	void rebuild();
+};
+} // namespace godot
@@ -0,0 +1,96 @@
+/**************************************************************************/
+/*  openxr_environment_depth_collider.h                                   */
+/**************************************************************************/
+/*                       This file is part of:                            */
+/*                              GODOT XR                                  */
+/*                      https://godotengine.org                           */
+/**************************************************************************/
+/* Copyright (c) 2022-present Godot XR contributors (see CONTRIBUTORS.md) */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#pragma once
+
+#include <godot_cpp/classes/node3d.hpp>
+
+#include "openxr_environment_depth_frame.h"
+
+namespace godot {
+// Periodically turns the newest environment depth image into a heightfield collider around the
+// headset, built on the WorkerThreadPool.
+class OpenXREnvironmentDepthCollider : public Node3D {
+	GDCLASS(OpenXREnvironmentDepthCollider, Node3D);
+
+	RID body;
+	RID shape;
+
+	float update_interval = 0.25;
+	int grid_size = 32;
+	float cell_size = 0.1;
+	float height_limit = 0.0;
+	uint32_t collision_layer = 1;
+	uint32_t collision_mask = 1;
+
+	double time_since_update = 0.0;
+	uint64_t last_frame_index = 0;
+	int64_t build_task_id = -1;
+	uint64_t build_serial = 0;
+
+	const OpenXREnvironmentDepthFrame *_get_cpu_depth_frame() const;
+	void _set_cpu_depth_frame_user(bool p_user);
+
+	void _start_build(const OpenXREnvironmentDepthFrame &p_frame);
+	void _cancel_build();
+	void _apply_heightfield(int p_grid_size, float p_cell_size, const Vector3 &p_center, const PackedFloat32Array &p_heights, float p_min_height, float p_max_height);
+
+	static void _build_task(uint64_t p_object_id, uint64_t p_serial, const PackedFloat32Array &p_depth, int p_width, int p_height, const Transform3D &p_view_to_world, const Vector4 &p_tan_fov, bool p_flip_y, int p_grid_size, float p_cell_size, float p_height_limit);
+	static void _finish_build(uint64_t p_object_id, uint64_t p_serial, int p_grid_size, float p_cell_size, const Vector3 &p_center, const PackedFloat32Array &p_heights, float p_min_height, float p_max_height);
+
+protected:
+	void _notification(int p_what);
+
+	static void _bind_methods();
+
+public:
+	void set_update_interval(float p_update_interval);
+	float get_update_interval() const;
+
+	void set_grid_size(int p_grid_size);
+	int get_grid_size() const;
+
+	void set_cell_size(float p_cell_size);
+	float get_cell_size() const;
+
+	void set_height_limit(float p_height_limit);
+	float get_height_limit() const;
+
+	void set_collision_layer(uint32_t p_collision_layer);
+	uint32_t get_collision_layer() const;
+
+	void set_collision_mask(uint32_t p_collision_mask);
+	uint32_t get_collision_mask() const;
+
+	RID get_rid() const;
+
+	OpenXREnvironmentDepthCollider();
+	~OpenXREnvironmentDepthCollider();
+};
+}; // namespace godot
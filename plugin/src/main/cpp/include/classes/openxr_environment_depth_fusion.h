@@ -0,0 +1,144 @@
+/**************************************************************************/
+/*  openxr_environment_depth_fusion.h                                     */
+/**************************************************************************/
+/*                       This file is part of:                            */
+/*                              GODOT XR                                  */
+/*                      https://godotengine.org                           */
+/**************************************************************************/
+/* Copyright (c) 2022-present Godot XR contributors (see CONTRIBUTORS.md) */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#pragma once
+
+#include <godot_cpp/classes/ref_counted.hpp>
+#include <godot_cpp/templates/hash_map.hpp>
+#include <godot_cpp/variant/aabb.hpp>
+#include <godot_cpp/variant/packed_byte_array.hpp>
+#include <godot_cpp/variant/packed_float32_array.hpp>
+#include <godot_cpp/variant/transform3d.hpp>
+#include <godot_cpp/variant/typed_array.hpp>
+#include <godot_cpp/variant/vector3i.hpp>
+#include <godot_cpp/variant/vector4.hpp>
+
+using namespace godot;
+
+// Fuses environment depth images into a sparse truncated signed distance field (TSDF).
+//
+// Space is divided into blocks of BLOCK_SIZE^3 voxels, which are only allocated near observed
+// surfaces. Depth images are integrated on the WorkerThreadPool, one at a time: while a frame is
+// being integrated only the newest incoming frame is kept, and older ones are dropped.
+class OpenXREnvironmentDepthFusion : public RefCounted {
+	GDCLASS(OpenXREnvironmentDepthFusion, RefCounted);
+
+public:
+	// Edge length, in voxels, of a block.
+	static const int BLOCK_SIZE = 8;
+
+	void integrate_depth_image(const PackedFloat32Array &p_depth, int p_width, int p_height, const Transform3D &p_view_to_world, const Vector4 &p_tan_fov, bool p_flip_y);
+	bool is_integrating() const;
+
+	float get_distance(const Vector3 &p_position) const;
+
+	TypedArray<Vector3i> get_blocks() const;
+	int get_block_count() const;
+	AABB get_block_aabb(const Vector3i &p_block) const;
+	Array extract_block_mesh(const Vector3i &p_block) const;
+
+	void clear();
+
+	void set_voxel_size(float p_voxel_size);
+	float get_voxel_size() const;
+
+	void set_truncation_distance(float p_truncation_distance);
+	float get_truncation_distance() const;
+
+	void set_max_depth(float p_max_depth);
+	float get_max_depth() const;
+
+	void set_max_weight(int p_max_weight);
+	int get_max_weight() const;
+
+	void set_max_blocks(int p_max_blocks);
+	int get_max_blocks() const;
+
+protected:
+	static void _bind_methods();
+
+private:
+	struct Voxel {
+		// Signed distance divided by the truncation distance, scaled to the int16_t range.
+		int16_t distance;
+		// Number of observations, 0 if the voxel was never observed.
+		uint16_t weight;
+	};
+
+	struct Block {
+		// BLOCK_SIZE^3 voxels, x first.
+		PackedByteArray voxels;
+		uint64_t last_integrated_frame = 0;
+	};
+
+	struct Frame {
+		PackedFloat32Array depth;
+		int width = 0;
+		int height = 0;
+		Transform3D view_to_world;
+		Vector4 tan_fov;
+		bool flip_y = false;
+	};
+
+	// Only touched by the worker thread while a task is running.
+	struct Integration {
+		Frame frame;
+		float voxel_size = 0.0;
+		float truncation_distance = 0.0;
+		float max_depth = 0.0;
+		int max_weight = 0;
+		HashMap<Vector3i, PackedByteArray> updated_blocks;
+	};
+
+	// The worker thread only reads the blocks, and they are only modified on the main thread
+	// while no task is running.
+	HashMap<Vector3i, Block> blocks;
+	uint64_t frame_counter = 0;
+
+	Integration integration;
+	int64_t integration_task_id = -1;
+	uint64_t integration_serial = 0;
+
+	Frame pending_frame;
+	bool has_pending_frame = false;
+
+	float voxel_size = 0.04;
+	float truncation_distance = 0.12;
+	float max_depth = 4.0;
+	int max_weight = 64;
+	int max_blocks = 8192;
+
+	void _start_integrating(const Frame &p_frame);
+	void _cancel_integration();
+	void _evict_blocks(TypedArray<Vector3i> &r_removed);
+	bool _get_voxel(const Vector3i &p_voxel, float &r_distance) const;
+
+	static void _integrate_task(const Ref<OpenXREnvironmentDepthFusion> &p_fusion, uint64_t p_serial);
+	static void _finish_integrating(const Ref<OpenXREnvironmentDepthFusion> &p_fusion, uint64_t p_serial);
+};
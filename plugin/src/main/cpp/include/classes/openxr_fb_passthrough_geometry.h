@@ -51,6 +51,9 @@ private:
 	bool enable_hole_punch = true;
 	RID geometry_instance;
 	MeshInstance3D *opaque_mesh = nullptr;
+	bool hole_punch_batched = false;
+
+	bool has_hole_punch() const { return opaque_mesh != nullptr || hole_punch_batched; }
 
 protected:
 	void _notification(int p_what);
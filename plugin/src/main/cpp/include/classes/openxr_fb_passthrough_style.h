@@ -0,0 +1,79 @@
+/**************************************************************************/
+/*  openxr_fb_passthrough_style.h                                         */
+/**************************************************************************/
+/*                       This file is part of:                            */
+/*                              GODOT XR                                  */
+/*                      https://godotengine.org                           */
+/**************************************************************************/
+/* Copyright (c) 2022-present Godot XR contributors (see CONTRIBUTORS.md) */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#pragma once
+
+#include "extensions/openxr_fb_passthrough_extension.h"
+
+#include <godot_cpp/classes/curve.hpp>
+#include <godot_cpp/classes/gradient.hpp>
+#include <godot_cpp/classes/resource.hpp>
+
+namespace godot {
+class OpenXRFbPassthroughStyle : public Resource {
+	GDCLASS(OpenXRFbPassthroughStyle, Resource);
+
+	float texture_opacity_factor = 1.0;
+	Color edge_color = Color(0.0, 0.0, 0.0, 0.0);
+	OpenXRFbPassthroughExtension::PassthroughFilter filter = OpenXRFbPassthroughExtension::PASSTHROUGH_FILTER_DISABLED;
+	float brightness = 0.0;
+	float contrast = 1.0;
+	float saturation = 1.0;
+	Ref<Gradient> color_map;
+	Ref<Curve> mono_map;
+
+protected:
+	static void _bind_methods();
+
+public:
+	void set_texture_opacity_factor(float p_value);
+	float get_texture_opacity_factor() const;
+
+	void set_edge_color(const Color &p_color);
+	Color get_edge_color() const;
+
+	void set_filter(OpenXRFbPassthroughExtension::PassthroughFilter p_filter);
+	OpenXRFbPassthroughExtension::PassthroughFilter get_filter() const;
+
+	void set_brightness(float p_brightness);
+	float get_brightness() const;
+
+	void set_contrast(float p_contrast);
+	float get_contrast() const;
+
+	void set_saturation(float p_saturation);
+	float get_saturation() const;
+
+	void set_color_map(const Ref<Gradient> &p_color_map);
+	Ref<Gradient> get_color_map() const;
+
+	void set_mono_map(const Ref<Curve> &p_mono_map);
+	Ref<Curve> get_mono_map() const;
+};
+} // namespace godot
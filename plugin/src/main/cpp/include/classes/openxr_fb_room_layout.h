@@ -0,0 +1,105 @@
+/**************************************************************************/
+/*  openxr_fb_room_layout.h                                               */
+/**************************************************************************/
+/*                       This file is part of:                            */
+/*                              GODOT XR                                  */
+/*                      https://godotengine.org                           */
+/**************************************************************************/
+/* Copyright (c) 2022-present Godot XR contributors (see CONTRIBUTORS.md) */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#pragma once
+
+#include <godot_cpp/classes/ref_counted.hpp>
+#include <godot_cpp/templates/local_vector.hpp>
+#include <godot_cpp/variant/typed_array.hpp>
+
+#include "classes/openxr_fb_spatial_entity.h"
+
+using namespace godot;
+
+// Acceleration structure over a room's floor outline, built once from the room layout, so that
+// containment, nearest wall and wall intersection queries don't need to walk the spatial entities.
+class OpenXRFbRoomLayout : public RefCounted {
+	GDCLASS(OpenXRFbRoomLayout, RefCounted);
+
+public:
+	bool build_from_spatial_entities(const Ref<OpenXRFbSpatialEntity> &p_room, const TypedArray<OpenXRFbSpatialEntity> &p_entities);
+	bool build_from_polygon(const PackedVector2Array &p_floor_polygon, float p_floor_height, float p_ceiling_height);
+	void clear();
+
+	bool is_valid() const;
+	PackedVector2Array get_floor_polygon() const;
+	float get_floor_height() const;
+	float get_ceiling_height() const;
+	int get_wall_count() const;
+
+	bool is_point_inside(const Vector3 &p_point) const;
+	float get_distance_to_nearest_wall(const Vector3 &p_point) const;
+	Vector3 get_closest_point_on_walls(const Vector3 &p_point) const;
+	Dictionary intersect_segment(const Vector3 &p_from, const Vector3 &p_to) const;
+
+protected:
+	static void _bind_methods();
+
+private:
+	// Walls are stored as 2D segments on the XZ plane, running from floor to ceiling.
+	struct Wall {
+		Vector2 from;
+		Vector2 to;
+		Vector2 normal; // Points into the room.
+	};
+
+	struct BVHNode {
+		Rect2 bounds;
+		// Index of the first child for inner nodes (the second child follows it), or of the first
+		// wall in wall_order for leaves.
+		uint32_t first = 0;
+		// Number of walls for leaves, 0 for inner nodes.
+		uint32_t count = 0;
+	};
+
+	LocalVector<Wall> walls;
+	float floor_height = 0.0;
+	float ceiling_height = 0.0;
+
+	// Slab decomposition for point in polygon tests: the sorted, unique X coordinates of the
+	// vertices, and for each slab between two of them the walls crossing it, sorted bottom to top.
+	LocalVector<float> slab_xs;
+	LocalVector<uint32_t> slab_offsets;
+	LocalVector<uint32_t> slab_walls;
+
+	// Bounding volume hierarchy over the walls, for the nearest wall and intersection queries.
+	LocalVector<BVHNode> bvh_nodes;
+	LocalVector<uint32_t> wall_order;
+
+	void _build_slabs();
+	void _build_bvh();
+	void _build_bvh_node(uint32_t p_node, uint32_t p_begin, uint32_t p_end, const Vector2 *p_centroids);
+
+	bool _is_point_inside_polygon(const Vector2 &p_point) const;
+	int _find_nearest_wall(const Vector2 &p_point, Vector2 &r_closest) const;
+
+	static float _wall_z_at(const Wall &p_wall, float p_x);
+	static float _distance_squared_to_rect(const Vector2 &p_point, const Rect2 &p_rect);
+	static bool _segment_intersects_rect(const Vector2 &p_from, const Vector2 &p_to, const Rect2 &p_rect);
+};
@@ -0,0 +1,106 @@
+/**************************************************************************/
+/*  openxr_hand_gesture.h                                                 */
+/**************************************************************************/
+/*                       This file is part of:                            */
+/*                              GODOT XR                                  */
+/*                      https://godotengine.org                           */
+/**************************************************************************/
+/* Copyright (c) 2022-present Godot XR contributors (see CONTRIBUTORS.md) */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#pragma once
+
+#include <godot_cpp/classes/resource.hpp>
+#include <godot_cpp/classes/xr_hand_tracker.hpp>
+#include <godot_cpp/templates/local_vector.hpp>
+
+namespace godot {
+class OpenXRHandGesture : public Resource {
+	GDCLASS(OpenXRHandGesture, Resource);
+
+public:
+	using HandJoint = XRHandTracker::HandJoint;
+
+	enum ConstraintType {
+		CONSTRAINT_TYPE_DISTANCE,
+		CONSTRAINT_TYPE_ANGLE,
+	};
+
+private:
+	struct Constraint {
+		ConstraintType type = CONSTRAINT_TYPE_DISTANCE;
+		HandJoint joints[3] = { XRHandTracker::HAND_JOINT_PALM, XRHandTracker::HAND_JOINT_PALM, XRHandTracker::HAND_JOINT_PALM };
+
+		// Distances are stored in squared meters, so they can be compared against squared
+		// lengths, and angles as the cosine of the angle.
+		float min_value = 0.0;
+		float max_value = 0.0;
+		float release_min_value = 0.0;
+		float release_max_value = 0.0;
+
+		// The values exactly as the user provided them (angles are in degrees).
+		float user_min_value = 0.0;
+		float user_max_value = 0.0;
+	};
+
+	StringName gesture_name;
+	float distance_hysteresis = 0.01;
+	float angle_hysteresis = 10.0;
+
+	LocalVector<Constraint> constraints;
+	uint32_t joint_mask = 0;
+
+	void _update_constraint(Constraint &r_constraint) const;
+	void _update_constraints();
+
+protected:
+	static void _bind_methods();
+
+public:
+	void set_gesture_name(const StringName &p_gesture_name);
+	StringName get_gesture_name() const;
+
+	void set_distance_hysteresis(float p_distance_hysteresis);
+	float get_distance_hysteresis() const;
+
+	void set_angle_hysteresis(float p_angle_hysteresis);
+	float get_angle_hysteresis() const;
+
+	void add_distance_constraint(HandJoint p_joint_a, HandJoint p_joint_b, float p_min_distance, float p_max_distance);
+	void add_angle_constraint(HandJoint p_joint_a, HandJoint p_joint_b, HandJoint p_joint_c, float p_min_angle, float p_max_angle);
+	void remove_constraint(int p_index);
+	void clear_constraints();
+	int get_constraint_count() const;
+
+	void set_constraints(const TypedArray<Dictionary> &p_constraints);
+	TypedArray<Dictionary> get_constraints() const;
+
+	// A bit mask of all the joints (indexed by HandJoint) that this gesture reads.
+	uint32_t get_joint_mask() const { return joint_mask; }
+
+	// Evaluates the gesture against joint positions indexed by HandJoint. While the gesture
+	// is active, the constraints are widened by the hysteresis so it doesn't flicker.
+	bool evaluate(const Vector3 *p_joint_positions, bool p_active) const;
+};
+} // namespace godot
+
+VARIANT_ENUM_CAST(OpenXRHandGesture::ConstraintType);
@@ -0,0 +1,69 @@
+/**************************************************************************/
+/*  openxr_hand_gesture_recognizer.h                                      */
+/**************************************************************************/
+/*                       This file is part of:                            */
+/*                              GODOT XR                                  */
+/*                      https://godotengine.org                           */
+/**************************************************************************/
+/* Copyright (c) 2022-present Godot XR contributors (see CONTRIBUTORS.md) */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#pragma once
+
+#include <godot_cpp/classes/node.hpp>
+#include <godot_cpp/classes/xr_hand_tracker.hpp>
+#include <godot_cpp/templates/local_vector.hpp>
+
+#include "classes/openxr_hand_gesture.h"
+
+namespace godot {
+class OpenXRHandGestureRecognizer : public Node {
+	GDCLASS(OpenXRHandGestureRecognizer, Node);
+
+	StringName hand_tracker = "/user/hand_tracker/left";
+
+	LocalVector<Ref<OpenXRHandGesture>> gestures;
+	LocalVector<bool> active;
+
+	// Scratch buffers, reused every frame.
+	Vector3 joint_positions[XRHandTracker::HAND_JOINT_MAX];
+	LocalVector<bool> next_active;
+
+	void _update_gestures();
+	void _end_all_gestures();
+
+protected:
+	void _notification(int p_what);
+
+	static void _bind_methods();
+
+public:
+	void set_hand_tracker(const StringName &p_hand_tracker);
+	StringName get_hand_tracker() const;
+
+	void set_gestures(const TypedArray<OpenXRHandGesture> &p_gestures);
+	TypedArray<OpenXRHandGesture> get_gestures() const;
+
+	bool is_gesture_active(const StringName &p_gesture_name) const;
+	TypedArray<StringName> get_active_gestures() const;
+};
+} // namespace godot
@@ -62,6 +62,12 @@ public:
 	void set_reprojection_offset_exponent(float p_offset_exponent);
 	float get_reprojection_offset_exponent() const;
 
+	void set_downsample(int p_downsample);
+	int get_downsample() const;
+
+	void set_limit_to_receivers(bool p_enabled);
+	bool get_limit_to_receivers() const;
+
 	OpenXRMetaEnvironmentDepth();
 	~OpenXRMetaEnvironmentDepth();
 };
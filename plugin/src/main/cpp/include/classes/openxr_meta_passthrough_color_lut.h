@@ -31,6 +31,7 @@
 
 #include <godot_cpp/classes/image.hpp>
 #include <godot_cpp/classes/ref_counted.hpp>
+#include <godot_cpp/templates/hash_map.hpp>
 
 namespace godot {
 class OpenXRMetaPassthroughColorLut : public RefCounted {
@@ -47,14 +48,41 @@ private:
 	int image_cell_resolution = 0;
 	ColorLutChannels channels = COLOR_LUT_CHANNELS_RGB;
 	PackedByteArray buffer;
+	bool prepared = false;
+
+	struct CacheEntry {
+		// Holding on to the image data means any later change to the image gets a new buffer.
+		PackedByteArray image_data;
+		Ref<OpenXRMetaPassthroughColorLut> color_lut;
+		uint64_t last_used = 0;
+	};
+
+	static HashMap<uint64_t, CacheEntry> cache;
+	static uint64_t cache_tick;
+	static int max_cache_size;
+
+	static Ref<OpenXRMetaPassthroughColorLut> get_cached(uint64_t p_image_id, const PackedByteArray &p_image_data, ColorLutChannels p_channels);
+	static void add_to_cache(uint64_t p_image_id, const PackedByteArray &p_image_data, const Ref<OpenXRMetaPassthroughColorLut> &p_color_lut);
+
+	static bool prepare_buffer(int p_width, int p_height, Image::Format p_format, const PackedByteArray &p_image_data, ColorLutChannels p_channels, int &r_image_cell_resolution, PackedByteArray &r_buffer);
+	static void _prepare_task(const Ref<OpenXRMetaPassthroughColorLut> &p_color_lut, uint64_t p_image_id, int p_width, int p_height, int p_format, const PackedByteArray &p_image_data);
+	static void _finish_preparing(const Ref<OpenXRMetaPassthroughColorLut> &p_color_lut, uint64_t p_image_id, const PackedByteArray &p_image_data, int p_image_cell_resolution, const PackedByteArray &p_buffer);
+	static void _fail_preparing(const Ref<OpenXRMetaPassthroughColorLut> &p_color_lut);
+
+	void finish_preparing(int p_image_cell_resolution, const PackedByteArray &p_buffer);
 
 protected:
 	static void _bind_methods();
 
-	void populate_buffer(const Ref<Image> &p_image, ColorLutChannels p_channels);
-
 public:
 	static Ref<OpenXRMetaPassthroughColorLut> create_from_image(Ref<Image> p_image, ColorLutChannels p_channels);
+	static Ref<OpenXRMetaPassthroughColorLut> create_from_image_async(Ref<Image> p_image, ColorLutChannels p_channels);
+
+	static void set_max_cache_size(int p_max_cache_size);
+	static int get_max_cache_size();
+	static void clear_cache();
+
+	bool is_prepared() const { return prepared; }
 
 	RID get_handle() const { return color_lut_handle; }
 
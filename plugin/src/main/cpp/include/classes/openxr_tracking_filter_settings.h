@@ -0,0 +1,60 @@
+/**************************************************************************/
+/*  openxr_tracking_filter_settings.h                                     */
+/**************************************************************************/
+/*                       This file is part of:                            */
+/*                              GODOT XR                                  */
+/*                      https://godotengine.org                           */
+/**************************************************************************/
+/* Copyright (c) 2022-present Godot XR contributors (see CONTRIBUTORS.md) */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#pragma once
+
+#include <godot_cpp/classes/resource.hpp>
+
+#include "openxr_one_euro_filter.h"
+
+namespace godot {
+class OpenXRTrackingFilterSettings : public Resource {
+	GDCLASS(OpenXRTrackingFilterSettings, Resource);
+
+	OpenXROneEuroFilter::Parameters parameters;
+
+protected:
+	static void _bind_methods();
+
+public:
+	void set_min_cutoff(float p_min_cutoff);
+	float get_min_cutoff() const;
+
+	void set_beta(float p_beta);
+	float get_beta() const;
+
+	void set_derivative_cutoff(float p_derivative_cutoff);
+	float get_derivative_cutoff() const;
+
+	void set_prediction_time(float p_prediction_time);
+	float get_prediction_time() const;
+
+	const OpenXROneEuroFilter::Parameters &get_parameters() const { return parameters; }
+};
+} // namespace godot
@@ -40,6 +40,14 @@
 #include <godot_cpp/templates/hash_set.hpp>
 #include <godot_cpp/templates/local_vector.hpp>
 
+#include "classes/openxr_environment_depth_fusion.h"
+#include "openxr_environment_depth_frame.h"
+#include "openxr_environment_depth_hand_mask.h"
+#include "openxr_environment_depth_pyramid.h"
+#include "openxr_environment_depth_queries.h"
+#include "openxr_environment_depth_receivers.h"
+#include "openxr_environment_depth_temporal_filter.h"
+#include "openxr_environment_depth_uniforms.h"
 #include "util.h"
 
 using namespace godot;
@@ -63,6 +71,7 @@ public:
 	virtual void _on_session_created(uint64_t p_instance) override;
 	virtual void _on_session_destroyed() override;
 
+	virtual void _on_process() override;
 	virtual void _on_pre_render() override;
 
 	virtual uint64_t _set_system_properties_and_get_next_pointer(void *p_next_pointer) override;
@@ -80,6 +89,15 @@ public:
 
 	bool set_smooth(bool p_smooth);
 
+	void set_temporal_filter_enabled(bool p_enabled);
+	bool get_temporal_filter_enabled() const;
+
+	void set_temporal_filter_history_weight(float p_history_weight);
+	float get_temporal_filter_history_weight() const;
+
+	void set_hand_mask_enabled(bool p_enabled);
+	bool get_hand_mask_enabled() const;
+
 	RID get_reprojection_mesh();
 
 	void set_reprojection_render_priority(int p_render_priority);
@@ -91,6 +109,36 @@ public:
 	void set_reprojection_offset_exponent(float p_offset_exponent);
 	float get_reprojection_offset_exponent() const;
 
+	void set_reprojection_downsample(int p_downsample);
+	int get_reprojection_downsample() const;
+
+	void set_reprojection_limit_to_receivers(bool p_enabled);
+	bool get_reprojection_limit_to_receivers() const;
+
+	void register_occlusion_receiver(VisualInstance3D *p_receiver);
+	void unregister_occlusion_receiver(VisualInstance3D *p_receiver);
+
+	void set_occlusion_queries_enabled(bool p_enabled);
+	bool get_occlusion_queries_enabled() const;
+
+	PackedByteArray test_occlusion_spheres(const PackedFloat32Array &p_spheres, float p_bias = 0.05) const;
+	PackedByteArray test_occlusion_aabbs(const PackedFloat32Array &p_aabbs, float p_bias = 0.05) const;
+
+	void set_depth_fusion(const Ref<OpenXREnvironmentDepthFusion> &p_depth_fusion);
+	Ref<OpenXREnvironmentDepthFusion> get_depth_fusion() const;
+
+	void set_depth_queries_enabled(bool p_enabled);
+	bool get_depth_queries_enabled() const;
+
+	PackedFloat32Array depth_raycast_batch(const PackedFloat32Array &p_rays, float p_max_distance = 10.0) const;
+	Dictionary estimate_depth_plane(const Vector3 &p_position, float p_radius = 0.1) const;
+	PackedFloat32Array estimate_depth_planes(const PackedFloat32Array &p_positions, float p_radius = 0.1) const;
+
+	// Keeps the newest depth image on the CPU while there is at least one user.
+	void register_cpu_depth_frame_user();
+	void unregister_cpu_depth_frame_user();
+	const OpenXREnvironmentDepthFrame &get_cpu_depth_frame() const;
+
 	void setup_global_uniforms();
 
 	static OpenXRAndroidEnvironmentDepthExtension *get_singleton();
@@ -133,11 +181,33 @@ private:
 	HashMap<String, bool *> request_extensions;
 	bool android_environment_depth_ext = false;
 	bool already_setup_global_uniforms = false;
+
+	enum GlobalShaderParameter {
+		GLOBAL_SHADER_PARAMETER_AVAILABLE,
+		GLOBAL_SHADER_PARAMETER_TEXTURE,
+		GLOBAL_SHADER_PARAMETER_RESOLUTION,
+		GLOBAL_SHADER_PARAMETER_TANFOV,
+		GLOBAL_SHADER_PARAMETER_CAMERA_TO_WORLD = GLOBAL_SHADER_PARAMETER_TANFOV + 2,
+		GLOBAL_SHADER_PARAMETER_MAX = GLOBAL_SHADER_PARAMETER_CAMERA_TO_WORLD + 2,
+	};
+
+	LocalVector<StringName> global_shader_parameter_names;
+	OpenXREnvironmentDepthUniforms environment_depth_uniforms;
+
 	DepthCameraData depth_camera_data;
 	HashSet<DepthCameraResolution> supported_resolutions;
 	DepthCameraResolution resolution = DEPTH_CAMERA_RESOLUTION_320x320;
 	bool smooth = false;
 
+	bool temporal_filter_enabled = false;
+	OpenXREnvironmentDepthTemporalFilter temporal_filter;
+	// The swapchain image last fed into temporal_filter, on the render thread.
+	int64_t filtered_acquired_index = -1;
+
+	bool hand_mask_enabled = false;
+	OpenXREnvironmentDepthHandMask hand_mask;
+	void _set_hand_mask_capsules_rt(const PackedFloat32Array &p_capsules);
+
 	// Image data is copied from XR to Ref<Image> twice every frame
 	// This enables us to re-use the same buffer of the same size, instead of create/destroy every
 	// frame
@@ -157,11 +227,35 @@ private:
 	int reprojection_render_priority = -50;
 	float reprojection_offset_scale = 0.005;
 	float reprojection_offset_exponent = 1.0;
+	int reprojection_downsample = 1;
+	bool reprojection_limit_to_receivers = false;
 	bool reprojection_material_dirty = false;
+	OpenXREnvironmentDepthReceivers occlusion_receivers;
+
+	bool occlusion_queries_enabled = false;
+	// Mirrors occlusion_queries_enabled on the render thread.
+	bool render_occlusion_queries_enabled = false;
+	OpenXREnvironmentDepthPyramid depth_pyramid;
+
+	Ref<OpenXREnvironmentDepthFusion> depth_fusion;
+	OpenXREnvironmentDepthFrame cpu_depth_frame;
+	int cpu_depth_frame_users = 0;
+	bool depth_queries_enabled = false;
+	// Read on the render thread.
+	bool cpu_depth_frames_enabled = false;
 
 	void update_reprojection_material(bool p_creation = false);
 
 	void _update_mesh();
+
+	void _update_depth_globals(const RID &p_depth_texture);
+
+	void _stop_environment_depth_rt();
+	void _set_occlusion_queries_enabled_rt(bool p_enabled);
+	void _set_depth_pyramid_view(int p_view, const Vector2i &p_size, const PackedFloat32Array &p_levels, const Transform3D &p_world_to_view, const Vector4 &p_tan_fov);
+
+	void _update_cpu_depth_frames_enabled();
+	void _set_cpu_depth_frame(const PackedFloat32Array &p_depth, int p_width, int p_height, const Transform3D &p_view_to_world, const Vector4 &p_tan_fov);
 };
 
 VARIANT_ENUM_CAST(OpenXRAndroidEnvironmentDepthExtension::DepthCameraResolution);
@@ -35,6 +35,8 @@
 #include <godot_cpp/classes/xr_controller_tracker.hpp>
 #include <godot_cpp/templates/hash_map.hpp>
 
+#include "classes/openxr_tracking_filter_settings.h"
+#include "openxr_one_euro_filter.h"
 #include "util.h"
 
 using namespace godot;
@@ -60,6 +62,9 @@ public:
 
 	void _on_process() override;
 
+	void set_filter_settings(const Ref<OpenXRTrackingFilterSettings> &p_filter_settings);
+	Ref<OpenXRTrackingFilterSettings> get_filter_settings() const;
+
 protected:
 	static void _bind_methods();
 
@@ -79,7 +84,7 @@ private:
 
 	bool _initialize_openxr_android_eye_tracking_extension();
 
-	void _populate_eye_tracker(XRControllerTracker *tracker, bool tracking_status, const XrEyeANDROID &xr_eye);
+	void _populate_eye_tracker(XRControllerTracker *tracker, bool tracking_status, XrEyeStateANDROID eye_state, const Transform3D &eye_transform);
 
 	static OpenXRAndroidEyeTrackingExtension *singleton;
 
@@ -94,4 +99,8 @@ private:
 	XrEyeTrackerANDROID eye_tracker = XR_NULL_HANDLE;
 
 	Ref<XRControllerTracker> xr_eye_tracker[2];
+
+	Ref<OpenXRTrackingFilterSettings> filter_settings;
+	OpenXROneEuroFilter position_filter;
+	OpenXROneEuroFilter rotation_filter;
 };
@@ -35,6 +35,8 @@
 #include <godot_cpp/classes/xr_face_tracker.hpp>
 #include <godot_cpp/templates/hash_map.hpp>
 
+#include "classes/openxr_tracking_filter_settings.h"
+#include "openxr_one_euro_filter.h"
 #include "util.h"
 
 using namespace godot;
@@ -68,6 +70,9 @@ public:
 
 	CalibrationState get_face_calibration_state() const;
 
+	void set_filter_settings(const Ref<OpenXRTrackingFilterSettings> &p_filter_settings);
+	Ref<OpenXRTrackingFilterSettings> get_filter_settings() const;
+
 protected:
 	static void _bind_methods();
 
@@ -106,6 +111,10 @@ private:
 	// Godot XRFaceTracker instance.
 	Ref<XRFaceTracker> xr_face_tracker;
 
+	// Optional smoothing applied to the weights before they're passed to the XRFaceTracker.
+	Ref<OpenXRTrackingFilterSettings> filter_settings;
+	OpenXROneEuroFilter weight_filter;
+
 	CalibrationState calibration_state = CALIBRATION_STATE_UNAVAILABLE;
 };
 
@@ -34,6 +34,7 @@
 
 #include <godot_cpp/classes/open_xr_extension_wrapper.hpp>
 #include <godot_cpp/templates/hash_map.hpp>
+#include <godot_cpp/templates/local_vector.hpp>
 
 #include "util.h"
 
@@ -92,6 +93,13 @@ public:
 	bool is_spherical_harmonics_total_valid() const;
 	PackedVector3Array get_spherical_harmonics_total_coefficients() const;
 
+	void set_global_shader_parameters_enabled(bool p_enabled);
+	bool is_global_shader_parameters_enabled() const;
+
+	// Publishes spherical harmonics smoothed by OpenXRAndroidLightEstimation, already scaled for
+	// evaluation, along with the rotation from world space into the estimate's space.
+	void set_smoothed_spherical_harmonics_global_shader_parameters(const Vector3 *p_coefficients, const Basis &p_rotation);
+
 	OpenXRAndroidLightEstimationExtension();
 	~OpenXRAndroidLightEstimationExtension();
 
@@ -117,6 +125,9 @@ private:
 
 	void clear_light_info();
 
+	void register_global_shader_parameters();
+	void update_global_shader_parameters();
+
 	static OpenXRAndroidLightEstimationExtension *singleton;
 
 	HashMap<String, bool *> request_extensions;
@@ -125,6 +136,24 @@ private:
 
 	BitField<LightEstimateType> estimate_types = 0;
 	XrLightEstimatorANDROID light_estimator = XR_NULL_HANDLE;
+	XrTime light_estimation_start_time = 0;
+
+	enum GlobalShaderParameter {
+		GLOBAL_SHADER_PARAMETER_DIRECTIONAL_LIGHT_DIRECTION,
+		GLOBAL_SHADER_PARAMETER_DIRECTIONAL_LIGHT_INTENSITY,
+		GLOBAL_SHADER_PARAMETER_AMBIENT_LIGHT_INTENSITY,
+		GLOBAL_SHADER_PARAMETER_AMBIENT_LIGHT_COLOR_CORRECTION,
+		GLOBAL_SHADER_PARAMETER_TIMESTAMP,
+		GLOBAL_SHADER_PARAMETER_SPHERICAL_HARMONICS_AMBIENT,
+		GLOBAL_SHADER_PARAMETER_SPHERICAL_HARMONICS_TOTAL = GLOBAL_SHADER_PARAMETER_SPHERICAL_HARMONICS_AMBIENT + 9,
+		GLOBAL_SHADER_PARAMETER_SPHERICAL_HARMONICS_SMOOTHED = GLOBAL_SHADER_PARAMETER_SPHERICAL_HARMONICS_TOTAL + 9,
+		GLOBAL_SHADER_PARAMETER_SPHERICAL_HARMONICS_ROTATION = GLOBAL_SHADER_PARAMETER_SPHERICAL_HARMONICS_SMOOTHED + 9,
+		GLOBAL_SHADER_PARAMETER_MAX,
+	};
+
+	bool global_shader_parameters_enabled = false;
+	XrTime global_shader_parameters_time = 0;
+	LocalVector<StringName> global_shader_parameter_names;
 
 	XrSystemLightEstimationPropertiesANDROID system_light_estimation_properties = {
 		XR_TYPE_SYSTEM_LIGHT_ESTIMATION_PROPERTIES_ANDROID, // type
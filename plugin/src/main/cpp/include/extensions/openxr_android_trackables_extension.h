@@ -73,6 +73,10 @@ public:
 	XrTrackableTrackerANDROID get_or_create_xrtrackable_tracker(XrTrackableTypeANDROID p_xrtrackable_type, XrTrackableTrackerANDROID p_xrtrackable_tracker, void *p_next);
 	void find_and_update_all_trackers(XrTrackableTrackerANDROID p_xrtrackable_tracker, XrTrackableTypeANDROID p_xrtrackable_type, bool p_update_trackers, HashMap<XrTrackableANDROID, Ref<OpenXRAndroidTrackableTracker>> &p_current_trackables);
 	void maybe_destroy_trackable_tracker(XrTrackableTrackerANDROID &trackable_tracker, HashMap<XrTrackableANDROID, Ref<OpenXRAndroidTrackableTracker>> &p_current_trackables);
+	// Fills r_xrtrackables with every trackable of p_xrtrackable_tracker, reusing its existing
+	// capacity so that only one runtime call is needed when the trackable count hasn't grown.
+	// Only the first r_count elements are valid.
+	bool get_all_xrtrackables(XrTrackableTrackerANDROID p_xrtrackable_tracker, LocalVector<XrTrackableANDROID> &r_xrtrackables, uint32_t &r_count);
 
 	// Similar to planes, anchors are also part of the XR_ANDROID_trackables extension (and we don't
 	// have a separate class since XR_ANDROID_trackables_anchor doesn't exist).
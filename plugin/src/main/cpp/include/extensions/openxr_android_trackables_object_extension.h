@@ -33,6 +33,7 @@
 #include <androidxr/androidxr.h>
 #include <godot_cpp/classes/open_xr_extension_wrapper.hpp>
 #include <godot_cpp/templates/hash_map.hpp>
+#include <godot_cpp/templates/local_vector.hpp>
 #include <godot_cpp/templates/rid_owner.hpp>
 #include <godot_cpp/variant/string.hpp>
 
@@ -67,6 +68,12 @@ public:
 	RID get_object_context(XrTrackableTrackerANDROID p_xrtrackable_tracker);
 	void free_object_context(RID p_object_context);
 
+	int get_tracked_object_count() const;
+	PackedFloat32Array get_tracked_object_transforms() const;
+	PackedVector3Array get_tracked_object_extents() const;
+	PackedInt32Array get_tracked_object_labels() const;
+	Array get_tracked_object_trackers() const;
+
 	EXT_PROTO_XRRESULT_FUNC3(xrGetTrackableObjectANDROID, (XrTrackableTrackerANDROID), trackableTracker, (const XrTrackableGetInfoANDROID *), getInfo, (XrTrackableObjectANDROID *), objectOutput);
 
 protected:
@@ -78,6 +85,8 @@ private:
 	bool _initialize_openxr_android_trackables_object_extension();
 	void _on_request_permissions_result(const String &p_permission, bool p_granted);
 	RID _make_object_context(XrTrackableTrackerANDROID p_xrtrackable_tracker);
+	void _update_object_context(RID p_object_context, bool p_update_trackers, bool p_collect_objects);
+	void _publish_tracked_objects();
 
 	HashMap<String, bool *> request_extensions;
 	bool available = false;
@@ -93,6 +102,23 @@ private:
 		HashMap<XrTrackableANDROID, Ref<OpenXRAndroidTrackableTracker>> xrtrackable_to_tracker;
 	};
 	RID_Owner<ObjectContext> object_context_owner;
+	LocalVector<RID> object_contexts;
+
+	// Scratch buffer for the trackables of one object context, kept around to reuse its capacity.
+	LocalVector<XrTrackableANDROID> xrtrackables;
+
+	// The objects tracked during the last update of all object contexts, as packed arrays.
+	struct {
+		LocalVector<float> transforms;
+		LocalVector<Vector3> extents;
+		LocalVector<int32_t> labels;
+		LocalVector<Ref<OpenXRAndroidTrackableTracker>> trackers;
+	} pending_objects;
+
+	PackedFloat32Array tracked_object_transforms;
+	PackedVector3Array tracked_object_extents;
+	PackedInt32Array tracked_object_labels;
+	Array tracked_object_trackers;
 
 	int next_object_tracker_id = 1;
 };
@@ -41,6 +41,8 @@
 #include <godot_cpp/variant/utility_functions.hpp>
 #include <map>
 
+#include "classes/openxr_tracking_filter_settings.h"
+#include "openxr_one_euro_filter.h"
 #include "util.h"
 
 using namespace godot;
@@ -68,6 +70,9 @@ public:
 
 	bool is_enabled() const;
 
+	void set_filter_settings(const Ref<OpenXRTrackingFilterSettings> &p_filter_settings);
+	Ref<OpenXRTrackingFilterSettings> get_filter_settings() const;
+
 	OpenXRFbBodyTrackingExtension();
 	~OpenXRFbBodyTrackingExtension();
 
@@ -112,6 +117,11 @@ private:
 	// Godot XRBodyTracker instance.
 	Ref<XRBodyTracker> xr_body_tracker;
 
+	// Optional smoothing applied to the joints before they're passed to the XRBodyTracker.
+	Ref<OpenXRTrackingFilterSettings> filter_settings;
+	OpenXROneEuroFilter position_filter;
+	OpenXROneEuroFilter rotation_filter;
+
 	// META_body_tracking_full_body extension.
 public:
 	bool is_full_body_tracking_supported();
@@ -34,6 +34,8 @@
 #include <godot_cpp/classes/open_xr_extension_wrapper.hpp>
 #include <godot_cpp/templates/hash_map.hpp>
 
+#include "openxr_fb_composition_layer_struct_cache.h"
+
 using namespace godot;
 
 // Wrapper for XR_FB_composition_layer_alpha_blend extension.
@@ -97,7 +99,7 @@ private:
 
 	bool fb_composition_layer_alpha_blend = false;
 
-	HashMap<const XrCompositionLayerBaseHeader *, XrCompositionLayerAlphaBlendFB> layer_structs;
+	OpenXRFbCompositionLayerStructCache<XrCompositionLayerAlphaBlendFB> layer_structs;
 
 	XrCompositionLayerAlphaBlendFB projection_layer_alpha_blend = {
 		XR_TYPE_COMPOSITION_LAYER_ALPHA_BLEND_FB, // type
@@ -34,6 +34,8 @@
 #include <godot_cpp/classes/open_xr_extension_wrapper.hpp>
 #include <godot_cpp/templates/hash_map.hpp>
 
+#include "openxr_fb_composition_layer_struct_cache.h"
+
 using namespace godot;
 
 // Wrapper for the XR_FB_composition_layer_depth_test extension. This asks the compositor to
@@ -70,7 +72,7 @@ protected:
 
 private:
 	HashMap<String, bool *> request_extensions;
-	HashMap<const XrCompositionLayerBaseHeader *, XrCompositionLayerDepthTestFB> layer_structs;
+	OpenXRFbCompositionLayerStructCache<XrCompositionLayerDepthTestFB> layer_structs;
 
 	void cleanup();
 
@@ -34,6 +34,8 @@
 #include <godot_cpp/classes/open_xr_extension_wrapper.hpp>
 #include <godot_cpp/templates/hash_map.hpp>
 
+#include "openxr_fb_composition_layer_struct_cache.h"
+
 using namespace godot;
 
 // Wrapper for XR_FB_composition_layer_image_layout extension.
@@ -75,7 +77,7 @@ private:
 
 	bool fb_composition_layer_image_layout = false;
 
-	HashMap<const XrCompositionLayerBaseHeader *, XrCompositionLayerImageLayoutFB> layer_structs;
+	OpenXRFbCompositionLayerStructCache<XrCompositionLayerImageLayoutFB> layer_structs;
 
 	XrCompositionLayerImageLayoutFB projection_layer_image_layout = {
 		XR_TYPE_COMPOSITION_LAYER_IMAGE_LAYOUT_FB, // type
@@ -34,6 +34,8 @@
 #include <godot_cpp/classes/open_xr_extension_wrapper.hpp>
 #include <godot_cpp/templates/hash_map.hpp>
 
+#include "openxr_fb_composition_layer_struct_cache.h"
+
 using namespace godot;
 
 // Wrapper for XR_FB_composition_layer_secure_content extension.
@@ -81,7 +83,7 @@ private:
 
 	bool fb_composition_layer_secure_content = false;
 
-	HashMap<const XrCompositionLayerBaseHeader *, XrCompositionLayerSecureContentFB> layer_structs;
+	OpenXRFbCompositionLayerStructCache<XrCompositionLayerSecureContentFB> layer_structs;
 
 	XrCompositionLayerSecureContentFB projection_layer_secure_content = {
 		XR_TYPE_COMPOSITION_LAYER_SECURE_CONTENT_FB, // type
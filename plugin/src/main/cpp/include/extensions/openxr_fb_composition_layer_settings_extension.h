@@ -34,6 +34,8 @@
 #include <godot_cpp/classes/open_xr_extension_wrapper.hpp>
 #include <godot_cpp/templates/hash_map.hpp>
 
+#include "openxr_fb_composition_layer_struct_cache.h"
+
 using namespace godot;
 
 // Wrapper for XR_FB_composition_layer_settings extension.
@@ -96,7 +98,8 @@ private:
 	bool fb_composition_layer_settings = false;
 	bool meta_automatic_layer_filter = false;
 
-	HashMap<const XrCompositionLayerBaseHeader *, XrCompositionLayerSettingsFB> layer_structs;
+	OpenXRFbCompositionLayerStructCache<XrCompositionLayerSettingsFB> layer_structs;
+	bool resolved_meta_automatic_layer_filter = false;
 
 	XrCompositionLayerSettingsFB projection_layer_settings = {
 		XR_TYPE_COMPOSITION_LAYER_SETTINGS_FB, // type
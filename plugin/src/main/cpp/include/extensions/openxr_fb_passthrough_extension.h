@@ -31,12 +31,15 @@
 
 #include "classes/openxr_fb_passthrough_geometry.h"
 #include "classes/openxr_meta_passthrough_color_lut.h"
+#include "openxr_fb_passthrough_hole_punch_batcher.h"
 
 #include <godot_cpp/classes/curve.hpp>
 #include <godot_cpp/classes/gradient.hpp>
 #include <godot_cpp/classes/mesh.hpp>
 #include <godot_cpp/classes/open_xr_extension_wrapper.hpp>
 #include <godot_cpp/classes/xr_interface.hpp>
+#include <godot_cpp/templates/hash_map.hpp>
+#include <godot_cpp/templates/local_vector.hpp>
 #include <godot_cpp/templates/rid_owner.hpp>
 #include <godot_cpp/variant/utility_functions.hpp>
 
@@ -49,6 +52,8 @@
 using namespace godot;
 
 // Wrapper for the set of Facebook XR passthrough extensions.
+class OpenXRFbPassthroughStyle;
+
 class OpenXRFbPassthroughExtension : public OpenXRExtensionWrapper {
 	GDCLASS(OpenXRFbPassthroughExtension, OpenXRExtensionWrapper);
 
@@ -108,9 +113,13 @@ public:
 	LayerPurpose get_current_layer_purpose() { return current_passthrough_layer; }
 
 	RID geometry_instance_create(const Array &p_array_mesh, const Transform3D &p_transform);
+	RID geometry_instance_create(const PackedVector3Array &p_vertices, const PackedInt32Array &p_indices, const Transform3D &p_transform);
 	void geometry_instance_set_transform(RID p_geometry_instance, const Transform3D &p_transform);
 	void geometry_instance_free(RID p_geometry_instance);
 
+	void hole_punch_update(uint64_t p_owner, RID p_scenario, const Ref<Mesh> &p_mesh, const Transform3D &p_transform);
+	void hole_punch_free(uint64_t p_owner);
+
 	RID color_lut_create(OpenXRMetaPassthroughColorLut::ColorLutChannels p_channels, uint32_t p_image_cell_resolution, const PackedByteArray &p_buffer);
 	void color_lut_free(RID p_color_lut);
 
@@ -121,11 +130,18 @@ public:
 	Color get_edge_color();
 
 	void set_passthrough_filter(PassthroughFilter p_filter);
-	PassthroughFilter get_current_passthrough_filter() { return current_passthrough_filter; }
+	PassthroughFilter get_current_passthrough_filter() { return style_state.filter; }
 	void set_color_map(const Ref<Gradient> &p_gradient);
 	void set_mono_map(const Ref<Curve> &p_curve);
+	void set_color_map_from_array(const PackedColorArray &p_colors);
+	void set_mono_map_from_array(const PackedByteArray &p_values);
 	void set_brightness_contrast_saturation(float p_brightness, float p_contrast, float p_saturation);
 
+	void set_style(const Ref<OpenXRFbPassthroughStyle> &p_style);
+	void animate_style(const Ref<OpenXRFbPassthroughStyle> &p_style, float p_duration, float p_ease_curve = 1.0);
+	void stop_style_animation();
+	bool is_style_animating() const;
+
 	bool has_passthrough_capability();
 	bool has_color_passthrough_capability();
 	bool has_layer_depth_passthrough_capability();
@@ -374,10 +390,47 @@ private:
 	} render_state;
 
 	bool passthrough_started = false;
-	float texture_opacity_factor = 1.0;
-	Color edge_color;
 	LayerPurpose current_passthrough_layer = LAYER_PURPOSE_NONE;
-	PassthroughFilter current_passthrough_filter = PASSTHROUGH_FILTER_DISABLED;
+
+	// The style as last set from the main thread, which is submitted to the
+	// render thread at most once per frame.
+	struct StyleState {
+		float texture_opacity_factor = 1.0;
+		Color edge_color = Color(0.0, 0.0, 0.0, 0.0);
+		PassthroughFilter filter = PASSTHROUGH_FILTER_DISABLED;
+		Vector3 brightness_contrast_saturation = Vector3(0.0, 1.0, 1.0);
+		PackedColorArray color_map;
+		PackedByteArray mono_map;
+	};
+
+	StyleState style_state;
+	bool style_update_queued = false;
+
+	struct StyleKeyframe {
+		StyleState target;
+		float duration = 0.0;
+		float ease_curve = 1.0;
+	};
+
+	LocalVector<StyleKeyframe> style_keyframes;
+
+	struct {
+		bool active = false;
+		StyleState from;
+		StyleState to;
+		PassthroughFilter filter = PASSTHROUGH_FILTER_DISABLED;
+		double elapsed = 0.0;
+		uint64_t last_ticks = 0;
+	} style_animation;
+
+	StyleState _make_style_state(const Ref<OpenXRFbPassthroughStyle> &p_style);
+	static PackedColorArray _get_identity_color_map();
+	static PackedByteArray _get_identity_mono_map();
+	void _begin_style_keyframe();
+	void _update_style_animation();
+	void _queue_style_update();
+	void _flush_style_update();
+	void _reset_color_lut_filter();
 
 	struct GeometryInstance {
 		XrGeometryInstanceFB handle = XR_NULL_HANDLE;
@@ -385,6 +438,12 @@ private:
 
 	RID_Owner<GeometryInstance, true> geometry_instances;
 
+	OpenXRFbPassthroughHolePunchBatcher hole_punch_batcher;
+	bool hole_punch_flush_queued = false;
+
+	void _queue_hole_punch_flush();
+	void _flush_hole_punch();
+
 	struct ColorLut {
 		XrPassthroughColorLutChannelsMETA channels;
 		uint32_t image_cell_resolution;
@@ -395,6 +454,27 @@ private:
 
 	RID_Owner<ColorLut, true> color_luts;
 
+	// Sampled color and mono map tables, keyed by the instance ID of the source
+	// Gradient or Curve, and resampled only after the resource emits "changed".
+	struct ColorMapTable {
+		PackedColorArray table;
+		bool dirty = true;
+	};
+
+	struct MonoMapTable {
+		PackedByteArray table;
+		bool dirty = true;
+	};
+
+	HashMap<uint64_t, ColorMapTable> color_map_tables;
+	HashMap<uint64_t, MonoMapTable> mono_map_tables;
+
+	PackedColorArray _get_color_map_table(const Ref<Gradient> &p_gradient);
+	PackedByteArray _get_mono_map_table(const Ref<Curve> &p_curve);
+	void _on_color_map_changed(uint64_t p_id);
+	void _on_mono_map_changed(uint64_t p_id);
+	void _prune_map_tables();
+
 	void _set_passthrough_started(bool p_started) {
 		passthrough_started = p_started;
 	}
@@ -411,12 +491,10 @@ private:
 	void _stop_passthrough_rt();
 	void _start_passthrough_layer_rt(LayerPurpose p_layer_purpose);
 
-	void _set_texture_opacity_factor_rt(float p_value);
-	void _set_edge_color_rt(Color p_color);
 	void _set_passthrough_filter_rt(PassthroughFilter p_filter);
-	void _set_color_map_rt(const Ref<Gradient> &p_gradient);
-	void _set_mono_map_rt(const Ref<Curve> &p_curve);
-	void _set_brightness_contrast_saturation_rt(float p_brightness, float p_contrast, float p_saturation);
+	bool _update_passthrough_filter_rt(PassthroughFilter p_filter);
+	void _set_passthrough_style_rt(float p_texture_opacity_factor, const Color &p_edge_color, int p_filter, const Vector3 &p_brightness_contrast_saturation, const PackedColorArray &p_color_map, const PackedByteArray &p_mono_map);
+	void _submit_passthrough_style_rt();
 
 	void _set_color_lut_rt(float p_weight, const Ref<OpenXRMetaPassthroughColorLut> &p_color_lut);
 	void _set_interpolated_color_lut_rt(float p_weight, const Ref<OpenXRMetaPassthroughColorLut> &p_source_color_lut, const Ref<OpenXRMetaPassthroughColorLut> &p_target_color_lut);
@@ -424,7 +502,7 @@ private:
 	XrPassthroughColorLutMETA _color_lut_get_handle_rt(RID p_color_lut);
 	void _color_lut_free_rt(RID p_color_lut);
 
-	void _geometry_instance_initialize_rt(RID p_geometry_instance, const Array &p_array_mesh, const Transform3D &p_transform);
+	void _geometry_instance_initialize_rt(RID p_geometry_instance, const PackedVector3Array &p_vertices, const PackedInt32Array &p_indices, const Transform3D &p_transform);
 	void _geometry_instance_set_transform_rt(RID p_geometry_instance, const Transform3D &p_transform);
 	void _geometry_instance_free_rt(RID p_geometry_instance);
 };
@@ -55,6 +55,7 @@ public:
 	void _on_session_created(uint64_t p_instance) override;
 	void _on_session_destroyed() override;
 	void _on_state_ready() override;
+	void _on_process() override;
 	void _on_main_swapchains_created() override;
 	void _on_pre_draw_viewport(const RID &p_render_target) override;
 	void _on_post_draw_viewport(const RID &p_render_target) override;
@@ -65,18 +66,62 @@ public:
 
 	void skip_space_warp_frame();
 
+	void set_automatic_mode_enabled(bool p_enable);
+	bool is_automatic_mode_enabled() const;
+
+	void set_engage_threshold(float p_threshold);
+	float get_engage_threshold() const;
+
+	void set_disengage_threshold(float p_threshold);
+	float get_disengage_threshold() const;
+
+	void set_engage_frame_count(int p_count);
+	int get_engage_frame_count() const;
+
+	void set_disengage_frame_count(int p_count);
+	int get_disengage_frame_count() const;
+
+	float get_cpu_frame_time() const;
+	float get_gpu_frame_time() const;
+
+	int get_engage_count() const;
+	int get_disengage_count() const;
+
 protected:
 	static void _bind_methods();
 
 private:
 	void _skip_space_warp_frame();
 
+	bool _measure_frame_times(float &r_cpu_ms, float &r_gpu_ms);
+	void _stop_measuring_render_time();
+	void _update_governor();
+
 	void cleanup();
 
 	static OpenXRFbSpaceWarpExtension *singleton;
 
 	bool enabled = true;
 
+	struct Governor {
+		bool enabled = false;
+		float engage_threshold = 0.95;
+		float disengage_threshold = 0.75;
+		int engage_frame_count = 10;
+		int disengage_frame_count = 90;
+
+		int frames_over_budget = 0;
+		int frames_under_budget = 0;
+		RID measured_viewport;
+		bool frame_time_counters_checked = false;
+		bool has_frame_time_counters = false;
+		float cpu_frame_time = 0.0;
+		float gpu_frame_time = 0.0;
+
+		int engage_count = 0;
+		int disengage_count = 0;
+	} governor;
+
 	XrSystemSpaceWarpPropertiesFB system_space_warp_properties = {
 		XR_TYPE_SYSTEM_SPACE_WARP_PROPERTIES_FB, // type
 		nullptr, // next
@@ -94,6 +139,7 @@ private:
 
 	struct RenderState {
 		bool skip_space_warp_frame = false;
+		bool swapchains_acquired = false;
 		Vector3 previous_origin;
 		Quaternion previous_quat;
 	} render_state;
@@ -34,6 +34,7 @@
 #include <godot_cpp/classes/xr_positional_tracker.hpp>
 #include <godot_cpp/templates/hash_map.hpp>
 
+#include "openxr_fb_async_request_tracker.h"
 #include "util.h"
 
 using namespace godot;
@@ -47,6 +48,8 @@ public:
 
 	void _on_instance_created(uint64_t instance) override;
 	void _on_instance_destroyed() override;
+	void _on_session_destroyed() override;
+	void _on_state_stopping() override;
 	void _on_process() override;
 
 	bool is_spatial_entity_supported() {
@@ -59,6 +62,10 @@ public:
 	bool create_spatial_anchor(const Transform3D &p_transform, SpatialAnchorCreatedCallback p_callback, void *p_userdata);
 	bool destroy_space(const XrSpace &p_space);
 
+	// Locates the space relative to the play space at the predicted display time. Returns false if
+	// the position or orientation isn't currently valid.
+	bool locate_space(const XrSpace &p_space, Transform3D &r_transform);
+
 	Vector<XrSpaceComponentTypeFB> get_support_components(const XrSpace &p_space);
 	bool is_component_enabled(const XrSpace &p_space, XrSpaceComponentTypeFB p_component);
 	bool set_component_enabled(const XrSpace &p_space, XrSpaceComponentTypeFB p_component, bool p_enabled, SetComponentEnabledCallback p_callback, void *p_userdata);
@@ -69,6 +76,18 @@ public:
 
 	virtual bool _on_event_polled(const void *event) override;
 
+	// Shared by all of the spatial entity extensions to track their asynchronous requests.
+	OpenXRFbAsyncRequestTracker *get_request_tracker() {
+		return &request_tracker;
+	}
+
+	void set_request_timeout(double p_timeout);
+	double get_request_timeout() const;
+	int get_pending_request_count() const;
+	Dictionary get_request_statistics() const;
+	void reset_request_statistics();
+	void cancel_pending_requests();
+
 	static OpenXRFbSpatialEntityExtension *get_singleton();
 
 	OpenXRFbSpatialEntityExtension();
@@ -116,8 +135,13 @@ private:
 	void on_spatial_anchor_created(const XrEventDataSpatialAnchorCreateCompleteFB *event);
 	void on_set_component_enabled_complete(const XrEventDataSpaceSetStatusCompleteFB *event);
 
+	static void _on_spatial_anchor_creation_abandoned(XrResult p_result, void *p_request_data, bool p_report);
+	static void _on_set_component_enabled_abandoned(XrResult p_result, void *p_request_data, bool p_report);
+
 	HashMap<String, bool *> request_extensions;
 
+	OpenXRFbAsyncRequestTracker request_tracker;
+
 	struct SpatialAnchorCreationInfo {
 		SpatialAnchorCreatedCallback callback = nullptr;
 		void *userdata = nullptr;
@@ -129,20 +153,22 @@ private:
 			userdata = p_userdata;
 		}
 	};
-	HashMap<XrAsyncRequestIdFB, SpatialAnchorCreationInfo> spatial_anchor_creation_info;
 
 	struct SetComponentEnabledInfo {
 		SetComponentEnabledCallback callback = nullptr;
 		void *userdata = nullptr;
+		XrSpaceComponentTypeFB component = XR_SPACE_COMPONENT_TYPE_MAX_ENUM_FB;
+		bool enabled = false;
 
 		SetComponentEnabledInfo() {}
 
-		SetComponentEnabledInfo(SetComponentEnabledCallback p_callback, void *p_userdata) {
+		SetComponentEnabledInfo(SetComponentEnabledCallback p_callback, void *p_userdata, XrSpaceComponentTypeFB p_component, bool p_enabled) {
 			callback = p_callback;
 			userdata = p_userdata;
+			component = p_component;
+			enabled = p_enabled;
 		}
 	};
-	HashMap<XrAsyncRequestIdFB, SetComponentEnabledInfo> set_component_enabled_info;
 
 	struct TrackedEntity {
 		XrSpace space = XR_NULL_HANDLE;
@@ -81,6 +81,9 @@ private:
 	bool initialize_fb_spatial_entity_query_extension(const XrInstance &instance);
 	void on_space_query_results(const XrEventDataSpaceQueryResultsAvailableFB *event);
 	void on_space_query_complete(const XrEventDataSpaceQueryCompleteFB *event);
+	void _retrieve_results(XrAsyncRequestIdFB p_request_id, Vector<XrSpaceQueryResultFB> &r_results);
+
+	static void _on_query_abandoned(XrResult p_result, void *p_request_data, bool p_report);
 
 	HashMap<String, bool *> request_extensions;
 
@@ -97,8 +100,6 @@ private:
 		}
 	};
 
-	HashMap<XrAsyncRequestIdFB, QueryInfo> queries;
-
 	void cleanup();
 
 	static OpenXRFbSpatialEntityQueryExtension *singleton;
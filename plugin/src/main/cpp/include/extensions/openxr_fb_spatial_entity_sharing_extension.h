@@ -74,6 +74,8 @@ private:
 	bool initialize_fb_spatial_entity_sharing_extension(const XrInstance &instance);
 	void on_space_share_complete(const XrEventDataSpaceShareCompleteFB *event);
 
+	static void _on_request_abandoned(XrResult p_result, void *p_request_data, bool p_report);
+
 	HashMap<String, bool *> request_extensions;
 
 	struct RequestInfo {
@@ -88,8 +90,6 @@ private:
 		}
 	};
 
-	HashMap<XrAsyncRequestIdFB, RequestInfo> requests;
-
 	void cleanup();
 
 	static OpenXRFbSpatialEntitySharingExtension *singleton;
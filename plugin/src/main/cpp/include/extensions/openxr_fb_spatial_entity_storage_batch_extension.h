@@ -74,6 +74,8 @@ private:
 	bool initialize_fb_spatial_entity_storage_batch_extension(const XrInstance &instance);
 	void on_space_list_save_complete(const XrEventDataSpaceListSaveCompleteFB *event);
 
+	static void _on_request_abandoned(XrResult p_result, void *p_request_data, bool p_report);
+
 	HashMap<String, bool *> request_extensions;
 
 	struct RequestInfo {
@@ -90,8 +92,6 @@ private:
 		}
 	};
 
-	HashMap<XrAsyncRequestIdFB, RequestInfo> requests;
-
 	void cleanup();
 
 	static OpenXRFbSpatialEntityStorageBatchExtension *singleton;
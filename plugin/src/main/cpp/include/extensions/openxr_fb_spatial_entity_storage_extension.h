@@ -79,22 +79,24 @@ private:
 	void on_space_save_complete(const XrEventDataSpaceSaveCompleteFB *event);
 	void on_space_erase_complete(const XrEventDataSpaceEraseCompleteFB *event);
 
+	static void _on_request_abandoned(XrResult p_result, void *p_request_data, bool p_report);
+
 	HashMap<String, bool *> request_extensions;
 
 	struct RequestInfo {
 		StorageRequestCompleteCallback callback = nullptr;
 		void *userdata = nullptr;
+		XrSpaceStorageLocationFB location = XR_SPACE_STORAGE_LOCATION_INVALID_FB;
 
 		RequestInfo() {}
 
-		RequestInfo(StorageRequestCompleteCallback p_callback, void *p_userdata) {
+		RequestInfo(StorageRequestCompleteCallback p_callback, void *p_userdata, XrSpaceStorageLocationFB p_location) {
 			callback = p_callback;
 			userdata = p_userdata;
+			location = p_location;
 		}
 	};
 
-	HashMap<XrAsyncRequestIdFB, RequestInfo> requests;
-
 	void cleanup();
 
 	static OpenXRFbSpatialEntityStorageExtension *singleton;
@@ -35,6 +35,8 @@
 #include <godot_cpp/variant/utility_functions.hpp>
 #include <map>
 
+#include "classes/openxr_tracking_filter_settings.h"
+#include "openxr_one_euro_filter.h"
 #include "util.h"
 
 using namespace godot;
@@ -65,6 +67,9 @@ public:
 	OpenXRHtcFacialTrackingExtension();
 	~OpenXRHtcFacialTrackingExtension();
 
+	void set_filter_settings(const Ref<OpenXRTrackingFilterSettings> &p_filter_settings);
+	Ref<OpenXRTrackingFilterSettings> get_filter_settings() const;
+
 protected:
 	static void _bind_methods();
 
@@ -108,4 +113,8 @@ private:
 
 	// Godot XRFaceTracker instance.
 	Ref<XRFaceTracker> xr_face_tracker;
+
+	// Optional smoothing applied to the weights before they're passed to the XRFaceTracker.
+	Ref<OpenXRTrackingFilterSettings> filter_settings;
+	OpenXROneEuroFilter weight_filter;
 };
@@ -36,7 +36,15 @@
 #include <godot_cpp/classes/shader_material.hpp>
 #include <godot_cpp/templates/hash_map.hpp>
 #include <godot_cpp/templates/local_vector.hpp>
-
+#include <godot_cpp/variant/projection.hpp>
+
+#include "classes/openxr_environment_depth_fusion.h"
+#include "openxr_environment_depth_frame.h"
+#include "openxr_environment_depth_hand_mask.h"
+#include "openxr_environment_depth_pyramid.h"
+#include "openxr_environment_depth_queries.h"
+#include "openxr_environment_depth_receivers.h"
+#include "openxr_environment_depth_uniforms.h"
 #include "util.h"
 
 using namespace godot;
@@ -52,7 +60,9 @@ public:
 	virtual void _on_instance_destroyed() override;
 
 	virtual void _on_session_destroyed() override;
+	virtual void _on_state_ready() override;
 
+	virtual void _on_process() override;
 	virtual void _on_pre_render() override;
 
 	virtual uint64_t _set_system_properties_and_get_next_pointer(void *p_next_pointer) override;
@@ -72,6 +82,12 @@ public:
 	void set_hand_removal_enabled(bool p_enable);
 	bool get_hand_removal_enabled() const;
 
+	void set_hand_mask_enabled(bool p_enabled);
+	bool get_hand_mask_enabled() const;
+
+	void set_depth_acquisition_rate(float p_rate);
+	float get_depth_acquisition_rate() const;
+
 	RID get_reprojection_mesh();
 
 	void set_reprojection_render_priority(int p_render_priority);
@@ -86,8 +102,38 @@ public:
 	void set_reprojection_bilinear_filtering(bool p_enabled);
 	bool get_reprojection_bilinear_filtering() const;
 
+	void set_reprojection_downsample(int p_downsample);
+	int get_reprojection_downsample() const;
+
+	void set_reprojection_limit_to_receivers(bool p_enabled);
+	bool get_reprojection_limit_to_receivers() const;
+
+	void register_occlusion_receiver(VisualInstance3D *p_receiver);
+	void unregister_occlusion_receiver(VisualInstance3D *p_receiver);
+
 	void get_environment_depth_map_async(const Callable &p_callback);
 
+	void set_occlusion_queries_enabled(bool p_enabled);
+	bool get_occlusion_queries_enabled() const;
+
+	PackedByteArray test_occlusion_spheres(const PackedFloat32Array &p_spheres, float p_bias = 0.05) const;
+	PackedByteArray test_occlusion_aabbs(const PackedFloat32Array &p_aabbs, float p_bias = 0.05) const;
+
+	void set_depth_fusion(const Ref<OpenXREnvironmentDepthFusion> &p_depth_fusion);
+	Ref<OpenXREnvironmentDepthFusion> get_depth_fusion() const;
+
+	void set_depth_queries_enabled(bool p_enabled);
+	bool get_depth_queries_enabled() const;
+
+	PackedFloat32Array depth_raycast_batch(const PackedFloat32Array &p_rays, float p_max_distance = 10.0) const;
+	Dictionary estimate_depth_plane(const Vector3 &p_position, float p_radius = 0.1) const;
+	PackedFloat32Array estimate_depth_planes(const PackedFloat32Array &p_positions, float p_radius = 0.1) const;
+
+	// Keeps the newest depth image on the CPU while there is at least one user.
+	void register_cpu_depth_frame_user();
+	void unregister_cpu_depth_frame_user();
+	const OpenXREnvironmentDepthFrame &get_cpu_depth_frame() const;
+
 	void setup_global_uniforms();
 
 	static OpenXRMetaEnvironmentDepthExtension *get_singleton();
@@ -149,6 +195,19 @@ private:
 	bool meta_environment_depth_ext = false;
 	bool already_setup_global_uniforms = false;
 
+	enum GlobalShaderParameter {
+		GLOBAL_SHADER_PARAMETER_AVAILABLE,
+		GLOBAL_SHADER_PARAMETER_TEXTURE,
+		GLOBAL_SHADER_PARAMETER_TEXEL_SIZE,
+		GLOBAL_SHADER_PARAMETER_PROJECTION_VIEW,
+		GLOBAL_SHADER_PARAMETER_INV_PROJECTION_VIEW = GLOBAL_SHADER_PARAMETER_PROJECTION_VIEW + 2,
+		GLOBAL_SHADER_PARAMETER_FROM_CAMERA_PROJECTION = GLOBAL_SHADER_PARAMETER_INV_PROJECTION_VIEW + 2,
+		GLOBAL_SHADER_PARAMETER_TO_CAMERA_PROJECTION = GLOBAL_SHADER_PARAMETER_FROM_CAMERA_PROJECTION + 2,
+		GLOBAL_SHADER_PARAMETER_MAX = GLOBAL_SHADER_PARAMETER_TO_CAMERA_PROJECTION + 2,
+	};
+
+	LocalVector<StringName> global_shader_parameter_names;
+
 	XrSystemEnvironmentDepthPropertiesMETA system_depth_properties = {
 		XR_TYPE_SYSTEM_ENVIRONMENT_DEPTH_PROPERTIES_META, // type
 		nullptr, // next
@@ -169,12 +228,43 @@ private:
 		bool depth_provider_started = false;
 		GraphicsAPI graphics_api = GRAPHICS_API_UNKNOWN;
 		Vector2 depth_swapchain_texel_size;
+		Vector2i depth_swapchain_size;
 		LocalVector<RID> depth_swapchain_textures;
+		LocalVector<RID> depth_swapchain_rd_textures;
 		LocalVector<Callable> depth_map_callbacks;
+
+		bool occlusion_queries_enabled = false;
+		RID depth_pyramid_shader;
+		RID depth_pyramid_pipeline;
+		RID depth_pyramid_sampler;
+		RID depth_pyramid_texture;
+		Vector2i depth_pyramid_size;
+		LocalVector<RID> depth_pyramid_uniform_sets;
+		int depth_pyramid_readbacks_pending = 0;
+
+		// The last acquired depth image, and what was derived from it, which are reused until the
+		// runtime hands out a different one.
+		XrEnvironmentDepthImageMETA depth_image = {};
+		bool depth_image_valid = false;
+		XrTime depth_image_acquire_time = 0;
+		XrTime depth_acquisition_interval = 0;
+		Transform3D depth_image_world_origin;
+		Projection depth_proj_view[2];
+		Projection depth_inv_proj_view[2];
+		Transform3D depth_to_world[2];
+		Vector4 depth_tan_fov[2];
+		bool depth_pyramid_dirty = false;
+
+		OpenXREnvironmentDepthUniforms environment_depth_uniforms;
+
+		bool hand_mask_enabled = false;
+		OpenXREnvironmentDepthHandMask hand_mask;
 	} render_state;
 
 	bool depth_provider_started = false;
 	bool hand_removal_enabled = false;
+	bool hand_mask_enabled = false;
+	float depth_acquisition_rate = 0.0;
 
 	Ref<Shader> reprojection_shader;
 	Ref<ShaderMaterial> reprojection_material;
@@ -183,16 +273,44 @@ private:
 	float reprojection_offset_scale = 0.005;
 	float reprojection_offset_exponent = 1.0;
 	bool reprojection_bilinear_filtering = true;
+	int reprojection_downsample = 1;
+	bool reprojection_limit_to_receivers = false;
 	bool reprojection_material_dirty = false;
+	OpenXREnvironmentDepthReceivers occlusion_receivers;
+
+	bool occlusion_queries_enabled = false;
+	OpenXREnvironmentDepthPyramid depth_pyramid;
+
+	Ref<OpenXREnvironmentDepthFusion> depth_fusion;
+	OpenXREnvironmentDepthFrame cpu_depth_frame;
+	int cpu_depth_frame_users = 0;
+	bool depth_queries_enabled = false;
+	bool cpu_depth_frames_enabled = false;
 
 	GraphicsAPI get_graphics_api();
 
 	void update_reprojection_material(bool p_creation = false);
 
+	void _update_mesh();
+
+	void _update_depth_globals_rt(const RID &p_depth_texture);
+
 	void _start_environment_depth_rt();
 	void _stop_environment_depth_rt();
 	void _set_hand_removal_enabled_rt(bool p_enable);
+	void _set_hand_mask_enabled_rt(bool p_enabled);
+	void _set_depth_acquisition_interval_rt(int64_t p_interval);
+	void _set_hand_mask_capsules_rt(const PackedFloat32Array &p_capsules);
 	void _add_depth_map_callback_rt(const Callable &p_callback);
+	void _set_occlusion_queries_enabled_rt(bool p_enabled);
+
+	bool _create_depth_pyramid_rt();
+	void _free_depth_pyramid_rt();
+	void _dispatch_depth_pyramid_rt(uint32_t p_swapchain_index, float p_near_z, float p_far_z, const Transform3D *p_world_to_view, const Vector4 *p_tan_fov);
+	void _on_depth_pyramid_readback_rt(const PackedByteArray &p_data, int p_view, const Transform3D &p_world_to_view, const Vector4 &p_tan_fov);
+	void _set_depth_pyramid_view(int p_view, const Vector2i &p_size, const PackedFloat32Array &p_levels, const Transform3D &p_world_to_view, const Vector4 &p_tan_fov);
+
+	void _update_cpu_depth_frames_enabled();
 
 	bool _create_depth_provider_rt();
 	void _destroy_depth_provider_rt();
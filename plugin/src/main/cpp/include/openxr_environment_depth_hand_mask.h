@@ -0,0 +1,77 @@
+/**************************************************************************/
+/*  openxr_environment_depth_hand_mask.h                                  */
+/**************************************************************************/
+/*                       This file is part of:                            */
+/*                              GODOT XR                                  */
+/*                      https://godotengine.org                           */
+/**************************************************************************/
+/* Copyright (c) 2022-present Godot XR contributors (see CONTRIBUTORS.md) */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#pragma once
+
+#include <godot_cpp/classes/image.hpp>
+#include <godot_cpp/variant/packed_byte_array.hpp>
+#include <godot_cpp/variant/packed_float32_array.hpp>
+#include <godot_cpp/variant/rid.hpp>
+#include <godot_cpp/variant/transform3d.hpp>
+#include <godot_cpp/variant/vector4.hpp>
+
+using namespace godot;
+
+// Renders the tracked hands into a small texture array laid out like the environment depth, so
+// shaders can occlude virtual content with the hands even where the depth camera misses them.
+//
+// Each bone of the hand skeleton is approximated by a capsule between its two joints, and each
+// texel holds the linear depth, in meters, of the nearest capsule along its ray, or 0.0 if it
+// doesn't hit any. At this resolution, casting the rays on the CPU is cheaper than a render pass.
+//
+// gather_capsules() must be called on the main thread, everything else on the render thread.
+class OpenXREnvironmentDepthHandMask {
+public:
+	static constexpr int VIEW_COUNT = 2;
+	static constexpr int RESOLUTION = 64;
+
+	// Returns the world space capsules of all tracked hands, as (a.x, a.y, a.z, b.x, b.y, b.z,
+	// radius) for each bone.
+	static PackedFloat32Array gather_capsules();
+
+	void set_capsules(const PackedFloat32Array &p_capsules);
+
+	// Renders the capsules into a view, given the pose of the depth camera and the tangents of its
+	// field of view angles (left, right, down, up). Rows go from down to up.
+	void render_view(int p_view, const Transform3D &p_depth_view_to_world, const Vector4 &p_tan_fov);
+
+	// Uploads the rendered views, and returns the texture array holding them.
+	RID update();
+
+	// Frees the texture array.
+	void clear();
+
+private:
+	PackedFloat32Array capsules;
+
+	PackedByteArray data[VIEW_COUNT];
+	Ref<Image> images[VIEW_COUNT];
+	RID texture;
+	bool uploaded_empty = false;
+};
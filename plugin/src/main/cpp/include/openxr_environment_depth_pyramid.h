@@ -0,0 +1,94 @@
+/**************************************************************************/
+/*  openxr_environment_depth_pyramid.h                                    */
+/**************************************************************************/
+/*                       This file is part of:                            */
+/*                              GODOT XR                                  */
+/*                      https://godotengine.org                           */
+/**************************************************************************/
+/* Copyright (c) 2022-present Godot XR contributors (see CONTRIBUTORS.md) */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#pragma once
+
+#include <godot_cpp/templates/local_vector.hpp>
+#include <godot_cpp/variant/packed_byte_array.hpp>
+#include <godot_cpp/variant/packed_float32_array.hpp>
+#include <godot_cpp/variant/transform3d.hpp>
+#include <godot_cpp/variant/vector2i.hpp>
+#include <godot_cpp/variant/vector4.hpp>
+
+using namespace godot;
+
+// Hierarchical min/max pyramid of the environment depth, used to answer occlusion queries on
+// the CPU without reading back the full resolution depth images.
+//
+// Each level stores interleaved (min, max) pairs of the linear depth in meters along the depth
+// camera's forward axis, with every texel covering 2x2 texels of the level below. Texels without
+// valid depth are stored as +infinity, so they never occlude anything.
+class OpenXREnvironmentDepthPyramid {
+public:
+	static const int VIEW_COUNT = 2;
+
+	// Edge length, in depth texels, of the area covered by a texel of the first level.
+	static const int BASE_TILE_SIZE = 4;
+
+	// Builds the level data from a linear depth image. Returns the size of the first level in r_size.
+	static PackedFloat32Array build_levels(const float *p_depth, int p_width, int p_height, Vector2i &r_size);
+
+	// Builds the level data from an image which already holds (min, max) pairs, and is used as
+	// the first level as is.
+	static PackedFloat32Array build_levels_from_min_max(const float *p_min_max, int p_width, int p_height);
+
+	// Sets the pyramid for one view. p_tan_fov holds the tangents of the left, right, down and up
+	// angles of the depth camera, and p_flip_y must be set if the first row of the depth image is
+	// the top one.
+	void set_view(int p_view, const Vector2i &p_size, const PackedFloat32Array &p_levels, const Transform3D &p_world_to_view, const Vector4 &p_tan_fov, bool p_flip_y);
+
+	void clear();
+
+	bool is_valid() const;
+
+	// Tests packed spheres (x, y, z, radius) in world space. Bit i of the returned array is set
+	// if sphere i may be visible.
+	PackedByteArray test_spheres(const PackedFloat32Array &p_spheres, float p_bias) const;
+
+	// Tests packed AABBs (position x, y, z, size x, y, z) in world space. Bit i of the returned
+	// array is set if AABB i may be visible.
+	PackedByteArray test_aabbs(const PackedFloat32Array &p_aabbs, float p_bias) const;
+
+private:
+	struct View {
+		PackedFloat32Array levels;
+		LocalVector<Vector2i> level_sizes;
+		LocalVector<uint32_t> level_offsets;
+		Transform3D world_to_view;
+		Vector4 tan_fov;
+		bool flip_y = false;
+	};
+
+	View views[VIEW_COUNT];
+
+	static void build_next_levels(PackedFloat32Array &r_levels, const Vector2i &p_size);
+
+	bool is_occluded(const View &p_view, const Vector3 *p_corners, float p_bias) const;
+	bool is_box_occluded(const Vector3 &p_position, const Vector3 &p_size, float p_bias) const;
+};
@@ -0,0 +1,70 @@
+/**************************************************************************/
+/*  openxr_environment_depth_queries.h                                    */
+/**************************************************************************/
+/*                       This file is part of:                            */
+/*                              GODOT XR                                  */
+/*                      https://godotengine.org                           */
+/**************************************************************************/
+/* Copyright (c) 2022-present Godot XR contributors (see CONTRIBUTORS.md) */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#pragma once
+
+#include <godot_cpp/variant/dictionary.hpp>
+#include <godot_cpp/variant/packed_float32_array.hpp>
+#include <godot_cpp/variant/vector3.hpp>
+
+#include "openxr_environment_depth_frame.h"
+
+using namespace godot;
+
+// Answers geometric queries against the newest depth image kept on the CPU, so they can be made
+// any number of times per frame without a round-trip to the runtime or the GPU.
+class OpenXREnvironmentDepthQueries {
+public:
+	static constexpr int RAY_STRIDE = 6;
+	static constexpr int RAY_HIT_STRIDE = 7;
+	static constexpr int PLANE_STRIDE = 7;
+
+	// Marches world space rays, packed as (origin.x, origin.y, origin.z, direction.x, direction.y,
+	// direction.z), through the depth image, up to p_max_distance meters. Returns the hits packed
+	// as (position.x, position.y, position.z, normal.x, normal.y, normal.z, distance), with a
+	// negative distance for rays which didn't hit anything. Normals are estimated from the depth
+	// gradient around the hit, and face the depth camera, or are zero where there isn't enough
+	// depth to estimate them.
+	static PackedFloat32Array raycast(const OpenXREnvironmentDepthFrame &p_frame, const PackedFloat32Array &p_rays, float p_max_distance);
+
+	// Fits a plane to the depth within p_radius meters of each world space position, packed as
+	// (x, y, z), rejecting outliers once. Returns the planes packed as (position.x, position.y,
+	// position.z, normal.x, normal.y, normal.z, planarity), where the position is the query
+	// position projected onto the plane, the normal faces the depth camera, and the planarity
+	// goes from 0.0 (no plane at all) to 1.0 (perfectly flat, without outliers). Planes which
+	// couldn't be estimated are all zeros.
+	static PackedFloat32Array estimate_planes(const OpenXREnvironmentDepthFrame &p_frame, const PackedFloat32Array &p_positions, float p_radius);
+
+	// Same as estimate_planes(), for a single position. Returns a dictionary with "position",
+	// "normal" and "planarity", or an empty one if no plane could be estimated.
+	static Dictionary estimate_plane(const OpenXREnvironmentDepthFrame &p_frame, const Vector3 &p_position, float p_radius);
+
+private:
+	static bool _has_depth(const OpenXREnvironmentDepthFrame &p_frame);
+};
@@ -0,0 +1,58 @@
+/**************************************************************************/
+/*  openxr_environment_depth_receivers.h                                  */
+/**************************************************************************/
+/*                       This file is part of:                            */
+/*                              GODOT XR                                  */
+/*                      https://godotengine.org                           */
+/**************************************************************************/
+/* Copyright (c) 2022-present Godot XR contributors (see CONTRIBUTORS.md) */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#pragma once
+
+#include <godot_cpp/classes/visual_instance3d.hpp>
+#include <godot_cpp/templates/local_vector.hpp>
+#include <godot_cpp/variant/projection.hpp>
+#include <godot_cpp/variant/vector4.hpp>
+
+using namespace godot;
+
+// Tracks the nodes that should be occluded by the environment depth, so the reprojection pass can
+// be limited to the part of the screen they cover.
+class OpenXREnvironmentDepthReceivers {
+public:
+	void add(VisualInstance3D *p_receiver);
+	void remove(VisualInstance3D *p_receiver);
+	void clear();
+
+	// Returns the camera projection of the given view, in the same clip space as POSITION in a
+	// spatial shader for the current renderer. Returns false if the OpenXR interface isn't available.
+	static bool get_view_projection(int p_view, Projection &r_view_projection);
+
+	// Returns the NDC rect (min x, min y, max x, max y) covering all visible receivers in the given
+	// view, or a zero-sized rect if none of them are visible. Receivers which have been freed are
+	// forgotten.
+	Vector4 get_region(int p_view);
+
+private:
+	LocalVector<uint64_t> receivers;
+};
@@ -0,0 +1,80 @@
+/**************************************************************************/
+/*  openxr_environment_depth_temporal_filter.h                            */
+/**************************************************************************/
+/*                       This file is part of:                            */
+/*                              GODOT XR                                  */
+/*                      https://godotengine.org                           */
+/**************************************************************************/
+/* Copyright (c) 2022-present Godot XR contributors (see CONTRIBUTORS.md) */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#pragma once
+
+#include <godot_cpp/templates/local_vector.hpp>
+#include <godot_cpp/variant/transform3d.hpp>
+#include <godot_cpp/variant/vector4.hpp>
+
+using namespace godot;
+
+// Temporally filters linear depth images, to stabilize the edges of real world objects.
+//
+// The filtered depth of the previous frame is reprojected into the new frame using the pose of
+// the depth camera, and blended with the new depth, weighted by its per-texel confidence. Where
+// the reprojected depth doesn't match the new depth, for example where something moved or was
+// uncovered, the new depth is used as is.
+class OpenXREnvironmentDepthTemporalFilter {
+public:
+	static const int VIEW_COUNT = 2;
+
+	// Filters the new depth image of a view, with the first row at the top. p_confidence may be
+	// null, in which case every texel is fully confident. p_tan_fov holds the tangents of the
+	// left, right, down and up angles of the depth camera. Returns the filtered image, which stays
+	// valid until the next call for the same view.
+	const float *filter(int p_view, const float *p_depth, const uint8_t *p_confidence, int p_width, int p_height, const Transform3D &p_view_to_world, const Vector4 &p_tan_fov);
+
+	// Returns the last filtered image of a view, or null if there is none of the given size.
+	const float *get_filtered(int p_view, int p_width, int p_height) const;
+
+	// Forgets the previous frames.
+	void reset();
+
+	bool is_empty() const;
+
+	// How much of the accumulated history is kept every frame, from 0.0 (none) to just below 1.0.
+	void set_history_weight(float p_history_weight);
+	float get_history_weight() const;
+
+private:
+	struct View {
+		// Double buffered, so the previous frame can be read while the new one is written.
+		LocalVector<float> depth[2];
+		LocalVector<float> weight[2];
+		int current = 0;
+		int width = 0;
+		int height = 0;
+		Transform3D world_to_view;
+		Vector4 tan_fov;
+	};
+
+	View views[VIEW_COUNT];
+	float history_weight = 0.8;
+};
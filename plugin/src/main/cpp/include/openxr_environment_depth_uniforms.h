@@ -0,0 +1,124 @@
+/**************************************************************************/
+/*  openxr_environment_depth_uniforms.h                                   */
+/**************************************************************************/
+/*                       This file is part of:                            */
+/*                              GODOT XR                                  */
+/*                      https://godotengine.org                           */
+/**************************************************************************/
+/* Copyright (c) 2022-present Godot XR contributors (see CONTRIBUTORS.md) */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#pragma once
+
+#include <godot_cpp/classes/image.hpp>
+#include <godot_cpp/classes/project_settings.hpp>
+#include <godot_cpp/classes/rendering_server.hpp>
+#include <godot_cpp/templates/local_vector.hpp>
+#include <godot_cpp/variant/packed_byte_array.hpp>
+#include <godot_cpp/variant/rid.hpp>
+#include <godot_cpp/variant/string_name.hpp>
+#include <godot_cpp/variant/transform3d.hpp>
+#include <godot_cpp/variant/vector2.hpp>
+#include <godot_cpp/variant/vector4.hpp>
+
+using namespace godot;
+
+// Publishes the environment depth of either provider through the same global shader uniforms, so
+// user shaders can include addons/godotopenxrvendors/shaders/environment_depth.gdshaderinc and work
+// on both. Everything besides the depth texture itself is packed into a small float texture, which
+// costs a single texture update per depth frame.
+//
+// All methods except setup_global_uniforms() must be called on the render thread.
+class OpenXREnvironmentDepthUniforms {
+public:
+	static constexpr int VIEW_COUNT = 2;
+
+	// The texels of each row (one per view) of the data texture. Matrices take up one texel per
+	// column.
+	enum DataTexel {
+		DATA_TEXEL_WORLD_TO_DEPTH_VIEW = 0,
+		DATA_TEXEL_DEPTH_VIEW_TO_WORLD = 4,
+		DATA_TEXEL_TAN_FOV = 8,
+		DATA_TEXEL_LINEARIZE = 9,
+		DATA_TEXEL_TEXTURE_INFO = 10,
+		DATA_TEXEL_MAX = 11,
+	};
+
+	// Registers or removes the shared global uniforms, depending on whether any environment depth
+	// provider is enabled in the project settings.
+	static void setup_global_uniforms();
+
+	// Adds a global shader uniform, unless the project already declares it, and also declares it
+	// in the project settings when running in the editor, so shaders using it compile. Used for
+	// the provider specific globals as well.
+	static void create_shader_global_uniform(const String &p_name, RenderingServer::GlobalShaderParameterType p_type, const Variant &p_value, RenderingServer *p_rendering_server, ProjectSettings *p_project_settings, bool p_is_editor);
+	static void remove_shader_global_uniform(const String &p_name, RenderingServer *p_rendering_server, ProjectSettings *p_project_settings);
+
+	// Sets how the values in the depth texture map to linear depth, as (a, b, c, d) in
+	// linear = (a * value + b) / (c * value + d), and the layout of the depth texture.
+	void set_depth_format(const Vector4 &p_linearize, const Vector2 &p_texel_size, bool p_flip_y);
+
+	// Sets the pose of a view of the depth camera, and the tangents of its field of view angles
+	// (left, right, down, up).
+	void set_view(int p_view, const Transform3D &p_depth_view_to_world, const Vector4 &p_tan_fov);
+
+	// Points the shared globals at a texture array holding the linear depth of the tracked hands,
+	// laid out like the depth texture but never flipped, or clears it when passed an invalid RID.
+	// Takes effect with the next call to update().
+	void set_hand_mask(const RID &p_hand_mask);
+
+	// Uploads the data set since the last call, if it changed, and points the shared globals at the
+	// given depth texture. Passing an invalid RID marks the environment depth as unavailable. Returns true if
+	// the depth texture changed, so the caller can update any provider specific globals which
+	// mirror it.
+	bool update(const RID &p_depth_texture);
+
+	bool is_available() const { return depth_texture.is_valid(); }
+
+	// Marks the environment depth as unavailable and frees the data texture.
+	void clear();
+
+	OpenXREnvironmentDepthUniforms();
+
+private:
+	enum GlobalShaderParameter {
+		GLOBAL_SHADER_PARAMETER_AVAILABLE,
+		GLOBAL_SHADER_PARAMETER_TEXTURE,
+		GLOBAL_SHADER_PARAMETER_DATA,
+		GLOBAL_SHADER_PARAMETER_HAND_MASK,
+		GLOBAL_SHADER_PARAMETER_MAX,
+	};
+
+	LocalVector<StringName> global_shader_parameter_names;
+
+	PackedByteArray data;
+	bool data_dirty = true;
+	Ref<Image> data_image;
+	RID data_texture;
+
+	RID depth_texture;
+	RID hand_mask;
+
+	float *_get_data_texel(int p_view, int p_texel);
+	void _set_data_texel(int p_view, int p_texel, const Vector4 &p_value);
+	bool _set_depth_texture(const RID &p_depth_texture);
+};
@@ -0,0 +1,116 @@
+/**************************************************************************/
+/*  openxr_fb_async_request_tracker.h                                     */
+/**************************************************************************/
+/*                       This file is part of:                            */
+/*                              GODOT XR                                  */
+/*                      https://godotengine.org                           */
+/**************************************************************************/
+/* Copyright (c) 2022-present Godot XR contributors (see CONTRIBUTORS.md) */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#pragma once
+
+#include <openxr/openxr.h>
+#include <godot_cpp/templates/hash_map.hpp>
+#include <godot_cpp/variant/dictionary.hpp>
+
+using namespace godot;
+
+// Keeps track of the asynchronous requests made through the XR_FB_spatial_entity family of
+// extensions, so requests that the runtime never answers are eventually failed and their
+// userdata released, rather than being kept around forever.
+class OpenXRFbAsyncRequestTracker {
+public:
+	enum RequestType {
+		REQUEST_TYPE_CREATE_SPATIAL_ANCHOR,
+		REQUEST_TYPE_SET_COMPONENT_ENABLED,
+		REQUEST_TYPE_SAVE_SPACE,
+		REQUEST_TYPE_ERASE_SPACE,
+		REQUEST_TYPE_SAVE_SPACE_LIST,
+		REQUEST_TYPE_QUERY_SPACES,
+		REQUEST_TYPE_SHARE_SPACES,
+		REQUEST_TYPE_MAX,
+	};
+
+	// Called when a request is timed out or cancelled. The owner of the request data must free the
+	// request data, and report the failure to its own callback if p_report is true. It's false when
+	// the tracker itself is being destroyed, and nothing may be called back anymore.
+	typedef void (*RequestAbandonedCallback)(XrResult p_result, void *p_request_data, bool p_report);
+
+	// Starts tracking a request. A negative timeout means the default timeout is used, and a
+	// timeout of zero means the request never times out.
+	void add_request(XrAsyncRequestIdFB p_request_id, RequestType p_type, void *p_request_data, RequestAbandonedCallback p_abandoned_callback, double p_timeout = -1.0);
+
+	// Gets the request data of a pending request, without completing it.
+	void *get_request_data(XrAsyncRequestIdFB p_request_id, RequestType p_type) const;
+
+	// Stops tracking a request and returns its request data, or nullptr if no request of the given
+	// type is pending with this id.
+	void *complete_request(XrAsyncRequestIdFB p_request_id, RequestType p_type);
+
+	// Fails all requests that have exceeded their timeout.
+	void process();
+
+	// Fails all pending requests, for example because the session is stopping.
+	void cancel_all_requests();
+
+	void set_default_timeout(double p_timeout);
+	double get_default_timeout() const;
+
+	int get_pending_request_count() const;
+	Dictionary get_statistics() const;
+	void reset_statistics();
+
+	static const char *get_request_type_name(RequestType p_type);
+
+	OpenXRFbAsyncRequestTracker() {}
+	~OpenXRFbAsyncRequestTracker();
+
+private:
+	struct Request {
+		RequestType type = REQUEST_TYPE_MAX;
+		void *request_data = nullptr;
+		RequestAbandonedCallback abandoned_callback = nullptr;
+		uint64_t start_time = 0;
+		uint64_t deadline = 0;
+	};
+
+	HashMap<XrAsyncRequestIdFB, Request> requests;
+
+	struct Statistics {
+		uint64_t issued = 0;
+		uint64_t completed = 0;
+		uint64_t timed_out = 0;
+		uint64_t cancelled = 0;
+		uint64_t pending = 0;
+		uint64_t total_latency = 0;
+		uint64_t min_latency = 0;
+		uint64_t max_latency = 0;
+		uint64_t last_latency = 0;
+	};
+
+	Statistics statistics[REQUEST_TYPE_MAX];
+
+	double default_timeout = 60.0;
+
+	void abandon_request(XrAsyncRequestIdFB p_request_id, XrResult p_result, bool p_report = true);
+};
@@ -0,0 +1,65 @@
+/**************************************************************************/
+/*  openxr_fb_composition_layer_property_tracker.h                        */
+/**************************************************************************/
+/*                       This file is part of:                            */
+/*                              GODOT XR                                  */
+/*                      https://godotengine.org                           */
+/**************************************************************************/
+/* Copyright (c) 2022-present Godot XR contributors (see CONTRIBUTORS.md) */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#pragma once
+
+#include <godot_cpp/templates/local_vector.hpp>
+#include <godot_cpp/variant/dictionary.hpp>
+
+using namespace godot;
+
+// Works out whether a viewport composition layer's extension property values have changed,
+// once per layer per frame, so the composition layer extensions sharing that layer don't
+// each hash its property values again.
+//
+// Changes are detected from the hash alone, without keeping a copy of the values around to
+// compare against. Every change is given a new version number, so an extension only needs to
+// remember the last version it resolved its struct from. Only used from the render thread.
+class OpenXRFbCompositionLayerPropertyTracker {
+public:
+	// Returns the version of p_layer's property values. p_frame identifies the frame being
+	// rendered, the property values are only checked again once it changes.
+	static uint64_t get_version(const void *p_layer, const Dictionary &p_property_values, int64_t p_frame);
+
+	static void erase(const void *p_layer);
+
+private:
+	struct LayerState {
+		const void *layer = nullptr;
+		int64_t frame = 0;
+		int64_t property_values_hash = 0;
+		uint64_t version = 0;
+	};
+
+	// Only exists while there are layers to track, so no Godot types outlive the layers.
+	static OpenXRFbCompositionLayerPropertyTracker *singleton;
+	static uint64_t last_version;
+
+	LocalVector<LayerState> layers;
+};
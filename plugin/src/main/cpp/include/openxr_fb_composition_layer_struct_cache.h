@@ -0,0 +1,136 @@
+/**************************************************************************/
+/*  openxr_fb_composition_layer_struct_cache.h                            */
+/**************************************************************************/
+/*                       This file is part of:                            */
+/*                              GODOT XR                                  */
+/*                      https://godotengine.org                           */
+/**************************************************************************/
+/* Copyright (c) 2022-present Godot XR contributors (see CONTRIBUTORS.md) */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#pragma once
+
+#include "openxr_fb_composition_layer_property_tracker.h"
+
+#include <godot_cpp/core/memory.hpp>
+#include <godot_cpp/templates/local_vector.hpp>
+#include <godot_cpp/variant/dictionary.hpp>
+
+using namespace godot;
+
+// Per viewport composition layer storage for the structs an extension chains onto the layer.
+//
+// Each layer gets a slot in a dense array, found by a linear scan over the layer pointers
+// (there are rarely more than a handful of layers). The structs themselves live in fixed
+// size pages, so their addresses stay stable for as long as the layer exists, even when
+// more layers are added. The layer's property values are only resolved into the struct
+// again when OpenXRFbCompositionLayerPropertyTracker reports they have changed.
+template <typename T>
+class OpenXRFbCompositionLayerStructCache {
+public:
+	struct Entry {
+		// Whether the struct should be chained onto the layer at all.
+		bool enabled = false;
+		T data = {};
+	};
+
+	// Returns the entry for p_layer, creating it if needed. r_changed is set when the
+	// entry is new, or p_property_values have changed since the last call. p_frame
+	// identifies the frame being rendered.
+	Entry *get_entry(const void *p_layer, const Dictionary &p_property_values, int64_t p_frame, bool &r_changed) {
+		uint64_t property_values_version = OpenXRFbCompositionLayerPropertyTracker::get_version(p_layer, p_property_values, p_frame);
+
+		uint32_t free_slot = layers.size();
+		for (uint32_t i = 0; i < layers.size(); i++) {
+			if (layers[i] == p_layer) {
+				r_changed = property_values_versions[i] != property_values_version;
+				property_values_versions[i] = property_values_version;
+				return get_slot(i);
+			} else if (layers[i] == nullptr && free_slot == layers.size()) {
+				free_slot = i;
+			}
+		}
+
+		if (free_slot == layers.size()) {
+			layers.push_back(nullptr);
+			property_values_versions.push_back(0);
+			if (free_slot / PAGE_SIZE >= pages.size()) {
+				pages.push_back(memnew_arr(Entry, PAGE_SIZE));
+			}
+		}
+
+		layers[free_slot] = p_layer;
+		property_values_versions[free_slot] = property_values_version;
+		r_changed = true;
+
+		Entry *entry = get_slot(free_slot);
+		*entry = Entry();
+		return entry;
+	}
+
+	// Makes every entry report a change on its next get_entry(), for when state outside of the
+	// property values that the structs are resolved from has changed.
+	void invalidate() {
+		for (uint64_t &property_values_version : property_values_versions) {
+			property_values_version = 0;
+		}
+	}
+
+	void erase(const void *p_layer) {
+		for (uint32_t i = 0; i < layers.size(); i++) {
+			if (layers[i] == p_layer) {
+				layers[i] = nullptr;
+				break;
+			}
+		}
+		OpenXRFbCompositionLayerPropertyTracker::erase(p_layer);
+	}
+
+	void clear() {
+		for (const void *layer : layers) {
+			if (layer != nullptr) {
+				OpenXRFbCompositionLayerPropertyTracker::erase(layer);
+			}
+		}
+		for (Entry *page : pages) {
+			memdelete_arr(page);
+		}
+		pages.clear();
+		layers.clear();
+		property_values_versions.clear();
+	}
+
+	~OpenXRFbCompositionLayerStructCache() {
+		clear();
+	}
+
+private:
+	static constexpr uint32_t PAGE_SIZE = 16;
+
+	Entry *get_slot(uint32_t p_slot) {
+		return &pages[p_slot / PAGE_SIZE][p_slot % PAGE_SIZE];
+	}
+
+	LocalVector<const void *> layers;
+	LocalVector<uint64_t> property_values_versions;
+	LocalVector<Entry *> pages;
+};
@@ -0,0 +1,84 @@
+/**************************************************************************/
+/*  openxr_fb_passthrough_hole_punch_batcher.h                            */
+/**************************************************************************/
+/*                       This file is part of:                            */
+/*                              GODOT XR                                  */
+/*                      https://godotengine.org                           */
+/**************************************************************************/
+/* Copyright (c) 2022-present Godot XR contributors (see CONTRIBUTORS.md) */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#pragma once
+
+#include <godot_cpp/classes/mesh.hpp>
+#include <godot_cpp/classes/shader_material.hpp>
+#include <godot_cpp/templates/hash_map.hpp>
+#include <godot_cpp/templates/local_vector.hpp>
+
+using namespace godot;
+
+// Draws the hole punch geometry of all passthrough geometries, which clears the alpha of the
+// projection layer so passthrough shows through.
+//
+// Geometries sharing a mesh and scenario are drawn by a single MultiMesh instance, and every
+// batch uses the same material, so many passthrough windows cost one draw call per distinct
+// mesh. Changes only mark their batch as dirty; the MultiMesh buffers are rewritten by flush().
+class OpenXRFbPassthroughHolePunchBatcher {
+public:
+	// Adds or updates the hole punch geometry of p_owner. Returns true if a flush is needed.
+	bool update(uint64_t p_owner, RID p_scenario, const Ref<Mesh> &p_mesh, const Transform3D &p_transform);
+
+	// Removes the hole punch geometry of p_owner. Returns true if a flush is needed.
+	bool remove(uint64_t p_owner);
+
+	// Uploads the transforms of all dirty batches, and frees empty ones.
+	void flush();
+
+	void clear();
+
+	~OpenXRFbPassthroughHolePunchBatcher();
+
+private:
+	struct Batch {
+		RID scenario;
+		Ref<Mesh> mesh;
+		RID multimesh;
+		RID instance;
+		LocalVector<uint64_t> owners;
+		uint32_t allocated_count = 0;
+		bool dirty = false;
+	};
+
+	struct Entry {
+		RID scenario;
+		RID mesh;
+		Transform3D transform;
+	};
+
+	LocalVector<Batch> batches;
+	HashMap<uint64_t, Entry> entries;
+	Ref<ShaderMaterial> material;
+
+	Batch *find_batch(RID p_scenario, RID p_mesh);
+	void free_batch(Batch &p_batch);
+	RID get_material();
+};
@@ -0,0 +1,78 @@
+/**************************************************************************/
+/*  openxr_one_euro_filter.h                                              */
+/**************************************************************************/
+/*                       This file is part of:                            */
+/*                              GODOT XR                                  */
+/*                      https://godotengine.org                           */
+/**************************************************************************/
+/* Copyright (c) 2022-present Godot XR contributors (see CONTRIBUTORS.md) */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#pragma once
+
+#include <openxr/openxr.h>
+#include <godot_cpp/templates/local_vector.hpp>
+#include <godot_cpp/variant/quaternion.hpp>
+#include <godot_cpp/variant/vector3.hpp>
+
+using namespace godot;
+
+// A One Euro filter (Casiez et al. 2012) over contiguous arrays of tracking data, with
+// optional velocity based prediction to make up for the latency added by the smoothing.
+//
+// Values are filtered in groups (for example, the 3 components of a position), and the
+// cutoff frequency of each group adapts to the speed of the group as a whole.
+class OpenXROneEuroFilter {
+public:
+	struct Parameters {
+		// Cutoff frequency (in Hz) used when the value isn't moving. Lower values remove more jitter.
+		float min_cutoff = 1.0;
+		// How much the cutoff frequency increases with speed. Higher values reduce lag on fast movements.
+		float beta = 0.0;
+		// Cutoff frequency (in Hz) used to smooth the speed estimate.
+		float derivative_cutoff = 1.0;
+		// Time (in seconds) to extrapolate the filtered values forward by.
+		float prediction_time = 0.0;
+	};
+
+	// Filters p_count groups of p_group_size values in place. Groups whose entry in p_valid is
+	// false are passed through, and their filter state is reset.
+	void filter(float *r_values, uint32_t p_count, uint32_t p_group_size, XrTime p_time, const Parameters &p_parameters, const bool *p_valid = nullptr);
+
+	void filter_positions(Vector3 *r_positions, uint32_t p_count, XrTime p_time, const Parameters &p_parameters, const bool *p_valid = nullptr);
+
+	// Rotations are filtered component wise after being moved into the same hemisphere as the
+	// previous filtered rotation, and then normalized.
+	void filter_rotations(Quaternion *r_rotations, uint32_t p_count, XrTime p_time, const Parameters &p_parameters, const bool *p_valid = nullptr);
+
+	void reset();
+
+private:
+	template <typename T>
+	void _filter(T *r_values, uint32_t p_count, uint32_t p_group_size, XrTime p_time, const Parameters &p_parameters, const bool *p_valid);
+
+	XrTime last_time = 0;
+
+	LocalVector<float> filtered_values;
+	LocalVector<float> derivatives;
+	LocalVector<bool> initialized;
+};
@@ -0,0 +1,260 @@
+/**************************************************************************/
+/*  openxr_environment_depth_hand_mask.cpp                                */
+/**************************************************************************/
+/*                       This file is part of:                            */
+/*                              GODOT XR                                  */
+/*                      https://godotengine.org                           */
+/**************************************************************************/
+/* Copyright (c) 2022-present Godot XR contributors (see CONTRIBUTORS.md) */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#include "openxr_environment_depth_hand_mask.h"
+
+#include <godot_cpp/classes/rendering_server.hpp>
+#include <godot_cpp/classes/xr_hand_tracker.hpp>
+#include <godot_cpp/classes/xr_server.hpp>
+#include <godot_cpp/core/error_macros.hpp>
+#include <godot_cpp/core/math.hpp>
+#include <godot_cpp/variant/aabb.hpp>
+#include <godot_cpp/variant/typed_array.hpp>
+
+static const int CAPSULE_STRIDE = 7;
+
+// Capsules closer to the depth camera than this cover the whole view.
+static const float NEAR_DEPTH = 0.01;
+
+// Some runtimes report a zero radius for the finger tips.
+static const float MIN_JOINT_RADIUS = 0.005;
+
+static const int JOINT_PARENTS[XRHandTracker::HAND_JOINT_MAX] = {
+	1, -1, 1, 2, 3, 4, 1, 6, 7, 8, 9, 1, 11, 12, 13, 14, 1, 16, 17, 18, 19, 1, 21, 22, 23, 24
+};
+
+// Returns the depth at which a ray from the origin along p_direction, whose z is -1, enters the
+// capsule, or -1.0 if it misses it.
+static float intersect_capsule(const Vector3 &p_direction, const Vector3 &p_a, const Vector3 &p_b, float p_radius) {
+	Vector3 ba = p_b - p_a;
+	Vector3 oa = -p_a;
+
+	float baba = ba.dot(ba);
+	float bard = ba.dot(p_direction);
+	float baoa = ba.dot(oa);
+	float rdoa = p_direction.dot(oa);
+	float rdrd = p_direction.dot(p_direction);
+	float radius_squared = p_radius * p_radius;
+
+	// The cylinder around the segment.
+	float a = baba * rdrd - bard * bard;
+	float y = baoa;
+	if (a > CMP_EPSILON) {
+		float b = baba * rdoa - baoa * bard;
+		float c = baba * oa.dot(oa) - baoa * baoa - radius_squared * baba;
+		float h = b * b - a * c;
+		if (h < 0.0) {
+			return -1.0;
+		}
+		float t = (-b - Math::sqrt(h)) / a;
+		y = baoa + t * bard;
+		if (y > 0.0 && y < baba) {
+			return t;
+		}
+	}
+
+	// The sphere at the end the ray is closest to.
+	Vector3 oc = y <= 0.0 ? oa : -p_b;
+	float b = p_direction.dot(oc);
+	float c = oc.dot(oc) - radius_squared;
+	float h = b * b - rdrd * c;
+	if (h < 0.0) {
+		return -1.0;
+	}
+	return (-b - Math::sqrt(h)) / rdrd;
+}
+
+PackedFloat32Array OpenXREnvironmentDepthHandMask::gather_capsules() {
+	PackedFloat32Array ret;
+
+	XRServer *xr_server = XRServer::get_singleton();
+	ERR_FAIL_NULL_V(xr_server, ret);
+
+	Transform3D world_origin = xr_server->get_world_origin();
+
+	const char *tracker_names[] = { "/user/hand_tracker/left", "/user/hand_tracker/right" };
+	for (const char *tracker_name : tracker_names) {
+		Ref<XRHandTracker> tracker = xr_server->get_tracker(tracker_name);
+		if (tracker.is_null() || !tracker->get_has_tracking_data()) {
+			continue;
+		}
+
+		for (int i = 0; i < XRHandTracker::HAND_JOINT_MAX; i++) {
+			int parent = JOINT_PARENTS[i];
+			if (parent < 0) {
+				continue;
+			}
+
+			const XRHandTracker::HandJoint joint = (XRHandTracker::HandJoint)i;
+			const XRHandTracker::HandJoint parent_joint = (XRHandTracker::HandJoint)parent;
+			if (!tracker->get_hand_joint_flags(joint).has_flag(XRHandTracker::HAND_JOINT_FLAG_POSITION_VALID) ||
+					!tracker->get_hand_joint_flags(parent_joint).has_flag(XRHandTracker::HAND_JOINT_FLAG_POSITION_VALID)) {
+				continue;
+			}
+
+			Vector3 a = world_origin.xform(tracker->get_hand_joint_transform(parent_joint).origin);
+			Vector3 b = world_origin.xform(tracker->get_hand_joint_transform(joint).origin);
+			float radius = MAX(MAX(tracker->get_hand_joint_radius(parent_joint), tracker->get_hand_joint_radius(joint)), MIN_JOINT_RADIUS);
+
+			ret.push_back(a.x);
+			ret.push_back(a.y);
+			ret.push_back(a.z);
+			ret.push_back(b.x);
+			ret.push_back(b.y);
+			ret.push_back(b.z);
+			ret.push_back(radius);
+		}
+	}
+
+	return ret;
+}
+
+void OpenXREnvironmentDepthHandMask::set_capsules(const PackedFloat32Array &p_capsules) {
+	capsules = p_capsules;
+}
+
+void OpenXREnvironmentDepthHandMask::render_view(int p_view, const Transform3D &p_depth_view_to_world, const Vector4 &p_tan_fov) {
+	ERR_FAIL_INDEX(p_view, VIEW_COUNT);
+
+	PackedByteArray &view_data = data[p_view];
+	if (view_data.is_empty()) {
+		view_data.resize(RESOLUTION * RESOLUTION * sizeof(float));
+	}
+	view_data.fill(0);
+
+	if (capsules.is_empty()) {
+		return;
+	}
+
+	float *mask = reinterpret_cast<float *>(view_data.ptrw());
+
+	Transform3D world_to_view = p_depth_view_to_world.affine_inverse();
+	float tan_width = p_tan_fov.y - p_tan_fov.x;
+	float tan_height = p_tan_fov.w - p_tan_fov.z;
+
+	const float *capsule = capsules.ptr();
+	int capsule_count = capsules.size() / CAPSULE_STRIDE;
+	for (int i = 0; i < capsule_count; i++, capsule += CAPSULE_STRIDE) {
+		Vector3 a = world_to_view.xform(Vector3(capsule[0], capsule[1], capsule[2]));
+		Vector3 b = world_to_view.xform(Vector3(capsule[3], capsule[4], capsule[5]));
+		float radius = capsule[6];
+
+		AABB bounds = AABB(a, Vector3()).expand(b).grow(radius);
+		float min_depth = -bounds.get_end().z;
+		float max_depth = -bounds.position.z;
+		if (max_depth <= NEAR_DEPTH) {
+			continue;
+		}
+
+		// Only the texels covered by the capsule's bounds, as seen from the depth camera, are
+		// tested.
+		int x_begin = 0;
+		int x_end = RESOLUTION;
+		int y_begin = 0;
+		int y_end = RESOLUTION;
+		if (min_depth > NEAR_DEPTH) {
+			Vector3 end = bounds.get_end();
+			float tan_x_min = MIN(bounds.position.x / min_depth, bounds.position.x / max_depth);
+			float tan_x_max = MAX(end.x / min_depth, end.x / max_depth);
+			float tan_y_min = MIN(bounds.position.y / min_depth, bounds.position.y / max_depth);
+			float tan_y_max = MAX(end.y / min_depth, end.y / max_depth);
+
+			x_begin = MAX(x_begin, (int)Math::floor((tan_x_min - p_tan_fov.x) / tan_width * RESOLUTION));
+			x_end = MIN(x_end, (int)Math::ceil((tan_x_max - p_tan_fov.x) / tan_width * RESOLUTION));
+			y_begin = MAX(y_begin, (int)Math::floor((tan_y_min - p_tan_fov.z) / tan_height * RESOLUTION));
+			y_end = MIN(y_end, (int)Math::ceil((tan_y_max - p_tan_fov.z) / tan_height * RESOLUTION));
+		}
+
+		for (int y = y_begin; y < y_end; y++) {
+			float tan_y = p_tan_fov.z + (y + 0.5f) * tan_height / RESOLUTION;
+			float *row = mask + y * RESOLUTION;
+			for (int x = x_begin; x < x_end; x++) {
+				float tan_x = p_tan_fov.x + (x + 0.5f) * tan_width / RESOLUTION;
+				float depth = intersect_capsule(Vector3(tan_x, tan_y, -1.0), a, b, radius);
+				if (depth > 0.0 && (row[x] == 0.0 || depth < row[x])) {
+					row[x] = depth;
+				}
+			}
+		}
+	}
+}
+
+RID OpenXREnvironmentDepthHandMask::update() {
+	RenderingServer *rs = RenderingServer::get_singleton();
+	ERR_FAIL_NULL_V(rs, RID());
+
+	// Without any hands, there's nothing new to upload after the first empty frame.
+	bool empty = capsules.is_empty();
+	if (empty && uploaded_empty && texture.is_valid()) {
+		return texture;
+	}
+
+	for (int i = 0; i < VIEW_COUNT; i++) {
+		if (data[i].is_empty()) {
+			data[i].resize(RESOLUTION * RESOLUTION * sizeof(float));
+			data[i].fill(0);
+		}
+
+		if (images[i].is_null()) {
+			images[i] = Image::create_from_data(RESOLUTION, RESOLUTION, false, Image::FORMAT_RF, data[i]);
+		} else {
+			images[i]->set_data(RESOLUTION, RESOLUTION, false, Image::FORMAT_RF, data[i]);
+		}
+	}
+
+	if (likely(texture.is_valid())) {
+		for (int i = 0; i < VIEW_COUNT; i++) {
+			rs->texture_2d_update(texture, images[i], i);
+		}
+	} else {
+		TypedArray<Image> layers;
+		for (int i = 0; i < VIEW_COUNT; i++) {
+			layers.push_back(images[i]);
+		}
+		texture = rs->texture_2d_layered_create(layers, RenderingServer::TEXTURE_LAYERED_2D_ARRAY);
+	}
+
+	uploaded_empty = empty;
+	return texture;
+}
+
+void OpenXREnvironmentDepthHandMask::clear() {
+	RenderingServer *rs = RenderingServer::get_singleton();
+	if (rs != nullptr && texture.is_valid()) {
+		rs->free_rid(texture);
+	}
+	texture = RID();
+
+	for (int i = 0; i < VIEW_COUNT; i++) {
+		data[i] = PackedByteArray();
+		images[i].unref();
+	}
+	capsules = PackedFloat32Array();
+	uploaded_empty = false;
+}
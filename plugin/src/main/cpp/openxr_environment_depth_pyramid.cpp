@@ -0,0 +1,296 @@
+/**************************************************************************/
+/*  openxr_environment_depth_pyramid.cpp                                  */
+/**************************************************************************/
+/*                       This file is part of:                            */
+/*                              GODOT XR                                  */
+/*                      https://godotengine.org                           */
+/**************************************************************************/
+/* Copyright (c) 2022-present Godot XR contributors (see CONTRIBUTORS.md) */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#include "openxr_environment_depth_pyramid.h"
+
+#include <godot_cpp/core/error_macros.hpp>
+#include <godot_cpp/core/math.hpp>
+#include <godot_cpp/variant/vector2.hpp>
+
+// Volumes closer than this to the depth camera are always considered visible.
+static const float MIN_TEST_DEPTH = 0.01;
+
+static inline float get_linear_depth(float p_depth) {
+	return (p_depth > 0.0f && !Math::is_inf(p_depth)) ? p_depth : INFINITY;
+}
+
+PackedFloat32Array OpenXREnvironmentDepthPyramid::build_levels(const float *p_depth, int p_width, int p_height, Vector2i &r_size) {
+	ERR_FAIL_NULL_V(p_depth, PackedFloat32Array());
+	ERR_FAIL_COND_V(p_width <= 0 || p_height <= 0, PackedFloat32Array());
+
+	r_size = Vector2i((p_width + BASE_TILE_SIZE - 1) / BASE_TILE_SIZE, (p_height + BASE_TILE_SIZE - 1) / BASE_TILE_SIZE);
+
+	PackedFloat32Array levels;
+	levels.resize(r_size.x * r_size.y * 2);
+	float *dst = levels.ptrw();
+
+	for (int y = 0; y < r_size.y; y++) {
+		int src_y_end = MIN((y + 1) * BASE_TILE_SIZE, p_height);
+		for (int x = 0; x < r_size.x; x++) {
+			int src_x_end = MIN((x + 1) * BASE_TILE_SIZE, p_width);
+
+			float min_depth = INFINITY;
+			float max_depth = 0.0f;
+			for (int src_y = y * BASE_TILE_SIZE; src_y < src_y_end; src_y++) {
+				const float *src = p_depth + src_y * p_width;
+				for (int src_x = x * BASE_TILE_SIZE; src_x < src_x_end; src_x++) {
+					float depth = get_linear_depth(src[src_x]);
+					min_depth = MIN(min_depth, depth);
+					max_depth = MAX(max_depth, depth);
+				}
+			}
+
+			float *texel = dst + (y * r_size.x + x) * 2;
+			texel[0] = min_depth;
+			texel[1] = max_depth;
+		}
+	}
+
+	build_next_levels(levels, r_size);
+	return levels;
+}
+
+PackedFloat32Array OpenXREnvironmentDepthPyramid::build_levels_from_min_max(const float *p_min_max, int p_width, int p_height) {
+	ERR_FAIL_NULL_V(p_min_max, PackedFloat32Array());
+	ERR_FAIL_COND_V(p_width <= 0 || p_height <= 0, PackedFloat32Array());
+
+	PackedFloat32Array levels;
+	levels.resize(p_width * p_height * 2);
+	memcpy(levels.ptrw(), p_min_max, p_width * p_height * 2 * sizeof(float));
+
+	build_next_levels(levels, Vector2i(p_width, p_height));
+	return levels;
+}
+
+void OpenXREnvironmentDepthPyramid::build_next_levels(PackedFloat32Array &r_levels, const Vector2i &p_size) {
+	int64_t total_size = 0;
+	Vector2i size = p_size;
+	while (true) {
+		total_size += size.x * size.y * 2;
+		if (size.x == 1 && size.y == 1) {
+			break;
+		}
+		size = Vector2i((size.x + 1) / 2, (size.y + 1) / 2);
+	}
+	r_levels.resize(total_size);
+
+	float *src = r_levels.ptrw();
+	Vector2i src_size = p_size;
+	while (src_size.x > 1 || src_size.y > 1) {
+		Vector2i dst_size((src_size.x + 1) / 2, (src_size.y + 1) / 2);
+		float *dst = src + src_size.x * src_size.y * 2;
+
+		for (int y = 0; y < dst_size.y; y++) {
+			int src_y_end = MIN(y * 2 + 2, src_size.y);
+			for (int x = 0; x < dst_size.x; x++) {
+				int src_x_end = MIN(x * 2 + 2, src_size.x);
+
+				float min_depth = INFINITY;
+				float max_depth = 0.0f;
+				for (int src_y = y * 2; src_y < src_y_end; src_y++) {
+					for (int src_x = x * 2; src_x < src_x_end; src_x++) {
+						const float *texel = src + (src_y * src_size.x + src_x) * 2;
+						min_depth = MIN(min_depth, texel[0]);
+						max_depth = MAX(max_depth, texel[1]);
+					}
+				}
+
+				float *texel = dst + (y * dst_size.x + x) * 2;
+				texel[0] = min_depth;
+				texel[1] = max_depth;
+			}
+		}
+
+		src = dst;
+		src_size = dst_size;
+	}
+}
+
+void OpenXREnvironmentDepthPyramid::set_view(int p_view, const Vector2i &p_size, const PackedFloat32Array &p_levels, const Transform3D &p_world_to_view, const Vector4 &p_tan_fov, bool p_flip_y) {
+	ERR_FAIL_INDEX(p_view, VIEW_COUNT);
+	ERR_FAIL_COND(p_size.x <= 0 || p_size.y <= 0);
+
+	View &view = views[p_view];
+	view.level_sizes.clear();
+	view.level_offsets.clear();
+
+	uint32_t offset = 0;
+	Vector2i size = p_size;
+	while (true) {
+		view.level_sizes.push_back(size);
+		view.level_offsets.push_back(offset);
+		offset += size.x * size.y * 2;
+		if (size.x == 1 && size.y == 1) {
+			break;
+		}
+		size = Vector2i((size.x + 1) / 2, (size.y + 1) / 2);
+	}
+
+	if (p_levels.size() != offset) {
+		ERR_PRINT("Environment depth pyramid has an unexpected size.");
+		view.levels = PackedFloat32Array();
+		return;
+	}
+
+	view.levels = p_levels;
+	view.world_to_view = p_world_to_view;
+	view.tan_fov = p_tan_fov;
+	view.flip_y = p_flip_y;
+}
+
+void OpenXREnvironmentDepthPyramid::clear() {
+	for (View &view : views) {
+		view.levels = PackedFloat32Array();
+		view.level_sizes.clear();
+		view.level_offsets.clear();
+	}
+}
+
+bool OpenXREnvironmentDepthPyramid::is_valid() const {
+	for (const View &view : views) {
+		if (view.levels.is_empty()) {
+			return false;
+		}
+	}
+	return true;
+}
+
+PackedByteArray OpenXREnvironmentDepthPyramid::test_spheres(const PackedFloat32Array &p_spheres, float p_bias) const {
+	ERR_FAIL_COND_V_MSG(p_spheres.size() % 4 != 0, PackedByteArray(), "Spheres must be packed as (x, y, z, radius).");
+
+	int count = p_spheres.size() / 4;
+	PackedByteArray result;
+	result.resize((count + 7) / 8);
+	result.fill(0);
+
+	bool valid = is_valid();
+	const float *src = p_spheres.ptr();
+	uint8_t *dst = result.ptrw();
+	for (int i = 0; i < count; i++) {
+		const float *sphere = src + i * 4;
+		float radius = sphere[3];
+		if (!valid || !is_box_occluded(Vector3(sphere[0] - radius, sphere[1] - radius, sphere[2] - radius), Vector3(radius, radius, radius) * 2.0, p_bias)) {
+			dst[i >> 3] |= 1 << (i & 7);
+		}
+	}
+
+	return result;
+}
+
+PackedByteArray OpenXREnvironmentDepthPyramid::test_aabbs(const PackedFloat32Array &p_aabbs, float p_bias) const {
+	ERR_FAIL_COND_V_MSG(p_aabbs.size() % 6 != 0, PackedByteArray(), "AABBs must be packed as (position x, y, z, size x, y, z).");
+
+	int count = p_aabbs.size() / 6;
+	PackedByteArray result;
+	result.resize((count + 7) / 8);
+	result.fill(0);
+
+	bool valid = is_valid();
+	const float *src = p_aabbs.ptr();
+	uint8_t *dst = result.ptrw();
+	for (int i = 0; i < count; i++) {
+		const float *aabb = src + i * 6;
+		if (!valid || !is_box_occluded(Vector3(aabb[0], aabb[1], aabb[2]), Vector3(aabb[3], aabb[4], aabb[5]), p_bias)) {
+			dst[i >> 3] |= 1 << (i & 7);
+		}
+	}
+
+	return result;
+}
+
+bool OpenXREnvironmentDepthPyramid::is_box_occluded(const Vector3 &p_position, const Vector3 &p_size, float p_bias) const {
+	Vector3 corners[8];
+	for (int i = 0; i < 8; i++) {
+		corners[i] = Vector3(
+				p_position.x + ((i & 1) ? p_size.x : 0.0),
+				p_position.y + ((i & 2) ? p_size.y : 0.0),
+				p_position.z + ((i & 4) ? p_size.z : 0.0));
+	}
+
+	// Only hidden if it's hidden from both depth cameras.
+	for (const View &view : views) {
+		if (!is_occluded(view, corners, p_bias)) {
+			return false;
+		}
+	}
+	return true;
+}
+
+bool OpenXREnvironmentDepthPyramid::is_occluded(const View &p_view, const Vector3 *p_corners, float p_bias) const {
+	float nearest_depth = INFINITY;
+	Vector2 uv_min(INFINITY, INFINITY);
+	Vector2 uv_max(-INFINITY, -INFINITY);
+
+	for (int i = 0; i < 8; i++) {
+		Vector3 point = p_view.world_to_view.xform(p_corners[i]);
+		float depth = -point.z;
+		if (depth < MIN_TEST_DEPTH) {
+			return false;
+		}
+		nearest_depth = MIN(nearest_depth, depth);
+
+		Vector2 uv(
+				(point.x / depth - p_view.tan_fov.x) / (p_view.tan_fov.y - p_view.tan_fov.x),
+				(point.y / depth - p_view.tan_fov.z) / (p_view.tan_fov.w - p_view.tan_fov.z));
+		if (p_view.flip_y) {
+			uv.y = 1.0 - uv.y;
+		}
+		uv_min = uv_min.min(uv);
+		uv_max = uv_max.max(uv);
+	}
+
+	// We know nothing about what lies outside of the depth camera's view.
+	if (uv_min.x < 0.0 || uv_min.y < 0.0 || uv_max.x > 1.0 || uv_max.y > 1.0) {
+		return false;
+	}
+
+	const Vector2i &base_size = p_view.level_sizes[0];
+	int x0 = MIN(int(uv_min.x * base_size.x), base_size.x - 1);
+	int y0 = MIN(int(uv_min.y * base_size.y), base_size.y - 1);
+	int x1 = MIN(int(uv_max.x * base_size.x), base_size.x - 1);
+	int y1 = MIN(int(uv_max.y * base_size.y), base_size.y - 1);
+
+	// Pick the finest level where the rect is covered by at most 2x2 texels.
+	uint32_t level = 0;
+	while (level + 1 < p_view.level_sizes.size() && ((x1 >> level) - (x0 >> level) > 1 || (y1 >> level) - (y0 >> level) > 1)) {
+		level++;
+	}
+
+	const Vector2i &level_size = p_view.level_sizes[level];
+	const float *texels = p_view.levels.ptr() + p_view.level_offsets[level];
+
+	float max_depth = 0.0f;
+	for (int y = y0 >> level; y <= (y1 >> level); y++) {
+		for (int x = x0 >> level; x <= (x1 >> level); x++) {
+			max_depth = MAX(max_depth, texels[(y * level_size.x + x) * 2 + 1]);
+		}
+	}
+
+	return nearest_depth > max_depth + p_bias;
+}
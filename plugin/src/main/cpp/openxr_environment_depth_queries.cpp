@@ -0,0 +1,499 @@
+/**************************************************************************/
+/*  openxr_environment_depth_queries.cpp                                  */
+/**************************************************************************/
+/*                       This file is part of:                            */
+/*                              GODOT XR                                  */
+/*                      https://godotengine.org                           */
+/**************************************************************************/
+/* Copyright (c) 2022-present Godot XR contributors (see CONTRIBUTORS.md) */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#include "openxr_environment_depth_queries.h"
+
+#include <godot_cpp/core/error_macros.hpp>
+#include <godot_cpp/core/math.hpp>
+#include <godot_cpp/templates/local_vector.hpp>
+
+// Points closer to the depth camera than this are never tested.
+static const float NEAR_DEPTH = 0.05;
+
+// Rays step by roughly one texel, but never by less than this many meters.
+static const float MIN_STEP = 0.01;
+static const int MAX_STEPS = 1024;
+
+// A ray which ends up further than this many meters (plus one step) behind the environment is
+// considered to pass behind a foreground object, rather than to hit it.
+static const float HIT_THICKNESS = 0.1;
+
+static const int REFINE_STEPS = 6;
+
+// Plane fits look at no more than this many texels in each direction around the query.
+static const int MAX_PLANE_TEXEL_RADIUS = 8;
+static const int MIN_PLANE_POINTS = 6;
+
+// Outliers are further from the first fit than this many times its RMS distance, or than
+// MIN_OUTLIER_DISTANCE meters, whichever is larger.
+static const float OUTLIER_RMS_RATIO = 2.5;
+static const float MIN_OUTLIER_DISTANCE = 0.005;
+
+namespace {
+
+// A view of the depth image of a frame, in the view space of the depth camera, which looks down
+// -Z.
+struct DepthImage {
+	const float *depth = nullptr;
+	int width = 0;
+	int height = 0;
+	Vector4 tan_fov;
+	float tan_width = 0.0;
+	float tan_height = 0.0;
+	// The tangent of the angle covered by a texel.
+	float texel_tan = 0.0;
+	bool flip_y = false;
+
+	explicit DepthImage(const OpenXREnvironmentDepthFrame &p_frame) {
+		depth = p_frame.depth.ptr();
+		width = p_frame.width;
+		height = p_frame.height;
+		tan_fov = p_frame.tan_fov;
+		tan_width = tan_fov.y - tan_fov.x;
+		tan_height = tan_fov.w - tan_fov.z;
+		texel_tan = MIN(tan_width / width, tan_height / height);
+		flip_y = p_frame.flip_y;
+	}
+
+	// Returns the texel a view space point projects to, or false if it's outside the image.
+	bool project(const Vector3 &p_point, int &r_x, int &r_y) const {
+		float point_depth = -p_point.z;
+		float u = (p_point.x / point_depth - tan_fov.x) / tan_width;
+		float v = (p_point.y / point_depth - tan_fov.z) / tan_height;
+		if (!(u >= 0.0f && u < 1.0f && v >= 0.0f && v < 1.0f)) {
+			return false;
+		}
+		r_x = MIN((int)(u * width), width - 1);
+		r_y = MIN((int)((flip_y ? 1.0f - v : v) * height), height - 1);
+		return true;
+	}
+
+	// Returns the linear depth of a texel, or 0.0 if it's unknown.
+	float get_depth(int p_x, int p_y) const {
+		if (p_x < 0 || p_y < 0 || p_x >= width || p_y >= height) {
+			return 0.0;
+		}
+		float value = depth[p_y * width + p_x];
+		return value > 0.0f && !Math::is_inf(value) ? value : 0.0f;
+	}
+
+	Vector3 unproject(int p_x, int p_y, float p_depth) const {
+		float tan_x = tan_fov.x + (p_x + 0.5f) * tan_width / width;
+		float tan_y = flip_y ? tan_fov.w - (p_y + 0.5f) * tan_height / height : tan_fov.z + (p_y + 0.5f) * tan_height / height;
+		return Vector3(tan_x * p_depth, tan_y * p_depth, -p_depth);
+	}
+
+	// Returns the view space normal of the surface at a texel, facing the depth camera, or a zero
+	// vector if there isn't enough depth around it.
+	Vector3 estimate_normal(int p_x, int p_y) const {
+		float center_depth = get_depth(p_x, p_y);
+		if (center_depth <= 0.0f) {
+			return Vector3();
+		}
+		Vector3 center = unproject(p_x, p_y, center_depth);
+
+		// Of the two neighbors along each axis, the one closest in depth is used, so that depth
+		// edges don't bend the normal.
+		Vector3 tangents[2];
+		const int offsets[2][2] = { { 1, 0 }, { 0, 1 } };
+		for (int i = 0; i < 2; i++) {
+			float best_difference = Math_INF;
+			for (int sign = -1; sign <= 1; sign += 2) {
+				int x = p_x + sign * offsets[i][0];
+				int y = p_y + sign * offsets[i][1];
+				float neighbor_depth = get_depth(x, y);
+				if (neighbor_depth <= 0.0f || Math::abs(neighbor_depth - center_depth) >= best_difference) {
+					continue;
+				}
+				best_difference = Math::abs(neighbor_depth - center_depth);
+				tangents[i] = (unproject(x, y, neighbor_depth) - center) * sign;
+			}
+			if (Math::is_inf(best_difference)) {
+				return Vector3();
+			}
+		}
+
+		Vector3 normal = tangents[0].cross(tangents[1]);
+		if (normal.is_zero_approx()) {
+			return Vector3();
+		}
+		normal.normalize();
+		return normal.dot(center) > 0.0f ? -normal : normal;
+	}
+
+	// Returns true if a view space point is behind the environment, and writes the texel it
+	// projects to.
+	bool is_behind(const Vector3 &p_point, int &r_x, int &r_y, float &r_environment_depth) const {
+		r_environment_depth = 0.0;
+		if (-p_point.z <= NEAR_DEPTH || !project(p_point, r_x, r_y)) {
+			return false;
+		}
+		r_environment_depth = get_depth(r_x, r_y);
+		return r_environment_depth > 0.0f && -p_point.z >= r_environment_depth;
+	}
+};
+
+// Returns the eigenvalues of a symmetric 3x3 matrix, in ascending order.
+void get_symmetric_eigenvalues(const double p_matrix[3][3], double r_values[3]) {
+	double off_diagonal = p_matrix[0][1] * p_matrix[0][1] + p_matrix[0][2] * p_matrix[0][2] + p_matrix[1][2] * p_matrix[1][2];
+	double q = (p_matrix[0][0] + p_matrix[1][1] + p_matrix[2][2]) / 3.0;
+	double p = Math::sqrt(((p_matrix[0][0] - q) * (p_matrix[0][0] - q) + (p_matrix[1][1] - q) * (p_matrix[1][1] - q) + (p_matrix[2][2] - q) * (p_matrix[2][2] - q) + 2.0 * off_diagonal) / 6.0);
+	if (p < 1e-12) {
+		r_values[0] = r_values[1] = r_values[2] = q;
+		return;
+	}
+
+	double b[3][3];
+	for (int i = 0; i < 3; i++) {
+		for (int j = 0; j < 3; j++) {
+			b[i][j] = (p_matrix[i][j] - (i == j ? q : 0.0)) / p;
+		}
+	}
+	double half_determinant = 0.5 * (b[0][0] * (b[1][1] * b[2][2] - b[1][2] * b[2][1]) - b[0][1] * (b[1][0] * b[2][2] - b[1][2] * b[2][0]) + b[0][2] * (b[1][0] * b[2][1] - b[1][1] * b[2][0]));
+	double phi = Math::acos(CLAMP(half_determinant, -1.0, 1.0)) / 3.0;
+
+	r_values[2] = q + 2.0 * p * Math::cos(phi);
+	r_values[0] = q + 2.0 * p * Math::cos(phi + Math_TAU / 3.0);
+	r_values[1] = 3.0 * q - r_values[0] - r_values[2];
+}
+
+// Finds the eigenvector of a symmetric 3x3 matrix for one of its eigenvalues, as the longest cross
+// product of two rows of (matrix - value * identity). Returns false if the eigenvalue isn't
+// distinct enough for its eigenvector to be unique.
+bool get_symmetric_eigenvector(const double p_matrix[3][3], double p_value, Vector3 &r_vector) {
+	double rows[3][3];
+	for (int i = 0; i < 3; i++) {
+		for (int j = 0; j < 3; j++) {
+			rows[i][j] = p_matrix[i][j] - (i == j ? p_value : 0.0);
+		}
+	}
+
+	const int pairs[3][2] = { { 0, 1 }, { 0, 2 }, { 1, 2 } };
+	double best[3] = { 0.0, 0.0, 0.0 };
+	double best_length_squared = 0.0;
+	for (const int *pair : pairs) {
+		const double *u = rows[pair[0]];
+		const double *v = rows[pair[1]];
+		double cross[3] = {
+			u[1] * v[2] - u[2] * v[1],
+			u[2] * v[0] - u[0] * v[2],
+			u[0] * v[1] - u[1] * v[0],
+		};
+		double length_squared = cross[0] * cross[0] + cross[1] * cross[1] + cross[2] * cross[2];
+		if (length_squared > best_length_squared) {
+			best_length_squared = length_squared;
+			best[0] = cross[0];
+			best[1] = cross[1];
+			best[2] = cross[2];
+		}
+	}
+
+	if (best_length_squared < 1e-24) {
+		return false;
+	}
+
+	double length = Math::sqrt(best_length_squared);
+	r_vector = Vector3(best[0] / length, best[1] / length, best[2] / length);
+	return true;
+}
+
+// Fits a plane through the given points with principal component analysis. The eigenvalues of
+// their covariance are returned in ascending order, the first one being the mean squared distance
+// of the points to the plane.
+bool fit_plane(const LocalVector<Vector3> &p_points, Vector3 &r_centroid, Vector3 &r_normal, double r_eigenvalues[3]) {
+	if (p_points.size() < (uint32_t)MIN_PLANE_POINTS) {
+		return false;
+	}
+
+	Vector3 centroid;
+	for (const Vector3 &point : p_points) {
+		centroid += point;
+	}
+	centroid /= p_points.size();
+
+	double covariance[3][3] = {};
+	for (const Vector3 &point : p_points) {
+		Vector3 offset = point - centroid;
+		for (int i = 0; i < 3; i++) {
+			for (int j = i; j < 3; j++) {
+				covariance[i][j] += (double)offset[i] * offset[j];
+			}
+		}
+	}
+	for (int i = 0; i < 3; i++) {
+		for (int j = i; j < 3; j++) {
+			covariance[i][j] /= p_points.size();
+			covariance[j][i] = covariance[i][j];
+		}
+	}
+
+	get_symmetric_eigenvalues(covariance, r_eigenvalues);
+	if (!get_symmetric_eigenvector(covariance, r_eigenvalues[0], r_normal)) {
+		return false;
+	}
+
+	r_centroid = centroid;
+	return true;
+}
+
+// Estimates the plane around a world space position, see OpenXREnvironmentDepthQueries.
+bool estimate_plane_at(const DepthImage &p_image, const Transform3D &p_world_to_view, const Vector3 &p_position, float p_radius, LocalVector<Vector3> &r_scratch, Vector3 &r_position, Vector3 &r_normal, float &r_planarity) {
+	Vector3 query = p_world_to_view.xform(p_position);
+	int center_x, center_y;
+	if (-query.z <= NEAR_DEPTH || !p_image.project(query, center_x, center_y)) {
+		return false;
+	}
+
+	float center_depth = p_image.get_depth(center_x, center_y);
+	Vector3 center = center_depth > 0.0f ? p_image.unproject(center_x, center_y, center_depth) : query;
+	int texel_radius = CLAMP((int)Math::ceil(p_radius / (-center.z * p_image.texel_tan)), 1, MAX_PLANE_TEXEL_RADIUS);
+
+	LocalVector<Vector3> &points = r_scratch;
+	points.clear();
+	float radius_squared = p_radius * p_radius;
+	for (int y = center_y - texel_radius; y <= center_y + texel_radius; y++) {
+		for (int x = center_x - texel_radius; x <= center_x + texel_radius; x++) {
+			float texel_depth = p_image.get_depth(x, y);
+			if (texel_depth <= 0.0f) {
+				continue;
+			}
+			Vector3 point = p_image.unproject(x, y, texel_depth);
+			if (point.distance_squared_to(center) <= radius_squared) {
+				points.push_back(point);
+			}
+		}
+	}
+
+	Vector3 centroid;
+	Vector3 normal;
+	double eigenvalues[3];
+	if (!fit_plane(points, centroid, normal, eigenvalues)) {
+		return false;
+	}
+
+	// Drops the outliers of the first fit, such as the edge of another surface, and fits again.
+	uint32_t point_count = points.size();
+	float outlier_distance = MAX(OUTLIER_RMS_RATIO * (float)Math::sqrt(MAX(eigenvalues[0], 0.0)), MIN_OUTLIER_DISTANCE);
+	uint32_t inlier_count = 0;
+	for (uint32_t i = 0; i < point_count; i++) {
+		if (Math::abs(normal.dot(points[i] - centroid)) <= outlier_distance) {
+			points[inlier_count++] = points[i];
+		}
+	}
+	if (inlier_count < point_count) {
+		points.resize(inlier_count);
+		if (!fit_plane(points, centroid, normal, eigenvalues)) {
+			return false;
+		}
+	}
+
+	// How much flatter the points are than they are wide, scaled by how many of them were kept.
+	double eigenvalue_sum = eigenvalues[0] + eigenvalues[1] + eigenvalues[2];
+	double flatness = eigenvalue_sum > 0.0 ? CLAMP(1.0 - 3.0 * eigenvalues[0] / eigenvalue_sum, 0.0, 1.0) : 0.0;
+	r_planarity = flatness * inlier_count / point_count;
+
+	// The depth camera is at the origin.
+	if (normal.dot(centroid) > 0.0f) {
+		normal = -normal;
+	}
+	r_normal = normal;
+	r_position = query - normal * normal.dot(query - centroid);
+	return true;
+}
+
+} // namespace
+
+PackedFloat32Array OpenXREnvironmentDepthQueries::raycast(const OpenXREnvironmentDepthFrame &p_frame, const PackedFloat32Array &p_rays, float p_max_distance) {
+	PackedFloat32Array ret;
+	ERR_FAIL_COND_V(p_rays.size() % RAY_STRIDE != 0, ret);
+
+	int ray_count = p_rays.size() / RAY_STRIDE;
+	ret.resize(ray_count * RAY_HIT_STRIDE);
+	ret.fill(0.0);
+
+	float *hits = ret.ptrw();
+	for (int i = 0; i < ray_count; i++) {
+		hits[i * RAY_HIT_STRIDE + 6] = -1.0;
+	}
+
+	if (!_has_depth(p_frame)) {
+		return ret;
+	}
+
+	const DepthImage image(p_frame);
+	Transform3D world_to_view = p_frame.view_to_world.affine_inverse();
+
+	const float *rays = p_rays.ptr();
+	for (int i = 0; i < ray_count; i++) {
+		const float *ray = rays + i * RAY_STRIDE;
+		Vector3 world_direction = Vector3(ray[3], ray[4], ray[5]);
+		if (world_direction.is_zero_approx()) {
+			continue;
+		}
+		world_direction.normalize();
+
+		// The depth camera's transform is rigid, so distances are the same in both spaces.
+		Vector3 origin = world_to_view.xform(Vector3(ray[0], ray[1], ray[2]));
+		Vector3 direction = world_to_view.basis.xform(world_direction);
+
+		// A hit needs a step in front of the environment, followed by one behind it.
+		float front_t = -1.0;
+		float hit_t = -1.0;
+		float t = 0.0;
+		for (int step = 0; step < MAX_STEPS && t <= p_max_distance; step++) {
+			Vector3 point = origin + direction * t;
+			float step_length = MAX(-point.z * image.texel_tan, MIN_STEP);
+
+			int x, y;
+			float environment_depth;
+			if (image.is_behind(point, x, y, environment_depth)) {
+				if (front_t >= 0.0f && -point.z - environment_depth <= HIT_THICKNESS + step_length) {
+					hit_t = t;
+					break;
+				}
+				front_t = -1.0;
+			} else {
+				front_t = environment_depth > 0.0f ? t : -1.0f;
+			}
+
+			t += step_length;
+		}
+
+		if (hit_t < 0.0f) {
+			continue;
+		}
+
+		// Narrows the crossing down between the last step in front and the first one behind.
+		float low = front_t;
+		float high = hit_t;
+		for (int j = 0; j < REFINE_STEPS; j++) {
+			float middle = (low + high) * 0.5f;
+			int x, y;
+			float environment_depth;
+			if (image.is_behind(origin + direction * middle, x, y, environment_depth)) {
+				high = middle;
+			} else {
+				low = middle;
+			}
+		}
+		hit_t = MIN(high, p_max_distance);
+
+		Vector3 hit_point = origin + direction * hit_t;
+		Vector3 normal;
+		int x, y;
+		if (image.project(hit_point, x, y)) {
+			normal = image.estimate_normal(x, y);
+		}
+
+		Vector3 world_hit_point = p_frame.view_to_world.xform(hit_point);
+		Vector3 world_normal = p_frame.view_to_world.basis.xform(normal);
+
+		float *hit = hits + i * RAY_HIT_STRIDE;
+		hit[0] = world_hit_point.x;
+		hit[1] = world_hit_point.y;
+		hit[2] = world_hit_point.z;
+		hit[3] = world_normal.x;
+		hit[4] = world_normal.y;
+		hit[5] = world_normal.z;
+		hit[6] = hit_t;
+	}
+
+	return ret;
+}
+
+PackedFloat32Array OpenXREnvironmentDepthQueries::estimate_planes(const OpenXREnvironmentDepthFrame &p_frame, const PackedFloat32Array &p_positions, float p_radius) {
+	PackedFloat32Array ret;
+	ERR_FAIL_COND_V(p_positions.size() % 3 != 0, ret);
+	ERR_FAIL_COND_V(p_radius <= 0.0, ret);
+
+	int position_count = p_positions.size() / 3;
+	ret.resize(position_count * PLANE_STRIDE);
+	ret.fill(0.0);
+
+	if (!_has_depth(p_frame)) {
+		return ret;
+	}
+
+	const DepthImage image(p_frame);
+	Transform3D world_to_view = p_frame.view_to_world.affine_inverse();
+	LocalVector<Vector3> scratch;
+
+	const float *positions = p_positions.ptr();
+	float *planes = ret.ptrw();
+	for (int i = 0; i < position_count; i++) {
+		Vector3 position;
+		Vector3 normal;
+		float planarity;
+		if (!estimate_plane_at(image, world_to_view, Vector3(positions[i * 3], positions[i * 3 + 1], positions[i * 3 + 2]), p_radius, scratch, position, normal, planarity)) {
+			continue;
+		}
+
+		Vector3 world_position = p_frame.view_to_world.xform(position);
+		Vector3 world_normal = p_frame.view_to_world.basis.xform(normal);
+
+		float *plane = planes + i * PLANE_STRIDE;
+		plane[0] = world_position.x;
+		plane[1] = world_position.y;
+		plane[2] = world_position.z;
+		plane[3] = world_normal.x;
+		plane[4] = world_normal.y;
+		plane[5] = world_normal.z;
+		plane[6] = planarity;
+	}
+
+	return ret;
+}
+
+Dictionary OpenXREnvironmentDepthQueries::estimate_plane(const OpenXREnvironmentDepthFrame &p_frame, const Vector3 &p_position, float p_radius) {
+	Dictionary ret;
+
+	PackedFloat32Array positions;
+	positions.push_back(p_position.x);
+	positions.push_back(p_position.y);
+	positions.push_back(p_position.z);
+
+	PackedFloat32Array plane = estimate_planes(p_frame, positions, p_radius);
+	if (plane.size() < PLANE_STRIDE) {
+		return ret;
+	}
+
+	Vector3 normal = Vector3(plane[3], plane[4], plane[5]);
+	if (normal.is_zero_approx()) {
+		return ret;
+	}
+
+	ret["position"] = Vector3(plane[0], plane[1], plane[2]);
+	ret["normal"] = normal;
+	ret["planarity"] = plane[6];
+	return ret;
+}
+
+bool OpenXREnvironmentDepthQueries::_has_depth(const OpenXREnvironmentDepthFrame &p_frame) {
+	return p_frame.index != 0 && p_frame.width > 0 && p_frame.height > 0 && p_frame.depth.size() >= (int64_t)p_frame.width * p_frame.height;
+}
@@ -0,0 +1,125 @@
+/**************************************************************************/
+/*  openxr_environment_depth_receivers.cpp                                */
+/**************************************************************************/
+/*                       This file is part of:                            */
+/*                              GODOT XR                                  */
+/*                      https://godotengine.org                           */
+/**************************************************************************/
+/* Copyright (c) 2022-present Godot XR contributors (see CONTRIBUTORS.md) */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#include "openxr_environment_depth_receivers.h"
+
+#include <godot_cpp/classes/rendering_server.hpp>
+#include <godot_cpp/classes/xr_interface.hpp>
+#include <godot_cpp/classes/xr_server.hpp>
+#include <godot_cpp/core/object.hpp>
+
+void OpenXREnvironmentDepthReceivers::add(VisualInstance3D *p_receiver) {
+	ERR_FAIL_NULL(p_receiver);
+
+	uint64_t id = p_receiver->get_instance_id();
+	if (receivers.find(id) < 0) {
+		receivers.push_back(id);
+	}
+}
+
+void OpenXREnvironmentDepthReceivers::remove(VisualInstance3D *p_receiver) {
+	ERR_FAIL_NULL(p_receiver);
+
+	receivers.erase(p_receiver->get_instance_id());
+}
+
+void OpenXREnvironmentDepthReceivers::clear() {
+	receivers.clear();
+}
+
+bool OpenXREnvironmentDepthReceivers::get_view_projection(int p_view, Projection &r_view_projection) {
+	XRServer *xr_server = XRServer::get_singleton();
+	ERR_FAIL_NULL_V(xr_server, false);
+
+	Ref<XRInterface> openxr_interface = xr_server->find_interface("OpenXR");
+	if (openxr_interface.is_null() || !openxr_interface->is_initialized()) {
+		return false;
+	}
+
+	Vector2 viewport_size = openxr_interface->get_render_target_size();
+	float aspect = viewport_size.height > 0.0 ? viewport_size.width / viewport_size.height : 1.0;
+
+	// The near and far planes don't affect the screen space position, only depth.
+	r_view_projection = openxr_interface->get_projection_for_view(p_view, aspect, 0.05, 4000.0) * openxr_interface->get_transform_for_view(p_view, xr_server->get_world_origin()).affine_inverse();
+
+	RenderingServer *rs = RenderingServer::get_singleton();
+	if (rs != nullptr && rs->get_current_rendering_driver_name() == "vulkan") {
+		Projection correction;
+		correction.set_depth_correction(true);
+		r_view_projection = correction * r_view_projection;
+	}
+
+	return true;
+}
+
+Vector4 OpenXREnvironmentDepthReceivers::get_region(int p_view) {
+	Projection view_projection;
+	if (!get_view_projection(p_view, view_projection)) {
+		return Vector4(-1.0, -1.0, 1.0, 1.0);
+	}
+
+	Vector2 region_min(INFINITY, INFINITY);
+	Vector2 region_max(-INFINITY, -INFINITY);
+
+	uint32_t i = 0;
+	while (i < receivers.size()) {
+		VisualInstance3D *receiver = Object::cast_to<VisualInstance3D>(ObjectDB::get_instance(receivers[i]));
+		if (receiver == nullptr) {
+			receivers.remove_at_unordered(i);
+			continue;
+		}
+		i++;
+
+		if (!receiver->is_visible_in_tree()) {
+			continue;
+		}
+
+		AABB aabb = receiver->get_global_transform().xform(receiver->get_aabb());
+		for (int corner = 0; corner < 8; corner++) {
+			Vector3 point = aabb.get_endpoint(corner);
+			Vector4 clip = view_projection.xform(Vector4(point.x, point.y, point.z, 1.0));
+			if (clip.w <= 0.0) {
+				// The receiver crosses the camera plane, so it may cover any part of the screen.
+				return Vector4(-1.0, -1.0, 1.0, 1.0);
+			}
+
+			Vector2 ndc(clip.x / clip.w, clip.y / clip.w);
+			region_min = region_min.min(ndc);
+			region_max = region_max.max(ndc);
+		}
+	}
+
+	region_min = region_min.maxf(-1.0);
+	region_max = region_max.minf(1.0);
+	if (region_min.x >= region_max.x || region_min.y >= region_max.y) {
+		return Vector4();
+	}
+
+	return Vector4(region_min.x, region_min.y, region_max.x, region_max.y);
+}
@@ -0,0 +1,174 @@
+/**************************************************************************/
+/*  openxr_environment_depth_temporal_filter.cpp                          */
+/**************************************************************************/
+/*                       This file is part of:                            */
+/*                              GODOT XR                                  */
+/*                      https://godotengine.org                           */
+/**************************************************************************/
+/* Copyright (c) 2022-present Godot XR contributors (see CONTRIBUTORS.md) */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#include "openxr_environment_depth_temporal_filter.h"
+
+#include <godot_cpp/core/error_macros.hpp>
+#include <godot_cpp/core/math.hpp>
+
+// History is rejected if its depth differs from the new depth by more than this ratio plus
+// DISOCCLUSION_OFFSET meters.
+static const float DISOCCLUSION_RATIO = 0.05;
+static const float DISOCCLUSION_OFFSET = 0.02;
+
+// History with less weight than this is dropped where there is no new depth.
+static const float MIN_HISTORY_WEIGHT = 0.05;
+
+const float *OpenXREnvironmentDepthTemporalFilter::filter(int p_view, const float *p_depth, const uint8_t *p_confidence, int p_width, int p_height, const Transform3D &p_view_to_world, const Vector4 &p_tan_fov) {
+	ERR_FAIL_INDEX_V(p_view, VIEW_COUNT, p_depth);
+	ERR_FAIL_NULL_V(p_depth, p_depth);
+
+	View &view = views[p_view];
+	uint32_t texel_count = p_width * p_height;
+
+	bool has_history = view.width == p_width && view.height == p_height;
+	if (!has_history) {
+		for (int i = 0; i < 2; i++) {
+			view.depth[i].resize(texel_count);
+			view.weight[i].resize(texel_count);
+		}
+		view.width = p_width;
+		view.height = p_height;
+	}
+
+	const float *history_depth = view.depth[view.current].ptr();
+	const float *history_weights = view.weight[view.current].ptr();
+	view.current = 1 - view.current;
+	float *out_depth = view.depth[view.current].ptr();
+	float *out_weight = view.weight[view.current].ptr();
+
+	// Moves points from the current depth camera view into the previous one.
+	Transform3D current_to_history = view.world_to_view * p_view_to_world;
+	const Basis &basis = current_to_history.basis;
+	const Vector3 &origin = current_to_history.origin;
+
+	const Vector4 &tan_fov = p_tan_fov;
+	const Vector4 &history_tan_fov = view.tan_fov;
+	float tan_width = tan_fov.y - tan_fov.x;
+	float tan_height = tan_fov.w - tan_fov.z;
+	float history_tan_width = history_tan_fov.y - history_tan_fov.x;
+	float history_tan_height = history_tan_fov.w - history_tan_fov.z;
+
+	for (int y = 0; y < p_height; y++) {
+		// The first row is the top one.
+		float tan_y = tan_fov.w - (y + 0.5f) * tan_height / p_height;
+
+		for (int x = 0; x < p_width; x++) {
+			uint32_t i = y * p_width + x;
+			float depth = p_depth[i];
+			float confidence = p_confidence != nullptr ? p_confidence[i] / 255.0f : 1.0f;
+
+			if (!has_history) {
+				out_depth[i] = depth;
+				out_weight[i] = depth > 0.0f ? confidence : 0.0f;
+				continue;
+			}
+
+			if (!(depth > 0.0f) || Math::is_inf(depth)) {
+				// Without new depth there's nothing to reproject with, so briefly hold on to
+				// the history at the same texel instead of leaving a hole.
+				float weight = history_weights[i] * history_weight;
+				out_depth[i] = weight > MIN_HISTORY_WEIGHT ? history_depth[i] : depth;
+				out_weight[i] = weight > MIN_HISTORY_WEIGHT ? weight : 0.0f;
+				continue;
+			}
+
+			out_depth[i] = depth;
+			out_weight[i] = confidence;
+
+			float tan_x = tan_fov.x + (x + 0.5f) * tan_width / p_width;
+			Vector3 point = basis.xform(Vector3(tan_x * depth, tan_y * depth, -depth)) + origin;
+			float point_depth = -point.z;
+			if (point_depth <= 0.0f) {
+				continue;
+			}
+
+			int hx = (int)Math::floor((point.x / point_depth - history_tan_fov.x) / history_tan_width * p_width);
+			int hy = (int)Math::floor((history_tan_fov.w - point.y / point_depth) / history_tan_height * p_height);
+			if (hx < 0 || hy < 0 || hx >= p_width || hy >= p_height) {
+				continue;
+			}
+
+			uint32_t h = hy * p_width + hx;
+			float weight = history_weights[h] * history_weight;
+			if (weight <= 0.0f || Math::abs(history_depth[h] - point_depth) > point_depth * DISOCCLUSION_RATIO + DISOCCLUSION_OFFSET) {
+				continue;
+			}
+
+			// Move the history depth along the new texel's ray, so the camera motion doesn't
+			// bias the result.
+			float reprojected_depth = depth * history_depth[h] / point_depth;
+			out_depth[i] = (confidence * depth + weight * reprojected_depth) / (confidence + weight);
+			out_weight[i] = confidence + weight;
+		}
+	}
+
+	view.world_to_view = p_view_to_world.affine_inverse();
+	view.tan_fov = p_tan_fov;
+
+	return out_depth;
+}
+
+const float *OpenXREnvironmentDepthTemporalFilter::get_filtered(int p_view, int p_width, int p_height) const {
+	ERR_FAIL_INDEX_V(p_view, VIEW_COUNT, nullptr);
+
+	const View &view = views[p_view];
+	if (view.width != p_width || view.height != p_height) {
+		return nullptr;
+	}
+	return view.depth[view.current].ptr();
+}
+
+void OpenXREnvironmentDepthTemporalFilter::reset() {
+	for (View &view : views) {
+		for (int i = 0; i < 2; i++) {
+			view.depth[i].clear();
+			view.weight[i].clear();
+		}
+		view.width = 0;
+		view.height = 0;
+	}
+}
+
+bool OpenXREnvironmentDepthTemporalFilter::is_empty() const {
+	for (const View &view : views) {
+		if (view.width != 0) {
+			return false;
+		}
+	}
+	return true;
+}
+
+void OpenXREnvironmentDepthTemporalFilter::set_history_weight(float p_history_weight) {
+	history_weight = CLAMP(p_history_weight, 0.0, 0.95);
+}
+
+float OpenXREnvironmentDepthTemporalFilter::get_history_weight() const {
+	return history_weight;
+}
@@ -0,0 +1,252 @@
+/**************************************************************************/
+/*  openxr_environment_depth_uniforms.cpp                                 */
+/**************************************************************************/
+/*                       This file is part of:                            */
+/*                              GODOT XR                                  */
+/*                      https://godotengine.org                           */
+/**************************************************************************/
+/* Copyright (c) 2022-present Godot XR contributors (see CONTRIBUTORS.md) */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#include "openxr_environment_depth_uniforms.h"
+
+#include <godot_cpp/classes/engine.hpp>
+#include <godot_cpp/classes/project_settings.hpp>
+#include <godot_cpp/classes/rendering_server.hpp>
+#include <godot_cpp/core/error_macros.hpp>
+#include <godot_cpp/variant/projection.hpp>
+
+static const char *ENVIRONMENT_DEPTH_AVAILABLE_NAME = "ENVIRONMENT_DEPTH_AVAILABLE";
+static const char *ENVIRONMENT_DEPTH_TEXTURE_NAME = "ENVIRONMENT_DEPTH_TEXTURE";
+static const char *ENVIRONMENT_DEPTH_DATA_NAME = "ENVIRONMENT_DEPTH_DATA";
+static const char *ENVIRONMENT_DEPTH_HAND_MASK_NAME = "ENVIRONMENT_DEPTH_HAND_MASK";
+
+static bool already_setup_global_uniforms = false;
+
+void OpenXREnvironmentDepthUniforms::create_shader_global_uniform(const String &p_name, RenderingServer::GlobalShaderParameterType p_type, const Variant &p_value, RenderingServer *p_rendering_server, ProjectSettings *p_project_settings, bool p_is_editor) {
+	String setting_name = "shader_globals/" + p_name;
+	if (!p_project_settings->has_setting(setting_name)) {
+		p_rendering_server->global_shader_parameter_add(p_name, p_type, p_value);
+		if (p_is_editor) {
+			String type_name;
+			switch (p_type) {
+				case RenderingServer::GLOBAL_VAR_TYPE_BOOL: {
+					type_name = "bool";
+				} break;
+				case RenderingServer::GLOBAL_VAR_TYPE_INT: {
+					type_name = "int";
+				} break;
+				case RenderingServer::GLOBAL_VAR_TYPE_VEC2: {
+					type_name = "vec2";
+				} break;
+				case RenderingServer::GLOBAL_VAR_TYPE_VEC4: {
+					type_name = "vec4";
+				} break;
+				case RenderingServer::GLOBAL_VAR_TYPE_MAT4: {
+					type_name = "mat4";
+				} break;
+				case RenderingServer::GLOBAL_VAR_TYPE_SAMPLER2D: {
+					type_name = "sampler2D";
+				} break;
+				case RenderingServer::GLOBAL_VAR_TYPE_SAMPLER2DARRAY: {
+					type_name = "sampler2DArray";
+				} break;
+				default: {
+					ERR_FAIL_MSG("Unsupported shader global uniform type.");
+				} break;
+			}
+
+			Variant setting_value = p_value;
+			if (p_type == RenderingServer::GLOBAL_VAR_TYPE_SAMPLER2D || p_type == RenderingServer::GLOBAL_VAR_TYPE_SAMPLER2DARRAY) {
+				// In ProjectSettings, this uses a path as a value.
+				setting_value = "";
+			}
+
+			Dictionary d;
+			d["type"] = type_name;
+			d["value"] = setting_value;
+			p_project_settings->set(setting_name, d);
+		}
+	}
+}
+
+void OpenXREnvironmentDepthUniforms::remove_shader_global_uniform(const String &p_name, RenderingServer *p_rendering_server, ProjectSettings *p_project_settings) {
+	String setting_name = "shader_globals/" + p_name;
+	if (p_project_settings->has_setting(setting_name)) {
+		p_rendering_server->global_shader_parameter_remove(p_name);
+		p_project_settings->clear(setting_name);
+	}
+}
+
+void OpenXREnvironmentDepthUniforms::setup_global_uniforms() {
+	RenderingServer *rs = RenderingServer::get_singleton();
+	ERR_FAIL_NULL(rs);
+
+	ProjectSettings *project_settings = ProjectSettings::get_singleton();
+	ERR_FAIL_NULL(project_settings);
+
+	// Shared by all providers, so only remove them once none of them are enabled.
+	bool meta_enabled = project_settings->get_setting_with_override("xr/openxr/extensions/meta/environment_depth");
+	bool android_enabled = project_settings->get_setting_with_override("xr/openxr/extensions/androidxr/environment_depth");
+
+	if (!meta_enabled && !android_enabled) {
+		remove_shader_global_uniform(ENVIRONMENT_DEPTH_AVAILABLE_NAME, rs, project_settings);
+		remove_shader_global_uniform(ENVIRONMENT_DEPTH_TEXTURE_NAME, rs, project_settings);
+		remove_shader_global_uniform(ENVIRONMENT_DEPTH_DATA_NAME, rs, project_settings);
+		remove_shader_global_uniform(ENVIRONMENT_DEPTH_HAND_MASK_NAME, rs, project_settings);
+
+		already_setup_global_uniforms = false;
+		return;
+	}
+
+	if (already_setup_global_uniforms) {
+		return;
+	}
+
+	Engine *engine = Engine::get_singleton();
+	ERR_FAIL_NULL(engine);
+
+	bool is_editor = engine->is_editor_hint();
+
+	// Set this right away, to prevent getting in a loop of project settings changes.
+	already_setup_global_uniforms = true;
+
+	create_shader_global_uniform(ENVIRONMENT_DEPTH_AVAILABLE_NAME, RenderingServer::GLOBAL_VAR_TYPE_BOOL, false, rs, project_settings, is_editor);
+	create_shader_global_uniform(ENVIRONMENT_DEPTH_TEXTURE_NAME, RenderingServer::GLOBAL_VAR_TYPE_SAMPLER2DARRAY, Variant(), rs, project_settings, is_editor);
+	create_shader_global_uniform(ENVIRONMENT_DEPTH_DATA_NAME, RenderingServer::GLOBAL_VAR_TYPE_SAMPLER2D, Variant(), rs, project_settings, is_editor);
+	create_shader_global_uniform(ENVIRONMENT_DEPTH_HAND_MASK_NAME, RenderingServer::GLOBAL_VAR_TYPE_SAMPLER2DARRAY, Variant(), rs, project_settings, is_editor);
+}
+
+OpenXREnvironmentDepthUniforms::OpenXREnvironmentDepthUniforms() {
+	global_shader_parameter_names.resize(GLOBAL_SHADER_PARAMETER_MAX);
+	global_shader_parameter_names[GLOBAL_SHADER_PARAMETER_AVAILABLE] = StringName(ENVIRONMENT_DEPTH_AVAILABLE_NAME);
+	global_shader_parameter_names[GLOBAL_SHADER_PARAMETER_TEXTURE] = StringName(ENVIRONMENT_DEPTH_TEXTURE_NAME);
+	global_shader_parameter_names[GLOBAL_SHADER_PARAMETER_DATA] = StringName(ENVIRONMENT_DEPTH_DATA_NAME);
+	global_shader_parameter_names[GLOBAL_SHADER_PARAMETER_HAND_MASK] = StringName(ENVIRONMENT_DEPTH_HAND_MASK_NAME);
+
+	data.resize(VIEW_COUNT * DATA_TEXEL_MAX * 4 * sizeof(float));
+	data.fill(0);
+}
+
+void OpenXREnvironmentDepthUniforms::set_depth_format(const Vector4 &p_linearize, const Vector2 &p_texel_size, bool p_flip_y) {
+	Vector4 texture_info = Vector4(p_texel_size.x, p_texel_size.y, p_flip_y ? 1.0 : 0.0, hand_mask.is_valid() ? 1.0 : 0.0);
+	for (int i = 0; i < VIEW_COUNT; i++) {
+		_set_data_texel(i, DATA_TEXEL_LINEARIZE, p_linearize);
+		_set_data_texel(i, DATA_TEXEL_TEXTURE_INFO, texture_info);
+	}
+}
+
+void OpenXREnvironmentDepthUniforms::set_view(int p_view, const Transform3D &p_depth_view_to_world, const Vector4 &p_tan_fov) {
+	ERR_FAIL_INDEX(p_view, VIEW_COUNT);
+
+	Projection world_to_depth_view = Projection(p_depth_view_to_world.affine_inverse());
+	Projection depth_view_to_world = Projection(p_depth_view_to_world);
+	for (int i = 0; i < 4; i++) {
+		_set_data_texel(p_view, DATA_TEXEL_WORLD_TO_DEPTH_VIEW + i, world_to_depth_view.columns[i]);
+		_set_data_texel(p_view, DATA_TEXEL_DEPTH_VIEW_TO_WORLD + i, depth_view_to_world.columns[i]);
+	}
+	_set_data_texel(p_view, DATA_TEXEL_TAN_FOV, p_tan_fov);
+}
+
+void OpenXREnvironmentDepthUniforms::set_hand_mask(const RID &p_hand_mask) {
+	if (p_hand_mask == hand_mask) {
+		return;
+	}
+
+	RenderingServer *rs = RenderingServer::get_singleton();
+	ERR_FAIL_NULL(rs);
+
+	rs->global_shader_parameter_set(global_shader_parameter_names[GLOBAL_SHADER_PARAMETER_HAND_MASK], p_hand_mask);
+	hand_mask = p_hand_mask;
+
+	// The last component of the texture info tells shaders whether to sample the hand mask.
+	for (int i = 0; i < VIEW_COUNT; i++) {
+		_get_data_texel(i, DATA_TEXEL_TEXTURE_INFO)[3] = hand_mask.is_valid() ? 1.0 : 0.0;
+	}
+}
+
+bool OpenXREnvironmentDepthUniforms::update(const RID &p_depth_texture) {
+	RenderingServer *rs = RenderingServer::get_singleton();
+	ERR_FAIL_NULL_V(rs, false);
+
+	if (p_depth_texture.is_valid() && (data_dirty || !data_texture.is_valid())) {
+		if (data_image.is_null()) {
+			data_image = Image::create_from_data(DATA_TEXEL_MAX, VIEW_COUNT, false, Image::FORMAT_RGBAF, data);
+		} else {
+			data_image->set_data(DATA_TEXEL_MAX, VIEW_COUNT, false, Image::FORMAT_RGBAF, data);
+		}
+
+		if (likely(data_texture.is_valid())) {
+			rs->texture_2d_update(data_texture, data_image, 0);
+		} else {
+			data_texture = rs->texture_2d_create(data_image);
+			rs->global_shader_parameter_set(global_shader_parameter_names[GLOBAL_SHADER_PARAMETER_DATA], data_texture);
+		}
+		data_dirty = false;
+	}
+
+	return _set_depth_texture(p_depth_texture);
+}
+
+void OpenXREnvironmentDepthUniforms::clear() {
+	_set_depth_texture(RID());
+	set_hand_mask(RID());
+
+	RenderingServer *rs = RenderingServer::get_singleton();
+	if (rs != nullptr && data_texture.is_valid()) {
+		rs->global_shader_parameter_set(global_shader_parameter_names[GLOBAL_SHADER_PARAMETER_DATA], RID());
+		rs->free_rid(data_texture);
+	}
+	data_texture = RID();
+	data_image.unref();
+}
+
+float *OpenXREnvironmentDepthUniforms::_get_data_texel(int p_view, int p_texel) {
+	data_dirty = true;
+	return reinterpret_cast<float *>(data.ptrw()) + (p_view * DATA_TEXEL_MAX + p_texel) * 4;
+}
+
+void OpenXREnvironmentDepthUniforms::_set_data_texel(int p_view, int p_texel, const Vector4 &p_value) {
+	float *texel = _get_data_texel(p_view, p_texel);
+	texel[0] = p_value.x;
+	texel[1] = p_value.y;
+	texel[2] = p_value.z;
+	texel[3] = p_value.w;
+}
+
+bool OpenXREnvironmentDepthUniforms::_set_depth_texture(const RID &p_depth_texture) {
+	if (p_depth_texture == depth_texture) {
+		return false;
+	}
+
+	RenderingServer *rs = RenderingServer::get_singleton();
+	ERR_FAIL_NULL_V(rs, false);
+
+	if (p_depth_texture.is_valid() != depth_texture.is_valid()) {
+		rs->global_shader_parameter_set(global_shader_parameter_names[GLOBAL_SHADER_PARAMETER_AVAILABLE], p_depth_texture.is_valid());
+	}
+	rs->global_shader_parameter_set(global_shader_parameter_names[GLOBAL_SHADER_PARAMETER_TEXTURE], p_depth_texture);
+
+	depth_texture = p_depth_texture;
+
+	return true;
+}
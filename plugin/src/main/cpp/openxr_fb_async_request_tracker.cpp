@@ -0,0 +1,222 @@
+/**************************************************************************/
+/*  openxr_fb_async_request_tracker.cpp                                   */
+/**************************************************************************/
+/*                       This file is part of:                            */
+/*                              GODOT XR                                  */
+/*                      https://godotengine.org                           */
+/**************************************************************************/
+/* Copyright (c) 2022-present Godot XR contributors (see CONTRIBUTORS.md) */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#include "openxr_fb_async_request_tracker.h"
+
+#include <godot_cpp/classes/time.hpp>
+#include <godot_cpp/templates/local_vector.hpp>
+
+using namespace godot;
+
+OpenXRFbAsyncRequestTracker::~OpenXRFbAsyncRequestTracker() {
+	// The owners of the requests are likely being destroyed as well, so only free the request data.
+	LocalVector<XrAsyncRequestIdFB> pending;
+	for (const KeyValue<XrAsyncRequestIdFB, Request> &E : requests) {
+		pending.push_back(E.key);
+	}
+
+	for (const XrAsyncRequestIdFB &request_id : pending) {
+		abandon_request(request_id, XR_ERROR_SESSION_NOT_RUNNING, false);
+	}
+}
+
+const char *OpenXRFbAsyncRequestTracker::get_request_type_name(RequestType p_type) {
+	switch (p_type) {
+		case REQUEST_TYPE_CREATE_SPATIAL_ANCHOR:
+			return "create_spatial_anchor";
+		case REQUEST_TYPE_SET_COMPONENT_ENABLED:
+			return "set_component_enabled";
+		case REQUEST_TYPE_SAVE_SPACE:
+			return "save_space";
+		case REQUEST_TYPE_ERASE_SPACE:
+			return "erase_space";
+		case REQUEST_TYPE_SAVE_SPACE_LIST:
+			return "save_space_list";
+		case REQUEST_TYPE_QUERY_SPACES:
+			return "query_spaces";
+		case REQUEST_TYPE_SHARE_SPACES:
+			return "share_spaces";
+		default:
+			return "unknown";
+	}
+}
+
+void OpenXRFbAsyncRequestTracker::add_request(XrAsyncRequestIdFB p_request_id, RequestType p_type, void *p_request_data, RequestAbandonedCallback p_abandoned_callback, double p_timeout) {
+	ERR_FAIL_INDEX(p_type, REQUEST_TYPE_MAX);
+	ERR_FAIL_NULL(p_abandoned_callback);
+
+	if (requests.has(p_request_id)) {
+		// Should never happen, but make sure we don't silently drop the previous request.
+		WARN_PRINT(vformat("OpenXR: Async request %d is already being tracked.", (int64_t)p_request_id));
+		abandon_request(p_request_id, XR_ERROR_RUNTIME_FAILURE);
+	}
+
+	if (p_timeout < 0.0) {
+		p_timeout = default_timeout;
+	}
+
+	Request request;
+	request.type = p_type;
+	request.request_data = p_request_data;
+	request.abandoned_callback = p_abandoned_callback;
+	request.start_time = Time::get_singleton()->get_ticks_usec();
+	request.deadline = p_timeout > 0.0 ? request.start_time + (uint64_t)(p_timeout * 1000000.0) : 0;
+	requests[p_request_id] = request;
+
+	statistics[p_type].issued++;
+	statistics[p_type].pending++;
+}
+
+void *OpenXRFbAsyncRequestTracker::get_request_data(XrAsyncRequestIdFB p_request_id, RequestType p_type) const {
+	const Request *request = requests.getptr(p_request_id);
+	if (request == nullptr || request->type != p_type) {
+		return nullptr;
+	}
+	return request->request_data;
+}
+
+void *OpenXRFbAsyncRequestTracker::complete_request(XrAsyncRequestIdFB p_request_id, RequestType p_type) {
+	Request *request = requests.getptr(p_request_id);
+	if (request == nullptr || request->type != p_type) {
+		return nullptr;
+	}
+
+	uint64_t latency = Time::get_singleton()->get_ticks_usec() - request->start_time;
+
+	Statistics &stats = statistics[p_type];
+	stats.completed++;
+	stats.pending--;
+	stats.total_latency += latency;
+	stats.last_latency = latency;
+	if (stats.completed == 1 || latency < stats.min_latency) {
+		stats.min_latency = latency;
+	}
+	if (latency > stats.max_latency) {
+		stats.max_latency = latency;
+	}
+
+	void *request_data = request->request_data;
+	requests.erase(p_request_id);
+	return request_data;
+}
+
+void OpenXRFbAsyncRequestTracker::abandon_request(XrAsyncRequestIdFB p_request_id, XrResult p_result, bool p_report) {
+	Request *request = requests.getptr(p_request_id);
+	if (request == nullptr) {
+		return;
+	}
+
+	Statistics &stats = statistics[request->type];
+	stats.pending--;
+	if (p_result == XR_ERROR_SESSION_NOT_RUNNING) {
+		stats.cancelled++;
+	} else {
+		stats.timed_out++;
+	}
+
+	// Remove the request before calling back, in case the callback starts a new request.
+	Request abandoned = *request;
+	requests.erase(p_request_id);
+
+	abandoned.abandoned_callback(p_result, abandoned.request_data, p_report);
+}
+
+void OpenXRFbAsyncRequestTracker::process() {
+	if (requests.is_empty()) {
+		return;
+	}
+
+	uint64_t now = Time::get_singleton()->get_ticks_usec();
+
+	LocalVector<XrAsyncRequestIdFB> expired;
+	for (const KeyValue<XrAsyncRequestIdFB, Request> &E : requests) {
+		if (E.value.deadline != 0 && now >= E.value.deadline) {
+			expired.push_back(E.key);
+		}
+	}
+
+	for (const XrAsyncRequestIdFB &request_id : expired) {
+		WARN_PRINT(vformat("OpenXR: Async %s request %d timed out.", get_request_type_name(requests[request_id].type), (int64_t)request_id));
+		abandon_request(request_id, XR_ERROR_RUNTIME_FAILURE);
+	}
+}
+
+void OpenXRFbAsyncRequestTracker::cancel_all_requests() {
+	LocalVector<XrAsyncRequestIdFB> pending;
+	for (const KeyValue<XrAsyncRequestIdFB, Request> &E : requests) {
+		pending.push_back(E.key);
+	}
+
+	for (const XrAsyncRequestIdFB &request_id : pending) {
+		abandon_request(request_id, XR_ERROR_SESSION_NOT_RUNNING);
+	}
+}
+
+void OpenXRFbAsyncRequestTracker::set_default_timeout(double p_timeout) {
+	default_timeout = MAX(p_timeout, 0.0);
+}
+
+double OpenXRFbAsyncRequestTracker::get_default_timeout() const {
+	return default_timeout;
+}
+
+int OpenXRFbAsyncRequestTracker::get_pending_request_count() const {
+	return requests.size();
+}
+
+Dictionary OpenXRFbAsyncRequestTracker::get_statistics() const {
+	Dictionary ret;
+
+	for (int i = 0; i < REQUEST_TYPE_MAX; i++) {
+		const Statistics &stats = statistics[i];
+
+		Dictionary entry;
+		entry["issued"] = (int64_t)stats.issued;
+		entry["completed"] = (int64_t)stats.completed;
+		entry["timed_out"] = (int64_t)stats.timed_out;
+		entry["cancelled"] = (int64_t)stats.cancelled;
+		entry["pending"] = (int64_t)stats.pending;
+		entry["last_latency_msec"] = stats.last_latency / 1000.0;
+		entry["min_latency_msec"] = stats.min_latency / 1000.0;
+		entry["max_latency_msec"] = stats.max_latency / 1000.0;
+		entry["average_latency_msec"] = stats.completed > 0 ? (stats.total_latency / (double)stats.completed) / 1000.0 : 0.0;
+
+		ret[get_request_type_name((RequestType)i)] = entry;
+	}
+
+	return ret;
+}
+
+void OpenXRFbAsyncRequestTracker::reset_statistics() {
+	for (int i = 0; i < REQUEST_TYPE_MAX; i++) {
+		uint64_t pending = statistics[i].pending;
+		statistics[i] = Statistics();
+		statistics[i].pending = pending;
+	}
+}
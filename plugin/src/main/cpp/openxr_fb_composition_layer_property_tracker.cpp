@@ -0,0 +1,92 @@
+/**************************************************************************/
+/*  openxr_fb_composition_layer_property_tracker.cpp                      */
+/**************************************************************************/
+/*                       This file is part of:                            */
+/*                              GODOT XR                                  */
+/*                      https://godotengine.org                           */
+/**************************************************************************/
+/* Copyright (c) 2022-present Godot XR contributors (see CONTRIBUTORS.md) */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#include "openxr_fb_composition_layer_property_tracker.h"
+
+#include <godot_cpp/core/memory.hpp>
+
+using namespace godot;
+
+OpenXRFbCompositionLayerPropertyTracker *OpenXRFbCompositionLayerPropertyTracker::singleton = nullptr;
+uint64_t OpenXRFbCompositionLayerPropertyTracker::last_version = 0;
+
+uint64_t OpenXRFbCompositionLayerPropertyTracker::get_version(const void *p_layer, const Dictionary &p_property_values, int64_t p_frame) {
+	if (singleton == nullptr) {
+		singleton = memnew(OpenXRFbCompositionLayerPropertyTracker);
+	}
+
+	LayerState *state = nullptr;
+	for (LayerState &layer_state : singleton->layers) {
+		if (layer_state.layer == p_layer) {
+			state = &layer_state;
+			break;
+		}
+	}
+
+	if (state == nullptr) {
+		singleton->layers.push_back(LayerState());
+		state = &singleton->layers[singleton->layers.size() - 1];
+		state->layer = p_layer;
+		state->frame = p_frame;
+		state->property_values_hash = p_property_values.hash();
+		state->version = ++last_version;
+		return state->version;
+	}
+
+	if (state->frame == p_frame) {
+		return state->version;
+	}
+	state->frame = p_frame;
+
+	int64_t property_values_hash = p_property_values.hash();
+	if (property_values_hash != state->property_values_hash) {
+		state->property_values_hash = property_values_hash;
+		state->version = ++last_version;
+	}
+
+	return state->version;
+}
+
+void OpenXRFbCompositionLayerPropertyTracker::erase(const void *p_layer) {
+	if (singleton == nullptr) {
+		return;
+	}
+
+	for (uint32_t i = 0; i < singleton->layers.size(); i++) {
+		if (singleton->layers[i].layer == p_layer) {
+			singleton->layers.remove_at_unordered(i);
+			break;
+		}
+	}
+
+	if (singleton->layers.is_empty()) {
+		memdelete(singleton);
+		singleton = nullptr;
+	}
+}
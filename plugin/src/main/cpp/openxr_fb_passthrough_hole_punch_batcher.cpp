@@ -0,0 +1,189 @@
+/**************************************************************************/
+/*  openxr_fb_passthrough_hole_punch_batcher.cpp                          */
+/**************************************************************************/
+/*                       This file is part of:                            */
+/*                              GODOT XR                                  */
+/*                      https://godotengine.org                           */
+/**************************************************************************/
+/* Copyright (c) 2022-present Godot XR contributors (see CONTRIBUTORS.md) */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#include "openxr_fb_passthrough_hole_punch_batcher.h"
+
+#include <godot_cpp/classes/rendering_server.hpp>
+#include <godot_cpp/classes/shader.hpp>
+
+static const char *HOLE_PUNCH_SHADER_CODE =
+		"shader_type spatial;\n"
+		"render_mode blend_mix, depth_draw_opaque, cull_back, shadow_to_opacity, shadows_disabled;\n"
+		"void fragment() {\n"
+		"\tALBEDO = vec3(0.0, 0.0, 0.0);\n"
+		"}\n";
+
+bool OpenXRFbPassthroughHolePunchBatcher::update(uint64_t p_owner, RID p_scenario, const Ref<Mesh> &p_mesh, const Transform3D &p_transform) {
+	ERR_FAIL_COND_V(p_mesh.is_null(), false);
+
+	RID mesh = p_mesh->get_rid();
+
+	Entry *entry = entries.getptr(p_owner);
+	if (entry != nullptr && (entry->scenario != p_scenario || entry->mesh != mesh)) {
+		remove(p_owner);
+		entry = nullptr;
+	}
+
+	if (entry == nullptr) {
+		Batch *batch = find_batch(p_scenario, mesh);
+		if (batch == nullptr) {
+			batches.push_back(Batch());
+			batch = &batches[batches.size() - 1];
+			batch->scenario = p_scenario;
+			batch->mesh = p_mesh;
+		}
+
+		batch->owners.push_back(p_owner);
+		batch->dirty = true;
+		entries.insert(p_owner, { p_scenario, mesh, p_transform });
+		return true;
+	}
+
+	if (entry->transform.is_equal_approx(p_transform)) {
+		return false;
+	}
+
+	entry->transform = p_transform;
+	find_batch(p_scenario, mesh)->dirty = true;
+	return true;
+}
+
+bool OpenXRFbPassthroughHolePunchBatcher::remove(uint64_t p_owner) {
+	Entry *entry = entries.getptr(p_owner);
+	if (entry == nullptr) {
+		return false;
+	}
+
+	Batch *batch = find_batch(entry->scenario, entry->mesh);
+	if (batch != nullptr) {
+		batch->owners.erase(p_owner);
+		batch->dirty = true;
+	}
+
+	entries.erase(p_owner);
+	return true;
+}
+
+void OpenXRFbPassthroughHolePunchBatcher::flush() {
+	RenderingServer *rs = RenderingServer::get_singleton();
+
+	uint32_t i = 0;
+	while (i < batches.size()) {
+		Batch &batch = batches[i];
+		if (!batch.dirty) {
+			i++;
+			continue;
+		}
+		batch.dirty = false;
+
+		if (batch.owners.is_empty()) {
+			free_batch(batch);
+			batches.remove_at_unordered(i);
+			continue;
+		}
+
+		if (!batch.multimesh.is_valid()) {
+			batch.multimesh = rs->multimesh_create();
+			rs->multimesh_set_mesh(batch.multimesh, batch.mesh->get_rid());
+
+			batch.instance = rs->instance_create2(batch.multimesh, batch.scenario);
+			rs->instance_geometry_set_material_override(batch.instance, get_material());
+			rs->instance_geometry_set_cast_shadows_setting(batch.instance, RenderingServer::SHADOW_CASTING_SETTING_OFF);
+		}
+
+		if (batch.allocated_count != batch.owners.size()) {
+			rs->multimesh_allocate_data(batch.multimesh, batch.owners.size(), RenderingServer::MULTIMESH_TRANSFORM_3D);
+			batch.allocated_count = batch.owners.size();
+		}
+
+		// Each instance is a 3x4 row-major transform.
+		PackedFloat32Array buffer;
+		buffer.resize(batch.owners.size() * 12);
+		float *w = buffer.ptrw();
+		for (uint64_t owner : batch.owners) {
+			const Transform3D &t = entries[owner].transform;
+			for (int row = 0; row < 3; row++) {
+				*w++ = t.basis.rows[row].x;
+				*w++ = t.basis.rows[row].y;
+				*w++ = t.basis.rows[row].z;
+				*w++ = t.origin[row];
+			}
+		}
+		rs->multimesh_set_buffer(batch.multimesh, buffer);
+
+		i++;
+	}
+}
+
+void OpenXRFbPassthroughHolePunchBatcher::clear() {
+	for (Batch &batch : batches) {
+		free_batch(batch);
+	}
+	batches.clear();
+	entries.clear();
+	material.unref();
+}
+
+OpenXRFbPassthroughHolePunchBatcher::~OpenXRFbPassthroughHolePunchBatcher() {
+	clear();
+}
+
+OpenXRFbPassthroughHolePunchBatcher::Batch *OpenXRFbPassthroughHolePunchBatcher::find_batch(RID p_scenario, RID p_mesh) {
+	for (Batch &batch : batches) {
+		if (batch.scenario == p_scenario && batch.mesh->get_rid() == p_mesh) {
+			return &batch;
+		}
+	}
+	return nullptr;
+}
+
+void OpenXRFbPassthroughHolePunchBatcher::free_batch(Batch &p_batch) {
+	RenderingServer *rs = RenderingServer::get_singleton();
+	if (p_batch.instance.is_valid()) {
+		rs->free_rid(p_batch.instance);
+		p_batch.instance = RID();
+	}
+	if (p_batch.multimesh.is_valid()) {
+		rs->free_rid(p_batch.multimesh);
+		p_batch.multimesh = RID();
+	}
+	p_batch.allocated_count = 0;
+}
+
+RID OpenXRFbPassthroughHolePunchBatcher::get_material() {
+	if (material.is_null()) {
+		Ref<Shader> shader;
+		shader.instantiate();
+		shader->set_code(HOLE_PUNCH_SHADER_CODE);
+
+		material.instantiate();
+		material->set_shader(shader);
+	}
+	return material->get_rid();
+}
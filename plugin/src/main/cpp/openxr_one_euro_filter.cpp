@@ -0,0 +1,150 @@
+/**************************************************************************/
+/*  openxr_one_euro_filter.cpp                                            */
+/**************************************************************************/
+/*                       This file is part of:                            */
+/*                              GODOT XR                                  */
+/*                      https://godotengine.org                           */
+/**************************************************************************/
+/* Copyright (c) 2022-present Godot XR contributors (see CONTRIBUTORS.md) */
+/*                                                                        */
+/* Permission is hereby granted, free of charge, to any person obtaining  */
+/* a copy of this software and associated documentation files (the        */
+/* "Software"), to deal in the Software without restriction, including    */
+/* without limitation the rights to use, copy, modify, merge, publish,    */
+/* distribute, sublicense, and/or sell copies of the Software, and to     */
+/* permit persons to whom the Software is furnished to do so, subject to  */
+/* the following conditions:                                              */
+/*                                                                        */
+/* The above copyright notice and this permission notice shall be         */
+/* included in all copies or substantial portions of the Software.        */
+/*                                                                        */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,        */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF     */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. */
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY   */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,   */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE      */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                 */
+/**************************************************************************/
+
+#include "openxr_one_euro_filter.h"
+
+#include <godot_cpp/core/math.hpp>
+
+using namespace godot;
+
+// Gaps longer than this (for example, after the application was paused) restart the filter,
+// rather than smoothing between two unrelated poses.
+static constexpr double MAX_FILTER_DELTA = 0.25;
+
+static inline float _smoothing_factor(float p_cutoff, float p_delta) {
+	float tau = 1.0f / (Math_TAU * p_cutoff);
+	return 1.0f / (1.0f + tau / p_delta);
+}
+
+template <typename T>
+void OpenXROneEuroFilter::_filter(T *r_values, uint32_t p_count, uint32_t p_group_size, XrTime p_time, const Parameters &p_parameters, const bool *p_valid) {
+	const uint32_t value_count = p_count * p_group_size;
+	if (filtered_values.size() != value_count) {
+		filtered_values.resize(value_count);
+		derivatives.resize(value_count);
+		initialized.resize(p_count);
+		for (uint32_t i = 0; i < p_count; i++) {
+			initialized[i] = false;
+		}
+	}
+
+	double delta = last_time != 0 ? double(p_time - last_time) / 1000000000.0 : 0.0;
+	if (delta < 0.0 || delta > MAX_FILTER_DELTA) {
+		for (uint32_t i = 0; i < p_count; i++) {
+			initialized[i] = false;
+		}
+		delta = 0.0;
+	}
+	last_time = p_time;
+
+	const float dt = (float)delta;
+	const float min_cutoff = MAX(p_parameters.min_cutoff, 0.001f);
+	const float derivative_alpha = dt > 0.0f ? _smoothing_factor(MAX(p_parameters.derivative_cutoff, 0.001f), dt) : 0.0f;
+
+	for (uint32_t i = 0; i < p_count; i++) {
+		T *values = r_values + i * p_group_size;
+		float *filtered = filtered_values.ptr() + i * p_group_size;
+		float *derivative = derivatives.ptr() + i * p_group_size;
+
+		if (p_valid && !p_valid[i]) {
+			initialized[i] = false;
+			continue;
+		}
+
+		if (!initialized[i]) {
+			for (uint32_t j = 0; j < p_group_size; j++) {
+				filtered[j] = values[j];
+				derivative[j] = 0.0f;
+			}
+			initialized[i] = true;
+			continue;
+		}
+
+		if (dt > 0.0f) {
+			float speed_squared = 0.0f;
+			for (uint32_t j = 0; j < p_group_size; j++) {
+				float raw_derivative = (float(values[j]) - filtered[j]) / dt;
+				derivative[j] += derivative_alpha * (raw_derivative - derivative[j]);
+				speed_squared += derivative[j] * derivative[j];
+			}
+
+			const float alpha = _smoothing_factor(min_cutoff + p_parameters.beta * Math::sqrt(speed_squared), dt);
+			for (uint32_t j = 0; j < p_group_size; j++) {
+				filtered[j] += alpha * (float(values[j]) - filtered[j]);
+			}
+		}
+
+		for (uint32_t j = 0; j < p_group_size; j++) {
+			values[j] = filtered[j] + derivative[j] * p_parameters.prediction_time;
+		}
+	}
+}
+
+void OpenXROneEuroFilter::filter(float *r_values, uint32_t p_count, uint32_t p_group_size, XrTime p_time, const Parameters &p_parameters, const bool *p_valid) {
+	_filter(r_values, p_count, p_group_size, p_time, p_parameters, p_valid);
+}
+
+void OpenXROneEuroFilter::filter_positions(Vector3 *r_positions, uint32_t p_count, XrTime p_time, const Parameters &p_parameters, const bool *p_valid) {
+	static_assert(sizeof(Vector3) == 3 * sizeof(real_t));
+	_filter(&r_positions[0].x, p_count, 3, p_time, p_parameters, p_valid);
+}
+
+void OpenXROneEuroFilter::filter_rotations(Quaternion *r_rotations, uint32_t p_count, XrTime p_time, const Parameters &p_parameters, const bool *p_valid) {
+	static_assert(sizeof(Quaternion) == 4 * sizeof(real_t));
+
+	// q and -q are the same rotation, so make sure we don't average across the two.
+	if (filtered_values.size() == p_count * 4) {
+		for (uint32_t i = 0; i < p_count; i++) {
+			if (!initialized[i]) {
+				continue;
+			}
+
+			const float *filtered = filtered_values.ptr() + i * 4;
+			Quaternion &rotation = r_rotations[i];
+			if (rotation.x * filtered[0] + rotation.y * filtered[1] + rotation.z * filtered[2] + rotation.w * filtered[3] < 0.0f) {
+				rotation = -rotation;
+			}
+		}
+	}
+
+	_filter(&r_rotations[0].x, p_count, 4, p_time, p_parameters, p_valid);
+
+	for (uint32_t i = 0; i < p_count; i++) {
+		if (!p_valid || p_valid[i]) {
+			r_rotations[i].normalize();
+		}
+	}
+}
+
+void OpenXROneEuroFilter::reset() {
+	last_time = 0;
+	for (uint32_t i = 0; i < initialized.size(); i++) {
+		initialized[i] = false;
+	}
+}
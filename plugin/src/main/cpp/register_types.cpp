@@ -109,15 +109,22 @@
 #include "classes/openxr_android_scene_submesh_data.h"
 #include "classes/openxr_android_trackable_object_tracker.h"
 #include "classes/openxr_android_trackable_plane_tracker.h"
+#include "classes/openxr_body_retargeter.h"
+#include "classes/openxr_environment_depth_collider.h"
+#include "classes/openxr_environment_depth_fusion.h"
 #include "classes/openxr_fb_hand_tracking_mesh.h"
 #include "classes/openxr_fb_passthrough_geometry.h"
+#include "classes/openxr_fb_passthrough_style.h"
 #include "classes/openxr_fb_render_model.h"
+#include "classes/openxr_fb_room_layout.h"
 #include "classes/openxr_fb_scene_manager.h"
 #include "classes/openxr_fb_spatial_anchor_manager.h"
 #include "classes/openxr_fb_spatial_entity.h"
 #include "classes/openxr_fb_spatial_entity_batch.h"
 #include "classes/openxr_fb_spatial_entity_query.h"
 #include "classes/openxr_fb_spatial_entity_user.h"
+#include "classes/openxr_hand_gesture.h"
+#include "classes/openxr_hand_gesture_recognizer.h"
 #include "classes/openxr_hybrid_app.h"
 #include "classes/openxr_meta_environment_depth.h"
 #include "classes/openxr_meta_passthrough_color_lut.h"
@@ -132,6 +139,7 @@
 #include "classes/openxr_ml_marker_detector_upc_a_settings.h"
 #include "classes/openxr_ml_marker_tracker.h"
 #include "classes/openxr_ml_marker_understanding_manager.h"
+#include "classes/openxr_tracking_filter_settings.h"
 #include "classes/openxr_vendor_performance_metrics.h"
 #include "classes/openxr_vendor_performance_metrics_provider.h"
 
@@ -184,6 +192,7 @@ void initialize_plugin_module(ModuleInitializationLevel p_level) {
 
 			GDREGISTER_ABSTRACT_CLASS(OpenXRVendorPerformanceMetricsProvider);
 			GDREGISTER_CLASS(OpenXRVendorPerformanceMetrics);
+			GDREGISTER_CLASS(OpenXRTrackingFilterSettings);
 			GDREGISTER_CLASS(OpenXRAndroidRecommendedResolutionExtension);
 			GDREGISTER_CLASS(OpenXRMetaPerformanceMetricsExtension);
 
@@ -236,6 +245,7 @@ void initialize_plugin_module(ModuleInitializationLevel p_level) {
 			GDREGISTER_CLASS(OpenXRHtcPassthroughExtension);
 			GDREGISTER_CLASS(OpenXRMlMarkerUnderstandingExtension);
 			GDREGISTER_CLASS(OpenXRFbSpaceWarpExtension);
+			GDREGISTER_CLASS(OpenXREnvironmentDepthFusion);
 			GDREGISTER_CLASS(OpenXRMetaEnvironmentDepthExtension);
 			GDREGISTER_CLASS(OpenXRAndroidEnvironmentDepthExtension);
 
@@ -491,16 +501,22 @@ void initialize_plugin_module(ModuleInitializationLevel p_level) {
 
 			GDREGISTER_CLASS(OpenXRFbRenderModel);
 			GDREGISTER_CLASS(OpenXRFbHandTrackingMesh);
+			GDREGISTER_CLASS(OpenXRHandGesture);
+			GDREGISTER_CLASS(OpenXRHandGestureRecognizer);
+			GDREGISTER_CLASS(OpenXRBodyRetargeter);
 			GDREGISTER_CLASS(OpenXRFbSceneManager);
 			GDREGISTER_CLASS(OpenXRFbSpatialAnchorManager);
 			GDREGISTER_CLASS(OpenXRFbSpatialEntity);
 			GDREGISTER_CLASS(OpenXRFbSpatialEntityBatch);
 			GDREGISTER_CLASS(OpenXRFbSpatialEntityQuery);
 			GDREGISTER_CLASS(OpenXRFbSpatialEntityUser);
+			GDREGISTER_CLASS(OpenXRFbRoomLayout);
 			GDREGISTER_CLASS(OpenXRFbPassthroughGeometry);
+			GDREGISTER_CLASS(OpenXRFbPassthroughStyle);
 			GDREGISTER_CLASS(OpenXRMetaPassthroughColorLut);
 			GDREGISTER_CLASS(OpenXRMetaEnvironmentDepth);
 			GDREGISTER_CLASS(OpenXRAndroidEnvironmentDepth);
+			GDREGISTER_CLASS(OpenXREnvironmentDepthCollider);
 
 			GDREGISTER_CLASS(OpenXRMlMarkerTracker);
 			GDREGISTER_CLASS(OpenXRMlMarkerDetector);
@@ -654,6 +670,7 @@ void add_plugin_project_settings() {
 	_add_bool_project_setting(project_settings, "xr/openxr/extensions/androidxr/eye_tracking", false);
 	_add_bool_project_setting(project_settings, "xr/openxr/extensions/androidxr/face_tracking", false);
 	_add_bool_project_setting(project_settings, "xr/openxr/extensions/androidxr/light_estimation", false);
+	_add_bool_project_setting(project_settings, "xr/openxr/extensions/androidxr/light_estimation/global_shader_parameters", false);
 	_add_bool_project_setting(project_settings, "xr/openxr/extensions/androidxr/passthrough_camera_state", false);
 	_add_bool_project_setting(project_settings, "xr/openxr/extensions/androidxr/dynamic_resolution", true);
 	_add_bool_project_setting(project_settings, "xr/openxr/extensions/androidxr/scene_meshing", false);